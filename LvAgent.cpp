@@ -0,0 +1,92 @@
+#include "LvAgent.h"
+#include "LvEndgameSolver.h"
+#include "LvExpectedValue.h"
+#include "LvMctsAgent.h"
+#include "LvUtils.h"
+
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+template <typename T> std::unique_ptr<lv::Agent> MakeAgent() { return std::make_unique<T>(); }
+
+// Search valued by the shared network, plain playouts without one
+std::unique_ptr<lv::Agent> MakeNetworkMctsAgent()
+{
+    lv::MctsConfig config{};
+    config.pNetwork = lv::GetSharedNeuralNetwork();
+    return std::make_unique<lv::MctsAgent>(config);
+}
+
+} // namespace
+
+const lv::AgentEntry lv::AGENT_TABLE[] = {
+    {"first", MakeAgent<FirstDiceAgent>},
+    {"random", MakeAgent<RandomAgent>},
+    {"greedy", MakeAgent<GreedyAgent>},
+    {"mcts", MakeAgent<MctsAgent>},
+    {"mcts-nn", MakeNetworkMctsAgent},
+    {"ev", MakeAgent<ExpectedValueAgent>},
+    {"endgame", MakeAgent<EndgameAgent>},
+};
+
+const int32_t lv::AGENT_TABLE_SIZE = static_cast<int32_t>(std::size(AGENT_TABLE));
+
+lv::AgentFactoryFn lv::FindAgent(const char* pName)
+{
+    for (int32_t agent_idx = 0; agent_idx < AGENT_TABLE_SIZE; ++agent_idx) {
+        if (std::strcmp(AGENT_TABLE[agent_idx].pName, pName) == 0) {
+            return AGENT_TABLE[agent_idx].factory;
+        }
+    }
+    return nullptr;
+}
+
+lv::DiceValue lv::FirstDiceAgent::ChooseDice(const CompactGameState& rGame, const LegalMoveList& rMoves)
+{
+    return rMoves.moves[0].dice;
+}
+
+void lv::RandomAgent::OnGameStart(const CompactGameState& rGame, PlayerIdx player_idx, uint64_t seed)
+{
+    m_rng.Seed(seed);
+}
+
+lv::DiceValue lv::RandomAgent::ChooseDice(const CompactGameState& rGame, const LegalMoveList& rMoves)
+{
+    return rMoves.moves[m_rng.NextBelow(static_cast<uint32_t>(rMoves.count))].dice;
+}
+
+lv::DiceValue lv::GreedyAgent::ChooseDice(const CompactGameState& rGame, const LegalMoveList& rMoves)
+{
+    const PlayerIdx player_idx = rGame.current_turn.player_idx;
+
+    DiceValue best_dice = DiceValue::Invalid;
+    int32_t best_value = -1;
+    int32_t best_dice_count = 0;
+
+    for (int32_t move_idx = 0; move_idx < rMoves.count; ++move_idx) {
+        const LegalMove &rMove = rMoves.moves[move_idx];
+
+        // Would the player lead this casino after the allocation ?
+        const CompactCasinoState &rCasino = rGame.casinos[static_cast<CasinoIdx>(rMove.dice) - 1];
+        const int32_t bet = rCasino.dice_bets[player_idx] + rMove.dice_count;
+        bool leading = bet > rCasino.neutral_dice_bet + rMove.white_dice_count;
+        for (int32_t other_player_idx = 0; other_player_idx < rGame.player_count; ++other_player_idx) {
+            if (other_player_idx != static_cast<int32_t>(player_idx) &&
+                rCasino.dice_bets[other_player_idx] >= bet) {
+                leading = false;
+            }
+        }
+
+        const int32_t value = leading ? GetCasinoMoneyValue(rCasino) : 0;
+        if (value > best_value || (value == best_value && rMove.dice_count > best_dice_count)) {
+            best_dice = rMove.dice;
+            best_value = value;
+            best_dice_count = rMove.dice_count;
+        }
+    }
+
+    return best_dice;
+}
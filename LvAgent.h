@@ -0,0 +1,60 @@
+#pragma once
+
+#include "LvPublic.h"
+#include "LvRandom.h"
+
+#include <memory>
+
+namespace lv {
+
+// Agent interface, the game loop asks the agent of the current player which legal move to play
+class Agent {
+public:
+    virtual ~Agent() = default;
+
+    // Called before the first turn of every game, seed is the agent's own random stream for that game
+    virtual void OnGameStart(const CompactGameState &rGame, PlayerIdx player_idx, uint64_t seed) {}
+
+    // Choose one of rMoves for the current turn of rGame, rMoves is never empty
+    virtual DiceValue ChooseDice(const CompactGameState &rGame, const LegalMoveList &rMoves) = 0;
+
+    // Called for every agent after any player's move, rGame is the state after the move
+    virtual void OnMovePlayed(const CompactGameState &rGame, PlayerIdx player_idx, DiceValue dice) {}
+};
+
+// Allocate the lowest dice value rolled
+class FirstDiceAgent : public Agent {
+public:
+    DiceValue ChooseDice(const CompactGameState &rGame, const LegalMoveList &rMoves) override;
+};
+
+// Allocate a dice value chosen uniformly among the rolled values
+class RandomAgent : public Agent {
+public:
+    void OnGameStart(const CompactGameState &rGame, PlayerIdx player_idx, uint64_t seed) override;
+    DiceValue ChooseDice(const CompactGameState &rGame, const LegalMoveList &rMoves) override;
+
+private:
+    Rng m_rng;
+};
+
+// Allocate to the richest casino the player would lead, otherwise the value with the most dices
+class GreedyAgent : public Agent {
+public:
+    DiceValue ChooseDice(const CompactGameState &rGame, const LegalMoveList &rMoves) override;
+};
+
+using AgentFactoryFn = std::unique_ptr<Agent> (*)();
+
+struct AgentEntry {
+    const char *pName = nullptr;
+    AgentFactoryFn factory = nullptr;
+};
+
+extern const AgentEntry AGENT_TABLE[];
+extern const int32_t AGENT_TABLE_SIZE;
+
+// Returns nullptr if no agent has that name
+AgentFactoryFn FindAgent(const char *pName);
+
+} // namespace lv
@@ -0,0 +1,615 @@
+#include "LvBatchGameEngine.h"
+#include "LvDiceRoll.h"
+#include "LvGameEngine.h"
+#include "LvStateHash.h"
+#include "LvUtils.h"
+
+#include <algorithm>
+
+namespace {
+
+// Bidders of a casino: the players, then the neutral player
+enum { BIDDER_COUNT = lv::MAX_PLAYER_COUNT + 1 };
+
+// Lane loops pick their values with masks rather than branches or conditional loads, so that they vectorize
+inline uint8_t LaneMask(bool condition)
+{
+    return static_cast<uint8_t>(0 - static_cast<uint8_t>(condition));
+}
+
+inline uint8_t LaneSelect(bool condition, uint8_t value, uint8_t other_value)
+{
+    const uint8_t mask = LaneMask(condition);
+    return static_cast<uint8_t>((value & mask) | (other_value & ~mask));
+}
+
+} // namespace
+
+lv::BatchGameEngine::BatchGameEngine(int32_t game_count, int32_t player_count)
+    : m_game_count(std::max(0, game_count)),
+      m_lane_count((std::max(0, game_count) + LANE_BLOCK_SIZE - 1) / LANE_BLOCK_SIZE * LANE_BLOCK_SIZE),
+      m_player_count(std::clamp<int32_t>(player_count, 2, MAX_PLAYER_COUNT))
+{
+    const size_t lane_count = static_cast<size_t>(m_lane_count);
+
+    m_running.assign(lane_count, 0);
+    m_round_over.assign(lane_count, 0);
+    m_rolling.assign(lane_count, 0);
+
+    m_moves.assign(lane_count, 0);
+    m_lane_dices.assign(lane_count, 0);
+    m_lane_white_dices.assign(lane_count, 0);
+    m_next_player.assign(lane_count, 0);
+    m_found.assign(lane_count, 0);
+    m_ending_games.reserve(lane_count);
+    m_ending_bets.assign(lane_count * CASINO_COUNT * BIDDER_COUNT, 0);
+    m_ending_casino_bills.assign(lane_count * CASINO_COUNT * BILL_TYPE_COUNT, 0);
+    m_ending_won_bills.assign(lane_count * BIDDER_COUNT * BILL_TYPE_COUNT, 0);
+    m_ending_leftovers.assign(lane_count * CASINO_COUNT * BILL_TYPE_COUNT, 0);
+    m_unique_bidders.assign(lane_count * BIDDER_COUNT, 0);
+    m_bidder_ranks.assign(lane_count * BIDDER_COUNT, 0);
+    m_survivors.assign(lane_count, 0);
+    m_bills_above.assign(lane_count, 0);
+
+    m_rng_state.assign(lane_count * 4, 0);
+
+    m_round.assign(lane_count, 0);
+    m_first_player.assign(lane_count, 0);
+    m_current_player.assign(lane_count, 0);
+
+    m_player_dices.assign(lane_count * MAX_PLAYER_COUNT, 0);
+    m_player_white_dices.assign(lane_count * MAX_PLAYER_COUNT, 0);
+    m_turn_dices.assign(lane_count * CASINO_COUNT, 0);
+    m_turn_white_dices.assign(lane_count * CASINO_COUNT, 0);
+    m_dice_bets.assign(lane_count * CASINO_COUNT * MAX_PLAYER_COUNT, 0);
+    m_neutral_dice_bets.assign(lane_count * CASINO_COUNT, 0);
+
+    m_bills.assign(lane_count, {});
+}
+
+bool lv::BatchGameEngine::SetupGame(int32_t game_idx, uint64_t seed)
+{
+    GameEngine engine{seed};
+    CompactGameState game{};
+
+    if (!engine.SetupInitGameState(game, m_player_count) || !engine.SetupRound(game) || !engine.StartRound(game)) {
+        return false;
+    }
+
+    return SetGameState(game_idx, game, engine.GetRng());
+}
+
+bool lv::BatchGameEngine::SetGameState(int32_t game_idx, const CompactGameState& rGame, const Rng& rRng)
+{
+    if (game_idx < 0 || game_idx >= m_game_count || rGame.player_count != m_player_count) {
+        return false;
+    }
+    if (rGame.bank_size < 0 || rGame.bank_size > BANK_BILL_COUNT || rGame.round < 0) {
+        return false;
+    }
+
+    const int32_t lane = game_idx;
+
+    for (int32_t word_idx = 0; word_idx < 4; ++word_idx) {
+        m_rng_state[word_idx * m_lane_count + lane] = rRng.GetState()[word_idx];
+    }
+
+    m_round[lane] = static_cast<uint8_t>(std::min<int32_t>(rGame.round, ROUND_COUNT));
+    m_first_player[lane] = static_cast<uint8_t>(rGame.first_player_idx);
+    m_current_player[lane] = static_cast<uint8_t>(rGame.current_turn.player_idx);
+    m_running[lane] = rGame.round < ROUND_COUNT;
+
+    GameBills &rBills = m_bills[lane];
+    rBills = {};
+
+    for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+        const bool present = player_idx < m_player_count;
+        const CompactPlayerState &rPlayer = rGame.players[player_idx];
+        Row(m_player_dices, player_idx)[lane] = present ? static_cast<uint8_t>(rPlayer.dices) : 0;
+        Row(m_player_white_dices, player_idx)[lane] = present ? static_cast<uint8_t>(rPlayer.white_dices) : 0;
+        if (present) {
+            rBills.players[player_idx] = rPlayer.bills;
+        }
+    }
+
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+            const bool present = player_idx < m_player_count;
+            Row(m_dice_bets, casino_idx * MAX_PLAYER_COUNT + player_idx)[lane] =
+                present ? static_cast<uint8_t>(rCasino.dice_bets[player_idx]) : 0;
+        }
+        Row(m_neutral_dice_bets, casino_idx)[lane] = static_cast<uint8_t>(rCasino.neutral_dice_bet);
+        rBills.casinos[casino_idx] = rCasino.bills;
+
+        Row(m_turn_dices, casino_idx)[lane] = rGame.current_turn.dices[casino_idx];
+        Row(m_turn_white_dices, casino_idx)[lane] = rGame.current_turn.white_dices[casino_idx];
+    }
+
+    rBills.neutral_player = rGame.neutral_player_bills;
+    rBills.bank = rGame.bank;
+    rBills.bank_size = static_cast<uint8_t>(rGame.bank_size);
+
+    return true;
+}
+
+void lv::BatchGameEngine::GetGameState(int32_t game_idx, CompactGameState& rGame) const
+{
+    const int32_t lane = game_idx;
+    const GameBills &rBills = m_bills[lane];
+
+    rGame = {};
+    rGame.round = m_round[lane];
+    rGame.first_player_idx = m_first_player[lane];
+    rGame.player_count = m_player_count;
+    rGame.neutral_player_present = m_player_count < MAX_PLAYER_COUNT;
+
+    for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+        CompactPlayerState &rPlayer = rGame.players[player_idx];
+        rPlayer.dices = static_cast<int8_t>(Row(m_player_dices, player_idx)[lane]);
+        rPlayer.white_dices = static_cast<int8_t>(Row(m_player_white_dices, player_idx)[lane]);
+        rPlayer.bills = rBills.players[player_idx];
+    }
+
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+            rCasino.dice_bets[player_idx] =
+                static_cast<int8_t>(Row(m_dice_bets, casino_idx * MAX_PLAYER_COUNT + player_idx)[lane]);
+        }
+        rCasino.neutral_dice_bet = static_cast<int8_t>(Row(m_neutral_dice_bets, casino_idx)[lane]);
+        rCasino.bills = rBills.casinos[casino_idx];
+
+        rGame.current_turn.dices[casino_idx] = Row(m_turn_dices, casino_idx)[lane];
+        rGame.current_turn.white_dices[casino_idx] = Row(m_turn_white_dices, casino_idx)[lane];
+    }
+    rGame.current_turn.player_idx = m_current_player[lane];
+
+    rGame.neutral_player_bills = rBills.neutral_player;
+    rGame.bank = rBills.bank;
+    rGame.bank_size = rBills.bank_size;
+
+    // Lanes don't keep a hash, it is only needed once the game leaves the batch
+    rGame.hash = ComputeHash(rGame);
+}
+
+lv::Rng lv::BatchGameEngine::GetRng(int32_t game_idx) const
+{
+    Rng::StateType state{};
+    for (int32_t word_idx = 0; word_idx < 4; ++word_idx) {
+        state[word_idx] = m_rng_state[word_idx * m_lane_count + game_idx];
+    }
+
+    Rng rng{};
+    rng.SetState(state);
+
+    return rng;
+}
+
+int32_t lv::BatchGameEngine::GetRunningGameCount() const
+{
+    int32_t running_count = 0;
+    for (int32_t lane = 0; lane < m_lane_count; ++lane) {
+        running_count += m_running[lane];
+    }
+    return running_count;
+}
+
+int32_t lv::BatchGameEngine::GetLegalMoves(int32_t game_idx, LegalMoveList& rMoves) const
+{
+    // One move per rolled face, in ascending face order like GameEngine
+    rMoves.count = 0;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        LegalMove &rMove = rMoves.moves[rMoves.count];
+        rMove.dice = static_cast<DiceValue>(face_idx + 1);
+        rMove.dice_count = Row(m_turn_dices, face_idx)[game_idx];
+        rMove.white_dice_count = Row(m_turn_white_dices, face_idx)[game_idx];
+        rMoves.count += (rMove.dice_count | rMove.white_dice_count) != 0;
+    }
+
+    return rMoves.count;
+}
+
+int32_t lv::BatchGameEngine::GetPlayerMoneyValue(int32_t game_idx, PlayerIdx player_idx) const
+{
+    int32_t value = 0;
+    for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+        value += m_bills[game_idx].players[player_idx][bill_idx] * static_cast<int32_t>(GetBillFromIndex(bill_idx));
+    }
+    return value;
+}
+
+bool lv::BatchGameEngine::PlayMoves(const DiceValue* pMoves)
+{
+    const int32_t lane_count = m_lane_count;
+    uint8_t *pFound = m_found.data();
+    uint8_t *pRoundOver = m_round_over.data();
+    uint8_t *pRolling = m_rolling.data();
+    uint8_t *pRunning = m_running.data();
+    // Every running game must be given a rolled face
+    for (int32_t lane = 0; lane < m_game_count; ++lane) {
+        if (!pRunning[lane]) {
+            m_moves[lane] = 0;
+            continue;
+        }
+        const int32_t face_idx = static_cast<int32_t>(pMoves[lane]) - 1;
+        if (face_idx < 0 || face_idx >= CASINO_COUNT ||
+            (Row(m_turn_dices, face_idx)[lane] | Row(m_turn_white_dices, face_idx)[lane]) == 0) {
+            return false;
+        }
+        m_moves[lane] = static_cast<uint8_t>(face_idx + 1);
+    }
+
+    AllocateDices(m_moves.data());
+
+    // The round is over in the games where nobody has any dice left, the others go on with the next player
+    std::fill(m_found.begin(), m_found.end(), 0);
+    for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+        const uint8_t *pDices = Row(m_player_dices, player_idx);
+        const uint8_t *pWhiteDices = Row(m_player_white_dices, player_idx);
+        for (int32_t lane = 0; lane < lane_count; ++lane) {
+            pFound[lane] |= pDices[lane] | pWhiteDices[lane];
+        }
+    }
+    bool any_round_over = false;
+    for (int32_t lane = 0; lane < lane_count; ++lane) {
+        pRoundOver[lane] = pRunning[lane] & (pFound[lane] == 0);
+        pRolling[lane] = pRunning[lane] & (pFound[lane] != 0);
+        any_round_over |= pRoundOver[lane] != 0;
+    }
+
+    AdvanceToNextPlayer();
+
+    m_deal_failed = false;
+    if (any_round_over) {
+        EndRound();
+        SetupRounds();
+    }
+
+    RollDices();
+
+    return !m_deal_failed;
+}
+
+void lv::BatchGameEngine::AllocateDices(const uint8_t* pMoves)
+{
+    const int32_t lane_count = m_lane_count;
+    uint8_t *pDices = m_lane_dices.data();
+    uint8_t *pWhiteDices = m_lane_white_dices.data();
+    const uint8_t *pCurrentPlayer = m_current_player.data();
+
+    // Dices of the chosen face, the turn is over
+    std::fill(m_lane_dices.begin(), m_lane_dices.end(), 0);
+    std::fill(m_lane_white_dices.begin(), m_lane_white_dices.end(), 0);
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        uint8_t *pTurnDices = Row(m_turn_dices, face_idx);
+        uint8_t *pTurnWhiteDices = Row(m_turn_white_dices, face_idx);
+        const uint8_t face = static_cast<uint8_t>(face_idx + 1);
+        for (int32_t lane = 0; lane < lane_count; ++lane) {
+            pDices[lane] += pTurnDices[lane] & LaneMask(pMoves[lane] == face);
+            pWhiteDices[lane] += pTurnWhiteDices[lane] & LaneMask(pMoves[lane] == face);
+            pTurnDices[lane] &= LaneMask(pMoves[lane] == 0);
+            pTurnWhiteDices[lane] &= LaneMask(pMoves[lane] == 0);
+        }
+    }
+
+    // They go to the casino of that face
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const uint8_t face = static_cast<uint8_t>(casino_idx + 1);
+        for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+            uint8_t *pBets = Row(m_dice_bets, casino_idx * MAX_PLAYER_COUNT + player_idx);
+            for (int32_t lane = 0; lane < lane_count; ++lane) {
+                const bool selected = (pMoves[lane] == face) & (pCurrentPlayer[lane] == player_idx);
+                pBets[lane] += pDices[lane] & LaneMask(selected);
+            }
+        }
+        uint8_t *pNeutralBets = Row(m_neutral_dice_bets, casino_idx);
+        for (int32_t lane = 0; lane < lane_count; ++lane) {
+            pNeutralBets[lane] += pWhiteDices[lane] & LaneMask(pMoves[lane] == face);
+        }
+    }
+
+    for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+        uint8_t *pPlayerDices = Row(m_player_dices, player_idx);
+        uint8_t *pPlayerWhiteDices = Row(m_player_white_dices, player_idx);
+        for (int32_t lane = 0; lane < lane_count; ++lane) {
+            const bool selected = pCurrentPlayer[lane] == player_idx;
+            pPlayerDices[lane] -= pDices[lane] & LaneMask(selected);
+            pPlayerWhiteDices[lane] -= pWhiteDices[lane] & LaneMask(selected);
+        }
+    }
+}
+
+void lv::BatchGameEngine::AdvanceToNextPlayer()
+{
+    const int32_t lane_count = m_lane_count;
+    uint8_t *pCurrentPlayer = m_current_player.data();
+    uint8_t *pRolling = m_rolling.data();
+    // Next player with some dices, the current player plays again when nobody else has any
+    const uint8_t player_count = static_cast<uint8_t>(m_player_count);
+    uint8_t *pNextPlayer = m_next_player.data();
+    uint8_t *pFound = m_found.data();
+
+    std::copy(m_current_player.begin(), m_current_player.end(), m_next_player.begin());
+    std::fill(m_found.begin(), m_found.end(), 0);
+
+    for (uint8_t offset = 1; offset <= player_count; ++offset) {
+        for (uint8_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            const uint8_t *pDices = Row(m_player_dices, player_idx);
+            const uint8_t *pWhiteDices = Row(m_player_white_dices, player_idx);
+            for (int32_t lane = 0; lane < lane_count; ++lane) {
+                uint8_t candidate = static_cast<uint8_t>(pCurrentPlayer[lane] + offset);
+                candidate -= player_count & LaneMask(candidate >= player_count);
+                const bool take = pRolling[lane] & (pFound[lane] == 0) & (candidate == player_idx) &
+                                  ((pDices[lane] | pWhiteDices[lane]) != 0);
+                pNextPlayer[lane] = LaneSelect(take, player_idx, pNextPlayer[lane]);
+                pFound[lane] |= take;
+            }
+        }
+    }
+
+    std::copy(m_next_player.begin(), m_next_player.end(), m_current_player.begin());
+}
+
+void lv::BatchGameEngine::DistributeCasinoBills()
+{
+    // Gather the games whose round is over, usually a small part of the batch
+    m_ending_games.clear();
+    for (int32_t lane = 0; lane < m_game_count; ++lane) {
+        if (m_round_over[lane]) {
+            m_ending_games.push_back(lane);
+        }
+    }
+    const int32_t ending_game_count = static_cast<int32_t>(m_ending_games.size());
+    m_ending_lane_count = (ending_game_count + LANE_BLOCK_SIZE - 1) / LANE_BLOCK_SIZE * LANE_BLOCK_SIZE;
+    const int32_t lane_count = m_ending_lane_count;
+
+    for (int32_t ending_lane = 0; ending_lane < ending_game_count; ++ending_lane) {
+        const int32_t lane = m_ending_games[ending_lane];
+        for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+            for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+                EndingRow(m_ending_bets, casino_idx * BIDDER_COUNT + player_idx)[ending_lane] =
+                    Row(m_dice_bets, casino_idx * MAX_PLAYER_COUNT + player_idx)[lane];
+            }
+            EndingRow(m_ending_bets, casino_idx * BIDDER_COUNT + MAX_PLAYER_COUNT)[ending_lane] =
+                Row(m_neutral_dice_bets, casino_idx)[lane];
+            std::array<uint8_t, BILL_TYPE_COUNT> &rCasinoBills = m_bills[lane].casinos[casino_idx];
+            for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+                EndingRow(m_ending_casino_bills, casino_idx * BILL_TYPE_COUNT + bill_idx)[ending_lane] =
+                    rCasinoBills[bill_idx];
+            }
+            rCasinoBills = {};
+        }
+    }
+    for (int32_t ending_lane = ending_game_count; ending_lane < lane_count; ++ending_lane) {
+        for (int32_t row_idx = 0; row_idx < static_cast<int32_t>(CASINO_COUNT) * BIDDER_COUNT; ++row_idx) {
+            EndingRow(m_ending_bets, row_idx)[ending_lane] = 0;
+        }
+        for (int32_t row_idx = 0; row_idx < static_cast<int32_t>(CASINO_COUNT) * BILL_TYPE_COUNT; ++row_idx) {
+            EndingRow(m_ending_casino_bills, row_idx)[ending_lane] = 0;
+        }
+    }
+    std::fill(m_ending_won_bills.begin(), m_ending_won_bills.begin() + lane_count * BIDDER_COUNT * BILL_TYPE_COUNT,
+              0);
+
+    // GetCasinoWinners for all the lanes at once: after the equal bets cancel each other, the remaining bidders take
+    // the bills from the highest bet and the highest bill down, and what is left once they all have one goes back to
+    // the bank
+    uint8_t *pSurvivors = m_survivors.data();
+    uint8_t *pBillsAbove = m_bills_above.data();
+
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const auto get_bets = [&](int32_t bidder_idx) {
+            return EndingRow(m_ending_bets, casino_idx * BIDDER_COUNT + bidder_idx);
+        };
+
+        // A bet survives if nobody else bet the same number of dices
+        for (int32_t bidder_idx = 0; bidder_idx < BIDDER_COUNT; ++bidder_idx) {
+            uint8_t *pUnique = EndingRow(m_unique_bidders, bidder_idx);
+            const uint8_t *pBets = get_bets(bidder_idx);
+            for (int32_t lane = 0; lane < lane_count; ++lane) {
+                pUnique[lane] = pBets[lane] != 0;
+            }
+            for (int32_t other_idx = 0; other_idx < BIDDER_COUNT; ++other_idx) {
+                if (other_idx == bidder_idx) {
+                    continue;
+                }
+                const uint8_t *pOtherBets = get_bets(other_idx);
+                for (int32_t lane = 0; lane < lane_count; ++lane) {
+                    pUnique[lane] &= pOtherBets[lane] != pBets[lane];
+                }
+            }
+        }
+
+        // Rank of each surviving bet, 0 for the highest
+        std::fill(pSurvivors, pSurvivors + lane_count, 0);
+        for (int32_t bidder_idx = 0; bidder_idx < BIDDER_COUNT; ++bidder_idx) {
+            uint8_t *pRank = EndingRow(m_bidder_ranks, bidder_idx);
+            const uint8_t *pUnique = EndingRow(m_unique_bidders, bidder_idx);
+            const uint8_t *pBets = get_bets(bidder_idx);
+            std::fill(pRank, pRank + lane_count, 0);
+            for (int32_t other_idx = 0; other_idx < BIDDER_COUNT; ++other_idx) {
+                const uint8_t *pOtherUnique = EndingRow(m_unique_bidders, other_idx);
+                const uint8_t *pOtherBets = get_bets(other_idx);
+                for (int32_t lane = 0; lane < lane_count; ++lane) {
+                    pRank[lane] += pOtherUnique[lane] & (pOtherBets[lane] > pBets[lane]);
+                }
+            }
+            for (int32_t lane = 0; lane < lane_count; ++lane) {
+                pSurvivors[lane] += pUnique[lane];
+            }
+        }
+
+        // Bills by rank, from the highest one down
+        std::fill(pBillsAbove, pBillsAbove + lane_count, 0);
+        for (int32_t bill_idx = BILL_TYPE_COUNT - 1; bill_idx >= 0; --bill_idx) {
+            const uint8_t *pCasinoBills = EndingRow(m_ending_casino_bills, casino_idx * BILL_TYPE_COUNT + bill_idx);
+
+            for (int32_t bidder_idx = 0; bidder_idx < BIDDER_COUNT; ++bidder_idx) {
+                uint8_t *pWonBills = EndingRow(m_ending_won_bills, bidder_idx * BILL_TYPE_COUNT + bill_idx);
+                const uint8_t *pUnique = EndingRow(m_unique_bidders, bidder_idx);
+                const uint8_t *pRank = EndingRow(m_bidder_ranks, bidder_idx);
+                for (int32_t lane = 0; lane < lane_count; ++lane) {
+                    const uint8_t first_rank = pBillsAbove[lane];
+                    const uint8_t end_rank = static_cast<uint8_t>(first_rank + pCasinoBills[lane]);
+                    pWonBills[lane] += pUnique[lane] & (pRank[lane] >= first_rank) & (pRank[lane] < end_rank);
+                }
+            }
+
+            uint8_t *pLeftovers = EndingRow(m_ending_leftovers, casino_idx * BILL_TYPE_COUNT + bill_idx);
+            for (int32_t lane = 0; lane < lane_count; ++lane) {
+                const uint8_t first_rank = std::max(pBillsAbove[lane], pSurvivors[lane]);
+                const uint8_t end_rank = static_cast<uint8_t>(pBillsAbove[lane] + pCasinoBills[lane]);
+                pLeftovers[lane] = static_cast<uint8_t>(end_rank - first_rank) & LaneMask(end_rank > first_rank);
+                pBillsAbove[lane] = end_rank;
+            }
+        }
+    }
+
+    // Scatter the bills won, the ones nobody won go back to the bank casino by casino in ascending value
+    for (int32_t ending_lane = 0; ending_lane < ending_game_count; ++ending_lane) {
+        GameBills &rBills = m_bills[m_ending_games[ending_lane]];
+        for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+            for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+                rBills.players[player_idx][bill_idx] +=
+                    EndingRow(m_ending_won_bills, player_idx * BILL_TYPE_COUNT + bill_idx)[ending_lane];
+            }
+            const int32_t neutral_row_idx = static_cast<int32_t>(MAX_PLAYER_COUNT) * BILL_TYPE_COUNT + bill_idx;
+            rBills.neutral_player[bill_idx] += EndingRow(m_ending_won_bills, neutral_row_idx)[ending_lane];
+        }
+
+        for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+            for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+                const uint8_t leftover_count =
+                    EndingRow(m_ending_leftovers, casino_idx * BILL_TYPE_COUNT + bill_idx)[ending_lane];
+                for (uint8_t i = 0; i < leftover_count; ++i) {
+                    rBills.bank[rBills.bank_size++] = static_cast<uint8_t>(bill_idx);
+                }
+            }
+        }
+    }
+}
+
+void lv::BatchGameEngine::EndRound()
+{
+    const int32_t lane_count = m_lane_count;
+    uint8_t *pFirstPlayer = m_first_player.data();
+    uint8_t *pRound = m_round.data();
+    uint8_t *pRunning = m_running.data();
+    DistributeCasinoBills();
+
+    // Players take back their dices for the next round
+    const uint8_t *pRoundOver = m_round_over.data();
+    const uint8_t extra_white_dices_count = static_cast<uint8_t>(GetExtraWhiteDiceCount(m_player_count));
+    for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+        uint8_t *pDices = Row(m_player_dices, player_idx);
+        uint8_t *pWhiteDices = Row(m_player_white_dices, player_idx);
+        for (int32_t lane = 0; lane < lane_count; ++lane) {
+            pDices[lane] = LaneSelect(pRoundOver[lane], DICE_COUNT, pDices[lane]);
+            pWhiteDices[lane] = LaneSelect(pRoundOver[lane], extra_white_dices_count, pWhiteDices[lane]);
+        }
+    }
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+            uint8_t *pBets = Row(m_dice_bets, casino_idx * MAX_PLAYER_COUNT + player_idx);
+            for (int32_t lane = 0; lane < lane_count; ++lane) {
+                pBets[lane] &= LaneMask(!pRoundOver[lane]);
+            }
+        }
+        uint8_t *pNeutralBets = Row(m_neutral_dice_bets, casino_idx);
+        for (int32_t lane = 0; lane < lane_count; ++lane) {
+            pNeutralBets[lane] &= LaneMask(!pRoundOver[lane]);
+        }
+    }
+
+    // Next player starts the next round
+    const uint8_t player_count = static_cast<uint8_t>(m_player_count);
+    for (int32_t lane = 0; lane < lane_count; ++lane) {
+        uint8_t next_first_player = static_cast<uint8_t>(pFirstPlayer[lane] + 1);
+        next_first_player -= player_count & LaneMask(next_first_player >= player_count);
+        pFirstPlayer[lane] = LaneSelect(pRoundOver[lane], next_first_player, pFirstPlayer[lane]);
+        pRound[lane] += pRoundOver[lane];
+        pRunning[lane] &= pRound[lane] < ROUND_COUNT;
+    }
+}
+
+void lv::BatchGameEngine::SetupRounds()
+{
+    // Shuffling and dealing walk each bank one bill at a time, one game after the other
+    for (int32_t lane = 0; lane < m_game_count; ++lane) {
+        if (!m_round_over[lane] || !m_running[lane]) {
+            continue;
+        }
+
+        Rng rng = GetRng(lane);
+        GameBills &rBills = m_bills[lane];
+        std::array<uint8_t, BANK_BILL_COUNT> &rBank = rBills.bank;
+        uint8_t &rBankSize = rBills.bank_size;
+
+        Shuffle(rBank.data(), rBankSize, rng);
+
+        for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+            int32_t current_value = 0;
+            while (current_value < CASINO_MIN_MONEY_VALUE) {
+                if (rBankSize == 0) {
+                    m_deal_failed = true;
+                    m_running[lane] = 0;
+                    break;
+                }
+
+                const uint8_t bill_idx = rBank[--rBankSize];
+                rBank[rBankSize] = 0;
+                ++rBills.casinos[casino_idx][bill_idx];
+                current_value += static_cast<int32_t>(GetBillFromIndex(bill_idx));
+            }
+        }
+
+        for (int32_t word_idx = 0; word_idx < 4; ++word_idx) {
+            m_rng_state[word_idx * m_lane_count + lane] = rng.GetState()[word_idx];
+        }
+
+        m_current_player[lane] = m_first_player[lane];
+        m_rolling[lane] = m_running[lane];
+    }
+}
+
+void lv::BatchGameEngine::RollDices()
+{
+    const int32_t lane_count = m_lane_count;
+    uint8_t *pRolling = m_rolling.data();
+    uint8_t *pCurrentPlayer = m_current_player.data();
+    // Dices of the player whose turn it is
+    uint8_t *pDices = m_lane_dices.data();
+    uint8_t *pWhiteDices = m_lane_white_dices.data();
+    std::fill(m_lane_dices.begin(), m_lane_dices.end(), 0);
+    std::fill(m_lane_white_dices.begin(), m_lane_white_dices.end(), 0);
+    for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+        const uint8_t *pPlayerDices = Row(m_player_dices, player_idx);
+        const uint8_t *pPlayerWhiteDices = Row(m_player_white_dices, player_idx);
+        for (int32_t lane = 0; lane < lane_count; ++lane) {
+            const bool selected = pRolling[lane] & (pCurrentPlayer[lane] == player_idx);
+            pDices[lane] += pPlayerDices[lane] & LaneMask(selected);
+            pWhiteDices[lane] += pPlayerWhiteDices[lane] & LaneMask(selected);
+        }
+    }
+
+    for (int32_t lane = 0; lane < m_game_count; ++lane) {
+        if (!pRolling[lane]) {
+            continue;
+        }
+
+        // One histogram draw each, see LvDiceRoll.h
+        Rng rng = GetRng(lane);
+        DiceCounts dices{};
+        DiceCounts white_dices{};
+        RollDiceCounts(rng, pDices[lane], dices);
+        RollDiceCounts(rng, pWhiteDices[lane], white_dices);
+        for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+            Row(m_turn_dices, face_idx)[lane] = dices[face_idx];
+            Row(m_turn_white_dices, face_idx)[lane] = white_dices[face_idx];
+        }
+        for (int32_t word_idx = 0; word_idx < 4; ++word_idx) {
+            m_rng_state[word_idx * m_lane_count + lane] = rng.GetState()[word_idx];
+        }
+    }
+}
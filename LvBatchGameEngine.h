@@ -0,0 +1,122 @@
+#pragma once
+
+#include "LvPublic.h"
+#include "LvRandom.h"
+
+#include <array>
+#include <vector>
+
+namespace lv {
+
+// Many games with the same player count, stepped in lockstep
+//
+// The games are stored as structure of arrays: every counter a turn touches (dices, bets, ...) is a row holding one
+// lane per game, so each step runs the same branch-free loop over all the lanes. Bills only move at the end of a
+// round, they stay together game by game. Rolling takes one histogram draw per lane (see LvDiceRoll.h), the other
+// lane loops are written for the compiler to vectorize with whatever instruction set it targets, e.g. AVX2 when the
+// build enables it (LASVEG_ENABLE_AVX2 in CMake, /arch:AVX2 in Visual Studio). No explicit SIMD path remains, the
+// AVX2 dice roller was replaced by the alias table rolls: even with AVX2, whole games only run 7-17% faster than
+// with GameEngine on one thread (FullGameBatch against FullGame in LasVegBenchmark).
+//
+// Every lane has its own generator and consumes it exactly like GameEngine: a lane started with SetupGame(seed) and
+// given the same moves as a GameEngine(seed) goes through the same states (see GetGameState).
+class BatchGameEngine {
+public:
+    // Lane alignment of the rows, the lane count is rounded up to it
+    enum { LANE_BLOCK_SIZE = 32 };
+
+    BatchGameEngine(int32_t game_count, int32_t player_count);
+
+    int32_t GetGameCount() const { return m_game_count; }
+    int32_t GetPlayerCount() const { return m_player_count; }
+
+    // Start a new game in a lane, like GameEngine(seed) followed by SetupInitGameState, SetupRound and StartRound
+    bool SetupGame(int32_t game_idx, uint64_t seed);
+    // Continue from any state of a game with the given generator, e.g. from a determinized search state
+    bool SetGameState(int32_t game_idx, const CompactGameState &rGame, const Rng &rRng);
+
+    void GetGameState(int32_t game_idx, CompactGameState &rGame) const;
+    Rng GetRng(int32_t game_idx) const;
+
+    bool IsGameOver(int32_t game_idx) const { return m_running[game_idx] == 0; }
+    int32_t GetRunningGameCount() const;
+
+    PlayerIdx GetCurrentPlayer(int32_t game_idx) const { return m_current_player[game_idx]; }
+    int32_t GetLegalMoves(int32_t game_idx, LegalMoveList &rMoves) const;
+    int32_t GetPlayerMoneyValue(int32_t game_idx, PlayerIdx player_idx) const;
+
+    // GameEngine::PlayMove in every running game, pMoves holds one move per game and is ignored for finished games.
+    // Nothing is played and false is returned if a running game is given a face that was not rolled.
+    bool PlayMoves(const DiceValue *pMoves);
+
+private:
+    uint8_t *Row(std::vector<uint8_t> &rRows, int32_t row_idx) { return rRows.data() + row_idx * m_lane_count; }
+    const uint8_t *Row(const std::vector<uint8_t> &rRows, int32_t row_idx) const {
+        return rRows.data() + row_idx * m_lane_count;
+    }
+    uint8_t *EndingRow(std::vector<uint8_t> &rRows, int32_t row_idx) {
+        return rRows.data() + row_idx * m_ending_lane_count;
+    }
+
+    void AllocateDices(const uint8_t *pMoves);
+    void AdvanceToNextPlayer();
+    void DistributeCasinoBills();
+    void EndRound();
+    void SetupRounds();
+    void RollDices();
+
+    int32_t m_game_count = 0;
+    int32_t m_lane_count = 0;
+    int32_t m_player_count = 0;
+
+    // Lanes flags, set for the duration of a step
+    std::vector<uint8_t> m_running;
+    std::vector<uint8_t> m_round_over;
+    std::vector<uint8_t> m_rolling;
+
+    // Scratch rows of a step
+    std::vector<uint8_t> m_moves;
+    std::vector<uint8_t> m_lane_dices;       // Dices allocated or rolled per lane
+    std::vector<uint8_t> m_lane_white_dices; // White dices allocated or rolled per lane
+    std::vector<uint8_t> m_next_player;
+    std::vector<uint8_t> m_found;
+
+    // Games whose round is over are gathered into rows of their own to resolve the casinos, with
+    // m_ending_lane_count lanes per row. Bidders are the players then the neutral player.
+    std::vector<int32_t> m_ending_games;
+    int32_t m_ending_lane_count = 0;
+    std::vector<uint8_t> m_ending_bets;         // Row per casino and bidder
+    std::vector<uint8_t> m_ending_casino_bills; // Row per casino and bill type
+    std::vector<uint8_t> m_ending_won_bills;    // Row per bidder and bill type
+    std::vector<uint8_t> m_ending_leftovers;    // Row per casino and bill type, bills going back to the bank
+    std::vector<uint8_t> m_unique_bidders;      // Row per bidder
+    std::vector<uint8_t> m_bidder_ranks;        // Row per bidder
+    std::vector<uint8_t> m_survivors;
+    std::vector<uint8_t> m_bills_above;
+
+    // xoshiro256** state of every lane, one row per state word
+    std::vector<uint64_t> m_rng_state;
+
+    std::vector<uint8_t> m_round;
+    std::vector<uint8_t> m_first_player;
+    std::vector<uint8_t> m_current_player;
+
+    std::vector<uint8_t> m_player_dices;       // Row per player
+    std::vector<uint8_t> m_player_white_dices; // Row per player
+    std::vector<uint8_t> m_turn_dices;         // Row per face
+    std::vector<uint8_t> m_turn_white_dices;   // Row per face
+    std::vector<uint8_t> m_dice_bets;          // Row per casino and player
+    std::vector<uint8_t> m_neutral_dice_bets;  // Row per casino
+    bool m_deal_failed = false;
+
+    struct GameBills {
+        std::array<std::array<uint8_t, BILL_TYPE_COUNT>, CASINO_COUNT> casinos;
+        std::array<std::array<uint8_t, BILL_TYPE_COUNT>, MAX_PLAYER_COUNT> players;
+        std::array<uint8_t, BILL_TYPE_COUNT> neutral_player;
+        std::array<uint8_t, BANK_BILL_COUNT> bank;
+        uint8_t bank_size;
+    };
+    std::vector<GameBills> m_bills;
+};
+
+} // namespace lv
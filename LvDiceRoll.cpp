@@ -0,0 +1,139 @@
+#include "LvDiceRoll.h"
+
+#include <array>
+#include <vector>
+
+namespace {
+
+// 16 bytes, an entry never straddles two cache lines
+struct alignas(16) AliasEntry {
+    uint32_t threshold = 0; // Positions below it keep the entry's histogram, the others take the alias
+    uint32_t alias = 0;
+    lv::DiceCounts counts{};
+};
+
+struct AliasTable {
+    std::vector<AliasEntry> entries;
+    uint32_t column_size = 0; // 6^n
+    // Lemire's rejection thresholds of the column and position draws, 2^32 % bound
+    uint32_t column_threshold = 0;
+    uint32_t position_threshold = 0;
+};
+
+using AliasTables = std::array<AliasTable, lv::DICE_ROLL_TABLE_MAX_DICE_COUNT + 1>;
+
+AliasTable MakeAliasTable(int32_t dice_count)
+{
+    std::array<uint64_t, lv::DICE_ROLL_TABLE_MAX_DICE_COUNT + 1> factorials{};
+    factorials[0] = 1;
+    for (int32_t n = 1; n <= dice_count; ++n) {
+        factorials[n] = factorials[n - 1] * n;
+    }
+
+    // Histograms with their number of face sequences, n! / (c1! ... c6!)
+    AliasTable table{};
+    std::vector<uint64_t> weights;
+    lv::DiceCounts counts{};
+    auto add_fn = [&](auto &&rSelf, int32_t face_idx, int32_t dice_left) -> void {
+        if (face_idx == lv::CASINO_COUNT - 1) {
+            counts[face_idx] = static_cast<uint8_t>(dice_left);
+            uint64_t ways = factorials[dice_count];
+            for (const uint8_t count : counts) {
+                ways /= factorials[count];
+            }
+            AliasEntry entry{};
+            entry.counts = counts;
+            table.entries.push_back(entry);
+            weights.push_back(ways);
+            return;
+        }
+        for (int32_t count = 0; count <= dice_left; ++count) {
+            counts[face_idx] = static_cast<uint8_t>(count);
+            rSelf(rSelf, face_idx + 1, dice_left - count);
+        }
+    };
+    add_fn(add_fn, 0, dice_count);
+
+    uint64_t column_size = 1;
+    for (int32_t i = 0; i < dice_count; ++i) {
+        column_size *= lv::CASINO_COUNT;
+    }
+    const uint64_t entry_count = table.entries.size();
+    table.column_size = static_cast<uint32_t>(column_size);
+    table.column_threshold = static_cast<uint32_t>((uint64_t{1} << 32) % entry_count);
+    table.position_threshold = static_cast<uint32_t>((uint64_t{1} << 32) % column_size);
+
+    // Vose's alias method in integers: weights are scaled by the entry count so that a column holds column_size, an
+    // entry below it is topped up by a heavier one, which becomes light in turn once it gave enough
+    std::vector<uint32_t> light;
+    std::vector<uint32_t> heavy;
+    for (uint32_t entry_idx = 0; entry_idx < entry_count; ++entry_idx) {
+        weights[entry_idx] *= entry_count;
+        (weights[entry_idx] < column_size ? light : heavy).push_back(entry_idx);
+    }
+    while (!light.empty() && !heavy.empty()) {
+        const uint32_t light_idx = light.back();
+        light.pop_back();
+        const uint32_t heavy_idx = heavy.back();
+        table.entries[light_idx].threshold = static_cast<uint32_t>(weights[light_idx]);
+        table.entries[light_idx].alias = heavy_idx;
+        weights[heavy_idx] -= column_size - weights[light_idx];
+        if (weights[heavy_idx] < column_size) {
+            heavy.pop_back();
+            light.push_back(heavy_idx);
+        }
+    }
+    // What is left holds exactly column_size, the sums being exact
+    for (const uint32_t entry_idx : heavy) {
+        table.entries[entry_idx].threshold = table.column_size;
+        table.entries[entry_idx].alias = entry_idx;
+    }
+    for (const uint32_t entry_idx : light) {
+        table.entries[entry_idx].threshold = table.column_size;
+        table.entries[entry_idx].alias = entry_idx;
+    }
+
+    return table;
+}
+
+AliasTables MakeAliasTables()
+{
+    AliasTables tables{};
+    for (int32_t dice_count = lv::DICE_ROLL_TABLE_MIN_DICE_COUNT; dice_count <= lv::DICE_ROLL_TABLE_MAX_DICE_COUNT;
+         ++dice_count) {
+        tables[dice_count] = MakeAliasTable(dice_count);
+    }
+    return tables;
+}
+
+const AliasTables &GetAliasTables()
+{
+    static const AliasTables tables = MakeAliasTables();
+    return tables;
+}
+
+} // namespace
+
+void lv::RollDiceCountsFromTable(Rng& rRng, int32_t dice_count, DiceCounts& rCounts)
+{
+    // Column from the high half of a draw and position from the low half, both with Lemire's multiply-shift. A draw
+    // is used whole or not at all, so the pair stays uniform.
+    const AliasTable &rTable = GetAliasTables()[dice_count];
+    const uint64_t entry_count = rTable.entries.size();
+    uint64_t column_product = 0;
+    uint64_t position_product = 0;
+    do {
+        const uint64_t draw = rRng();
+        column_product = (draw >> 32) * entry_count;
+        position_product = (draw & 0xFFFFFFFF) * rTable.column_size;
+    } while (static_cast<uint32_t>(column_product) < rTable.column_threshold ||
+             static_cast<uint32_t>(position_product) < rTable.position_threshold);
+
+    // The alias is taken about half the time, it is picked with a mask as a branch would be mispredicted as often
+    const uint32_t column = static_cast<uint32_t>(column_product >> 32);
+    const uint32_t position = static_cast<uint32_t>(position_product >> 32);
+    const AliasEntry &rEntry = rTable.entries[column];
+    const uint32_t alias_mask = 0 - static_cast<uint32_t>(position >= rEntry.threshold);
+    const uint32_t entry_idx = column ^ ((column ^ rEntry.alias) & alias_mask);
+    rCounts = rTable.entries[entry_idx].counts;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "LvPublic.h"
+#include "LvRandom.h"
+
+namespace lv {
+
+// Dice rolls drawn as face histograms
+//
+// The engine only looks at how many dices show each face, so a roll of n dices is drawn as one of its C(n + 5, 5)
+// histograms rather than as n faces. Each dice count of the table range has an alias table over its histograms,
+// weighted by the number of face sequences giving each one (the multinomial coefficient, out of 6^n): a column is
+// picked uniformly, then either its own histogram or its alias from a position within the column. The weights are
+// integers and the column size is 6^n, so the draws are exact, not rounded.
+//
+// The column and the position come from the two halves of one 64-bit draw, each with Lemire's multiply-shift and
+// precomputed rejection thresholds, so a roll costs one draw and two dependent loads whatever its size. Below
+// DICE_ROLL_TABLE_MIN_DICE_COUNT one draw per dice is cheaper than the loads, as are rolls larger than the tables,
+// and a roll of 0 dices draws nothing. The tables are built on first use, about 300 KB.
+
+enum { DICE_ROLL_TABLE_MIN_DICE_COUNT = 3 };
+enum { DICE_ROLL_TABLE_MAX_DICE_COUNT = 12 }; // 6^12 still fits the 32-bit positions
+
+// Roll from the alias table, dice_count must be within the table range
+void RollDiceCountsFromTable(Rng &rRng, int32_t dice_count, DiceCounts &rCounts);
+
+// Roll dice_count dices into rCounts, face 1 at index 0
+inline void RollDiceCounts(Rng &rRng, int32_t dice_count, DiceCounts &rCounts) {
+    if (dice_count >= DICE_ROLL_TABLE_MIN_DICE_COUNT && dice_count <= DICE_ROLL_TABLE_MAX_DICE_COUNT) {
+        RollDiceCountsFromTable(rRng, dice_count, rCounts);
+        return;
+    }
+
+    rCounts.fill(0);
+    for (int32_t i = 0; i < dice_count; ++i) {
+        ++rCounts[rRng.NextBelow(CASINO_COUNT)];
+    }
+}
+
+} // namespace lv
@@ -0,0 +1,501 @@
+#include "LvEndgameSolver.h"
+#include "LvUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr int32_t GetMaxWhiteDiceCount()
+{
+    int32_t max_white_dice_count = 0;
+    for (const lv::ExtraWhiteDiceEntry &rEntry : lv::EXTRA_WHITE_DICE_COUNT_TABLE) {
+        max_white_dice_count = std::max(max_white_dice_count, rEntry.white_dice_count);
+    }
+    return max_white_dice_count;
+}
+
+enum { MAX_WHITE_DICE_COUNT = GetMaxWhiteDiceCount() };
+
+// Allocations of a chance node: face, dice count and white dice count
+enum { ALLOCATION_COUNT = lv::CASINO_COUNT * (lv::DICE_COUNT + 1) * (MAX_WHITE_DICE_COUNT + 1) };
+
+constexpr int32_t GetAllocationIndex(int32_t face_idx, int32_t dice_count, int32_t white_dice_count)
+{
+    return (face_idx * (lv::DICE_COUNT + 1) + dice_count) * (MAX_WHITE_DICE_COUNT + 1) + white_dice_count;
+}
+
+// One way the dices can fall, counts per face
+struct RollOutcome {
+    lv::DiceCounts counts{};
+    double probability = 0.0;
+};
+
+using RollOutcomeTable = std::array<std::vector<RollOutcome>, lv::DICE_COUNT + 1>;
+
+RollOutcomeTable MakeRollOutcomeTable()
+{
+    RollOutcomeTable table{};
+    std::array<double, lv::DICE_COUNT + 1> factorials{};
+    factorials[0] = 1.0;
+    for (int32_t n = 1; n <= lv::DICE_COUNT; ++n) {
+        factorials[n] = factorials[n - 1] * n;
+    }
+
+    // Multinomial: n! / (c1! ... c6!) / 6^n
+    for (int32_t dice_count = 0; dice_count <= lv::DICE_COUNT; ++dice_count) {
+        const double roll_count = std::pow(static_cast<double>(lv::CASINO_COUNT), dice_count);
+        lv::DiceCounts counts{};
+        auto add_fn = [&](auto &&rSelf, int32_t face_idx, int32_t dice_left) -> void {
+            if (face_idx == lv::CASINO_COUNT - 1) {
+                counts[face_idx] = static_cast<uint8_t>(dice_left);
+                double ways = factorials[dice_count];
+                for (const uint8_t count : counts) {
+                    ways /= factorials[count];
+                }
+                table[dice_count].push_back({counts, ways / roll_count});
+                return;
+            }
+            for (int32_t count = 0; count <= dice_left; ++count) {
+                counts[face_idx] = static_cast<uint8_t>(count);
+                rSelf(rSelf, face_idx + 1, dice_left - count);
+            }
+        };
+        add_fn(add_fn, 0, dice_count);
+    }
+
+    return table;
+}
+
+const std::vector<RollOutcome> &GetRollOutcomes(int32_t dice_count)
+{
+    static const RollOutcomeTable table = MakeRollOutcomeTable();
+    return table[dice_count];
+}
+
+// Word of the key, mixed in two independent ways
+void MixKeyWord(lv::EndgameKey &rKey, uint64_t word)
+{
+    rKey.lo = (rKey.lo ^ word) * 0x9E3779B97F4A7C15ull;
+    rKey.lo ^= rKey.lo >> 29;
+    rKey.hi = (rKey.hi ^ word) * 0xC2B2AE3D27D4EB4Full;
+    rKey.hi ^= rKey.hi >> 31;
+}
+
+uint64_t FinalizeKeyWord(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+lv::EndgameTablebase &GetSharedTablebase()
+{
+    static lv::EndgameTablebase tablebase;
+    return tablebase;
+}
+
+} // namespace
+
+bool lv::EndgameTablebase::Open(const char* pPath)
+{
+    Close();
+
+    if (!m_file.Open(pPath, FileAccess::Random) || m_file.GetSize() < ENDGAME_TABLEBASE_HEADER_SIZE) {
+        Close();
+        return false;
+    }
+
+    const uint8_t *pData = m_file.GetData();
+    uint32_t version = 0;
+    uint32_t max_dice_count = 0;
+    uint32_t entry_size = 0;
+    uint64_t entry_count = 0;
+    uint32_t flags = 0;
+    std::memcpy(&version, pData + 4, sizeof(version));
+    std::memcpy(&max_dice_count, pData + 8, sizeof(max_dice_count));
+    std::memcpy(&entry_size, pData + 12, sizeof(entry_size));
+    std::memcpy(&entry_count, pData + 16, sizeof(entry_count));
+    std::memcpy(&flags, pData + 24, sizeof(flags));
+
+    if (std::memcmp(pData, "LVEG", 4) != 0 || version != ENDGAME_TABLEBASE_VERSION ||
+        entry_size != sizeof(EndgameTablebaseEntry) ||
+        entry_count != (m_file.GetSize() - ENDGAME_TABLEBASE_HEADER_SIZE) / sizeof(EndgameTablebaseEntry) ||
+        (m_file.GetSize() - ENDGAME_TABLEBASE_HEADER_SIZE) % sizeof(EndgameTablebaseEntry) != 0) {
+        Close();
+        return false;
+    }
+
+    // The mapping is page aligned and the header keeps the entries 8 bytes aligned
+    m_pEntries = reinterpret_cast<const EndgameTablebaseEntry *>(pData + ENDGAME_TABLEBASE_HEADER_SIZE);
+    m_entry_count = static_cast<int64_t>(entry_count);
+    m_max_dice_count = static_cast<int32_t>(max_dice_count);
+    m_canonical_keys = (flags & ENDGAME_TABLEBASE_CANONICAL_KEYS) != 0;
+
+    return true;
+}
+
+void lv::EndgameTablebase::Close()
+{
+    m_file.Close();
+    m_pEntries = nullptr;
+    m_entry_count = 0;
+    m_max_dice_count = 0;
+    m_canonical_keys = false;
+}
+
+bool lv::EndgameTablebase::Probe(const EndgameKey& rKey, PlayerPayouts& rValues) const
+{
+    if (m_pEntries == nullptr) {
+        return false;
+    }
+
+    const EndgameTablebaseEntry *pEnd = m_pEntries + m_entry_count;
+    const EndgameTablebaseEntry *pEntry = std::lower_bound(
+        m_pEntries, pEnd, rKey, [](const EndgameTablebaseEntry &rEntry, const EndgameKey &rKey) {
+            return rEntry.key < rKey;
+        });
+    if (pEntry == pEnd || !(pEntry->key == rKey)) {
+        return false;
+    }
+
+    rValues = pEntry->values;
+    return true;
+}
+
+bool lv::EndgameTablebaseBuilder::Write(const char* pPath, int32_t max_dice_count, bool canonical_keys) const
+{
+    std::vector<EndgameTablebaseEntry> entries;
+    entries.reserve(m_values.size());
+    for (const auto &rEntry : m_values) {
+        entries.push_back({rEntry.first, rEntry.second});
+    }
+    std::sort(entries.begin(), entries.end(), [](const EndgameTablebaseEntry &rA, const EndgameTablebaseEntry &rB) {
+        return rA.key < rB.key;
+    });
+
+    std::array<uint8_t, ENDGAME_TABLEBASE_HEADER_SIZE> header{};
+    const uint32_t version = ENDGAME_TABLEBASE_VERSION;
+    const uint32_t header_max_dice_count = static_cast<uint32_t>(max_dice_count);
+    const uint32_t entry_size = sizeof(EndgameTablebaseEntry);
+    const uint64_t entry_count = entries.size();
+    const uint32_t flags = canonical_keys ? ENDGAME_TABLEBASE_CANONICAL_KEYS : 0;
+    std::memcpy(header.data(), "LVEG", 4);
+    std::memcpy(header.data() + 4, &version, sizeof(version));
+    std::memcpy(header.data() + 8, &header_max_dice_count, sizeof(header_max_dice_count));
+    std::memcpy(header.data() + 12, &entry_size, sizeof(entry_size));
+    std::memcpy(header.data() + 16, &entry_count, sizeof(entry_count));
+    std::memcpy(header.data() + 24, &flags, sizeof(flags));
+
+    FILE *pFile = std::fopen(pPath, "wb");
+    if (pFile == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(header.data(), header.size(), 1, pFile) == 1;
+    if (ok && !entries.empty()) {
+        ok = std::fwrite(entries.data(), sizeof(EndgameTablebaseEntry), entries.size(), pFile) == entries.size();
+    }
+    ok = std::fclose(pFile) == 0 && ok;
+
+    return ok;
+}
+
+lv::EndgameSolver::EndgameSolver(int32_t max_dice_count, int32_t memo_size_log2, bool canonical_keys)
+    : m_max_dice_count(std::clamp<int32_t>(max_dice_count, 0, MAX_DICE_COUNT_LIMIT)), m_canonical_keys(canonical_keys),
+      m_memo(memo_size_log2)
+{
+}
+
+bool lv::EndgameSolver::CanSolve(const CompactGameState& rGame) const
+{
+    if (rGame.player_count < 2 || rGame.player_count > MAX_PLAYER_COUNT ||
+        rGame.current_turn.player_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return false;
+    }
+
+    int32_t dice_count = 0;
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        dice_count += rGame.players[player_idx].dices + rGame.players[player_idx].white_dices;
+    }
+    return dice_count <= m_max_dice_count;
+}
+
+bool lv::EndgameSolver::Solve(const CompactGameState& rGame, PlayerPayouts& rValues)
+{
+    if (!CanSolve(rGame)) {
+        return false;
+    }
+
+    const CompactPlayerState &rPlayer = rGame.players[rGame.current_turn.player_idx];
+    if (rPlayer.dices == 0 && rPlayer.white_dices == 0) {
+        // Nobody else may have dices left once the player to move has none
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            if (rGame.players[player_idx].dices > 0 || rGame.players[player_idx].white_dices > 0) {
+                return false;
+            }
+        }
+        GetRoundPayouts(rGame, rValues);
+        return true;
+    }
+
+    SolveChance(rGame, rValues);
+    return true;
+}
+
+bool lv::EndgameSolver::ChooseDice(const CompactGameState& rGame, DiceValue& rDice, PlayerPayouts& rValues)
+{
+    if (!CanSolve(rGame)) {
+        return false;
+    }
+
+    // Ties go to the lowest face, like in SolveChance
+    const PlayerIdx player_idx = rGame.current_turn.player_idx;
+    rDice = DiceValue::Invalid;
+    float best_value = -1.0f;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        const int32_t dice_count = rGame.current_turn.dices[face_idx];
+        const int32_t white_dice_count = rGame.current_turn.white_dices[face_idx];
+        if (dice_count == 0 && white_dice_count == 0) {
+            continue;
+        }
+
+        PlayerPayouts values{};
+        SolveAllocation(rGame, face_idx, dice_count, white_dice_count, values);
+        if (values[player_idx] > best_value) {
+            best_value = values[player_idx];
+            rDice = static_cast<DiceValue>(face_idx + 1);
+            rValues = values;
+        }
+    }
+
+    return rDice != DiceValue::Invalid;
+}
+
+lv::EndgameKey lv::EndgameSolver::GetKey(const CompactGameState& rGame) const
+{
+    CompactGameState keyed{};
+    StateSymmetry symmetry{};
+    GetChanceState(rGame, keyed, symmetry);
+    return GetStateKey(keyed);
+}
+
+void lv::EndgameSolver::GetChanceState(const CompactGameState& rGame, CompactGameState& rKeyed,
+                                       StateSymmetry& rSymmetry) const
+{
+    // The dices aren't rolled yet, the previous roll must not tell casinos apart. AllocateDices clears it already.
+    const CompactGameState *pGame = &rGame;
+    CompactGameState game{};
+    if (rGame.current_turn.dices != DiceCounts{} || rGame.current_turn.white_dices != DiceCounts{}) {
+        game = rGame;
+        game.current_turn.dices = {};
+        game.current_turn.white_dices = {};
+        pGame = &game;
+    }
+
+    if (m_canonical_keys) {
+        Canonicalize(*pGame, SymmetryScope::Round, rKeyed, rSymmetry);
+        return;
+    }
+
+    rKeyed = *pGame;
+    for (uint8_t idx = 0; idx < CASINO_COUNT; ++idx) {
+        rSymmetry.canonical_casinos[idx] = idx;
+        rSymmetry.original_casinos[idx] = idx;
+    }
+    for (uint8_t idx = 0; idx < MAX_PLAYER_COUNT; ++idx) {
+        rSymmetry.canonical_players[idx] = idx;
+        rSymmetry.original_players[idx] = idx;
+    }
+}
+
+lv::EndgameKey lv::EndgameSolver::GetStateKey(const CompactGameState& rKeyed)
+{
+    const int32_t player_count = rKeyed.player_count;
+
+    // The player to move is always seat 0 of canonical states, which keeps their keys as they were
+    EndgameKey key{0x4C61735665676173ull, 0x456E6467616D6573ull};
+    uint64_t word = (static_cast<uint64_t>(rKeyed.current_turn.player_idx) << 8) | static_cast<uint64_t>(player_count);
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        const CompactPlayerState &rPlayer = rKeyed.players[player_idx];
+        word = (word << 16) | (static_cast<uint64_t>(static_cast<uint8_t>(rPlayer.dices)) << 8) |
+               static_cast<uint8_t>(rPlayer.white_dices);
+        if (player_idx % 3 == 2) {
+            MixKeyWord(key, word);
+            word = 0;
+        }
+    }
+    MixKeyWord(key, word);
+
+    for (const CompactCasinoState &rCasino : rKeyed.casinos) {
+        word = static_cast<uint8_t>(rCasino.neutral_dice_bet);
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            word = (word << 8) | static_cast<uint8_t>(rCasino.dice_bets[player_idx]);
+        }
+        MixKeyWord(key, word);
+
+        // Bill counts are below 16, one nibble each
+        word = 0;
+        for (const uint8_t bill_count : rCasino.bills) {
+            word = (word << 4) | (bill_count & 0xF);
+        }
+        MixKeyWord(key, word);
+    }
+
+    key.lo = FinalizeKeyWord(key.lo);
+    key.hi = FinalizeKeyWord(key.hi);
+    return key;
+}
+
+void lv::EndgameSolver::SolveChance(const CompactGameState& rGame, PlayerPayouts& rValues)
+{
+    // Solved on the keyed state, the canonical one with canonical keys
+    CompactGameState keyed{};
+    StateSymmetry symmetry{};
+    GetChanceState(rGame, keyed, symmetry);
+
+    const EndgameKey key = GetStateKey(keyed);
+    PlayerPayouts keyed_values{};
+    MemoEntry entry{};
+    if (m_memo.Probe(key.lo, entry) && entry.key_hi == key.hi) {
+        ++m_memo_hit_count;
+        keyed_values = entry.values;
+    } else if (m_pTablebase != nullptr && m_pTablebase->HasCanonicalKeys() == m_canonical_keys &&
+               m_pTablebase->Probe(key, keyed_values)) {
+        ++m_tablebase_hit_count;
+        m_memo.Store(key.lo, MemoEntry{key.hi, keyed_values});
+    } else {
+        ++m_solved_count;
+        SolveRolls(keyed, keyed_values);
+        m_memo.Store(key.lo, MemoEntry{key.hi, keyed_values});
+        if (m_pBuilder != nullptr) {
+            m_pBuilder->Add(key, keyed_values);
+        }
+    }
+
+    rValues = {};
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        rValues[player_idx] = keyed_values[symmetry.ToCanonical(static_cast<PlayerIdx>(player_idx))];
+    }
+}
+
+void lv::EndgameSolver::SolveRolls(const CompactGameState& rGame, PlayerPayouts& rValues)
+{
+    const int32_t player_count = rGame.player_count;
+    const PlayerIdx player_idx = rGame.current_turn.player_idx;
+
+    // Allocations solved on first use, a roll then takes the best one for the player to move
+    std::array<PlayerPayouts, ALLOCATION_COUNT> allocation_values;
+    std::array<bool, ALLOCATION_COUNT> solved{};
+
+    const CompactPlayerState &rPlayer = rGame.players[player_idx];
+    const std::vector<RollOutcome> &rDiceOutcomes = GetRollOutcomes(rPlayer.dices);
+    const std::vector<RollOutcome> &rWhiteDiceOutcomes = GetRollOutcomes(rPlayer.white_dices);
+
+    std::array<double, MAX_PLAYER_COUNT> expected_values{};
+    for (const RollOutcome &rDiceOutcome : rDiceOutcomes) {
+        for (const RollOutcome &rWhiteDiceOutcome : rWhiteDiceOutcomes) {
+            const PlayerPayouts *pBestValues = nullptr;
+            for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+                const int32_t dice_count = rDiceOutcome.counts[face_idx];
+                const int32_t white_dice_count = rWhiteDiceOutcome.counts[face_idx];
+                if (dice_count == 0 && white_dice_count == 0) {
+                    continue;
+                }
+
+                const int32_t allocation_idx = GetAllocationIndex(face_idx, dice_count, white_dice_count);
+                if (!solved[allocation_idx]) {
+                    SolveAllocation(rGame, face_idx, dice_count, white_dice_count, allocation_values[allocation_idx]);
+                    solved[allocation_idx] = true;
+                }
+                const PlayerPayouts &rAllocationValues = allocation_values[allocation_idx];
+                if (pBestValues == nullptr || rAllocationValues[player_idx] > (*pBestValues)[player_idx]) {
+                    pBestValues = &rAllocationValues;
+                }
+            }
+
+            const double probability = rDiceOutcome.probability * rWhiteDiceOutcome.probability;
+            for (int32_t value_idx = 0; value_idx < player_count; ++value_idx) {
+                expected_values[value_idx] += probability * (*pBestValues)[value_idx];
+            }
+        }
+    }
+
+    rValues = {};
+    for (int32_t value_idx = 0; value_idx < player_count; ++value_idx) {
+        rValues[value_idx] = static_cast<float>(expected_values[value_idx]);
+    }
+}
+
+void lv::EndgameSolver::SolveAllocation(const CompactGameState& rGame, int32_t face_idx, int32_t dice_count,
+                                        int32_t white_dice_count, PlayerPayouts& rValues)
+{
+    CompactGameState child = rGame;
+    child.current_turn.dices.fill(0);
+    child.current_turn.white_dices.fill(0);
+    child.current_turn.dices[face_idx] = static_cast<uint8_t>(dice_count);
+    child.current_turn.white_dices[face_idx] = static_cast<uint8_t>(white_dice_count);
+    m_engine.AllocateDices(child, static_cast<DiceValue>(face_idx + 1));
+
+    // Next player with some dices, like GameEngine::AdvanceToNextPlayer without the roll
+    const PlayerIdx player_count = static_cast<PlayerIdx>(child.player_count);
+    PlayerIdx next_player_idx = child.current_turn.player_idx;
+    for (PlayerIdx i = 0; i < player_count; ++i) {
+        next_player_idx = (next_player_idx + 1) % player_count;
+        const CompactPlayerState &rPlayer = child.players[next_player_idx];
+        if (rPlayer.dices > 0 || rPlayer.white_dices > 0) {
+            child.current_turn.player_idx = next_player_idx;
+            SolveChance(child, rValues);
+            return;
+        }
+    }
+
+    // Nobody has any dice left, the round is over
+    GetRoundPayouts(child, rValues);
+}
+
+void lv::EndgameSolver::GetRoundPayouts(const CompactGameState& rGame, PlayerPayouts& rValues)
+{
+    rValues = {};
+    for (const CompactCasinoState &rCasino : rGame.casinos) {
+        std::array<int32_t, MAX_PLAYER_COUNT> payouts{};
+        GetCasinoPayouts(rCasino.bills, rCasino.dice_bets, rCasino.neutral_dice_bet, rGame.player_count, payouts);
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            rValues[player_idx] += static_cast<float>(payouts[player_idx]);
+        }
+    }
+}
+
+bool lv::OpenSharedEndgameTablebase(const char* pPath)
+{
+    return GetSharedTablebase().Open(pPath);
+}
+
+const lv::EndgameTablebase* lv::GetSharedEndgameTablebase()
+{
+    const EndgameTablebase &rTablebase = GetSharedTablebase();
+    return rTablebase.IsOpen() ? &rTablebase : nullptr;
+}
+
+lv::EndgameAgent::EndgameAgent()
+    : m_solver(EndgameSolver::DEFAULT_MAX_DICE_COUNT, EndgameSolver::DEFAULT_MEMO_SIZE_LOG2,
+               GetSharedEndgameTablebase() != nullptr && GetSharedEndgameTablebase()->HasCanonicalKeys())
+{
+    m_solver.SetTablebase(GetSharedEndgameTablebase());
+}
+
+lv::DiceValue lv::EndgameAgent::ChooseDice(const CompactGameState& rGame, const LegalMoveList& rMoves)
+{
+    if (rMoves.count == 1) {
+        return rMoves.moves[0].dice;
+    }
+
+    DiceValue dice = DiceValue::Invalid;
+    PlayerPayouts values{};
+    if (m_solver.ChooseDice(rGame, dice, values)) {
+        return dice;
+    }
+
+    return m_fallback_agent.ChooseDice(rGame, rMoves);
+}
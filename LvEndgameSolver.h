@@ -0,0 +1,175 @@
+#pragma once
+
+#include "LvAgent.h"
+#include "LvExpectedValue.h"
+#include "LvGameEngine.h"
+#include "LvMappedFile.h"
+#include "LvStateSymmetry.h"
+#include "LvTranspositionTable.h"
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+namespace lv {
+
+// Exact solver of the end of a round
+//
+// Once few dices are left the rest of the round is an expectimax tree: chance nodes roll the dices of the player to
+// move, who then allocates one face. Every player maximizes the money they win from the casinos by the end of the
+// round (max^n, ties go to the lowest face), which is exact for the last round and ignores the effect of the bank
+// on later rounds otherwise. Allocations go through GameEngine::AllocateDices and payouts follow the rules of
+// GameEngine::DistributeCasinoBills (GetCasinoPayouts).
+//
+// The value of a roll only depends on the face chosen and its two counts, so every chance node solves each
+// allocation once and then picks the best one for every roll of the dices. Chance nodes are memoized on a key of the
+// player to move, dices left, bets and casino bills. Round, bank and the bills already won don't matter.
+//
+// With canonical keys, chance nodes are solved on their canonical state in the round scope of LvStateSymmetry.h,
+// casinos sorted and players numbered from the one to move, so that symmetric positions share one entry. They are off
+// by default: symmetric positions are rare in this game, canonicalizing costs about 10%, and ties then go to the
+// lowest face of the canonical state, which makes the values of the other players depend on the casino order.
+//
+// A tablebase holds solved positions on disk, sorted by key and memory-mapped, so that bots look positions up
+// rather than solving them. It is built by playing games and recording every position the solver goes through.
+
+// Key of a chance node, 128 bits so that collisions don't happen in practice
+struct EndgameKey {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator<(const EndgameKey &rOther) const {
+        return lo != rOther.lo ? lo < rOther.lo : hi < rOther.hi;
+    }
+    bool operator==(const EndgameKey &rOther) const = default;
+};
+
+// Expected money won from the casinos until the end of the round, players numbered as in the keyed state
+struct EndgameTablebaseEntry {
+    EndgameKey key;
+    PlayerPayouts values{};
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(EndgameTablebaseEntry) == 40, "Tablebase entries are written as they are");
+
+// File: 32 bytes header ("LVEG", uint32 version, uint32 max dice count, uint32 entry size, uint64 entry count,
+// uint32 flags, 4 reserved bytes), then the entries sorted by key, little endian
+enum { ENDGAME_TABLEBASE_VERSION = 3 };
+enum { ENDGAME_TABLEBASE_HEADER_SIZE = 32 };
+enum { ENDGAME_TABLEBASE_CANONICAL_KEYS = 1 }; // Flag of tablebases keyed on canonical states
+
+class EndgameTablebase {
+public:
+    bool Open(const char *pPath);
+    void Close();
+
+    bool IsOpen() const { return m_pEntries != nullptr; }
+    int32_t GetMaxDiceCount() const { return m_max_dice_count; }
+    int64_t GetEntryCount() const { return m_entry_count; }
+    bool HasCanonicalKeys() const { return m_canonical_keys; }
+
+    bool Probe(const EndgameKey &rKey, PlayerPayouts &rValues) const;
+
+private:
+    MappedFile m_file;
+    const EndgameTablebaseEntry *m_pEntries = nullptr;
+    int64_t m_entry_count = 0;
+    int32_t m_max_dice_count = 0;
+    bool m_canonical_keys = false;
+};
+
+// Positions solved while building a tablebase
+class EndgameTablebaseBuilder {
+public:
+    void Add(const EndgameKey &rKey, const PlayerPayouts &rValues) { m_values.emplace(rKey, rValues); }
+    int64_t GetEntryCount() const { return static_cast<int64_t>(m_values.size()); }
+
+    bool Write(const char *pPath, int32_t max_dice_count, bool canonical_keys) const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const EndgameKey &rKey) const { return static_cast<size_t>(rKey.lo); }
+    };
+
+    std::unordered_map<EndgameKey, PlayerPayouts, KeyHash> m_values;
+};
+
+class EndgameSolver {
+public:
+    enum { DEFAULT_MAX_DICE_COUNT = 6 };
+    enum { MAX_DICE_COUNT_LIMIT = 12 }; // Beyond that, rounds are too long to solve exactly
+    enum { DEFAULT_MEMO_SIZE_LOG2 = 16 };
+
+    explicit EndgameSolver(int32_t max_dice_count = DEFAULT_MAX_DICE_COUNT,
+                           int32_t memo_size_log2 = DEFAULT_MEMO_SIZE_LOG2, bool canonical_keys = false);
+
+    // Looked up before solving when keyed like the solver, the tablebase must outlive the solver
+    void SetTablebase(const EndgameTablebase *pTablebase) { m_pTablebase = pTablebase; }
+
+    // Every position solved from now on is added to pBuilder
+    void SetTablebaseBuilder(EndgameTablebaseBuilder *pBuilder) { m_pBuilder = pBuilder; }
+
+    int32_t GetMaxDiceCount() const { return m_max_dice_count; }
+    bool HasCanonicalKeys() const { return m_canonical_keys; }
+
+    // Whether the dices left in the round, the current player's included, are few enough to solve
+    bool CanSolve(const CompactGameState &rGame) const;
+
+    // Expected money each player wins from the casinos by the end of the round, before the current player rolls
+    bool Solve(const CompactGameState &rGame, PlayerPayouts &rValues);
+
+    // Best face for the current player's roll and the values once it is allocated
+    bool ChooseDice(const CompactGameState &rGame, DiceValue &rDice, PlayerPayouts &rValues);
+
+    // Key of the position before the current player rolls, the same for every symmetric position with canonical keys
+    EndgameKey GetKey(const CompactGameState &rGame) const;
+
+    void ClearMemo() { m_memo.Clear(); }
+    uint64_t GetSolvedCount() const { return m_solved_count; }
+    uint64_t GetMemoHitCount() const { return m_memo_hit_count; }
+    uint64_t GetTablebaseHitCount() const { return m_tablebase_hit_count; }
+
+private:
+    struct MemoEntry {
+        uint64_t key_hi = 0;
+        PlayerPayouts values{};
+    };
+
+    void GetChanceState(const CompactGameState &rGame, CompactGameState &rKeyed, StateSymmetry &rSymmetry) const;
+    static EndgameKey GetStateKey(const CompactGameState &rKeyed);
+
+    void SolveChance(const CompactGameState &rGame, PlayerPayouts &rValues);
+    void SolveRolls(const CompactGameState &rGame, PlayerPayouts &rValues);
+    void SolveAllocation(const CompactGameState &rGame, int32_t face_idx, int32_t dice_count, int32_t white_dice_count,
+                         PlayerPayouts &rValues);
+    static void GetRoundPayouts(const CompactGameState &rGame, PlayerPayouts &rValues);
+
+    GameEngine m_engine{0};
+    int32_t m_max_dice_count = DEFAULT_MAX_DICE_COUNT;
+    bool m_canonical_keys = false;
+    TranspositionTable<MemoEntry> m_memo;
+    const EndgameTablebase *m_pTablebase = nullptr;
+    EndgameTablebaseBuilder *m_pBuilder = nullptr;
+    uint64_t m_solved_count = 0;
+    uint64_t m_memo_hit_count = 0;
+    uint64_t m_tablebase_hit_count = 0;
+};
+
+// Tablebase shared by the endgame agents of the process, opened once at startup
+bool OpenSharedEndgameTablebase(const char *pPath);
+const EndgameTablebase *GetSharedEndgameTablebase();
+
+// Plays the end of rounds with EndgameSolver, the shared tablebase when open, and ExpectedValueAgent before that
+class EndgameAgent : public Agent {
+public:
+    EndgameAgent();
+
+    DiceValue ChooseDice(const CompactGameState &rGame, const LegalMoveList &rMoves) override;
+
+private:
+    EndgameSolver m_solver;
+    ExpectedValueAgent m_fallback_agent;
+};
+
+} // namespace lv
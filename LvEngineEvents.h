@@ -0,0 +1,129 @@
+#pragma once
+
+#include "LvPublic.h"
+
+#include <array>
+
+namespace lv {
+
+// Events emitted by GameEngine, see GameEngine::SetEventListener
+//
+// Emission is compiled in only when LV_ENABLE_ENGINE_EVENTS is defined (LASVEG_ENABLE_ENGINE_EVENTS in CMake), and
+// step timing only when LV_ENABLE_ENGINE_TIMING is defined as well (LASVEG_ENABLE_ENGINE_TIMING). Otherwise the
+// engine doesn't even test for a listener. Both representations emit the same events, PlayMove those of the steps it
+// goes through. BatchGameEngine doesn't emit any.
+
+enum class EngineEventType : int32_t {
+    RoundSetup = 0,
+    DiceRolled,
+    DiceAllocated,
+    PlayerSkipped,
+    BillAwarded,
+    RoundEnd,
+};
+
+enum { ENGINE_EVENT_TYPE_COUNT = static_cast<int32_t>(EngineEventType::RoundEnd) + 1 };
+
+// Engine steps timed when LV_ENABLE_ENGINE_TIMING is defined, DistributeCasinoBills is also part of EndRound
+enum class EngineStep : int32_t {
+    SetupRound = 0,
+    StartRound,
+    AllocateDices,
+    AdvanceToNextPlayer,
+    DistributeCasinoBills,
+    EndRound,
+};
+
+enum { ENGINE_STEP_COUNT = static_cast<int32_t>(EngineStep::EndRound) + 1 };
+
+// Casinos got their bills for the round
+struct RoundSetupEvent {
+    int32_t round = 0;
+    PlayerIdx first_player_idx = 0;
+    std::array<int32_t, CASINO_COUNT> casino_money_values{};
+};
+
+// A player rolled their dices, as counts per face
+struct DiceRolledEvent {
+    int32_t round = 0;
+    PlayerIdx player_idx = 0;
+    DiceCounts dices{};
+    DiceCounts white_dices{};
+};
+
+struct DiceAllocatedEvent {
+    int32_t round = 0;
+    PlayerIdx player_idx = 0;
+    DiceValue dice = DiceValue::Invalid;
+    int32_t dice_count = 0;
+    int32_t white_dice_count = 0;
+};
+
+// A player without any dice left was passed over when advancing to the next player
+struct PlayerSkippedEvent {
+    int32_t round = 0;
+    PlayerIdx player_idx = 0;
+};
+
+// A casino paid a bill to a bidder at the end of the round, bidder_idx is a player or
+// CASINO_NEUTRAL_WINNER, the maximum player count of the variant
+struct BillAwardedEvent {
+    int32_t round = 0;
+    CasinoIdx casino_idx = 0;
+    int32_t bidder_idx = 0;
+    int32_t rank = 0;
+    Bill bill = Bill::Invalid;
+};
+
+// Every casino has been paid, before the round counter moves on
+struct RoundEndEvent {
+    int32_t round = 0;
+    std::array<int32_t, RULES_MAX_PLAYER_COUNT_LIMIT> player_money_values{};
+    int32_t neutral_money_value = 0;
+};
+
+class EngineEventListener {
+public:
+    virtual ~EngineEventListener() = default;
+
+    virtual void OnRoundSetup(const RoundSetupEvent &rEvent) {}
+    virtual void OnDiceRolled(const DiceRolledEvent &rEvent) {}
+    virtual void OnDiceAllocated(const DiceAllocatedEvent &rEvent) {}
+    virtual void OnPlayerSkipped(const PlayerSkippedEvent &rEvent) {}
+    virtual void OnBillAwarded(const BillAwardedEvent &rEvent) {}
+    virtual void OnRoundEnd(const RoundEndEvent &rEvent) {}
+
+    // Wall time of one engine step, in nanoseconds
+    virtual void OnStepTimed(EngineStep step, int64_t duration_ns) {}
+};
+
+// Counts the events of every type and the time spent in every step
+class EngineEventCounters : public EngineEventListener {
+public:
+    void OnRoundSetup(const RoundSetupEvent &rEvent) override { Count(EngineEventType::RoundSetup); }
+    void OnDiceRolled(const DiceRolledEvent &rEvent) override { Count(EngineEventType::DiceRolled); }
+    void OnDiceAllocated(const DiceAllocatedEvent &rEvent) override { Count(EngineEventType::DiceAllocated); }
+    void OnPlayerSkipped(const PlayerSkippedEvent &rEvent) override { Count(EngineEventType::PlayerSkipped); }
+    void OnBillAwarded(const BillAwardedEvent &rEvent) override { Count(EngineEventType::BillAwarded); }
+    void OnRoundEnd(const RoundEndEvent &rEvent) override { Count(EngineEventType::RoundEnd); }
+
+    void OnStepTimed(EngineStep step, int64_t duration_ns) override {
+        ++m_step_counts[static_cast<int32_t>(step)];
+        m_step_durations_ns[static_cast<int32_t>(step)] += duration_ns;
+    }
+
+    uint64_t GetEventCount(EngineEventType type) const { return m_event_counts[static_cast<int32_t>(type)]; }
+    uint64_t GetStepCount(EngineStep step) const { return m_step_counts[static_cast<int32_t>(step)]; }
+    int64_t GetStepDuration(EngineStep step) const { return m_step_durations_ns[static_cast<int32_t>(step)]; }
+
+    void Clear() { *this = {}; }
+
+private:
+    void Count(EngineEventType type) { ++m_event_counts[static_cast<int32_t>(type)]; }
+
+    std::array<uint64_t, ENGINE_EVENT_TYPE_COUNT> m_event_counts{};
+    std::array<uint64_t, ENGINE_STEP_COUNT> m_step_counts{};
+    std::array<int64_t, ENGINE_STEP_COUNT> m_step_durations_ns{};
+};
+
+} // namespace lv
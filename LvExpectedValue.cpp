@@ -0,0 +1,333 @@
+#include "LvExpectedValue.h"
+#include "LvUtils.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+using BinomialTable =
+    std::array<std::array<double, lv::ExpectedValueEvaluator::MAX_MODEL_DICE_COUNT + 1>,
+               lv::ExpectedValueEvaluator::MAX_MODEL_DICE_COUNT + 1>;
+
+// BINOMIAL_PMF[n][k], probability that k of n dices land in a given casino
+constexpr BinomialTable MakeBinomialTable()
+{
+    constexpr double p = 1.0 / static_cast<int32_t>(lv::CASINO_COUNT);
+    BinomialTable table{};
+    for (int32_t n = 0; n <= lv::ExpectedValueEvaluator::MAX_MODEL_DICE_COUNT; ++n) {
+        double choose = 1.0;
+        for (int32_t k = 0; k <= n; ++k) {
+            double probability = choose;
+            for (int32_t i = 0; i < k; ++i) {
+                probability *= p;
+            }
+            for (int32_t i = 0; i < n - k; ++i) {
+                probability *= 1.0 - p;
+            }
+            table[n][k] = probability;
+            choose = choose * (n - k) / (k + 1);
+        }
+    }
+    return table;
+}
+
+constexpr BinomialTable BINOMIAL_PMF = MakeBinomialTable();
+
+// Pack a casino configuration into 128 bits, every field uses 4 bits
+bool MakeCacheKey(const lv::CompactCasinoState &rCasino, const lv::PlayerDiceCounts &rRemainingDices,
+                  int32_t remaining_white_dices, int32_t player_count, uint64_t &rKeyLo, uint64_t &rKeyHi)
+{
+    rKeyLo = 0;
+    rKeyHi = 0;
+
+    auto push_fn = [](uint64_t &rKey, int32_t value) {
+        if (value < 0 || value > 15) {
+            return false;
+        }
+        rKey = (rKey << 4) | static_cast<uint64_t>(value);
+        return true;
+    };
+
+    bool ok = true;
+    for (int32_t bill_idx = 0; bill_idx < lv::BILL_TYPE_COUNT; ++bill_idx) {
+        ok &= push_fn(rKeyLo, rCasino.bills[bill_idx]);
+    }
+    ok &= push_fn(rKeyLo, rCasino.neutral_dice_bet);
+    ok &= push_fn(rKeyLo, remaining_white_dices);
+    ok &= push_fn(rKeyLo, player_count);
+
+    for (int32_t player_idx = 0; player_idx < lv::MAX_PLAYER_COUNT; ++player_idx) {
+        const bool active = player_idx < player_count;
+        ok &= push_fn(rKeyHi, active ? rCasino.dice_bets[player_idx] : 0);
+        ok &= push_fn(rKeyHi, active ? rRemainingDices[player_idx] : 0);
+    }
+
+    return ok;
+}
+
+uint64_t HashCacheKey(uint64_t key_lo, uint64_t key_hi)
+{
+    uint64_t h = key_lo * 0x9E3779B97F4A7C15ull ^ key_hi;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+} // namespace
+
+lv::ExpectedValueEvaluator::ExpectedValueEvaluator(int32_t cache_size_log2)
+    : m_owned_cache(std::make_unique<ExpectedPayoutCache>(cache_size_log2)), m_pCache(m_owned_cache.get())
+{
+}
+
+lv::ExpectedValueEvaluator::ExpectedValueEvaluator(ExpectedPayoutCache& rSharedCache) : m_pCache(&rSharedCache) {}
+
+void lv::ExpectedValueEvaluator::ClearCache()
+{
+    m_pCache->Clear();
+    m_cache_hit_count = 0;
+    m_cache_miss_count = 0;
+}
+
+bool lv::ExpectedValueEvaluator::GetCasinoExpectedPayouts(const CompactCasinoState& rCasino,
+                                                          const PlayerDiceCounts& rRemainingDices,
+                                                          int32_t remaining_white_dices, int32_t player_count,
+                                                          PlayerPayouts& rPayouts)
+{
+    rPayouts.fill(0.0f);
+
+    // Validate model inputs
+    if (player_count < 2 || player_count > MAX_PLAYER_COUNT) {
+        return false;
+    }
+    if (remaining_white_dices < 0 || remaining_white_dices > MAX_MODEL_DICE_COUNT) {
+        return false;
+    }
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        if (rRemainingDices[player_idx] < 0 || rRemainingDices[player_idx] > MAX_MODEL_DICE_COUNT) {
+            return false;
+        }
+    }
+
+    // Check the cache
+    uint64_t key_lo = 0;
+    uint64_t key_hi = 0;
+    const bool cacheable =
+        MakeCacheKey(rCasino, rRemainingDices, remaining_white_dices, player_count, key_lo, key_hi);
+    const uint64_t cache_key = HashCacheKey(key_lo, key_hi);
+    if (cacheable) {
+        ExpectedPayoutCacheEntry entry{};
+        if (m_pCache->Probe(cache_key, entry) && entry.key_lo == key_lo && entry.key_hi == key_hi) {
+            ++m_cache_hit_count;
+            rPayouts = entry.payouts;
+            return true;
+        }
+    }
+    ++m_cache_miss_count;
+
+    // Bills in decreasing value order, as they are distributed
+    std::array<int32_t, MAX_MODEL_RANK_COUNT> sorted_bills{};
+    int32_t bill_count = 0;
+    for (int32_t bill_idx = BILL_TYPE_COUNT - 1; bill_idx >= 0; --bill_idx) {
+        for (int32_t i = 0; i < rCasino.bills[bill_idx] && bill_count < MAX_MODEL_RANK_COUNT; ++i) {
+            sorted_bills[bill_count++] = static_cast<int32_t>(GetBillFromIndex(bill_idx));
+        }
+    }
+
+    // Final bet distribution of every bidder, the neutral player is the last bidder
+    BidderDistributions bidders{};
+    bidders.bidder_count = player_count + 1;
+    for (int32_t bidder_idx = 0; bidder_idx < bidders.bidder_count; ++bidder_idx) {
+        const bool neutral = bidder_idx == player_count;
+        const int32_t base_bet = neutral ? rCasino.neutral_dice_bet : rCasino.dice_bets[bidder_idx];
+        const int32_t remaining = neutral ? remaining_white_dices : rRemainingDices[bidder_idx];
+        if (base_bet < 0 || base_bet + remaining > MAX_MODEL_BET) {
+            return false;
+        }
+
+        auto &rDistribution = bidders.distributions[bidder_idx];
+        auto &rBelow = bidders.below[bidder_idx];
+        for (int32_t extra_bet = 0; extra_bet <= remaining; ++extra_bet) {
+            rDistribution[base_bet + extra_bet] = BINOMIAL_PMF[remaining][extra_bet];
+        }
+        for (int32_t bet = 1; bet <= MAX_MODEL_BET; ++bet) {
+            rBelow[bet] = rBelow[bet - 1] + rDistribution[bet - 1];
+        }
+        bidders.max_bet = std::max(bidders.max_bet, base_bet + remaining);
+    }
+
+    std::array<double, MAX_PLAYER_COUNT> totals{};
+    for (int32_t player_idx = 0; player_idx < player_count && bill_count > 0; ++player_idx) {
+        totals[player_idx] = GetPlayerExpectedPayout(bidders, player_idx, sorted_bills, bill_count);
+    }
+
+    for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+        rPayouts[player_idx] = static_cast<float>(totals[player_idx]);
+    }
+
+    if (cacheable) {
+        m_pCache->Store(cache_key, ExpectedPayoutCacheEntry{key_lo, key_hi, rPayouts});
+    }
+
+    return true;
+}
+
+double lv::ExpectedValueEvaluator::GetPlayerExpectedPayout(
+    const BidderDistributions& rBidders, int32_t player_idx,
+    const std::array<int32_t, MAX_MODEL_RANK_COUNT>& rSortedBills, int32_t bill_count) const
+{
+    // A bet wins only if nobody else, neutral included, has the same amount, and winners are paid in decreasing bet
+    // order, so the player's rank is the number of other bets above theirs that are held by a single bidder.
+    //
+    // Walk the bet values from the top down, tracking the joint probability of (set of other bidders whose bet is
+    // still below the current value, rank so far). Assigned bidders contribute the probability of their bet, pending
+    // ones the probability of being below the value once the walk stops. Ranks past the last bill pay nothing and are
+    // dropped.
+    std::array<int32_t, MAX_PLAYER_COUNT> others{};
+    int32_t other_count = 0;
+    for (int32_t bidder_idx = 0; bidder_idx < rBidders.bidder_count; ++bidder_idx) {
+        // Bidders certain to bet nothing never matter
+        if (bidder_idx != player_idx && rBidders.distributions[bidder_idx][0] < 1.0) {
+            others[other_count++] = bidder_idx;
+        }
+    }
+
+    const uint32_t full_mask = (1u << other_count) - 1;
+    using RankProbabilities = std::array<double, MAX_MODEL_RANK_COUNT>;
+    std::array<RankProbabilities, 1 << MAX_PLAYER_COUNT> states{};
+    std::array<RankProbabilities, 1 << MAX_PLAYER_COUNT> next_states{};
+    states[full_mask][0] = 1.0;
+
+    const auto &rPlayerDistribution = rBidders.distributions[player_idx];
+    std::array<double, 1 << MAX_PLAYER_COUNT> subset_probabilities{};
+
+    double expected_payout = 0.0;
+    for (int32_t bet = rBidders.max_bet; bet > 0; --bet) {
+        // Payout if the player's bet is this value: every pending bidder must be strictly below it
+        if (rPlayerDistribution[bet] > 0.0) {
+            double payout = 0.0;
+            for (uint32_t mask = 0; mask <= full_mask; ++mask) {
+                double below = 1.0;
+                for (int32_t other_idx = 0; other_idx < other_count; ++other_idx) {
+                    if (mask & (1u << other_idx)) {
+                        below *= rBidders.below[others[other_idx]][bet];
+                    }
+                }
+                for (int32_t rank = 0; rank < bill_count; ++rank) {
+                    payout += states[mask][rank] * below * rSortedBills[rank];
+                }
+            }
+            expected_payout += rPlayerDistribution[bet] * payout;
+        }
+
+        // Probability that exactly the subset of other bidders bets this value
+        subset_probabilities[0] = 1.0;
+        for (uint32_t subset = 1; subset <= full_mask; ++subset) {
+            const int32_t other_idx = std::countr_zero(subset);
+            subset_probabilities[subset] =
+                subset_probabilities[subset & (subset - 1)] * rBidders.distributions[others[other_idx]][bet];
+        }
+
+        // Assign the pending bidders betting this value, a single one gains a rank over the player
+        for (uint32_t mask = 0; mask <= full_mask; ++mask) {
+            next_states[mask].fill(0.0);
+        }
+        for (uint32_t mask = 0; mask <= full_mask; ++mask) {
+            for (int32_t rank = 0; rank < bill_count; ++rank) {
+                const double probability = states[mask][rank];
+                if (probability == 0.0) {
+                    continue;
+                }
+                // Every subset of the pending bidders, the empty one included
+                uint32_t subset = mask;
+                while (true) {
+                    const double subset_probability = subset_probabilities[subset];
+                    if (subset_probability > 0.0) {
+                        const int32_t next_rank = rank + (std::popcount(subset) == 1);
+                        if (next_rank < bill_count) {
+                            next_states[mask ^ subset][next_rank] += probability * subset_probability;
+                        }
+                    }
+                    if (subset == 0) {
+                        break;
+                    }
+                    subset = (subset - 1) & mask;
+                }
+            }
+        }
+        std::swap(states, next_states);
+    }
+
+    return expected_payout;
+}
+
+float lv::ExpectedValueEvaluator::GetExpectedPayout(const CompactGameState& rGame, CasinoIdx casino_idx,
+                                                    int32_t dice_count, int32_t white_dice_count)
+{
+    const PlayerIdx player_idx = rGame.current_turn.player_idx;
+
+    PlayerDiceCounts remaining_dices{};
+    int32_t remaining_white_dices = 0;
+    for (int32_t other_player_idx = 0; other_player_idx < rGame.player_count; ++other_player_idx) {
+        remaining_dices[other_player_idx] = rGame.players[other_player_idx].dices;
+        remaining_white_dices += rGame.players[other_player_idx].white_dices;
+    }
+    remaining_dices[player_idx] = static_cast<int8_t>(remaining_dices[player_idx] - dice_count);
+    remaining_white_dices -= white_dice_count;
+
+    CompactCasinoState casino = rGame.casinos[casino_idx];
+    casino.dice_bets[player_idx] = static_cast<int8_t>(casino.dice_bets[player_idx] + dice_count);
+    casino.neutral_dice_bet = static_cast<int8_t>(casino.neutral_dice_bet + white_dice_count);
+
+    PlayerPayouts payouts{};
+    if (!GetCasinoExpectedPayouts(casino, remaining_dices, remaining_white_dices, rGame.player_count, payouts)) {
+        return 0.0f;
+    }
+    return payouts[player_idx];
+}
+
+float lv::ExpectedValueEvaluator::GetMoveExpectedValue(const CompactGameState& rGame, const LegalMove& rMove)
+{
+    const PlayerIdx player_idx = rGame.current_turn.player_idx;
+    const CasinoIdx move_casino_idx = static_cast<CasinoIdx>(rMove.dice) - 1;
+
+    // Dices still held by everyone once the move is played
+    PlayerDiceCounts remaining_dices{};
+    int32_t remaining_white_dices = 0;
+    for (int32_t other_player_idx = 0; other_player_idx < rGame.player_count; ++other_player_idx) {
+        remaining_dices[other_player_idx] = rGame.players[other_player_idx].dices;
+        remaining_white_dices += rGame.players[other_player_idx].white_dices;
+    }
+    remaining_dices[player_idx] = static_cast<int8_t>(remaining_dices[player_idx] - rMove.dice_count);
+    remaining_white_dices -= rMove.white_dice_count;
+
+    float value = 0.0f;
+    PlayerPayouts payouts{};
+    for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CompactCasinoState casino = rGame.casinos[casino_idx];
+        if (casino_idx == move_casino_idx) {
+            casino.dice_bets[player_idx] = static_cast<int8_t>(casino.dice_bets[player_idx] + rMove.dice_count);
+            casino.neutral_dice_bet = static_cast<int8_t>(casino.neutral_dice_bet + rMove.white_dice_count);
+        }
+        if (GetCasinoExpectedPayouts(casino, remaining_dices, remaining_white_dices, rGame.player_count, payouts)) {
+            value += payouts[player_idx];
+        }
+    }
+
+    return value;
+}
+
+lv::DiceValue lv::ExpectedValueAgent::ChooseDice(const CompactGameState& rGame, const LegalMoveList& rMoves)
+{
+    DiceValue best_dice = rMoves.moves[0].dice;
+    float best_value = -1.0f;
+    for (int32_t move_idx = 0; move_idx < rMoves.count; ++move_idx) {
+        const float value = m_evaluator.GetMoveExpectedValue(rGame, rMoves.moves[move_idx]);
+        if (value > best_value) {
+            best_value = value;
+            best_dice = rMoves.moves[move_idx].dice;
+        }
+    }
+    return best_dice;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "LvAgent.h"
+#include "LvPublic.h"
+#include "LvTranspositionTable.h"
+
+#include <array>
+#include <memory>
+
+namespace lv {
+
+using PlayerDiceCounts = std::array<int8_t, MAX_PLAYER_COUNT>;
+using PlayerPayouts = std::array<float, MAX_PLAYER_COUNT>;
+
+// Memoized payouts of one casino configuration, the table key is a hash of the configuration
+struct ExpectedPayoutCacheEntry {
+    uint64_t key_lo = 0;
+    uint64_t key_hi = 0;
+    PlayerPayouts payouts{};
+};
+
+using ExpectedPayoutCache = TranspositionTable<ExpectedPayoutCacheEntry>;
+
+// Expected end of round casino payouts
+//
+// Model: every dice still held by a player, own or white, ends up in a given casino with probability 1 / 6
+// independently of the others, so the extra bet of each player (and of the neutral player) on a casino follows a
+// binomial distribution. Under that model the expectation is exact, using the rules of DistributeCasinoBills
+// (GetCasinoWinners): equal bets cancel each other and the remaining ones are paid in decreasing order. Each
+// player's payout is computed by a dynamic program over bet values instead of enumerating every joint outcome.
+// Results are memoized per casino configuration in an ExpectedPayoutCache, owned by the evaluator or shared by the
+// evaluators of several threads. An evaluator itself is not thread safe, every thread should own one.
+class ExpectedValueEvaluator {
+public:
+    // Largest number of remaining dices per player, or of remaining white dices, the model handles
+    enum { MAX_MODEL_DICE_COUNT = 16 };
+
+    explicit ExpectedValueEvaluator(int32_t cache_size_log2 = 16);
+    // Use rSharedCache, which must outlive the evaluator, instead of a cache of its own
+    explicit ExpectedValueEvaluator(ExpectedPayoutCache &rSharedCache);
+
+    // Expected money each player wins from the casino at the end of the round.
+    // rRemainingDices are the dices each player still holds, remaining_white_dices the white dices held by everyone.
+    bool GetCasinoExpectedPayouts(const CompactCasinoState &rCasino, const PlayerDiceCounts &rRemainingDices,
+                                  int32_t remaining_white_dices, int32_t player_count, PlayerPayouts &rPayouts);
+
+    // Expected money the current player wins from a casino at the end of the round if dice_count of their dices and
+    // white_dice_count white dices are allocated to it now
+    float GetExpectedPayout(const CompactGameState &rGame, CasinoIdx casino_idx, int32_t dice_count,
+                            int32_t white_dice_count);
+
+    // Expected money the current player wins from every casino at the end of the round after playing the move
+    float GetMoveExpectedValue(const CompactGameState &rGame, const LegalMove &rMove);
+
+    void ClearCache();
+    uint64_t GetCacheHitCount() const { return m_cache_hit_count; }
+    uint64_t GetCacheMissCount() const { return m_cache_miss_count; }
+
+private:
+    // Largest final bet and number of bills the model handles
+    enum { MAX_MODEL_BET = 2 * MAX_MODEL_DICE_COUNT };
+    enum { MAX_MODEL_RANK_COUNT = 8 };
+
+    // Final bet distribution of every bidder, the players followed by the neutral player
+    struct BidderDistributions {
+        int32_t bidder_count = 0;
+        int32_t max_bet = 0;
+        std::array<std::array<double, MAX_MODEL_BET + 1>, MAX_PLAYER_COUNT + 1> distributions{};
+        std::array<std::array<double, MAX_MODEL_BET + 1>, MAX_PLAYER_COUNT + 1> below{}; // P(bet < value)
+    };
+
+    double GetPlayerExpectedPayout(const BidderDistributions &rBidders, int32_t player_idx,
+                                   const std::array<int32_t, MAX_MODEL_RANK_COUNT> &rSortedBills,
+                                   int32_t bill_count) const;
+
+    std::unique_ptr<ExpectedPayoutCache> m_owned_cache;
+    ExpectedPayoutCache *m_pCache = nullptr;
+    uint64_t m_cache_hit_count = 0;
+    uint64_t m_cache_miss_count = 0;
+};
+
+// Play the move with the highest expected payout for this round
+class ExpectedValueAgent : public Agent {
+public:
+    DiceValue ChooseDice(const CompactGameState &rGame, const LegalMoveList &rMoves) override;
+
+private:
+    ExpectedValueEvaluator m_evaluator;
+};
+
+} // namespace lv
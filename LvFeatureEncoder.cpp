@@ -0,0 +1,178 @@
+#include "LvFeatureEncoder.h"
+#include "LvStateConversion.h"
+
+#include <algorithm>
+
+namespace {
+
+using FeatureScales = std::array<float, lv::FEATURE_COUNT>;
+
+constexpr float BILL_COUNT_SCALE = 1.0f / 8;
+constexpr float DICE_COUNT_SCALE = 1.0f / static_cast<int32_t>(lv::DICE_COUNT);
+
+constexpr FeatureScales MakeFeatureScales()
+{
+    FeatureScales scales{};
+    const auto fill = [&](int32_t offset, int32_t count, float scale) {
+        for (int32_t feature_idx = offset; feature_idx < offset + count; ++feature_idx) {
+            scales[feature_idx] = scale;
+        }
+    };
+
+    for (int32_t casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+        const int32_t offset = lv::FEATURE_CASINOS_OFFSET + casino_idx * lv::FEATURE_CASINO_SIZE;
+        fill(offset, lv::BILL_TYPE_COUNT, BILL_COUNT_SCALE);
+        fill(offset + lv::BILL_TYPE_COUNT, lv::MAX_PLAYER_COUNT + 1, DICE_COUNT_SCALE);
+    }
+    for (int32_t seat_idx = 0; seat_idx < lv::MAX_PLAYER_COUNT; ++seat_idx) {
+        const int32_t offset = lv::FEATURE_PLAYERS_OFFSET + seat_idx * lv::FEATURE_PLAYER_SIZE;
+        fill(offset, 1, 1.0f);
+        fill(offset + 1, 2, DICE_COUNT_SCALE);
+        fill(offset + 3, lv::BILL_TYPE_COUNT, BILL_COUNT_SCALE);
+    }
+    fill(lv::FEATURE_NEUTRAL_OFFSET, 1, 1.0f);
+    fill(lv::FEATURE_NEUTRAL_OFFSET + 1, lv::BILL_TYPE_COUNT, BILL_COUNT_SCALE);
+    fill(lv::FEATURE_TURN_OFFSET, lv::MAX_PLAYER_COUNT, 1.0f);
+    fill(lv::FEATURE_TURN_DICES_OFFSET, 2 * lv::CASINO_COUNT, DICE_COUNT_SCALE);
+    fill(lv::FEATURE_ROUND_OFFSET, static_cast<int32_t>(lv::ROUND_COUNT) + lv::MAX_PLAYER_COUNT, 1.0f);
+
+    return scales;
+}
+
+constexpr FeatureScales FEATURE_SCALES = MakeFeatureScales();
+
+void CopyBillCounts(const lv::BillCounts &rBills, int8_t *pFeatures)
+{
+    for (int32_t bill_idx = 0; bill_idx < lv::BILL_TYPE_COUNT; ++bill_idx) {
+        pFeatures[bill_idx] = static_cast<int8_t>(rBills[bill_idx]);
+    }
+}
+
+// Every feature is gathered as int8 first, the float rows are scaled from it
+void ScaleFeatures(const int8_t *pRaw, float *pFeatures)
+{
+    for (int32_t feature_idx = 0; feature_idx < lv::FEATURE_COUNT; ++feature_idx) {
+        pFeatures[feature_idx] = static_cast<float>(pRaw[feature_idx]) * FEATURE_SCALES[feature_idx];
+    }
+}
+
+} // namespace
+
+const std::array<float, lv::FEATURE_COUNT>& lv::GetFeatureScales()
+{
+    return FEATURE_SCALES;
+}
+
+bool lv::EncodeFeatures(const CompactGameState& rGame, PlayerIdx perspective_idx, int8_t* pFeatures)
+{
+    std::fill(pFeatures, pFeatures + FEATURE_COUNT, int8_t{0});
+
+    const int32_t player_count = rGame.player_count;
+    if (player_count <= 0 || player_count > MAX_PLAYER_COUNT ||
+        perspective_idx >= static_cast<PlayerIdx>(player_count)) {
+        return false;
+    }
+
+    // Player of every seat, and seat of every player
+    std::array<uint8_t, MAX_PLAYER_COUNT> players{};
+    std::array<uint8_t, MAX_PLAYER_COUNT> seats{};
+    for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+        const int32_t player_idx = (static_cast<int32_t>(perspective_idx) + seat_idx) % player_count;
+        players[seat_idx] = static_cast<uint8_t>(player_idx);
+        seats[player_idx] = static_cast<uint8_t>(seat_idx);
+    }
+
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        int8_t *pCasino = pFeatures + FEATURE_CASINOS_OFFSET + casino_idx * FEATURE_CASINO_SIZE;
+        CopyBillCounts(rCasino.bills, pCasino);
+        for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+            pCasino[BILL_TYPE_COUNT + seat_idx] = rCasino.dice_bets[players[seat_idx]];
+        }
+        pCasino[static_cast<int32_t>(BILL_TYPE_COUNT) + MAX_PLAYER_COUNT] = rCasino.neutral_dice_bet;
+    }
+
+    for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+        const CompactPlayerState &rPlayer = rGame.players[players[seat_idx]];
+        int8_t *pPlayer = pFeatures + FEATURE_PLAYERS_OFFSET + seat_idx * FEATURE_PLAYER_SIZE;
+        pPlayer[0] = 1;
+        pPlayer[1] = rPlayer.dices;
+        pPlayer[2] = rPlayer.white_dices;
+        CopyBillCounts(rPlayer.bills, pPlayer + 3);
+    }
+
+    pFeatures[FEATURE_NEUTRAL_OFFSET] = rGame.neutral_player_present ? 1 : 0;
+    CopyBillCounts(rGame.neutral_player_bills, pFeatures + FEATURE_NEUTRAL_OFFSET + 1);
+
+    if (rGame.current_turn.player_idx < static_cast<PlayerIdx>(player_count)) {
+        pFeatures[FEATURE_TURN_OFFSET + seats[rGame.current_turn.player_idx]] = 1;
+    }
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        pFeatures[FEATURE_TURN_DICES_OFFSET + face_idx] = static_cast<int8_t>(rGame.current_turn.dices[face_idx]);
+        pFeatures[FEATURE_TURN_WHITE_DICES_OFFSET + face_idx] =
+            static_cast<int8_t>(rGame.current_turn.white_dices[face_idx]);
+    }
+
+    if (rGame.round >= 0 && rGame.round < ROUND_COUNT) {
+        pFeatures[FEATURE_ROUND_OFFSET + rGame.round] = 1;
+    }
+    if (rGame.first_player_idx < static_cast<PlayerIdx>(player_count)) {
+        pFeatures[FEATURE_FIRST_PLAYER_OFFSET + seats[rGame.first_player_idx]] = 1;
+    }
+
+    return true;
+}
+
+bool lv::EncodeFeatures(const CompactGameState& rGame, PlayerIdx perspective_idx, float* pFeatures)
+{
+    alignas(64) std::array<int8_t, FEATURE_COUNT> raw;
+    const bool success = EncodeFeatures(rGame, perspective_idx, raw.data());
+    ScaleFeatures(raw.data(), pFeatures);
+    return success;
+}
+
+bool lv::EncodeFeatures(const GameState& rGame, PlayerIdx perspective_idx, int8_t* pFeatures)
+{
+    CompactGameState compact{};
+    if (!ToCompactGameState(rGame, compact)) {
+        std::fill(pFeatures, pFeatures + FEATURE_COUNT, int8_t{0});
+        return false;
+    }
+    return EncodeFeatures(compact, perspective_idx, pFeatures);
+}
+
+bool lv::EncodeFeatures(const GameState& rGame, PlayerIdx perspective_idx, float* pFeatures)
+{
+    CompactGameState compact{};
+    if (!ToCompactGameState(rGame, compact)) {
+        std::fill(pFeatures, pFeatures + FEATURE_COUNT, 0.0f);
+        return false;
+    }
+    return EncodeFeatures(compact, perspective_idx, pFeatures);
+}
+
+bool lv::EncodeFeatureBatch(const CompactGameState* pGames, const PlayerIdx* pPerspectives, int32_t state_count,
+                            int8_t* pFeatures)
+{
+    bool success = true;
+    for (int32_t state_idx = 0; state_idx < state_count; ++state_idx) {
+        const CompactGameState &rGame = pGames[state_idx];
+        const PlayerIdx perspective_idx =
+            pPerspectives != nullptr ? pPerspectives[state_idx] : rGame.current_turn.player_idx;
+        success &= EncodeFeatures(rGame, perspective_idx, pFeatures + static_cast<size_t>(state_idx) * FEATURE_COUNT);
+    }
+    return success;
+}
+
+bool lv::EncodeFeatureBatch(const CompactGameState* pGames, const PlayerIdx* pPerspectives, int32_t state_count,
+                            float* pFeatures)
+{
+    bool success = true;
+    for (int32_t state_idx = 0; state_idx < state_count; ++state_idx) {
+        const CompactGameState &rGame = pGames[state_idx];
+        const PlayerIdx perspective_idx =
+            pPerspectives != nullptr ? pPerspectives[state_idx] : rGame.current_turn.player_idx;
+        success &= EncodeFeatures(rGame, perspective_idx, pFeatures + static_cast<size_t>(state_idx) * FEATURE_COUNT);
+    }
+    return success;
+}
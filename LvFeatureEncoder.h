@@ -0,0 +1,66 @@
+#pragma once
+
+#include "LvPublic.h"
+
+#include <array>
+
+namespace lv {
+
+// Neural network features of game states
+//
+// A state is encoded as seen by one player into a row of FEATURE_COUNT values, laid out as the offsets below. Seats
+// are numbered from that player in turn order, so a network always finds itself at seat 0 and the next player to play
+// after it at seat 1, whatever the seats at the table. Seats past the player count are left at 0.
+//
+// int8 rows hold the raw counts and flags, float rows the same values times GetFeatureScales: bill counts over 8, dice
+// counts over DICE_COUNT, flags and one-hots as is. A row is gathered from the state as int8 then scaled in one pass
+// over the whole row, both loops the compiler vectorizes. Batches are written one row after the other to the caller's
+// buffer, nothing is allocated.
+//
+// The layout is versioned: any change to the offsets, sizes or scales bumps FEATURE_LAYOUT_VERSION, so that datasets
+// and trained networks can check what they were built for. Padding up to FEATURE_COUNT is always 0.
+
+enum { FEATURE_LAYOUT_VERSION = 1 };
+
+enum {
+    // Bill counts, bet of every seat, neutral bet
+    FEATURE_CASINO_SIZE = static_cast<int32_t>(BILL_TYPE_COUNT) + MAX_PLAYER_COUNT + 1,
+    // Present flag, dices, white dices, bill counts
+    FEATURE_PLAYER_SIZE = 3 + BILL_TYPE_COUNT,
+
+    FEATURE_CASINOS_OFFSET = 0, // Casino by casino, face 1 first
+    FEATURE_PLAYERS_OFFSET = FEATURE_CASINOS_OFFSET + static_cast<int32_t>(CASINO_COUNT) * FEATURE_CASINO_SIZE,
+    FEATURE_NEUTRAL_OFFSET = FEATURE_PLAYERS_OFFSET + MAX_PLAYER_COUNT * FEATURE_PLAYER_SIZE, // Present flag, bills
+    FEATURE_TURN_OFFSET = FEATURE_NEUTRAL_OFFSET + 1 + BILL_TYPE_COUNT, // Current seat one-hot
+    FEATURE_TURN_DICES_OFFSET = FEATURE_TURN_OFFSET + MAX_PLAYER_COUNT, // Rolled dices per face
+    FEATURE_TURN_WHITE_DICES_OFFSET = FEATURE_TURN_DICES_OFFSET + CASINO_COUNT,
+    FEATURE_ROUND_OFFSET = FEATURE_TURN_WHITE_DICES_OFFSET + CASINO_COUNT, // Round one-hot, none once the game is over
+    FEATURE_FIRST_PLAYER_OFFSET = FEATURE_ROUND_OFFSET + ROUND_COUNT,      // First seat of the round one-hot
+    FEATURE_USED_COUNT = FEATURE_FIRST_PLAYER_OFFSET + MAX_PLAYER_COUNT,
+
+    FEATURE_COUNT = 192, // Rows are whole cache lines of int8 and of float
+};
+
+static_assert(FEATURE_USED_COUNT == 186 && FEATURE_COUNT % 64 == 0,
+              "The feature layout changed, bump FEATURE_LAYOUT_VERSION and fix these numbers");
+
+// Scale of every feature from its int8 value to its float value
+const std::array<float, FEATURE_COUNT> &GetFeatureScales();
+
+// Features of rGame seen by perspective_idx into pFeatures, FEATURE_COUNT values.
+// Fails and writes a row of 0 if the player count or perspective_idx are out of range.
+bool EncodeFeatures(const CompactGameState &rGame, PlayerIdx perspective_idx, int8_t *pFeatures);
+bool EncodeFeatures(const CompactGameState &rGame, PlayerIdx perspective_idx, float *pFeatures);
+
+// Same through ToCompactGameState, which also fails on states without a compact representation
+bool EncodeFeatures(const GameState &rGame, PlayerIdx perspective_idx, int8_t *pFeatures);
+bool EncodeFeatures(const GameState &rGame, PlayerIdx perspective_idx, float *pFeatures);
+
+// Row state_idx of pFeatures from pGames[state_idx] seen by pPerspectives[state_idx], or by the current player of
+// every state if pPerspectives is null. pFeatures holds state_count * FEATURE_COUNT values. Fails if any row does.
+bool EncodeFeatureBatch(const CompactGameState *pGames, const PlayerIdx *pPerspectives, int32_t state_count,
+                        int8_t *pFeatures);
+bool EncodeFeatureBatch(const CompactGameState *pGames, const PlayerIdx *pPerspectives, int32_t state_count,
+                        float *pFeatures);
+
+} // namespace lv
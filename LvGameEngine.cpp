@@ -1,14 +1,170 @@
 #include "LvGameEngine.h"
+#include "LvDiceRoll.h"
+#include "LvStateHash.h"
+#include "LvUtils.h"
+
+#include <algorithm>
 #include <random>
 
-bool lv::GameEngine::SetupInitGameState(GameState& rGame, int32_t player_count)
+// Timing steps reports them to the same listener as the events
+#if defined(LV_ENABLE_ENGINE_TIMING) && !defined(LV_ENABLE_ENGINE_EVENTS)
+#define LV_ENABLE_ENGINE_EVENTS
+#endif
+
+#if defined(LV_ENABLE_ENGINE_TIMING)
+#include <chrono>
+#endif
+
+// Report an event to the listener, the event is only built when there's one
+#if defined(LV_ENABLE_ENGINE_EVENTS)
+#define LV_ENGINE_EVENT(call)               \
+    do {                                    \
+        if (m_pEventListener != nullptr) {  \
+            m_pEventListener->call;         \
+        }                                   \
+    } while (0)
+#else
+#define LV_ENGINE_EVENT(call) \
+    do {                      \
+    } while (0)
+#endif
+
+// Time the rest of the enclosing step
+#if defined(LV_ENABLE_ENGINE_TIMING)
+#define LV_ENGINE_TIMED_STEP(step) const StepTimer step_timer(m_pEventListener, step)
+#else
+#define LV_ENGINE_TIMED_STEP(step) \
+    do {                           \
+    } while (0)
+#endif
+
+namespace {
+
+#if defined(LV_ENABLE_ENGINE_EVENTS)
+
+template <const lv::RulesConfig &RULES>
+lv::RoundSetupEvent GetRoundSetupEvent(const lv::BasicGameState<RULES> &rGame)
+{
+    lv::RoundSetupEvent event{rGame.round, rGame.first_player_idx};
+    for (int32_t casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+        event.casino_money_values[casino_idx] = lv::GetCasinoMoneyValue(rGame.casinos[casino_idx]);
+    }
+    return event;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RoundSetupEvent GetRoundSetupEvent(const lv::BasicCompactGameState<RULES> &rGame)
+{
+    lv::RoundSetupEvent event{rGame.round, rGame.first_player_idx};
+    for (int32_t casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+        event.casino_money_values[casino_idx] = lv::GetCasinoMoneyValue(rGame.casinos[casino_idx]);
+    }
+    return event;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::DiceRolledEvent GetDiceRolledEvent(const lv::BasicGameState<RULES> &rGame)
+{
+    lv::DiceRolledEvent event{rGame.round, rGame.current_turn.player_idx};
+    for (const lv::DiceValue dice : rGame.current_turn.dices) {
+        ++event.dices[static_cast<int32_t>(dice) - 1];
+    }
+    for (const lv::DiceValue dice : rGame.current_turn.white_dices) {
+        ++event.white_dices[static_cast<int32_t>(dice) - 1];
+    }
+    return event;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::DiceRolledEvent GetDiceRolledEvent(const lv::BasicCompactGameState<RULES> &rGame)
+{
+    return lv::DiceRolledEvent{rGame.round, rGame.current_turn.player_idx, rGame.current_turn.dices,
+                               rGame.current_turn.white_dices};
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RoundEndEvent GetRoundEndEvent(const lv::BasicGameState<RULES> &rGame)
+{
+    lv::RoundEndEvent event{rGame.round};
+    for (size_t player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
+        event.player_money_values[player_idx] = lv::GetPlayerMoneyValue(rGame.players[player_idx]);
+    }
+    for (const lv::Bill bill : rGame.neutral_player.bills) {
+        event.neutral_money_value += static_cast<int32_t>(bill);
+    }
+    return event;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RoundEndEvent GetRoundEndEvent(const lv::BasicCompactGameState<RULES> &rGame)
+{
+    lv::RoundEndEvent event{rGame.round};
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        event.player_money_values[player_idx] = lv::GetPlayerMoneyValue(rGame.players[player_idx]);
+    }
+    event.neutral_money_value = lv::GetBillCountsMoneyValue(rGame.neutral_player_bills);
+    return event;
+}
+
+#endif
+
+#if defined(LV_ENABLE_ENGINE_TIMING)
+
+// Reports the time between its construction and destruction, the clock is only read when there's a listener
+class StepTimer {
+public:
+    StepTimer(lv::EngineEventListener *pListener, lv::EngineStep step) : m_pListener(pListener), m_step(step) {
+        if (m_pListener != nullptr) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~StepTimer() {
+        if (m_pListener != nullptr) {
+            const auto duration = std::chrono::steady_clock::now() - m_start;
+            m_pListener->OnStepTimed(m_step,
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+    }
+
+    StepTimer(const StepTimer &) = delete;
+    StepTimer &operator=(const StepTimer &) = delete;
+
+private:
+    lv::EngineEventListener *m_pListener = nullptr;
+    lv::EngineStep m_step;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
+
+} // namespace
+
+template <const lv::RulesConfig &RULES>
+lv::BasicGameEngine<RULES>::BasicGameEngine()
+{
+    std::random_device rd;
+    Seed((static_cast<uint64_t>(rd()) << 32) | rd());
+}
+
+template <const lv::RulesConfig &RULES>
+lv::BasicGameEngine<RULES>::BasicGameEngine(uint64_t seed) : m_rng(seed) {}
+
+template <const lv::RulesConfig &RULES>
+lv::BasicGameEngine<RULES>::BasicGameEngine(const Rng& rRng) : m_rng(rRng) {}
+
+template <const lv::RulesConfig &RULES>
+void lv::BasicGameEngine<RULES>::Seed(uint64_t seed) { m_rng.Seed(seed); }
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupInitGameState(GameState& rGame, int32_t player_count)
 {
     // Check player count
     if (player_count < 2 || player_count > MAX_PLAYER_COUNT) {
         return false;
     }
 
-    rGame = {};
+    rGame.Reset(player_count);
 
     // Setup bank
     for (const BankEntry &rEntry : BANK_INIT_STOCK_TABLE) {
@@ -20,16 +176,9 @@ bool lv::GameEngine::SetupInitGameState(GameState& rGame, int32_t player_count)
 
     // Setup players
     rGame.player_count = player_count;
-    rGame.neutral_player_present = player_count < MAX_PLAYER_COUNT;
-    rGame.players.resize(player_count);
-
-    int32_t extra_white_dices_count = 0;
-    for (const ExtraWhiteDiceEntry &rEntry : EXTRA_WHITE_DICE_COUNT_TABLE) {
-        if (player_count == rEntry.player_count) {
-            extra_white_dices_count = rEntry.white_dice_count;
-            break;
-        }
-    }
+    rGame.neutral_player_present = Rules::IsNeutralPlayerPresent(player_count);
+
+    const int32_t extra_white_dices_count = GetExtraWhiteDiceCount(player_count);
 
     for (PlayerIdx player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
         PlayerState &rPlayer = rGame.players[player_idx];
@@ -51,78 +200,123 @@ bool lv::GameEngine::SetupInitGameState(GameState& rGame, int32_t player_count)
     // Start round 0
     rGame.first_player_idx = 0;
 
+    rGame.hash = ComputeHash(rGame);
+
     return true;
 }
 
-bool lv::GameEngine::SetupRound(GameState& rGame)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupRound(GameState& rGame)
 {
+    LV_ENGINE_TIMED_STEP(EngineStep::SetupRound);
+
     ShuffleBank(rGame.bank);
 
     if (!SetupCasinoBills(rGame)) {
         return false;
     }
 
+    LV_ENGINE_EVENT(OnRoundSetup(GetRoundSetupEvent(rGame)));
+
     return true;
 }
 
-bool lv::GameEngine::StartRound(GameState& rGame)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::StartRound(GameState& rGame)
 {
+    LV_ENGINE_TIMED_STEP(EngineStep::StartRound);
+
+    const PlayerIdx previous_player_idx = rGame.current_turn.player_idx;
     if (!SetupPlayerTurnState(rGame.current_turn, rGame, rGame.first_player_idx)) {
         return false;
     }
+    rGame.hash += GetHashDelta(HASH_KEYS.current_player, int64_t{rGame.first_player_idx} - previous_player_idx);
+
+    LV_ENGINE_EVENT(OnDiceRolled(GetDiceRolledEvent(rGame)));
 
     return true;
 }
 
-bool lv::GameEngine::AllocateDices(GameState& rGame, DiceValue dice)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::AllocateDices(GameState& rGame, DiceValue dice)
 {
+    LV_ENGINE_TIMED_STEP(EngineStep::AllocateDices);
+
     // Validate dice value
     if (dice < DICE_VALUE_MIN || dice > DICE_VALUE_MAX) {
         return false;
     }
 
-    // Get the dice's casino
-    CasinoState &rCasino = rGame.casinos[static_cast<CasinoIdx>(dice) - 1];
+    // Validate current player index
+    if (rGame.current_turn.player_idx >= rGame.players.size()) {
+        return false;
+    }
 
-    auto allocate_fn = [&](std::vector<DiceValue> &rDices, int32_t &rCasino_bet, int32_t& rPlayer_dices) {
-        uint32_t dices_allocated = 0;
+    // Count the current turn's dices matching the dice value, before touching anything
+    const int32_t dices_allocated =
+        static_cast<int32_t>(std::count(rGame.current_turn.dices.begin(), rGame.current_turn.dices.end(), dice));
+    const int32_t white_dices_allocated = static_cast<int32_t>(
+        std::count(rGame.current_turn.white_dices.begin(), rGame.current_turn.white_dices.end(), dice));
 
-        // Iterate through the current turn's dices and find the one matching the dice value
-        for (DiceValue &rDice : rDices) {
-            if (rDice == dice) {
-                ++dices_allocated;
-                ++rCasino_bet;
-                --rPlayer_dices;
-            }
-        }
-        return dices_allocated;
-    };
+    // The dice value must have been rolled
+    if (dices_allocated == 0 && white_dices_allocated == 0) {
+        return false;
+    }
+
+    // Get the dice's casino
+    const CasinoIdx casino_idx = static_cast<CasinoIdx>(dice) - 1;
+    const PlayerIdx player_idx = rGame.current_turn.player_idx;
+    CasinoState &rCasino = rGame.casinos[casino_idx];
+    PlayerState &rPlayer = rGame.players[player_idx];
+    const uint64_t neutral_bet_key = HASH_KEYS.dice_bets[casino_idx][CASINO_NEUTRAL_WINNER];
+    rGame.hash += GetHashDelta(HASH_KEYS.dice_bets[casino_idx][player_idx] - HASH_KEYS.dices[player_idx],
+                               dices_allocated) +
+                  GetHashDelta(neutral_bet_key - HASH_KEYS.white_dices[player_idx], white_dices_allocated);
 
     // Allocate player dices
-    uint32_t dices_allocated = allocate_fn(rGame.current_turn.dices, rCasino.dice_bets[rGame.current_turn.player_idx],
-                                           rGame.players[rGame.current_turn.player_idx].dices);
+    rCasino.dice_bets[player_idx] += dices_allocated;
+    rPlayer.dices -= dices_allocated;
 
     // Allocate white dices
-    uint32_t white_dices_allocated = allocate_fn(rGame.current_turn.white_dices, rCasino.neutral_dice_bet,
-                                                 rGame.players[rGame.current_turn.player_idx].white_dices);
-    
+    rCasino.neutral_dice_bet += white_dices_allocated;
+    rPlayer.white_dices -= white_dices_allocated;
+
     // Clear current turn dices
     rGame.current_turn.dices.clear();
     rGame.current_turn.white_dices.clear();
 
-    // Do some validation
-    if (dices_allocated == 0 && white_dices_allocated == 0) {
-        return false;
-    }
+    LV_ENGINE_EVENT(OnDiceAllocated(
+        DiceAllocatedEvent{rGame.round, player_idx, dice, dices_allocated, white_dices_allocated}));
 
     return true;
 }
 
-bool lv::GameEngine::IsRoundOver(const GameState& rGame) const
+template <const lv::RulesConfig &RULES>
+int32_t lv::BasicGameEngine<RULES>::GetLegalMoves(const GameState& rGame, LegalMoveList& rMoves) const
+{
+    DiceCounts dices{};
+    DiceCounts white_dices{};
+
+    for (const DiceValue &rDice : rGame.current_turn.dices) {
+        if (rDice >= DICE_VALUE_MIN && rDice <= DICE_VALUE_MAX) {
+            ++dices[static_cast<int32_t>(rDice) - 1];
+        }
+    }
+    for (const DiceValue &rDice : rGame.current_turn.white_dices) {
+        if (rDice >= DICE_VALUE_MIN && rDice <= DICE_VALUE_MAX) {
+            ++white_dices[static_cast<int32_t>(rDice) - 1];
+        }
+    }
+
+    return FillLegalMoves(dices, white_dices, rMoves);
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::IsRoundOver(const GameState& rGame) const
 {
     // Round is over is no players have any dice left
     for (const PlayerState &rPlayer : rGame.players) {
-        if (rPlayer.dices > 0) {
+        if (rPlayer.dices > 0 || rPlayer.white_dices > 0) {
             return false;
         }
     }
@@ -130,7 +324,8 @@ bool lv::GameEngine::IsRoundOver(const GameState& rGame) const
     return true;
 }
 
-bool lv::GameEngine::IsGameOver(const GameState& rGame) const
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::IsGameOver(const GameState& rGame) const
 {
     // Game is over if this is the last round
     if (rGame.round >= ROUND_COUNT) {
@@ -139,46 +334,96 @@ bool lv::GameEngine::IsGameOver(const GameState& rGame) const
     return false;
 }
 
-bool lv::GameEngine::AdvanceToNextPlayer(GameState& rGame)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::AdvanceToNextPlayer(GameState& rGame)
 {
-    // Find the next player with some dices
+    LV_ENGINE_TIMED_STEP(EngineStep::AdvanceToNextPlayer);
+
+    // Find the next player with some dices, the current player plays again when nobody else has any
     PlayerIdx initial_player_idx = rGame.current_turn.player_idx;
-    PlayerIdx next_player_idx = (initial_player_idx + 1) % rGame.players.size();
+    PlayerIdx next_player_idx = initial_player_idx;
 
-    while (next_player_idx != initial_player_idx)
+    for (size_t i = 0; i < rGame.players.size(); ++i)
     {
+        next_player_idx = (next_player_idx + 1) % rGame.players.size();
         const PlayerState &rPlayer = rGame.players[next_player_idx];
 
         if (rPlayer.dices > 0 || rPlayer.white_dices > 0)
         {
+            rGame.hash += GetHashDelta(HASH_KEYS.current_player, int64_t{next_player_idx} - initial_player_idx);
             rGame.current_turn.player_idx = next_player_idx;
             if (!SetupPlayerTurnState(rGame.current_turn, rGame, rGame.current_turn.player_idx)) {
                 return false;
             }
 
+#if defined(LV_ENABLE_ENGINE_EVENTS)
+            // The players in between have no dice left
+            for (PlayerIdx skipped_player_idx = (initial_player_idx + 1) % rGame.players.size();
+                 skipped_player_idx != next_player_idx;
+                 skipped_player_idx = (skipped_player_idx + 1) % rGame.players.size()) {
+                LV_ENGINE_EVENT(OnPlayerSkipped(PlayerSkippedEvent{rGame.round, skipped_player_idx}));
+            }
+#endif
+            LV_ENGINE_EVENT(OnDiceRolled(GetDiceRolledEvent(rGame)));
+
             return true;
         }
-        next_player_idx = (next_player_idx + 1) % rGame.players.size();
     }
 
-    return false; // We got back to first player, logic error
+    return false; // Nobody has any dice left, the round is over
 }
 
-bool lv::GameEngine::EndRound(GameState& rGame)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::EndRound(GameState& rGame)
 {
+    LV_ENGINE_TIMED_STEP(EngineStep::EndRound);
+
     if (!DistributeCasinoBills(rGame)) {
         return false;
     }
 
+    // Players take back their dices for the next round
+    const int32_t extra_white_dices_count = GetExtraWhiteDiceCount(rGame.player_count);
+    for (size_t player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
+        PlayerState &rPlayer = rGame.players[player_idx];
+        rGame.hash += GetHashDelta(HASH_KEYS.dices[player_idx], DICE_COUNT - rPlayer.dices) +
+                      GetHashDelta(HASH_KEYS.white_dices[player_idx], extra_white_dices_count - rPlayer.white_dices);
+        rPlayer.dices = DICE_COUNT;
+        rPlayer.white_dices = extra_white_dices_count;
+    }
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CasinoState &rCasino = rGame.casinos[casino_idx];
+        for (size_t player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
+            rGame.hash -= GetHashDelta(HASH_KEYS.dice_bets[casino_idx][player_idx], rCasino.dice_bets[player_idx]);
+        }
+        rGame.hash -= GetHashDelta(HASH_KEYS.dice_bets[casino_idx][CASINO_NEUTRAL_WINNER], rCasino.neutral_dice_bet);
+        rCasino.dice_bets.fill(0);
+        rCasino.neutral_dice_bet = 0;
+    }
+
+    // Next player starts the next round
+    const PlayerIdx first_player_idx = (rGame.first_player_idx + 1) % rGame.players.size();
+    rGame.hash += GetHashDelta(HASH_KEYS.first_player, int64_t{first_player_idx} - rGame.first_player_idx) +
+                  HASH_KEYS.round;
+    rGame.first_player_idx = first_player_idx;
+
+    LV_ENGINE_EVENT(OnRoundEnd(GetRoundEndEvent(rGame)));
+
     ++rGame.round;
 
     return true;
 }
 
-bool lv::GameEngine::SetupCasinoBills(GameState& rGame)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupCasinoBills(GameState& rGame)
 {
     // Allocate bills to each casino
-    for (CasinoState &rCasino : rGame.casinos) {
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CasinoState &rCasino = rGame.casinos[casino_idx];
+        const auto &rBillKeys = HASH_KEYS.bills[HASH_CASINO_BILL_OWNER + casino_idx];
+        for (const Bill bill : rCasino.bills) {
+            rGame.hash -= rBillKeys[GetBillIndex(bill)];
+        }
         rCasino.bills.clear();
         int32_t current_value = 0;
         while (current_value < CASINO_MIN_MONEY_VALUE) {
@@ -186,6 +431,7 @@ bool lv::GameEngine::SetupCasinoBills(GameState& rGame)
                 return false;
             }
 
+            rGame.hash += rBillKeys[GetBillIndex(rGame.bank.back())];
             rCasino.bills.push_back(rGame.bank.back());
             rGame.bank.pop_back();
             current_value += static_cast<int32_t>(rCasino.bills.back());
@@ -195,7 +441,9 @@ bool lv::GameEngine::SetupCasinoBills(GameState& rGame)
     return true;
 }
 
-bool lv::GameEngine::SetupPlayerTurnState(PlayerTurnState& rPlayerTurn, const GameState &rGame, PlayerIdx player_idx)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupPlayerTurnState(PlayerTurnState& rPlayerTurn, const GameState &rGame,
+                                                      PlayerIdx player_idx)
 {
     // Validate current player index
     if (player_idx < 0 || player_idx >= rGame.players.size()) {
@@ -216,111 +464,483 @@ bool lv::GameEngine::SetupPlayerTurnState(PlayerTurnState& rPlayerTurn, const Ga
     return true;
 }
 
-bool lv::GameEngine::RollDices(std::vector<DiceValue>& rDices, int32_t dice_count)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::RollDices(DiceVector& rDices, int32_t dice_count)
 {
-    rDices.clear();
-
-    // Create a random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(static_cast<int32_t>(DICE_VALUE_MIN), static_cast<int32_t>(DICE_VALUE_MAX));
-
-    // Choose a number dice value for each dice
+    // Same draw as the compact state, the dices are listed by face like ToGameState does
+    DiceCounts counts{};
+    RollDiceCounts(m_rng, dice_count, counts);
+    rDices.resize(std::max(0, dice_count));
+
+    // The face of each dice is counted from where the faces end rather than with a loop per face, whose random
+    // lengths would be mispredicted
+    std::array<int32_t, CASINO_COUNT> face_ends{};
+    int32_t face_end = 0;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        face_end += counts[face_idx];
+        face_ends[face_idx] = face_end;
+    }
+    DiceValue *pDices = rDices.data();
     for (int32_t i = 0; i < dice_count; ++i) {
-        // Choose a random value between 1 and 6
-        rDices.push_back(static_cast<DiceValue>(dis(gen)));
+        int32_t face_idx = 0;
+        for (int32_t end_idx = 0; end_idx < CASINO_COUNT - 1; ++end_idx) {
+            face_idx += i >= face_ends[end_idx];
+        }
+        pDices[i] = static_cast<DiceValue>(face_idx + 1);
     }
 
     return true;
 }
 
-void lv::GameEngine::ShuffleBank(std::vector<Bill>& rBank) { 
-    // Create a random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::shuffle(rBank.begin(), rBank.end(), gen);
+template <const lv::RulesConfig &RULES>
+void lv::BasicGameEngine<RULES>::ShuffleBank(BillVector& rBank)
+{
+    Shuffle(rBank.data(), static_cast<int32_t>(rBank.size()), m_rng);
 }
 
-bool lv::GameEngine::DistributeCasinoBills(GameState& rGame)
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::DistributeCasinoBills(GameState& rGame)
 {
+    LV_ENGINE_TIMED_STEP(EngineStep::DistributeCasinoBills);
+
+    // Where each bidder's bills go
+    std::array<BillVector *, CASINO_BIDDER_COUNT> winner_bills{};
+    for (size_t player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
+        winner_bills[player_idx] = &rGame.players[player_idx].bills;
+    }
+    winner_bills[CASINO_NEUTRAL_WINNER] = &rGame.neutral_player.bills;
+
     // Go through all casinos
-    for (CasinoState &rCasino : rGame.casinos) {
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CasinoState &rCasino = rGame.casinos[casino_idx];
 
-        // Sort bills in ascending order
-        std::sort(rCasino.bills.begin(), rCasino.bills.end());
+        // Count bills per denomination rather than sorting them
+        BillCounts bills{};
+        for (const Bill bill : rCasino.bills) {
+            ++bills[GetBillIndex(bill)];
+            rGame.hash -= HASH_KEYS.bills[HASH_CASINO_BILL_OWNER + casino_idx][GetBillIndex(bill)];
+        }
+        rCasino.bills.clear();
 
-        bool more_to_distribute = true;
-        while (more_to_distribute)
-        {
-            // Check if there are no more bills to distribute
-            if (rCasino.bills.empty()) {
-                more_to_distribute = false;
-                break;
-            }
+        const CasinoWinners winners = GetCasinoWinners(rCasino.dice_bets, rCasino.neutral_dice_bet,
+                                                       static_cast<int32_t>(rGame.players.size()));
+        RankedBillCounts ranked_bills{};
+        const int32_t bill_count = GetRankedBillCounts(bills, ranked_bills);
+        const int32_t paid_count = std::min(winners.count, bill_count);
+
+        // Each winner takes the bill of their rank, the remaining bills go back to the bank in ascending order
+        for (int32_t rank = 0; rank < paid_count; ++rank) {
+            const int32_t bill_idx = GetRankedBillIndex(ranked_bills, rank);
+            winner_bills[winners.bidders[rank]]->push_back(GetBillFromIndex(bill_idx));
+            rGame.hash += HASH_KEYS.bills[winners.bidders[rank]][bill_idx];
+            LV_ENGINE_EVENT(OnBillAwarded(BillAwardedEvent{rGame.round, static_cast<CasinoIdx>(casino_idx),
+                                                           winners.bidders[rank], rank, GetBillFromIndex(bill_idx)}));
+        }
+        for (int32_t rank = bill_count - 1; rank >= paid_count; --rank) {
+            rGame.bank.push_back(GetBillFromIndex(GetRankedBillIndex(ranked_bills, rank)));
+        }
+    }
 
-            // Take the bill with highest value
-            Bill highest_bill = rCasino.bills.back();
-            rCasino.bills.pop_back();
-
-            // Cancel all equal bets
-            // Start by cancelling the neutral bet
-            if (rCasino.neutral_dice_bet > 0) {
-                bool neutral_bet_canceled = false;
-                for (PlayerIdx player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
-                    if (rCasino.dice_bets[player_idx] == rCasino.neutral_dice_bet) {
-                        rCasino.dice_bets[player_idx] = 0;
-                        neutral_bet_canceled = true;
-                    }
-                }
-                if (neutral_bet_canceled) {
-                    rCasino.neutral_dice_bet = 0;
-                }
-            }
+    return true;
+}
 
-            // Cancel equal player bets
-            for (PlayerIdx player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
-                int32_t bet = rCasino.dice_bets[player_idx];
-                if (bet > 0) {
-                    for (PlayerIdx other_player_idx = player_idx + 1; other_player_idx < rGame.players.size();
-                         ++other_player_idx) {
-                        if (bet == rCasino.dice_bets[other_player_idx]) {
-                            rCasino.dice_bets[player_idx] = 0;
-                            rCasino.dice_bets[other_player_idx] = 0;
-                        }
-                    }
-                }
-            }
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupInitGameState(CompactGameState& rGame, int32_t player_count)
+{
+    // Check player count
+    if (player_count < 2 || player_count > MAX_PLAYER_COUNT) {
+        return false;
+    }
+
+    rGame = {};
+
+    // Setup bank
+    for (const BankEntry &rEntry : BANK_INIT_STOCK_TABLE) {
+        for (int32_t i = 0; i < rEntry.count; ++i) {
+            rGame.bank[rGame.bank_size++] = static_cast<uint8_t>(GetBillIndex(rEntry.bill));
+        }
+    }
+
+    // Setup players
+    rGame.player_count = player_count;
+    rGame.neutral_player_present = Rules::IsNeutralPlayerPresent(player_count);
+
+    const int32_t extra_white_dices_count = GetExtraWhiteDiceCount(player_count);
+
+    for (PlayerIdx player_idx = 0; player_idx < static_cast<PlayerIdx>(player_count); ++player_idx) {
+        CompactPlayerState &rPlayer = rGame.players[player_idx];
+        rPlayer.dices = DICE_COUNT;
+        rPlayer.white_dices = static_cast<int8_t>(extra_white_dices_count);
+        rGame.hash += GetHashDelta(HASH_KEYS.dices[player_idx], DICE_COUNT) +
+                      GetHashDelta(HASH_KEYS.white_dices[player_idx], extra_white_dices_count);
+    }
+
+    // Start round 0
+    rGame.first_player_idx = 0;
+
+    const StateChanges all_changes = StateChanges::All();
+    MarkChanges(all_changes.casino_mask, all_changes.player_mask, all_changes.flags);
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupRound(CompactGameState& rGame)
+{
+    LV_ENGINE_TIMED_STEP(EngineStep::SetupRound);
+
+    MarkChanges((1u << CASINO_COUNT) - 1, 0, StateChanges::BANK);
+
+    ShuffleBank(rGame);
+
+    if (!SetupCasinoBills(rGame)) {
+        return false;
+    }
+
+    LV_ENGINE_EVENT(OnRoundSetup(GetRoundSetupEvent(rGame)));
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::StartRound(CompactGameState& rGame)
+{
+    LV_ENGINE_TIMED_STEP(EngineStep::StartRound);
+
+    MarkChanges(0, 0, StateChanges::TURN);
+
+    const PlayerIdx previous_player_idx = rGame.current_turn.player_idx;
+    if (!SetupPlayerTurnState(rGame.current_turn, rGame, rGame.first_player_idx)) {
+        return false;
+    }
+    rGame.hash += GetHashDelta(HASH_KEYS.current_player, int64_t{rGame.first_player_idx} - previous_player_idx);
+
+    LV_ENGINE_EVENT(OnDiceRolled(GetDiceRolledEvent(rGame)));
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::AllocateDices(CompactGameState& rGame, DiceValue dice)
+{
+    LV_ENGINE_TIMED_STEP(EngineStep::AllocateDices);
+
+    // Validate dice value
+    if (dice < DICE_VALUE_MIN || dice > DICE_VALUE_MAX) {
+        return false;
+    }
+
+    // Validate current player index
+    if (rGame.current_turn.player_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return false;
+    }
+
+    // Every rolled dice of that value goes to the casino, the value must have been rolled
+    const CasinoIdx casino_idx = static_cast<CasinoIdx>(dice) - 1;
+    const int8_t dices_allocated = static_cast<int8_t>(rGame.current_turn.dices[casino_idx]);
+    const int8_t white_dices_allocated = static_cast<int8_t>(rGame.current_turn.white_dices[casino_idx]);
+
+    if (dices_allocated == 0 && white_dices_allocated == 0) {
+        return false;
+    }
+
+    CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+    CompactPlayerState &rPlayer = rGame.players[rGame.current_turn.player_idx];
+
+    MarkChanges(1u << casino_idx, 1u << rGame.current_turn.player_idx, StateChanges::TURN);
+
+    const PlayerIdx player_idx = rGame.current_turn.player_idx;
+    const uint64_t neutral_bet_key = HASH_KEYS.dice_bets[casino_idx][CASINO_NEUTRAL_WINNER];
+    rGame.hash += GetHashDelta(HASH_KEYS.dice_bets[casino_idx][player_idx] - HASH_KEYS.dices[player_idx],
+                               dices_allocated) +
+                  GetHashDelta(neutral_bet_key - HASH_KEYS.white_dices[player_idx], white_dices_allocated);
+
+    rCasino.dice_bets[player_idx] += dices_allocated;
+    rPlayer.dices -= dices_allocated;
+
+    rCasino.neutral_dice_bet += white_dices_allocated;
+    rPlayer.white_dices -= white_dices_allocated;
+
+    // Clear current turn dices
+    rGame.current_turn.dices.fill(0);
+    rGame.current_turn.white_dices.fill(0);
+
+    LV_ENGINE_EVENT(OnDiceAllocated(
+        DiceAllocatedEvent{rGame.round, player_idx, dice, dices_allocated, white_dices_allocated}));
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+int32_t lv::BasicGameEngine<RULES>::GetLegalMoves(const CompactGameState& rGame, LegalMoveList& rMoves) const
+{
+    return FillLegalMoves(rGame.current_turn.dices, rGame.current_turn.white_dices, rMoves);
+}
 
-            // Find the player with the highest bet
-            int32_t highest_bet = 0;
-            enum {INVALID_PLAYER_IDX = -1};
-            PlayerIdx highest_bet_player_idx = INVALID_PLAYER_IDX;
-            for (PlayerIdx player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
-                if (rCasino.dice_bets[player_idx] > highest_bet) {
-                    highest_bet = rCasino.dice_bets[player_idx];
-                    highest_bet_player_idx = player_idx;
-                }
+template <const lv::RulesConfig &RULES>
+int32_t lv::BasicGameEngine<RULES>::FillLegalMoves(const DiceCounts& rDices, const DiceCounts& rWhiteDices,
+                                                   LegalMoveList& rMoves)
+{
+    // One move per rolled face, in ascending face order
+    rMoves.count = 0;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        LegalMove &rMove = rMoves.moves[rMoves.count];
+        rMove.dice = static_cast<DiceValue>(face_idx + 1);
+        rMove.dice_count = rDices[face_idx];
+        rMove.white_dice_count = rWhiteDices[face_idx];
+        rMoves.count += (rDices[face_idx] | rWhiteDices[face_idx]) != 0;
+    }
+
+    return rMoves.count;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::IsRoundOver(const CompactGameState& rGame) const
+{
+    // Round is over is no players have any dice left
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        if (rGame.players[player_idx].dices > 0 || rGame.players[player_idx].white_dices > 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::IsGameOver(const CompactGameState& rGame) const
+{
+    // Game is over if this is the last round
+    if (rGame.round >= ROUND_COUNT) {
+        return true;
+    }
+    return false;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::AdvanceToNextPlayer(CompactGameState& rGame)
+{
+    LV_ENGINE_TIMED_STEP(EngineStep::AdvanceToNextPlayer);
+
+    // Find the next player with some dices, the current player plays again when nobody else has any
+    const PlayerIdx player_count = static_cast<PlayerIdx>(rGame.player_count);
+    PlayerIdx next_player_idx = rGame.current_turn.player_idx;
+
+    for (PlayerIdx i = 0; i < player_count; ++i) {
+        next_player_idx = (next_player_idx + 1) % player_count;
+        const CompactPlayerState &rPlayer = rGame.players[next_player_idx];
+
+        if (rPlayer.dices > 0 || rPlayer.white_dices > 0) {
+            MarkChanges(0, 0, StateChanges::TURN);
+
+            const PlayerIdx previous_player_idx = rGame.current_turn.player_idx;
+            if (!SetupPlayerTurnState(rGame.current_turn, rGame, next_player_idx)) {
+                return false;
             }
+            rGame.hash += GetHashDelta(HASH_KEYS.current_player, int64_t{next_player_idx} - previous_player_idx);
 
-            // Check if the neutral player has the highest bet
-            bool highest_bet_neutral = false;
-            if (rCasino.neutral_dice_bet > highest_bet) {
-                highest_bet = rCasino.neutral_dice_bet;
-                highest_bet_neutral = true;
+#if defined(LV_ENABLE_ENGINE_EVENTS)
+            // The players in between have no dice left
+            for (PlayerIdx skipped_player_idx = (previous_player_idx + 1) % player_count;
+                 skipped_player_idx != next_player_idx; skipped_player_idx = (skipped_player_idx + 1) % player_count) {
+                LV_ENGINE_EVENT(OnPlayerSkipped(PlayerSkippedEvent{rGame.round, skipped_player_idx}));
             }
+#endif
+            LV_ENGINE_EVENT(OnDiceRolled(GetDiceRolledEvent(rGame)));
+
+            return true;
+        }
+    }
+
+    return false; // Nobody has any dice left, the round is over
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::EndRound(CompactGameState& rGame)
+{
+    LV_ENGINE_TIMED_STEP(EngineStep::EndRound);
+
+    MarkChanges((1u << CASINO_COUNT) - 1, (1u << rGame.player_count) - 1,
+                StateChanges::BANK | StateChanges::NEUTRAL_PLAYER | StateChanges::HEADER);
 
-            // Was there any bet ?
-            if (highest_bet_player_idx == INVALID_PLAYER_IDX && !highest_bet_neutral) {
-                more_to_distribute = false;
-                break;
-            } else {
-                // Add bill to highest player's money
-                if (!highest_bet_neutral) {
-                    rGame.players[highest_bet_player_idx].bills.push_back(highest_bill);
-                }
+    if (!DistributeCasinoBills(rGame)) {
+        return false;
+    }
+
+    // Players take back their dices for the next round, hashed in a local like in SetupCasinoBills
+    uint64_t hash = rGame.hash;
+    const int8_t extra_white_dices_count = static_cast<int8_t>(GetExtraWhiteDiceCount(rGame.player_count));
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        CompactPlayerState &rPlayer = rGame.players[player_idx];
+        hash += GetHashDelta(HASH_KEYS.dices[player_idx], DICE_COUNT - rPlayer.dices) +
+                GetHashDelta(HASH_KEYS.white_dices[player_idx], extra_white_dices_count - rPlayer.white_dices);
+        rPlayer.dices = DICE_COUNT;
+        rPlayer.white_dices = extra_white_dices_count;
+    }
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            hash -= GetHashDelta(HASH_KEYS.dice_bets[casino_idx][player_idx], rCasino.dice_bets[player_idx]);
+        }
+        hash -= GetHashDelta(HASH_KEYS.dice_bets[casino_idx][CASINO_NEUTRAL_WINNER], rCasino.neutral_dice_bet);
+        rCasino.dice_bets.fill(0);
+        rCasino.neutral_dice_bet = 0;
+    }
+
+    // Next player starts the next round
+    const PlayerIdx first_player_idx = (rGame.first_player_idx + 1) % static_cast<PlayerIdx>(rGame.player_count);
+    hash += GetHashDelta(HASH_KEYS.first_player, int64_t{first_player_idx} - rGame.first_player_idx) + HASH_KEYS.round;
+    rGame.hash = hash;
+    rGame.first_player_idx = first_player_idx;
+
+    LV_ENGINE_EVENT(OnRoundEnd(GetRoundEndEvent(rGame)));
+
+    ++rGame.round;
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::PlayMove(CompactGameState& rGame, DiceValue dice)
+{
+    if (!AllocateDices(rGame, dice)) {
+        return false;
+    }
+
+    if (!IsRoundOver(rGame)) {
+        return AdvanceToNextPlayer(rGame);
+    }
+
+    if (!EndRound(rGame)) {
+        return false;
+    }
+
+    if (IsGameOver(rGame)) {
+        return true;
+    }
+
+    return SetupRound(rGame) && StartRound(rGame);
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupCasinoBills(CompactGameState& rGame)
+{
+    // Hashed in a local, the bill counts being bytes the compiler can't keep rGame.hash in a register
+    uint64_t hash = rGame.hash;
+
+    // Allocate bills to each casino
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        const auto &rBillKeys = HASH_KEYS.bills[HASH_CASINO_BILL_OWNER + casino_idx];
+        for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+            hash -= GetHashDelta(rBillKeys[bill_idx], rCasino.bills[bill_idx]);
+        }
+        rCasino.bills.fill(0);
+        int32_t current_value = 0;
+        while (current_value < CASINO_MIN_MONEY_VALUE) {
+            if (rGame.bank_size == 0) {
+                rGame.hash = hash;
+                return false;
             }
+
+            const uint8_t bill_idx = rGame.bank[--rGame.bank_size];
+            rGame.bank[rGame.bank_size] = 0;
+            ++rCasino.bills[bill_idx];
+            hash += rBillKeys[bill_idx];
+            current_value += static_cast<int32_t>(GetBillFromIndex(bill_idx));
         }
     }
 
+    rGame.hash = hash;
+
     return true;
 }
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::SetupPlayerTurnState(CompactPlayerTurnState& rPlayerTurn,
+                                                      const CompactGameState& rGame, PlayerIdx player_idx)
+{
+    // Validate current player index
+    if (player_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return false;
+    }
+
+    const CompactPlayerState &rPlayer = rGame.players[player_idx];
+    rPlayerTurn.player_idx = player_idx;
+
+    if (!RollDices(rPlayerTurn.dices, rPlayer.dices)) {
+        return false;
+    }
+    if (!RollDices(rPlayerTurn.white_dices, rPlayer.white_dices)) {
+        return false;
+    }
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::RollDices(DiceCounts& rDices, int32_t dice_count)
+{
+    // Only the number of dices per face matters, see LvDiceRoll.h
+    RollDiceCounts(m_rng, dice_count, rDices);
+
+    return true;
+}
+
+template <const lv::RulesConfig &RULES>
+void lv::BasicGameEngine<RULES>::ShuffleBank(CompactGameState& rGame)
+{
+    Shuffle(rGame.bank.data(), rGame.bank_size, m_rng);
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicGameEngine<RULES>::DistributeCasinoBills(CompactGameState& rGame)
+{
+    LV_ENGINE_TIMED_STEP(EngineStep::DistributeCasinoBills);
+
+    // Where each bidder's bills go
+    std::array<BillCounts *, CASINO_BIDDER_COUNT> winner_bills{};
+    for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+        winner_bills[player_idx] = &rGame.players[player_idx].bills;
+    }
+    winner_bills[CASINO_NEUTRAL_WINNER] = &rGame.neutral_player_bills;
+
+    // Hashed in a local like in SetupCasinoBills
+    uint64_t hash = rGame.hash;
+
+    // Go through all casinos
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+
+        const CasinoWinners winners =
+            GetCasinoWinners(rCasino.dice_bets, rCasino.neutral_dice_bet, rGame.player_count);
+        RankedBillCounts ranked_bills{};
+        const int32_t bill_count = GetRankedBillCounts(rCasino.bills, ranked_bills);
+        const int32_t paid_count = std::min(winners.count, bill_count);
+        const auto &rBillKeys = HASH_KEYS.bills[HASH_CASINO_BILL_OWNER + casino_idx];
+        rCasino.bills = {};
+
+        // Each winner takes the bill of their rank, the remaining bills go back to the bank in ascending order
+        for (int32_t rank = 0; rank < paid_count; ++rank) {
+            const int32_t bill_idx = GetRankedBillIndex(ranked_bills, rank);
+            ++(*winner_bills[winners.bidders[rank]])[bill_idx];
+            hash += HASH_KEYS.bills[winners.bidders[rank]][bill_idx] - rBillKeys[bill_idx];
+            LV_ENGINE_EVENT(OnBillAwarded(BillAwardedEvent{rGame.round, static_cast<CasinoIdx>(casino_idx),
+                                                           winners.bidders[rank], rank, GetBillFromIndex(bill_idx)}));
+        }
+        for (int32_t rank = paid_count; rank < bill_count; ++rank) {
+            const int32_t bill_idx = GetRankedBillIndex(ranked_bills, rank);
+            rGame.bank[rGame.bank_size + bill_count - 1 - rank] = static_cast<uint8_t>(bill_idx);
+            hash -= rBillKeys[bill_idx];
+        }
+        rGame.bank_size += bill_count - paid_count;
+    }
+
+    rGame.hash = hash;
+
+    return true;
+}
+
+#define LV_INSTANTIATE_GAME_ENGINE(RULES) template class lv::BasicGameEngine<lv::RULES>;
+
+LV_FOR_EACH_RULES(LV_INSTANTIATE_GAME_ENGINE)
@@ -1,26 +1,116 @@
 #pragma once
 
+#include "LvEngineEvents.h"
 #include "LvPublic.h"
+#include "LvRandom.h"
+#include "LvStateHash.h"
+#include "LvUtils.h"
 
 namespace lv {
 
-class GameEngine {
+// Rules engine of a variant, see RulesConfig. Defined in LvGameEngine.cpp for every variant of LV_FOR_EACH_RULES.
+template <const RulesConfig &RULES> class BasicGameEngine {
 public:
+    using Rules = RulesTraits<RULES>;
+    using CasinoState = BasicCasinoState<RULES>;
+    using GameState = BasicGameState<RULES>;
+    using CompactCasinoState = BasicCompactCasinoState<RULES>;
+    using CompactGameState = BasicCompactGameState<RULES>;
+    using CasinoWinners = BasicCasinoWinners<Rules::MAX_PLAYER_COUNT>;
+
+    // The variant's constants, they hide the standard ones in the definitions of the members
+    enum : int32_t {
+        MAX_PLAYER_COUNT = Rules::MAX_PLAYER_COUNT,
+        DICE_COUNT = Rules::DICE_COUNT,
+        ROUND_COUNT = Rules::ROUND_COUNT,
+        CASINO_MIN_MONEY_VALUE = Rules::CASINO_MIN_MONEY_VALUE,
+        CASINO_NEUTRAL_WINNER = Rules::CASINO_NEUTRAL_WINNER,
+        CASINO_BIDDER_COUNT = Rules::CASINO_BIDDER_COUNT,
+        HASH_CASINO_BILL_OWNER = HashBillOwners<RULES>::CASINO,
+    };
+
+    // Seeded from std::random_device, use an explicit seed for reproducible games
+    BasicGameEngine();
+    explicit BasicGameEngine(uint64_t seed);
+    explicit BasicGameEngine(const Rng &rRng);
+
+    // Reseed the engine's generator, the same seed replays the same sequence of shuffles and rolls
+    void Seed(uint64_t seed);
+    Rng &GetRng() { return m_rng; }
+    const Rng &GetRng() const { return m_rng; }
+
     bool SetupInitGameState(GameState &rGame, int32_t player_count);
     bool SetupRound(GameState &rGame);
     bool StartRound(GameState &rGame);
     bool AllocateDices(GameState &rGame, DiceValue dice);
+    int32_t GetLegalMoves(const GameState &rGame, LegalMoveList &rMoves) const;
     bool IsRoundOver(const GameState &rGame) const;
     bool IsGameOver(const GameState &rGame) const;
     bool AdvanceToNextPlayer(GameState &rGame);
     bool EndRound(GameState &rGame);
-    
+
+    // Compact game state, same rules without any heap allocation
+    bool SetupInitGameState(CompactGameState &rGame, int32_t player_count);
+    bool SetupRound(CompactGameState &rGame);
+    bool StartRound(CompactGameState &rGame);
+    bool AllocateDices(CompactGameState &rGame, DiceValue dice);
+    int32_t GetLegalMoves(const CompactGameState &rGame, LegalMoveList &rMoves) const;
+    bool IsRoundOver(const CompactGameState &rGame) const;
+    bool IsGameOver(const CompactGameState &rGame) const;
+    bool AdvanceToNextPlayer(CompactGameState &rGame);
+    bool EndRound(CompactGameState &rGame);
+
+    // Play a whole step of the game: allocate the dices, then either pass the turn or end the round and start the
+    // next one if there's one
+    bool PlayMove(CompactGameState &rGame, DiceValue dice);
+
+    // Record the parts of compact game states modified by the calls above into rChanges, until the tracker is
+    // replaced or removed with nullptr. Marks accumulate, the owner clears them once consumed.
+    void SetChangeTracker(StateChanges *pChanges) { m_pChanges = pChanges; }
+
+    // Report the events of the calls above to pListener, until it is replaced or removed with nullptr. Nothing is
+    // reported unless the engine is built with LV_ENABLE_ENGINE_EVENTS, see LvEngineEvents.h.
+    void SetEventListener(EngineEventListener *pListener) { m_pEventListener = pListener; }
+
   private:
+    // Times the private steps below, see bench/LvBenchmark.cpp
+    friend class GameEngineBenchmark;
+
     bool SetupCasinoBills(GameState &rGame);
     bool SetupPlayerTurnState(PlayerTurnState &rPlayerTurn, const GameState &rGame, PlayerIdx player_idx);
-    bool RollDices(std::vector<DiceValue>& rDices, int32_t dice_count);
-    void ShuffleBank(std::vector<Bill> &rBank);
+    bool RollDices(DiceVector& rDices, int32_t dice_count);
+    void ShuffleBank(BillVector &rBank);
     bool DistributeCasinoBills(GameState &rGame);
+
+    bool SetupCasinoBills(CompactGameState &rGame);
+    bool SetupPlayerTurnState(CompactPlayerTurnState &rPlayerTurn, const CompactGameState &rGame,
+                              PlayerIdx player_idx);
+    bool RollDices(DiceCounts &rDices, int32_t dice_count);
+    void ShuffleBank(CompactGameState &rGame);
+    bool DistributeCasinoBills(CompactGameState &rGame);
+
+    void MarkChanges(uint32_t casino_mask, uint32_t player_mask, uint32_t flags) {
+        if (m_pChanges != nullptr) {
+            m_pChanges->casino_mask |= casino_mask;
+            m_pChanges->player_mask |= player_mask;
+            m_pChanges->flags |= flags;
+        }
+    }
+
+    static int32_t FillLegalMoves(const DiceCounts &rDices, const DiceCounts &rWhiteDices, LegalMoveList &rMoves);
+
+    static constexpr const BasicHashKeys<RULES> &HASH_KEYS = RULES_HASH_KEYS<RULES>;
+    static constexpr const std::array<BankEntry, BILL_TYPE_COUNT> &BANK_INIT_STOCK_TABLE = RULES.bank_init_stock;
+
+    static constexpr int32_t GetExtraWhiteDiceCount(int32_t player_count) {
+        return Rules::GetExtraWhiteDiceCount(player_count);
+    }
+
+    Rng m_rng;
+    StateChanges *m_pChanges = nullptr;
+    EngineEventListener *m_pEventListener = nullptr;
 };
 
+using GameEngine = BasicGameEngine<STANDARD_RULES>;
+
 } // namespace lv
@@ -0,0 +1,584 @@
+#include "LvGameRecord.h"
+#include "LvUtils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t STREAM_MAGIC[4] = {'L', 'V', 'G', 'R'};
+
+// Turn dices are ranked among the histograms of up to DICE_COUNT dices, white dices among the histograms of up to
+// the largest extra white dice count
+enum { MAX_WHITE_DICE_COUNT = 4 };
+enum { DICE_RANK_BITS = 12 };
+enum { WHITE_DICE_RANK_BITS = 8 };
+
+static_assert(lv::GetExtraWhiteDiceCount(2) <= MAX_WHITE_DICE_COUNT, "White dice rank too small");
+
+constexpr int32_t Binomial(int32_t n, int32_t k)
+{
+    if (k < 0 || k > n) {
+        return 0;
+    }
+    int32_t result = 1;
+    for (int32_t i = 1; i <= k; ++i) {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+// Binomials used by the dice histogram ranks, n up to the bar positions of DICE_COUNT dices
+enum { BINOMIAL_TABLE_SIZE = static_cast<int32_t>(lv::DICE_COUNT) + lv::CASINO_COUNT };
+
+constexpr auto BINOMIAL_TABLE = [] {
+    std::array<std::array<int32_t, lv::CASINO_COUNT + 1>, BINOMIAL_TABLE_SIZE> table{};
+    for (int32_t n = 0; n < BINOMIAL_TABLE_SIZE; ++n) {
+        for (int32_t k = 0; k <= lv::CASINO_COUNT; ++k) {
+            table[n][k] = Binomial(n, k);
+        }
+    }
+    return table;
+}();
+
+constexpr int32_t GetDiceCountsRankCount(int32_t max_dice_count)
+{
+    return Binomial(max_dice_count + lv::CASINO_COUNT, lv::CASINO_COUNT);
+}
+
+static_assert(GetDiceCountsRankCount(lv::DICE_COUNT) <= (1 << DICE_RANK_BITS), "Dice rank does not fit");
+static_assert(GetDiceCountsRankCount(MAX_WHITE_DICE_COUNT) <= (1 << WHITE_DICE_RANK_BITS),
+              "White dice rank does not fit");
+
+// Every histogram by rank, so decoding a turn is two table lookups
+template <int32_t MAX_DICE_COUNT>
+const std::array<lv::DiceCounts, GetDiceCountsRankCount(MAX_DICE_COUNT)> &GetDiceCountsTable()
+{
+    static const auto s_table = [] {
+        std::array<lv::DiceCounts, GetDiceCountsRankCount(MAX_DICE_COUNT)> table{};
+        for (int32_t rank = 0; rank < static_cast<int32_t>(table.size()); ++rank) {
+            lv::UnrankDiceCounts(rank, MAX_DICE_COUNT, table[rank]);
+        }
+        return table;
+    }();
+    return s_table;
+}
+
+void PutU16(std::vector<uint8_t> &rData, uint16_t value)
+{
+    rData.push_back(static_cast<uint8_t>(value));
+    rData.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void SetU16(uint8_t *pData, uint16_t value)
+{
+    pData[0] = static_cast<uint8_t>(value);
+    pData[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void SetU32(uint8_t *pData, uint32_t value)
+{
+    for (int32_t i = 0; i < 4; ++i) {
+        pData[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void SetU64(uint8_t *pData, uint64_t value)
+{
+    for (int32_t i = 0; i < 8; ++i) {
+        pData[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint16_t GetU16(const uint8_t *pData)
+{
+    return static_cast<uint16_t>(pData[0] | (pData[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t *pData)
+{
+    uint32_t value = 0;
+    for (int32_t i = 3; i >= 0; --i) {
+        value = (value << 8) | pData[i];
+    }
+    return value;
+}
+
+uint64_t GetU64(const uint8_t *pData)
+{
+    uint64_t value = 0;
+    for (int32_t i = 7; i >= 0; --i) {
+        value = (value << 8) | pData[i];
+    }
+    return value;
+}
+
+int32_t GetNeutralMoneyValue(const lv::CompactGameState &rGame)
+{
+    return lv::GetBillCountsMoneyValue(rGame.neutral_player_bills);
+}
+
+} // namespace
+
+int32_t lv::RankDiceCounts(const DiceCounts& rCounts, int32_t max_dice_count)
+{
+    // Stars and bars: the histogram is a row of max_dice_count stars split by CASINO_COUNT bars, the dices after the
+    // last bar being the ones not rolled. The bar positions are ranked with the combinatorial number system.
+    int32_t rank = 0;
+    int32_t position = -1;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        position += rCounts[face_idx] + 1;
+        if (position >= max_dice_count + CASINO_COUNT || position >= BINOMIAL_TABLE_SIZE) {
+            return -1;
+        }
+        rank += BINOMIAL_TABLE[position][face_idx + 1];
+    }
+
+    return rank;
+}
+
+bool lv::UnrankDiceCounts(int32_t rank, int32_t max_dice_count, DiceCounts& rCounts)
+{
+    if (rank < 0 || rank >= GetDiceCountsRankCount(max_dice_count)) {
+        return false;
+    }
+
+    std::array<int32_t, CASINO_COUNT> positions{};
+    int32_t position = max_dice_count + CASINO_COUNT - 1;
+    for (int32_t face_idx = CASINO_COUNT - 1; face_idx >= 0; --face_idx) {
+        while (Binomial(position, face_idx + 1) > rank) {
+            --position;
+        }
+        positions[face_idx] = position;
+        rank -= Binomial(position, face_idx + 1);
+        --position;
+    }
+
+    int32_t previous_position = -1;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        rCounts[face_idx] = static_cast<uint8_t>(positions[face_idx] - previous_position - 1);
+        previous_position = positions[face_idx];
+    }
+
+    return true;
+}
+
+bool lv::DecodeGameRecordTurn(const uint8_t* pTurn, GameRecordTurn& rTurn)
+{
+    const uint32_t word = pTurn[0] | (pTurn[1] << 8) | (pTurn[2] << 16);
+    const uint32_t face = word & 7;
+    const uint32_t dice_rank = (word >> 3) & ((1u << DICE_RANK_BITS) - 1);
+    const uint32_t white_dice_rank = word >> (3 + DICE_RANK_BITS);
+
+    const auto &rDiceTable = GetDiceCountsTable<DICE_COUNT>();
+    const auto &rWhiteDiceTable = GetDiceCountsTable<MAX_WHITE_DICE_COUNT>();
+    if (face < 1 || face > CASINO_COUNT || dice_rank >= rDiceTable.size() ||
+        white_dice_rank >= rWhiteDiceTable.size()) {
+        return false;
+    }
+
+    rTurn.dice = static_cast<DiceValue>(face);
+    rTurn.dices = rDiceTable[dice_rank];
+    rTurn.white_dices = rWhiteDiceTable[white_dice_rank];
+
+    return true;
+}
+
+void lv::GameRecordBuilder::BeginGame(uint64_t seed, int32_t player_count)
+{
+    m_data.assign(GAME_RECORD_GAME_HEADER_SIZE, 0);
+    SetU64(m_data.data() + 4, seed);
+    m_player_count = player_count;
+    m_turn_count = 0;
+    m_round_count = 0;
+}
+
+void lv::GameRecordBuilder::BeginRound(const CompactGameState& rGame)
+{
+    // Casino bills dealt from the shuffled bank, by ascending denomination
+    uint8_t pending_nibble = 0;
+    bool has_pending_nibble = false;
+    const auto put_nibble = [&](uint8_t nibble) {
+        if (has_pending_nibble) {
+            m_data.push_back(static_cast<uint8_t>(pending_nibble | (nibble << 4)));
+        } else {
+            pending_nibble = nibble;
+        }
+        has_pending_nibble = !has_pending_nibble;
+    };
+
+    for (const CompactCasinoState &rCasino : rGame.casinos) {
+        int32_t bill_count = 0;
+        for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+            bill_count += rCasino.bills[bill_idx];
+        }
+        put_nibble(static_cast<uint8_t>(bill_count));
+        for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+            for (int32_t i = 0; i < rCasino.bills[bill_idx]; ++i) {
+                put_nibble(static_cast<uint8_t>(bill_idx));
+            }
+        }
+    }
+    if (has_pending_nibble) {
+        m_data.push_back(pending_nibble);
+    }
+
+    m_round_turn_count_offset = m_data.size();
+    m_round_turn_count = 0;
+    PutU16(m_data, 0);
+
+    for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+        m_round_start_money[player_idx] = GetPlayerMoneyValue(rGame.players[player_idx]);
+    }
+    m_round_start_neutral_money = GetNeutralMoneyValue(rGame);
+}
+
+void lv::GameRecordBuilder::AddTurn(const CompactGameState& rGame, DiceValue dice)
+{
+    const uint32_t dice_rank = static_cast<uint32_t>(RankDiceCounts(rGame.current_turn.dices, DICE_COUNT));
+    const uint32_t white_dice_rank =
+        static_cast<uint32_t>(RankDiceCounts(rGame.current_turn.white_dices, MAX_WHITE_DICE_COUNT));
+    const uint32_t word =
+        static_cast<uint32_t>(dice) | (dice_rank << 3) | (white_dice_rank << (3 + DICE_RANK_BITS));
+
+    m_data.push_back(static_cast<uint8_t>(word));
+    m_data.push_back(static_cast<uint8_t>(word >> 8));
+    m_data.push_back(static_cast<uint8_t>(word >> 16));
+
+    ++m_round_turn_count;
+    ++m_turn_count;
+}
+
+void lv::GameRecordBuilder::EndRound(const CompactGameState& rGame)
+{
+    SetU16(m_data.data() + m_round_turn_count_offset, static_cast<uint16_t>(m_round_turn_count));
+
+    for (int32_t player_idx = 0; player_idx < m_player_count; ++player_idx) {
+        const int32_t money_won = GetPlayerMoneyValue(rGame.players[player_idx]) - m_round_start_money[player_idx];
+        m_data.push_back(static_cast<uint8_t>(money_won / 10));
+    }
+    m_data.push_back(static_cast<uint8_t>((GetNeutralMoneyValue(rGame) - m_round_start_neutral_money) / 10));
+
+    ++m_round_count;
+}
+
+void lv::GameRecordBuilder::EndGame()
+{
+    SetU32(m_data.data(), static_cast<uint32_t>(m_data.size() - GAME_RECORD_GAME_HEADER_SIZE));
+    SetU16(m_data.data() + 12, static_cast<uint16_t>(m_turn_count));
+    m_data[14] = static_cast<uint8_t>(m_player_count);
+    m_data[15] = static_cast<uint8_t>(m_round_count);
+}
+
+lv::GameRecordWriter::~GameRecordWriter()
+{
+    Close();
+}
+
+bool lv::GameRecordWriter::Open(const char* pPath)
+{
+    Close();
+
+    m_pFile = std::fopen(pPath, "a+b");
+    if (m_pFile == nullptr) {
+        return false;
+    }
+    m_failed = false;
+
+    // Append mode writes at the end, so an empty file is a new stream
+    std::fseek(m_pFile, 0, SEEK_END);
+    if (std::ftell(m_pFile) == 0) {
+        const uint8_t header[GAME_RECORD_STREAM_HEADER_SIZE] = {
+            STREAM_MAGIC[0], STREAM_MAGIC[1], STREAM_MAGIC[2], STREAM_MAGIC[3], GAME_RECORD_VERSION, 0, 0, 0};
+        if (std::fwrite(header, sizeof(header), 1, m_pFile) != 1) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    // Games of another version or of something else must not be appended to it
+    uint8_t header[GAME_RECORD_STREAM_HEADER_SIZE] = {};
+    std::fseek(m_pFile, 0, SEEK_SET);
+    if (std::fread(header, sizeof(header), 1, m_pFile) != 1 ||
+        std::memcmp(header, STREAM_MAGIC, sizeof(STREAM_MAGIC)) != 0 || header[4] != GAME_RECORD_VERSION) {
+        Close();
+        return false;
+    }
+    std::fseek(m_pFile, 0, SEEK_END);
+
+    return true;
+}
+
+bool lv::GameRecordWriter::Write(const GameRecordBuilder& rGame)
+{
+    const std::vector<uint8_t> &rData = rGame.GetData();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pFile == nullptr || m_failed) {
+        return false;
+    }
+    if (std::fwrite(rData.data(), 1, rData.size(), m_pFile) != rData.size()) {
+        m_failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool lv::GameRecordWriter::Close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pFile == nullptr) {
+        return true;
+    }
+
+    const bool success = std::fclose(m_pFile) == 0 && !m_failed;
+    m_pFile = nullptr;
+
+    return success;
+}
+
+lv::GameRecordReader::GameRecordReader(const uint8_t* pData, size_t size) : m_pData(pData), m_size(size)
+{
+    m_valid = size >= GAME_RECORD_STREAM_HEADER_SIZE && std::memcmp(pData, STREAM_MAGIC, sizeof(STREAM_MAGIC)) == 0 &&
+              pData[4] == GAME_RECORD_VERSION;
+    m_offset = GAME_RECORD_STREAM_HEADER_SIZE;
+}
+
+bool lv::GameRecordReader::NextGame(GameRecordView& rGame)
+{
+    if (!m_valid || m_error || m_offset == m_size) {
+        return false;
+    }
+
+    if (m_size - m_offset < GAME_RECORD_GAME_HEADER_SIZE) {
+        m_error = true;
+        return false;
+    }
+
+    const uint8_t *pHeader = m_pData + m_offset;
+    const size_t payload_size = GetU32(pHeader);
+    if (m_size - m_offset - GAME_RECORD_GAME_HEADER_SIZE < payload_size) {
+        m_error = true;
+        return false;
+    }
+
+    rGame.payload_size = payload_size;
+    rGame.seed = GetU64(pHeader + 4);
+    rGame.turn_count = GetU16(pHeader + 12);
+    rGame.player_count = pHeader[14];
+    rGame.round_count = pHeader[15];
+    rGame.pPayload = pHeader + GAME_RECORD_GAME_HEADER_SIZE;
+
+    m_offset += GAME_RECORD_GAME_HEADER_SIZE + payload_size;
+
+    return true;
+}
+
+bool lv::GameRecordReader::SeekToOffset(size_t offset)
+{
+    if (!m_valid || offset < GAME_RECORD_STREAM_HEADER_SIZE || offset > m_size) {
+        return false;
+    }
+
+    m_offset = offset;
+    m_error = false;
+
+    return true;
+}
+
+lv::GameRecordRoundReader::GameRecordRoundReader(const GameRecordView& rGame) : m_rGame(rGame)
+{
+    m_error = rGame.player_count < 2 || rGame.player_count > MAX_PLAYER_COUNT;
+}
+
+bool lv::GameRecordRoundReader::NextRound(GameRecordRound& rRound)
+{
+    if (m_error || m_round_idx >= m_rGame.round_count) {
+        return false;
+    }
+
+    const uint8_t *pData = m_rGame.pPayload;
+    const size_t size = m_rGame.payload_size;
+    size_t offset = m_offset;
+
+    // Casino bills
+    int32_t nibble_idx = 0;
+    const auto get_nibble = [&](uint8_t &rNibble) {
+        if (offset >= size) {
+            return false;
+        }
+        rNibble = (nibble_idx & 1) ? (pData[offset++] >> 4) : (pData[offset] & 0xF);
+        ++nibble_idx;
+        return true;
+    };
+
+    for (BillCounts &rBills : rRound.casino_bills) {
+        rBills.fill(0);
+        uint8_t bill_count = 0;
+        if (!get_nibble(bill_count)) {
+            m_error = true;
+            return false;
+        }
+        for (int32_t i = 0; i < bill_count; ++i) {
+            uint8_t bill_idx = 0;
+            if (!get_nibble(bill_idx) || bill_idx >= BILL_TYPE_COUNT) {
+                m_error = true;
+                return false;
+            }
+            ++rBills[bill_idx];
+        }
+    }
+    if (nibble_idx & 1) {
+        ++offset;
+    }
+
+    // Turns
+    if (size - offset < 2) {
+        m_error = true;
+        return false;
+    }
+    rRound.turn_count = GetU16(pData + offset);
+    offset += 2;
+
+    const size_t turns_size = static_cast<size_t>(rRound.turn_count) * GAME_RECORD_TURN_SIZE;
+    if (size - offset < turns_size + m_rGame.player_count + 1) {
+        m_error = true;
+        return false;
+    }
+    rRound.pTurns = pData + offset;
+    offset += turns_size;
+
+    // Round result
+    rRound.money_won.fill(0);
+    for (int32_t player_idx = 0; player_idx < m_rGame.player_count; ++player_idx) {
+        rRound.money_won[player_idx] = pData[offset++] * 10;
+    }
+    rRound.neutral_money_won = pData[offset++] * 10;
+
+    m_offset = offset;
+    ++m_round_idx;
+
+    return true;
+}
+
+const char *lv::GetReplayErrorName(ReplayError error)
+{
+    switch (error) {
+    case ReplayError::None: return "None";
+    case ReplayError::Format: return "Format";
+    case ReplayError::Engine: return "Engine";
+    case ReplayError::CasinoBills: return "CasinoBills";
+    case ReplayError::Roll: return "Roll";
+    case ReplayError::Move: return "Move";
+    case ReplayError::Rules: return "Rules";
+    case ReplayError::RoundResult: return "RoundResult";
+    case ReplayError::TurnCount: return "TurnCount";
+    }
+    return "Unknown";
+}
+
+lv::ReplayReport lv::StepGameRecord(const GameRecordView& rRecord, GameEngine& rEngine, CompactGameState& rGame,
+                                    ReplayTurnListener* pListener)
+{
+    ReplayReport report{};
+    const RulesChecker checker{};
+
+    const auto fail = [&](ReplayError error) {
+        report.error = error;
+        return report;
+    };
+
+    rEngine.Seed(rRecord.seed);
+    if (!rEngine.SetupInitGameState(rGame, rRecord.player_count)) {
+        return fail(ReplayError::Format);
+    }
+    if (!rEngine.SetupRound(rGame) || !rEngine.StartRound(rGame)) {
+        return fail(ReplayError::Engine);
+    }
+
+    GameRecordRoundReader round_reader(rRecord);
+    GameRecordRound round{};
+    GameRecordTurn turn{};
+
+    for (report.round = 0; report.round < rRecord.round_count; ++report.round) {
+        if (!round_reader.NextRound(round)) {
+            return fail(ReplayError::Format);
+        }
+        for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+            if (rGame.casinos[casino_idx].bills != round.casino_bills[casino_idx]) {
+                return fail(ReplayError::CasinoBills);
+            }
+        }
+        if (round.turn_count == 0) {
+            return fail(ReplayError::TurnCount);
+        }
+
+        std::array<int32_t, MAX_PLAYER_COUNT> start_money{};
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            start_money[player_idx] = GetPlayerMoneyValue(rGame.players[player_idx]);
+        }
+        const int32_t start_neutral_money = GetNeutralMoneyValue(rGame);
+
+        for (int32_t turn_idx = 0; turn_idx < round.turn_count; ++turn_idx) {
+            if (pListener != nullptr) {
+                pListener->OnTurnStart(report.turn_idx, rGame);
+            }
+
+            report.violation = checker.CheckGameState(rGame);
+            if (report.violation != RulesViolation::None) {
+                return fail(ReplayError::Rules);
+            }
+
+            if (!DecodeGameRecordTurn(round.pTurns + turn_idx * GAME_RECORD_TURN_SIZE, turn)) {
+                return fail(ReplayError::Format);
+            }
+            if (turn.dices != rGame.current_turn.dices || turn.white_dices != rGame.current_turn.white_dices) {
+                return fail(ReplayError::Roll);
+            }
+
+            // The face must have been rolled, PlayMove failing past that is the engine's doing
+            const CasinoIdx casino_idx = static_cast<CasinoIdx>(turn.dice) - 1;
+            if (turn.dice < DICE_VALUE_MIN || turn.dice > DICE_VALUE_MAX ||
+                (turn.dices[casino_idx] == 0 && turn.white_dices[casino_idx] == 0)) {
+                return fail(ReplayError::Move);
+            }
+            if (!rEngine.PlayMove(rGame, turn.dice)) {
+                return fail(ReplayError::Engine);
+            }
+            if (pListener != nullptr) {
+                pListener->OnTurnPlayed(report.turn_idx, turn.dice);
+            }
+            ++report.turn_idx;
+
+            // PlayMove moves on to the next round with the last turn of this one
+            const bool round_over = rGame.round != report.round;
+            if (round_over != (turn_idx + 1 == round.turn_count)) {
+                return fail(ReplayError::TurnCount);
+            }
+        }
+
+        // Setting up the next round doesn't change anyone's money
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            if (GetPlayerMoneyValue(rGame.players[player_idx]) - start_money[player_idx] !=
+                round.money_won[player_idx]) {
+                return fail(ReplayError::RoundResult);
+            }
+        }
+        if (GetNeutralMoneyValue(rGame) - start_neutral_money != round.neutral_money_won) {
+            return fail(ReplayError::RoundResult);
+        }
+    }
+
+    if (report.turn_idx != rRecord.turn_count || !rEngine.IsGameOver(rGame)) {
+        return fail(ReplayError::TurnCount);
+    }
+
+    return report;
+}
+
+lv::ReplayReport lv::ReplayGameRecord(const GameRecordView& rRecord, GameEngine& rEngine, CompactGameState& rGame)
+{
+    return StepGameRecord(rRecord, rEngine, rGame, nullptr);
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include "LvGameEngine.h"
+#include "LvRulesChecker.h"
+
+#include <array>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace lv {
+
+// Binary game records
+//
+// A record stream starts with an 8 bytes header ("LVGR", version, 3 reserved bytes) followed by games back to back.
+// All integers are little endian.
+//
+// Game: 16 bytes header
+//   uint32 payload size, uint64 engine seed, uint16 turn count, uint8 player count, uint8 round count
+// then one block per round:
+//   casino bills: what the round drew from the shuffled bank, for each casino a nibble with the bill count followed
+//                 by one nibble per bill index in ascending order, padded to a whole byte
+//   uint16 turn count
+//   3 bytes per turn: chosen face (3 bits), rolled dices (12 bits) and rolled white dices (8 bits), see RankDiceCounts
+//   round result: money won during the round divided by 10, one byte per player then one for the neutral player
+//
+// The player of each turn and the bets follow from the rules, replaying a record through GameEngine seeded with the
+// recorded seed reproduces every roll and every casino deal, which ReplayGameRecord verifies. The version changes with
+// the way the engine draws from its seed too: version 2 rolls histograms (see LvDiceRoll.h), not one face per dice.
+enum { GAME_RECORD_VERSION = 2 };
+enum { GAME_RECORD_STREAM_HEADER_SIZE = 8 };
+enum { GAME_RECORD_GAME_HEADER_SIZE = 16 };
+enum { GAME_RECORD_TURN_SIZE = 3 };
+
+// Rank of a dice histogram among all the histograms of at most max_dice_count dices, and back
+// There are 3003 histograms of up to 8 dices and 210 of up to 4 dices, RankDiceCounts returns -1 past DICE_COUNT.
+int32_t RankDiceCounts(const DiceCounts &rCounts, int32_t max_dice_count);
+bool UnrankDiceCounts(int32_t rank, int32_t max_dice_count, DiceCounts &rCounts);
+
+struct GameRecordTurn {
+    DiceValue dice = DiceValue::Invalid;
+    DiceCounts dices{};
+    DiceCounts white_dices{};
+};
+
+struct GameRecordRound {
+    std::array<BillCounts, CASINO_COUNT> casino_bills{};
+    int32_t turn_count = 0;
+    const uint8_t *pTurns = nullptr; // turn_count encoded turns, decode them with DecodeGameRecordTurn
+    std::array<int32_t, MAX_PLAYER_COUNT> money_won{};
+    int32_t neutral_money_won = 0;
+};
+
+// A game inside a record stream, pointing into the stream's memory
+struct GameRecordView {
+    uint64_t seed = 0;
+    int32_t player_count = 0;
+    int32_t round_count = 0;
+    int32_t turn_count = 0;
+    const uint8_t *pPayload = nullptr;
+    size_t payload_size = 0;
+};
+
+bool DecodeGameRecordTurn(const uint8_t *pTurn, GameRecordTurn &rTurn);
+
+// Builds the record of one game as it is played:
+// BeginGame with the engine seed, BeginRound after GameEngine::SetupRound, AddTurn before the dices of the
+// current turn are allocated, EndRound after GameEngine::EndRound and EndGame once the game is over.
+class GameRecordBuilder {
+public:
+    void BeginGame(uint64_t seed, int32_t player_count);
+    void BeginRound(const CompactGameState &rGame);
+    void AddTurn(const CompactGameState &rGame, DiceValue dice);
+    void EndRound(const CompactGameState &rGame);
+    void EndGame();
+
+    // Complete game record, header included, valid after EndGame
+    const std::vector<uint8_t> &GetData() const { return m_data; }
+
+private:
+    std::vector<uint8_t> m_data;
+    size_t m_round_turn_count_offset = 0;
+    int32_t m_round_turn_count = 0;
+    int32_t m_turn_count = 0;
+    int32_t m_round_count = 0;
+    int32_t m_player_count = 0;
+    std::array<int32_t, MAX_PLAYER_COUNT> m_round_start_money{};
+    int32_t m_round_start_neutral_money = 0;
+};
+
+// Append-only record file, games from several threads can be written concurrently
+class GameRecordWriter {
+public:
+    GameRecordWriter() = default;
+    ~GameRecordWriter();
+
+    GameRecordWriter(const GameRecordWriter &) = delete;
+    GameRecordWriter &operator=(const GameRecordWriter &) = delete;
+
+    // Games are appended to an existing record file, a new one gets the stream header. Fails on an existing file
+    // without the stream header of GAME_RECORD_VERSION.
+    bool Open(const char *pPath);
+    bool Write(const GameRecordBuilder &rGame);
+    bool Close();
+
+private:
+    std::mutex m_mutex;
+    FILE *m_pFile = nullptr;
+    bool m_failed = false;
+};
+
+// Walks the games of a record stream in place, nothing is copied
+class GameRecordReader {
+public:
+    GameRecordReader(const uint8_t *pData, size_t size);
+
+    // False if the stream header is missing or unsupported
+    bool IsValid() const { return m_valid; }
+
+    // False once every game has been read, or if the stream is truncated (see HasError)
+    bool NextGame(GameRecordView &rGame);
+    bool HasError() const { return m_error; }
+
+    // Position of the next game in the stream, NextGame continues from an offset given back to SeekToOffset
+    size_t GetOffset() const { return m_offset; }
+    bool SeekToOffset(size_t offset);
+
+private:
+    const uint8_t *m_pData = nullptr;
+    size_t m_size = 0;
+    size_t m_offset = 0;
+    bool m_valid = false;
+    bool m_error = false;
+};
+
+// Walks the rounds of a game record
+class GameRecordRoundReader {
+public:
+    explicit GameRecordRoundReader(const GameRecordView &rGame);
+
+    bool NextRound(GameRecordRound &rRound);
+    bool HasError() const { return m_error; }
+
+private:
+    const GameRecordView &m_rGame;
+    size_t m_offset = 0;
+    int32_t m_round_idx = 0;
+    bool m_error = false;
+};
+
+enum class ReplayError : int32_t {
+    None = 0,
+    Format,      // Record cannot be decoded
+    Engine,      // GameEngine refused a step
+    CasinoBills, // Dealt casino bills differ from the record
+    Roll,        // Rolled dices differ from the record
+    Move,        // Recorded face was not rolled
+    Rules,       // RulesChecker rejected a state
+    RoundResult, // Money won during a round differs from the record
+    TurnCount,   // Round or game turn count differs from the record
+};
+
+const char *GetReplayErrorName(ReplayError error);
+
+struct ReplayReport {
+    ReplayError error = ReplayError::None;
+    RulesViolation violation = RulesViolation::None;
+    int32_t round = 0;
+    int32_t turn_idx = 0; // Turn index within the game where replay stopped
+};
+
+// Told about every turn of a game stepped by StepGameRecord
+class ReplayTurnListener {
+public:
+    virtual ~ReplayTurnListener() = default;
+
+    // Before turn turn_idx of the game is verified, rGame is the state it starts from
+    virtual void OnTurnStart(int32_t turn_idx, const CompactGameState &rGame) {}
+    // Once the recorded move of turn turn_idx has been verified and played
+    virtual void OnTurnPlayed(int32_t turn_idx, DiceValue dice) {}
+};
+
+// Replay a recorded game through rEngine (reseeded with the record's seed), one GameEngine::PlayMove per turn, and
+// verify rolls, casino deals and round results against the record and every state with RulesChecker. rGame holds the
+// state where the replay stopped, the final state when the record is consistent. pListener may be null.
+ReplayReport StepGameRecord(const GameRecordView &rRecord, GameEngine &rEngine, CompactGameState &rGame,
+                            ReplayTurnListener *pListener);
+
+// StepGameRecord without a listener
+ReplayReport ReplayGameRecord(const GameRecordView &rRecord, GameEngine &rEngine, CompactGameState &rGame);
+
+} // namespace lv
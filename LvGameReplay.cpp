@@ -0,0 +1,128 @@
+#include "LvGameReplay.h"
+#include "LvStateConversion.h"
+#include "LvUtils.h"
+
+#include <algorithm>
+
+lv::GameReplay::GameReplay(int32_t checkpoint_interval) : m_checkpoint_interval(std::max(1, checkpoint_interval))
+{
+}
+
+lv::ReplayReport lv::GameReplay::Load(const GameRecordView& rRecord)
+{
+    m_moves.clear();
+    m_checkpoints.clear();
+    m_moves.reserve(rRecord.turn_count);
+
+    // Where the record and the engine disagree the replay stops, everything before stays reachable
+    const ReplayReport report = StepGameRecord(rRecord, m_engine, m_game, this);
+    m_turn_idx = GetTurnCount();
+
+    return report;
+}
+
+void lv::GameReplay::OnTurnStart(int32_t turn_idx, const CompactGameState& rGame)
+{
+    if (turn_idx % m_checkpoint_interval == 0) {
+        m_checkpoints.push_back({rGame, m_engine.GetRng()});
+    }
+}
+
+void lv::GameReplay::OnTurnPlayed(int32_t turn_idx, DiceValue dice)
+{
+    m_moves.push_back(dice);
+}
+
+bool lv::GameReplay::SeekTurn(int32_t turn_idx)
+{
+    if (turn_idx < 0 || turn_idx > GetTurnCount() || m_checkpoints.empty()) {
+        return false;
+    }
+
+    // Restore a checkpoint unless playing on from the current turn is shorter
+    const int32_t checkpoint_idx =
+        std::min(turn_idx / m_checkpoint_interval, static_cast<int32_t>(m_checkpoints.size()) - 1);
+    const int32_t checkpoint_turn_idx = checkpoint_idx * m_checkpoint_interval;
+
+    if (m_turn_idx > turn_idx || m_turn_idx < checkpoint_turn_idx) {
+        const Checkpoint &rCheckpoint = m_checkpoints[checkpoint_idx];
+        m_game = rCheckpoint.game;
+        m_engine.GetRng() = rCheckpoint.rng;
+        m_turn_idx = checkpoint_turn_idx;
+    }
+
+    while (m_turn_idx < turn_idx) {
+        if (!StepTurn()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool lv::GameReplay::StepTurn()
+{
+    if (m_turn_idx >= GetTurnCount()) {
+        return false;
+    }
+
+    if (!m_engine.PlayMove(m_game, m_moves[m_turn_idx])) {
+        return false;
+    }
+    ++m_turn_idx;
+
+    return true;
+}
+
+bool lv::GameReplay::GetGameState(GameState& rGame) const
+{
+    return ToGameState(m_game, rGame);
+}
+
+bool lv::GameRecordIndex::Build(const uint8_t* pData, size_t size, int32_t games_per_entry)
+{
+    m_pData = pData;
+    m_size = size;
+    m_games_per_entry = std::max(1, games_per_entry);
+    m_game_count = 0;
+    m_offsets.clear();
+
+    GameRecordReader reader(pData, size);
+    if (!reader.IsValid()) {
+        return false;
+    }
+
+    GameRecordView game{};
+    while (true) {
+        const size_t offset = reader.GetOffset();
+        if (!reader.NextGame(game)) {
+            break;
+        }
+        if (m_game_count % m_games_per_entry == 0) {
+            m_offsets.push_back(offset);
+        }
+        ++m_game_count;
+    }
+
+    return !reader.HasError();
+}
+
+bool lv::GameRecordIndex::FindGame(int64_t game_idx, GameRecordView& rGame) const
+{
+    if (game_idx < 0 || game_idx >= m_game_count) {
+        return false;
+    }
+
+    GameRecordReader reader(m_pData, m_size);
+    if (!reader.SeekToOffset(m_offsets[game_idx / m_games_per_entry])) {
+        return false;
+    }
+
+    for (int64_t skip_count = game_idx % m_games_per_entry; skip_count >= 0; --skip_count) {
+        if (!reader.NextGame(rGame)) {
+            return false;
+        }
+    }
+
+    return true;
+}
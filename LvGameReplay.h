@@ -0,0 +1,77 @@
+#pragma once
+
+#include "LvGameRecord.h"
+
+#include <vector>
+
+namespace lv {
+
+// Replay of a recorded game, positioned on any turn
+//
+// Load plays the record once through the engine with StepGameRecord and keeps a checkpoint (game state and generator
+// state) every checkpoint_interval turns. Seeking restores the closest checkpoint at or before the target turn and
+// plays the few recorded moves left, so only the rolls in between are drawn again.
+class GameReplay : private ReplayTurnListener {
+public:
+    explicit GameReplay(int32_t checkpoint_interval = 8);
+
+    // Verifies rolls, casino deals and round results against the record and every state with RulesChecker.
+    // When the record is inconsistent the replay stops there, turns up to report.turn_idx can still be visited.
+    ReplayReport Load(const GameRecordView &rRecord);
+
+    // Number of turns that can be visited, the state after the last one is the end of the game
+    int32_t GetTurnCount() const { return static_cast<int32_t>(m_moves.size()); }
+
+    // Go to the state before turn turn_idx is played, turn_idx == GetTurnCount() for the final state
+    bool SeekTurn(int32_t turn_idx);
+
+    // Play the recorded move of the current turn
+    bool StepTurn();
+
+    int32_t GetTurnIdx() const { return m_turn_idx; }
+    DiceValue GetRecordedMove(int32_t turn_idx) const { return m_moves[turn_idx]; }
+
+    const CompactGameState &GetGame() const { return m_game; }
+    bool GetGameState(GameState &rGame) const;
+
+    // The engine is left as it would be at this point of the original game, play can go on from there with it
+    GameEngine &GetEngine() { return m_engine; }
+
+private:
+    void OnTurnStart(int32_t turn_idx, const CompactGameState &rGame) override;
+    void OnTurnPlayed(int32_t turn_idx, DiceValue dice) override;
+
+    struct Checkpoint {
+        CompactGameState game{};
+        Rng rng{};
+    };
+
+    int32_t m_checkpoint_interval = 0;
+    std::vector<DiceValue> m_moves;
+    std::vector<Checkpoint> m_checkpoints; // Checkpoint i is the state before turn i * m_checkpoint_interval
+
+    GameEngine m_engine{0};
+    CompactGameState m_game{};
+    int32_t m_turn_idx = 0;
+};
+
+// Direct access to the games of a long record stream
+//
+// Build walks the game headers once, without decoding anything, and remembers the offset of one game every
+// games_per_entry games. FindGame starts from the closest entry and skips at most games_per_entry - 1 headers.
+class GameRecordIndex {
+public:
+    bool Build(const uint8_t *pData, size_t size, int32_t games_per_entry = 1024);
+
+    int64_t GetGameCount() const { return m_game_count; }
+    bool FindGame(int64_t game_idx, GameRecordView &rGame) const;
+
+private:
+    const uint8_t *m_pData = nullptr;
+    size_t m_size = 0;
+    int32_t m_games_per_entry = 0;
+    int64_t m_game_count = 0;
+    std::vector<size_t> m_offsets;
+};
+
+} // namespace lv
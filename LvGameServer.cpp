@@ -0,0 +1,831 @@
+#include "LvGameServer.h"
+#include "LvAgent.h"
+#include "LvGameEngine.h"
+#include "LvRulesChecker.h"
+#include "LvSimulator.h"
+#include "LvUtils.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Game ids hold the index of their worker in their low bits
+enum { WORKER_ID_BITS = 8, MAX_WORKER_COUNT = 1 << WORKER_ID_BITS };
+
+// Bytes read from a connection at once
+enum { RECEIVE_BUFFER_SIZE = 64 * 1024 };
+
+// Unsent response bytes past which a connection isn't read any more until the client catches up. One read answers at
+// most RECEIVE_BUFFER_SIZE bytes of requests, so the output stays within this plus the responses of one read.
+enum { MAX_PENDING_OUTPUT_SIZE = 1024 * 1024 };
+
+void AppendFormat(std::string &rText, const char *pFormat, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, pFormat);
+    const int size = std::vsnprintf(buffer, sizeof(buffer), pFormat, args);
+    va_end(args);
+    rText.append(buffer, static_cast<size_t>(std::clamp(size, 0, static_cast<int>(sizeof(buffer)) - 1)));
+}
+
+void AppendIntArray(std::string &rText, const char *pKey, const int32_t *pValues, int32_t count)
+{
+    AppendFormat(rText, ",\"%s\":[", pKey);
+    for (int32_t value_idx = 0; value_idx < count; ++value_idx) {
+        AppendFormat(rText, value_idx == 0 ? "%d" : ",%d", pValues[value_idx]);
+    }
+    rText += ']';
+}
+
+// Values of the bills, highest first
+void AppendBillArray(std::string &rText, const char *pKey, const lv::BillCounts &rBills)
+{
+    std::array<int32_t, lv::BANK_BILL_COUNT> values{};
+    int32_t count = 0;
+    for (int32_t bill_idx = lv::BILL_TYPE_COUNT - 1; bill_idx >= 0; --bill_idx) {
+        for (int32_t i = 0; i < rBills[bill_idx] && count < lv::BANK_BILL_COUNT; ++i) {
+            values[count++] = static_cast<int32_t>(lv::GetBillFromIndex(bill_idx));
+        }
+    }
+    AppendIntArray(rText, pKey, values.data(), count);
+}
+
+} // namespace
+
+namespace lv {
+
+// Event loop of one worker thread, see GameServer
+class GameServerWorker {
+public:
+    GameServerWorker(GameServer &rServer, int32_t worker_idx, int32_t max_game_count);
+    ~GameServerWorker();
+
+    bool Start();
+    void Stop();
+
+    // Called by the acceptor thread, the worker takes ownership of fd
+    void AddConnection(int fd);
+
+    void AddStats(GameServerStats &rStats) const;
+
+private:
+    struct PendingResponse {
+        ServerRequestType type = ServerRequestType::Invalid;
+        int64_t start_ns = 0;
+        size_t end_offset = 0; // In the output buffer
+    };
+
+    struct Connection {
+        int fd = INVALID_SOCKET_FD;
+        uint64_t serial = 0;
+        bool closed = false;
+        std::string input;
+        std::string output;
+        size_t output_offset = 0;
+        std::vector<PendingResponse> pending_responses;
+        size_t first_pending_idx = 0;
+
+        bool IsOutputFull() const { return output.size() - output_offset > MAX_PENDING_OUTPUT_SIZE; }
+    };
+
+    struct Game {
+        GameEngine engine{0};
+        CompactGameState state{};
+        StateChanges changes{};
+        IncrementalRulesChecker checker{};
+        uint64_t connection_serial = 0;
+        uint64_t agent_seed = 0;
+        PlayerIdx seat = 0;
+        int32_t bot_agent_idx = 0; // In AGENT_TABLE
+        int32_t turn_count = 0;
+    };
+
+    void Run();
+    void TakeNewConnections();
+    void ReadConnection(Connection &rConnection, char *pBuffer);
+    void FlushConnection(Connection &rConnection);
+    void DropConnection(Connection &rConnection);
+
+    ServerRequestType HandleRequest(const Connection &rConnection, std::string_view line, std::string &rResponse);
+    void HandleNew(const Connection &rConnection, std::string_view line, std::string &rResponse);
+    void HandleMove(const Connection &rConnection, std::string_view line, std::string &rResponse);
+    void HandleState(const Connection &rConnection, std::string_view line, std::string &rResponse);
+    void HandleClose(const Connection &rConnection, std::string_view line, std::string &rResponse);
+    void HandleStats(std::string &rResponse);
+
+    Game *FindGame(const Connection &rConnection, std::string_view line, uint64_t &rGameId, std::string &rResponse);
+    bool PlayBots(uint64_t game_id, Game &rGame, std::string &rResponse);
+    static void AppendGameState(uint64_t game_id, const Game &rGame, const int32_t *pBotDices, int32_t bot_move_count,
+                                std::string &rResponse);
+
+    GameServer &m_rServer;
+    int32_t m_worker_idx = 0;
+    int32_t m_max_game_count = 0;
+    std::array<int, 2> m_wake_fds{INVALID_SOCKET_FD, INVALID_SOCKET_FD};
+    std::thread m_thread;
+
+    // Handed over by the acceptor
+    std::mutex m_new_fds_mutex;
+    std::vector<int> m_new_fds;
+
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    std::unordered_map<uint64_t, Game> m_games;
+    std::vector<std::unique_ptr<Agent>> m_bots; // One per AGENT_TABLE entry, made on first use
+    std::vector<int32_t> m_bot_dices;           // Faces played by the bots during the current request
+    uint64_t m_next_game_serial = 0;
+    uint64_t m_next_connection_serial = 0;
+
+    std::atomic<int64_t> m_game_count{0};
+    std::atomic<int64_t> m_connection_count{0};
+    std::array<LatencyHistogram, SERVER_REQUEST_TYPE_COUNT> m_latencies{};
+};
+
+} // namespace lv
+
+const char* lv::GetServerRequestTypeName(ServerRequestType type)
+{
+    switch (type) {
+    case ServerRequestType::New:
+        return "new";
+    case ServerRequestType::Move:
+        return "move";
+    case ServerRequestType::State:
+        return "state";
+    case ServerRequestType::Close:
+        return "close";
+    case ServerRequestType::Stats:
+        return "stats";
+    case ServerRequestType::Invalid:
+        return "invalid";
+    }
+    return "unknown";
+}
+
+lv::GameServer::GameServer(const GameServerConfig& rConfig) : m_config(rConfig) {}
+
+lv::GameServer::~GameServer()
+{
+    Stop();
+}
+
+void lv::GameServer::GetStats(GameServerStats& rStats) const
+{
+    rStats.game_count = 0;
+    rStats.connection_count = 0;
+    for (LatencyHistogram &rLatencies : rStats.latencies) {
+        rLatencies.Clear();
+    }
+
+    for (const std::unique_ptr<GameServerWorker> &rWorker : m_workers) {
+        rWorker->AddStats(rStats);
+    }
+}
+
+#ifdef _WIN32
+
+bool lv::GameServer::Start()
+{
+    return false;
+}
+
+void lv::GameServer::Stop() {}
+
+void lv::GameServer::RunAcceptor() {}
+
+lv::GameServerWorker::GameServerWorker(GameServer& rServer, int32_t worker_idx, int32_t max_game_count)
+    : m_rServer(rServer)
+{
+}
+
+lv::GameServerWorker::~GameServerWorker() {}
+
+void lv::GameServerWorker::AddStats(GameServerStats& rStats) const {}
+
+#else
+
+bool lv::GameServer::Start()
+{
+    if (m_listen_fd != INVALID_SOCKET_FD || m_config.max_game_count < 0) {
+        return false;
+    }
+
+    int32_t worker_count = m_config.worker_count;
+    if (worker_count == 0) {
+        worker_count = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+    }
+    if (worker_count < 0 || worker_count > MAX_WORKER_COUNT) {
+        return false;
+    }
+    m_workers.clear();
+
+    m_listen_fd = OpenListenSocket(m_config.address);
+    if (m_listen_fd == INVALID_SOCKET_FD) {
+        return false;
+    }
+    if (pipe(m_wake_fds.data()) != 0) {
+        Stop();
+        return false;
+    }
+
+    // Games are split evenly, the first workers take the remainder
+    m_stopping.store(false);
+    for (int32_t worker_idx = 0; worker_idx < worker_count; ++worker_idx) {
+        const int32_t max_game_count =
+            m_config.max_game_count / worker_count + (worker_idx < m_config.max_game_count % worker_count);
+        m_workers.push_back(std::make_unique<GameServerWorker>(*this, worker_idx, max_game_count));
+        if (!m_workers.back()->Start()) {
+            Stop();
+            return false;
+        }
+    }
+
+    m_acceptor_thread = std::thread(&GameServer::RunAcceptor, this);
+
+    return true;
+}
+
+void lv::GameServer::Stop()
+{
+    m_stopping.store(true);
+
+    if (m_wake_fds[1] != INVALID_SOCKET_FD) {
+        const char wake_byte = 0;
+        (void)!write(m_wake_fds[1], &wake_byte, 1);
+    }
+    if (m_acceptor_thread.joinable()) {
+        m_acceptor_thread.join();
+    }
+    for (const std::unique_ptr<GameServerWorker> &rWorker : m_workers) {
+        rWorker->Stop();
+    }
+
+    if (m_listen_fd != INVALID_SOCKET_FD) {
+        CloseSocket(m_listen_fd);
+        m_listen_fd = INVALID_SOCKET_FD;
+        if (m_config.address.is_unix) {
+            unlink(m_config.address.path.c_str());
+        }
+    }
+    for (int &rFd : m_wake_fds) {
+        CloseSocket(rFd);
+        rFd = INVALID_SOCKET_FD;
+    }
+}
+
+void lv::GameServer::RunAcceptor()
+{
+    std::array<pollfd, 2> poll_fds{};
+    poll_fds[0] = {m_listen_fd, POLLIN, 0};
+    poll_fds[1] = {m_wake_fds[0], POLLIN, 0};
+
+    size_t next_worker_idx = 0;
+    while (!m_stopping.load()) {
+        if (poll(poll_fds.data(), poll_fds.size(), -1) < 0 && errno != EINTR) {
+            break;
+        }
+
+        // Hand every pending connection to the next worker
+        while (true) {
+            const int fd = AcceptSocket(m_listen_fd);
+            if (fd == INVALID_SOCKET_FD) {
+                break;
+            }
+            m_workers[next_worker_idx]->AddConnection(fd);
+            next_worker_idx = (next_worker_idx + 1) % m_workers.size();
+        }
+    }
+}
+
+lv::GameServerWorker::GameServerWorker(GameServer& rServer, int32_t worker_idx, int32_t max_game_count)
+    : m_rServer(rServer), m_worker_idx(worker_idx), m_max_game_count(max_game_count)
+{
+    m_bots.resize(AGENT_TABLE_SIZE);
+}
+
+lv::GameServerWorker::~GameServerWorker()
+{
+    Stop();
+}
+
+bool lv::GameServerWorker::Start()
+{
+    if (pipe(m_wake_fds.data()) != 0) {
+        return false;
+    }
+
+    m_thread = std::thread(&GameServerWorker::Run, this);
+
+    return true;
+}
+
+void lv::GameServerWorker::Stop()
+{
+    if (m_wake_fds[1] != INVALID_SOCKET_FD) {
+        const char wake_byte = 0;
+        (void)!write(m_wake_fds[1], &wake_byte, 1);
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    // Connections handed over after the loop ended
+    for (const int fd : m_new_fds) {
+        CloseSocket(fd);
+    }
+    m_new_fds.clear();
+
+    for (int &rFd : m_wake_fds) {
+        CloseSocket(rFd);
+        rFd = INVALID_SOCKET_FD;
+    }
+}
+
+void lv::GameServerWorker::AddConnection(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_new_fds_mutex);
+        m_new_fds.push_back(fd);
+    }
+
+    const char wake_byte = 0;
+    (void)!write(m_wake_fds[1], &wake_byte, 1);
+}
+
+void lv::GameServerWorker::AddStats(GameServerStats& rStats) const
+{
+    rStats.game_count += m_game_count.load(std::memory_order_relaxed);
+    rStats.connection_count += m_connection_count.load(std::memory_order_relaxed);
+    for (int32_t type_idx = 0; type_idx < SERVER_REQUEST_TYPE_COUNT; ++type_idx) {
+        rStats.latencies[type_idx].Add(m_latencies[type_idx]);
+    }
+}
+
+void lv::GameServerWorker::Run()
+{
+    std::vector<pollfd> poll_fds;
+    std::vector<char> buffer(RECEIVE_BUFFER_SIZE);
+
+    while (!m_rServer.m_stopping.load()) {
+        // The wake pipe first, then one entry per connection, in order
+        poll_fds.clear();
+        poll_fds.push_back({m_wake_fds[0], POLLIN, 0});
+        // A client that doesn't read its responses isn't read either, its requests wait in the socket
+        for (const std::unique_ptr<Connection> &rConnection : m_connections) {
+            short events = rConnection->IsOutputFull() ? 0 : POLLIN;
+            if (!rConnection->output.empty()) {
+                events |= POLLOUT;
+            }
+            poll_fds.push_back({rConnection->fd, events, 0});
+        }
+
+        if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        for (size_t connection_idx = 0; connection_idx < m_connections.size(); ++connection_idx) {
+            Connection &rConnection = *m_connections[connection_idx];
+            const short revents = poll_fds[connection_idx + 1].revents;
+            if ((revents & (POLLIN | POLLHUP | POLLERR)) && !rConnection.IsOutputFull()) {
+                ReadConnection(rConnection, buffer.data());
+            }
+            if (!rConnection.output.empty() && !rConnection.closed) {
+                FlushConnection(rConnection);
+            }
+        }
+
+        // Drop the connections that were closed, with their games
+        for (size_t connection_idx = 0; connection_idx < m_connections.size();) {
+            if (m_connections[connection_idx]->closed) {
+                DropConnection(*m_connections[connection_idx]);
+                m_connections[connection_idx] = std::move(m_connections.back());
+                m_connections.pop_back();
+            } else {
+                ++connection_idx;
+            }
+        }
+
+        if (poll_fds[0].revents & POLLIN) {
+            char wake_bytes[64];
+            (void)!read(m_wake_fds[0], wake_bytes, sizeof(wake_bytes));
+            TakeNewConnections();
+        }
+    }
+
+    for (const std::unique_ptr<Connection> &rConnection : m_connections) {
+        DropConnection(*rConnection);
+    }
+    m_connections.clear();
+}
+
+void lv::GameServerWorker::TakeNewConnections()
+{
+    std::vector<int> new_fds;
+    {
+        std::lock_guard<std::mutex> lock(m_new_fds_mutex);
+        new_fds.swap(m_new_fds);
+    }
+
+    for (const int fd : new_fds) {
+        auto pConnection = std::make_unique<Connection>();
+        pConnection->fd = fd;
+        pConnection->serial = m_next_connection_serial++;
+        m_connections.push_back(std::move(pConnection));
+    }
+    m_connection_count.store(static_cast<int64_t>(m_connections.size()), std::memory_order_relaxed);
+}
+
+void lv::GameServerWorker::ReadConnection(Connection& rConnection, char* pBuffer)
+{
+    const int64_t received_size = ReceiveSome(rConnection.fd, pBuffer, RECEIVE_BUFFER_SIZE);
+    if (received_size < 0) {
+        rConnection.closed = true;
+        return;
+    }
+    const int64_t start_ns = GetSteadyClockNs();
+    rConnection.input.append(pBuffer, static_cast<size_t>(received_size));
+
+    // Answer every complete line
+    size_t line_pos = 0;
+    while (true) {
+        const size_t end_pos = rConnection.input.find('\n', line_pos);
+        if (end_pos == std::string::npos) {
+            break;
+        }
+
+        const std::string_view line(rConnection.input.data() + line_pos, end_pos - line_pos);
+        line_pos = end_pos + 1;
+        if (line.find_first_not_of(" \r\t") == std::string_view::npos) {
+            continue;
+        }
+
+        const ServerRequestType type = HandleRequest(rConnection, line, rConnection.output);
+        rConnection.output += '\n';
+        rConnection.pending_responses.push_back({type, start_ns, rConnection.output.size()});
+    }
+    rConnection.input.erase(0, line_pos);
+
+    // A client that never ends its line is dropped
+    if (rConnection.input.size() > SERVER_MAX_LINE_LENGTH) {
+        rConnection.closed = true;
+    }
+}
+
+void lv::GameServerWorker::FlushConnection(Connection& rConnection)
+{
+    const int64_t sent_size =
+        SendSome(rConnection.fd, std::string_view(rConnection.output).substr(rConnection.output_offset));
+    if (sent_size < 0) {
+        rConnection.closed = true;
+        return;
+    }
+    rConnection.output_offset += static_cast<size_t>(sent_size);
+
+    // The latency of a request ends once its whole response is sent
+    const int64_t end_ns = GetSteadyClockNs();
+    while (rConnection.first_pending_idx < rConnection.pending_responses.size()) {
+        const PendingResponse &rPending = rConnection.pending_responses[rConnection.first_pending_idx];
+        if (rPending.end_offset > rConnection.output_offset) {
+            break;
+        }
+        m_latencies[static_cast<int32_t>(rPending.type)].Record(end_ns - rPending.start_ns);
+        ++rConnection.first_pending_idx;
+    }
+
+    if (rConnection.output_offset == rConnection.output.size()) {
+        rConnection.output.clear();
+        rConnection.output_offset = 0;
+        rConnection.pending_responses.clear();
+        rConnection.first_pending_idx = 0;
+    } else if (rConnection.output_offset > MAX_PENDING_OUTPUT_SIZE) {
+        // A client reading just enough to stay under the limit never empties the output, drop what was sent
+        const size_t sent_size = rConnection.output_offset;
+        rConnection.output.erase(0, sent_size);
+        rConnection.output_offset = 0;
+        rConnection.pending_responses.erase(rConnection.pending_responses.begin(),
+                                            rConnection.pending_responses.begin() + rConnection.first_pending_idx);
+        rConnection.first_pending_idx = 0;
+        for (PendingResponse &rPending : rConnection.pending_responses) {
+            rPending.end_offset -= sent_size;
+        }
+    }
+}
+
+void lv::GameServerWorker::DropConnection(Connection& rConnection)
+{
+    CloseSocket(rConnection.fd);
+    rConnection.fd = INVALID_SOCKET_FD;
+
+    std::erase_if(m_games, [&](const auto &rEntry) { return rEntry.second.connection_serial == rConnection.serial; });
+    m_game_count.store(static_cast<int64_t>(m_games.size()), std::memory_order_relaxed);
+}
+
+#endif
+
+lv::ServerRequestType lv::GameServerWorker::HandleRequest(const Connection& rConnection, std::string_view line,
+                                                          std::string& rResponse)
+{
+    // Responses echo the request id when there's one
+    int64_t request_id = 0;
+    if (GetJsonInt(line, "id", request_id)) {
+        AppendFormat(rResponse, "{\"id\":%lld", static_cast<long long>(request_id));
+    } else {
+        rResponse += "{\"id\":null";
+    }
+
+    std::string_view op;
+    if (!GetJsonString(line, "op", op)) {
+        rResponse += ",\"ok\":false,\"error\":\"bad_request\"}";
+        return ServerRequestType::Invalid;
+    }
+
+    if (op == "move") {
+        HandleMove(rConnection, line, rResponse);
+        return ServerRequestType::Move;
+    }
+    if (op == "new") {
+        HandleNew(rConnection, line, rResponse);
+        return ServerRequestType::New;
+    }
+    if (op == "state") {
+        HandleState(rConnection, line, rResponse);
+        return ServerRequestType::State;
+    }
+    if (op == "close") {
+        HandleClose(rConnection, line, rResponse);
+        return ServerRequestType::Close;
+    }
+    if (op == "stats") {
+        HandleStats(rResponse);
+        return ServerRequestType::Stats;
+    }
+
+    rResponse += ",\"ok\":false,\"error\":\"unknown_op\"}";
+    return ServerRequestType::Invalid;
+}
+
+void lv::GameServerWorker::HandleNew(const Connection& rConnection, std::string_view line, std::string& rResponse)
+{
+    int64_t player_count = 2;
+    int64_t seat = 0;
+    std::string_view bot_name = "greedy";
+    GetJsonInt(line, "players", player_count);
+    GetJsonInt(line, "seat", seat);
+    GetJsonString(line, "bots", bot_name);
+
+    if (player_count < 2 || player_count > MAX_PLAYER_COUNT) {
+        rResponse += ",\"ok\":false,\"error\":\"bad_players\"}";
+        return;
+    }
+    if (seat < 0 || seat >= player_count) {
+        rResponse += ",\"ok\":false,\"error\":\"bad_seat\"}";
+        return;
+    }
+
+    int32_t bot_agent_idx = 0;
+    while (bot_agent_idx < AGENT_TABLE_SIZE && bot_name != AGENT_TABLE[bot_agent_idx].pName) {
+        ++bot_agent_idx;
+    }
+    if (bot_agent_idx == AGENT_TABLE_SIZE) {
+        rResponse += ",\"ok\":false,\"error\":\"unknown_bot\"}";
+        return;
+    }
+
+    if (static_cast<int64_t>(m_games.size()) >= m_max_game_count) {
+        rResponse += ",\"ok\":false,\"error\":\"too_many_games\"}";
+        return;
+    }
+
+    const uint64_t game_id = (m_next_game_serial++ << WORKER_ID_BITS) | static_cast<uint64_t>(m_worker_idx);
+    int64_t seed = 0;
+    const uint64_t game_seed = GetJsonInt(line, "seed", seed)
+                                   ? static_cast<uint64_t>(seed)
+                                   : GetGameSeed(m_rServer.m_config.base_seed, static_cast<int64_t>(game_id));
+
+    Game &rGame = m_games[game_id];
+    rGame.connection_serial = rConnection.serial;
+    rGame.agent_seed = ~game_seed;
+    rGame.seat = static_cast<PlayerIdx>(seat);
+    rGame.bot_agent_idx = bot_agent_idx;
+    rGame.engine.Seed(game_seed);
+    rGame.engine.SetChangeTracker(&rGame.changes);
+    m_game_count.store(static_cast<int64_t>(m_games.size()), std::memory_order_relaxed);
+
+    if (!rGame.engine.SetupInitGameState(rGame.state, static_cast<int32_t>(player_count)) ||
+        !rGame.engine.SetupRound(rGame.state) || !rGame.engine.StartRound(rGame.state)) {
+        m_games.erase(game_id);
+        m_game_count.store(static_cast<int64_t>(m_games.size()), std::memory_order_relaxed);
+        rResponse += ",\"ok\":false,\"error\":\"engine_error\"}";
+        return;
+    }
+    rGame.checker.Reset(rGame.state);
+    rGame.changes.Clear();
+
+    PlayBots(game_id, rGame, rResponse);
+}
+
+void lv::GameServerWorker::HandleMove(const Connection& rConnection, std::string_view line, std::string& rResponse)
+{
+    uint64_t game_id = 0;
+    Game *pGame = FindGame(rConnection, line, game_id, rResponse);
+    if (pGame == nullptr) {
+        return;
+    }
+
+    if (pGame->engine.IsGameOver(pGame->state)) {
+        rResponse += ",\"ok\":false,\"error\":\"game_over\"}";
+        return;
+    }
+
+    // Bots always play up to the client's turn
+    int64_t dice = 0;
+    if (!GetJsonInt(line, "dice", dice) || dice < static_cast<int64_t>(DICE_VALUE_MIN) ||
+        dice > static_cast<int64_t>(DICE_VALUE_MAX)) {
+        rResponse += ",\"ok\":false,\"error\":\"bad_dice\"}";
+        return;
+    }
+    const int32_t face_idx = static_cast<int32_t>(dice) - 1;
+    const CompactPlayerTurnState &rTurn = pGame->state.current_turn;
+    if (rTurn.dices[face_idx] == 0 && rTurn.white_dices[face_idx] == 0) {
+        rResponse += ",\"ok\":false,\"error\":\"illegal_move\"}";
+        return;
+    }
+
+    if (!pGame->engine.PlayMove(pGame->state, static_cast<DiceValue>(dice))) {
+        m_games.erase(game_id);
+        m_game_count.store(static_cast<int64_t>(m_games.size()), std::memory_order_relaxed);
+        rResponse += ",\"ok\":false,\"error\":\"engine_error\"}";
+        return;
+    }
+    ++pGame->turn_count;
+
+    PlayBots(game_id, *pGame, rResponse);
+}
+
+void lv::GameServerWorker::HandleState(const Connection& rConnection, std::string_view line, std::string& rResponse)
+{
+    uint64_t game_id = 0;
+    const Game *pGame = FindGame(rConnection, line, game_id, rResponse);
+    if (pGame == nullptr) {
+        return;
+    }
+
+    AppendGameState(game_id, *pGame, nullptr, 0, rResponse);
+}
+
+void lv::GameServerWorker::HandleClose(const Connection& rConnection, std::string_view line, std::string& rResponse)
+{
+    uint64_t game_id = 0;
+    if (FindGame(rConnection, line, game_id, rResponse) == nullptr) {
+        return;
+    }
+
+    m_games.erase(game_id);
+    m_game_count.store(static_cast<int64_t>(m_games.size()), std::memory_order_relaxed);
+    rResponse += ",\"ok\":true}";
+}
+
+void lv::GameServerWorker::HandleStats(std::string& rResponse)
+{
+    // Statistics of every worker, read while they keep serving
+    auto pStats = std::make_unique<GameServerStats>();
+    m_rServer.GetStats(*pStats);
+
+    AppendFormat(rResponse, ",\"ok\":true,\"games\":%lld,\"connections\":%lld",
+                 static_cast<long long>(pStats->game_count), static_cast<long long>(pStats->connection_count));
+    for (int32_t type_idx = 0; type_idx < SERVER_REQUEST_TYPE_COUNT; ++type_idx) {
+        const LatencyHistogram &rLatencies = pStats->latencies[type_idx];
+        const char *pName = GetServerRequestTypeName(static_cast<ServerRequestType>(type_idx));
+        AppendFormat(rResponse, ",\"%s_count\":%llu,\"%s_p50_us\":%.1f,\"%s_p99_us\":%.1f", pName,
+                     static_cast<unsigned long long>(rLatencies.GetCount()), pName,
+                     rLatencies.GetPercentile(0.5) / 1000.0, pName, rLatencies.GetPercentile(0.99) / 1000.0);
+        AppendFormat(rResponse, ",\"%s_p999_us\":%.1f,\"%s_max_us\":%.1f", pName,
+                     rLatencies.GetPercentile(0.999) / 1000.0, pName, rLatencies.GetMax() / 1000.0);
+    }
+    rResponse += '}';
+}
+
+lv::GameServerWorker::Game* lv::GameServerWorker::FindGame(const Connection& rConnection, std::string_view line,
+                                                            uint64_t& rGameId, std::string& rResponse)
+{
+    int64_t game_id = 0;
+    if (!GetJsonInt(line, "game", game_id)) {
+        rResponse += ",\"ok\":false,\"error\":\"bad_request\"}";
+        return nullptr;
+    }
+
+    // Games of other connections are unknown to this one
+    const auto game_it = m_games.find(static_cast<uint64_t>(game_id));
+    if (game_it == m_games.end() || game_it->second.connection_serial != rConnection.serial) {
+        rResponse += ",\"ok\":false,\"error\":\"unknown_game\"}";
+        return nullptr;
+    }
+
+    rGameId = game_it->first;
+    return &game_it->second;
+}
+
+bool lv::GameServerWorker::PlayBots(uint64_t game_id, Game& rGame, std::string& rResponse)
+{
+    std::unique_ptr<Agent> &rBot = m_bots[rGame.bot_agent_idx];
+    if (rBot == nullptr) {
+        rBot = AGENT_TABLE[rGame.bot_agent_idx].factory();
+    }
+
+    m_bot_dices.clear();
+    LegalMoveList moves{};
+    bool engine_ok = true;
+
+    while (!rGame.engine.IsGameOver(rGame.state) && rGame.state.current_turn.player_idx != rGame.seat) {
+        if (rGame.engine.GetLegalMoves(rGame.state, moves) == 0) {
+            engine_ok = false;
+            break;
+        }
+
+        // Shared bots start over at every move, from a seed of their own
+        const PlayerIdx player_idx = rGame.state.current_turn.player_idx;
+        rBot->OnGameStart(rGame.state, player_idx, GetGameSeed(rGame.agent_seed, rGame.turn_count));
+        const DiceValue dice = rBot->ChooseDice(rGame.state, moves);
+        if (!rGame.engine.PlayMove(rGame.state, dice)) {
+            engine_ok = false;
+            break;
+        }
+        ++rGame.turn_count;
+        m_bot_dices.push_back(static_cast<int32_t>(dice));
+    }
+
+    // Every change of the request is checked at once. A finished game has no turn left, which the incremental checks
+    // expect, so the last round's payouts are checked on the whole final state.
+    RulesViolation violation = RulesViolation::None;
+    if (engine_ok) {
+        violation = rGame.engine.IsGameOver(rGame.state) ? RulesChecker{}.CheckFinalGameState(rGame.state)
+                                                         : rGame.checker.Update(rGame.state, rGame.changes);
+    }
+    rGame.changes.Clear();
+    if (!engine_ok || violation != RulesViolation::None) {
+        m_games.erase(game_id);
+        m_game_count.store(static_cast<int64_t>(m_games.size()), std::memory_order_relaxed);
+        if (engine_ok) {
+            AppendFormat(rResponse, ",\"ok\":false,\"error\":\"rules_violation\",\"violation\":\"%s\"}",
+                         GetRulesViolationName(violation));
+        } else {
+            rResponse += ",\"ok\":false,\"error\":\"engine_error\"}";
+        }
+        return false;
+    }
+
+    AppendGameState(game_id, rGame, m_bot_dices.data(), static_cast<int32_t>(m_bot_dices.size()), rResponse);
+    return true;
+}
+
+void lv::GameServerWorker::AppendGameState(uint64_t game_id, const Game& rGame, const int32_t* pBotDices,
+                                           int32_t bot_move_count, std::string& rResponse)
+{
+    const CompactGameState &rState = rGame.state;
+    AppendFormat(rResponse, ",\"ok\":true,\"game\":%llu,\"round\":%d,\"player\":%u,\"seat\":%u,\"over\":%s",
+                 static_cast<unsigned long long>(game_id), rState.round, rState.current_turn.player_idx, rGame.seat,
+                 rGame.engine.IsGameOver(rState) ? "true" : "false");
+    AppendFormat(rResponse, ",\"bot_moves\":%d", bot_move_count);
+    AppendIntArray(rResponse, "bot_dices", pBotDices, bot_move_count);
+
+    std::array<int32_t, CASINO_COUNT> counts{};
+    std::copy(rState.current_turn.dices.begin(), rState.current_turn.dices.end(), counts.begin());
+    AppendIntArray(rResponse, "dices", counts.data(), CASINO_COUNT);
+    std::copy(rState.current_turn.white_dices.begin(), rState.current_turn.white_dices.end(), counts.begin());
+    AppendIntArray(rResponse, "white_dices", counts.data(), CASINO_COUNT);
+
+    std::array<int32_t, MAX_PLAYER_COUNT> money{};
+    for (int32_t player_idx = 0; player_idx < rState.player_count; ++player_idx) {
+        money[player_idx] = GetPlayerMoneyValue(rState.players[player_idx]);
+    }
+    AppendIntArray(rResponse, "money", money.data(), rState.player_count);
+
+    std::array<int32_t, CASINO_COUNT> neutral_bets{};
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const CompactCasinoState &rCasino = rState.casinos[casino_idx];
+        char key[32];
+        std::snprintf(key, sizeof(key), "casino%d_bills", casino_idx + 1);
+        AppendBillArray(rResponse, key, rCasino.bills);
+
+        std::array<int32_t, MAX_PLAYER_COUNT> bets{};
+        std::copy(rCasino.dice_bets.begin(), rCasino.dice_bets.begin() + rState.player_count, bets.begin());
+        std::snprintf(key, sizeof(key), "casino%d_bets", casino_idx + 1);
+        AppendIntArray(rResponse, key, bets.data(), rState.player_count);
+        neutral_bets[casino_idx] = rCasino.neutral_dice_bet;
+    }
+    AppendIntArray(rResponse, "neutral_bets", neutral_bets.data(), CASINO_COUNT);
+    rResponse += '}';
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "LvLatencyHistogram.h"
+#include "LvServerProtocol.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lv {
+
+// Games served over a local socket, speaking the line protocol of LvServerProtocol.h
+//
+// An acceptor thread hands every new connection to one of the worker threads, round robin. A worker owns its
+// connections and every game they start, and plays them with its own engine steps, agents and rules checks: nothing is
+// shared between workers but the hand-over of new connections and the latency histograms, so requests never wait on
+// a global lock. A game can only be played by the connection that started it, and is dropped with it. Clients open
+// several connections to spread their games over the workers.
+//
+// Bots are shared by the games of a worker, each move gets its own seed derived from the game's, so a game with a
+// given seed plays the same whatever the other games do. A slow bot such as "mcts" holds up its worker for every move.
+
+enum class ServerRequestType : int32_t {
+    New = 0,
+    Move,
+    State,
+    Close,
+    Stats,
+    Invalid, // Malformed requests, unknown ops
+};
+
+enum { SERVER_REQUEST_TYPE_COUNT = static_cast<int32_t>(ServerRequestType::Invalid) + 1 };
+
+const char *GetServerRequestTypeName(ServerRequestType type);
+
+struct GameServerConfig {
+    ServerAddress address;
+    int32_t worker_count = 0;        // 0 uses every hardware thread
+    int32_t max_game_count = 100000; // Over every worker
+    uint64_t base_seed = 0;          // Games started without a seed use GetGameSeed(base_seed, game_id)
+};
+
+struct GameServerStats {
+    int64_t game_count = 0;
+    int64_t connection_count = 0;
+
+    // From reading the request to sending the whole response
+    std::array<LatencyHistogram, SERVER_REQUEST_TYPE_COUNT> latencies{};
+};
+
+class GameServerWorker;
+
+class GameServer {
+public:
+    explicit GameServer(const GameServerConfig &rConfig);
+    ~GameServer();
+
+    GameServer(const GameServer &) = delete;
+    GameServer &operator=(const GameServer &) = delete;
+
+    // Listen and start the threads, false if the address cannot be listened on
+    bool Start();
+
+    // Close every connection and join the threads
+    void Stop();
+
+    // Merge the statistics of every worker, they may still be serving
+    void GetStats(GameServerStats &rStats) const;
+
+private:
+    friend class GameServerWorker;
+
+    void RunAcceptor();
+
+    GameServerConfig m_config;
+    int m_listen_fd = INVALID_SOCKET_FD;
+    std::array<int, 2> m_wake_fds{INVALID_SOCKET_FD, INVALID_SOCKET_FD}; // Wakes the acceptor up to stop
+    std::atomic<bool> m_stopping{false};
+    std::vector<std::unique_ptr<GameServerWorker>> m_workers;
+    std::thread m_acceptor_thread;
+};
+
+} // namespace lv
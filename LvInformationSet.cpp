@@ -0,0 +1,66 @@
+#include "LvInformationSet.h"
+#include "LvBatchGameEngine.h"
+
+bool lv::GetObservation(const CompactGameState& rGame, PlayerIdx observer_idx, Observation& rObservation)
+{
+    if (observer_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return false;
+    }
+    if (rGame.bank_size < 0 || rGame.bank_size > BANK_BILL_COUNT) {
+        return false;
+    }
+
+    // Only the bank content is known
+    BillCounts bank_bills{};
+    for (int32_t bank_idx = 0; bank_idx < rGame.bank_size; ++bank_idx) {
+        if (rGame.bank[bank_idx] >= BILL_TYPE_COUNT) {
+            return false;
+        }
+        ++bank_bills[rGame.bank[bank_idx]];
+    }
+
+    rObservation.game = rGame;
+    rObservation.bank_bills = bank_bills;
+    rObservation.observer_idx = observer_idx;
+
+    // Canonical order, highest bill at the bottom and lowest on top
+    rObservation.game.bank = {};
+    int32_t bank_size = 0;
+    for (int32_t bill_idx = BILL_TYPE_COUNT - 1; bill_idx >= 0; --bill_idx) {
+        for (int32_t count = 0; count < bank_bills[bill_idx]; ++count) {
+            rObservation.game.bank[bank_size++] = static_cast<uint8_t>(bill_idx);
+        }
+    }
+
+    return true;
+}
+
+void lv::Determinize(const Observation& rObservation, Rng& rRng, CompactGameState& rGame, Rng& rChanceRng)
+{
+    rGame = rObservation.game;
+    rChanceRng.Seed(rRng());
+}
+
+void lv::Determinize(const Observation& rObservation, Rng& rRng, int32_t count, CompactGameState* pGames,
+                     Rng* pChanceRngs)
+{
+    for (int32_t sample_idx = 0; sample_idx < count; ++sample_idx) {
+        Determinize(rObservation, rRng, pGames[sample_idx], pChanceRngs[sample_idx]);
+    }
+}
+
+bool lv::Determinize(const Observation& rObservation, Rng& rRng, BatchGameEngine& rEngine, int32_t first_game_idx,
+                     int32_t count)
+{
+    if (first_game_idx < 0 || count < 0 || first_game_idx + count > rEngine.GetGameCount()) {
+        return false;
+    }
+
+    for (int32_t game_idx = first_game_idx; game_idx < first_game_idx + count; ++game_idx) {
+        if (!rEngine.SetGameState(game_idx, rObservation.game, Rng{rRng()})) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "LvPublic.h"
+#include "LvRandom.h"
+
+namespace lv {
+
+class BatchGameEngine;
+
+// What one player may know about a game
+//
+// Las Vegas has no private information: money, dices, bets, casino bills and the current roll are public. What a
+// player cannot know is chance, the future rolls and the order of the bank. SetupRound reshuffles the bank before
+// every deal, so only the bank content is observable, it is kept as counts and the bank is rewritten in canonical
+// order (ascending bill index from the top) so that two states differing only by hidden information give the same
+// observation.
+struct Observation {
+    CompactGameState game{};
+    BillCounts bank_bills{};
+    PlayerIdx observer_idx = 0;
+
+    bool operator==(const Observation &) const = default;
+};
+
+// Extract what observer_idx knows about rGame.
+// Fails if observer_idx is not a player of the game or if the bank holds an invalid bill.
+bool GetObservation(const CompactGameState &rGame, PlayerIdx observer_idx, Observation &rObservation);
+
+// Sample a game state consistent with an observation, together with the generator of its chance outcomes.
+// The bank is left in canonical order: it is only read after the shuffle of the next SetupRound, so its order and the
+// chance generator are both resampled by drawing a fresh generator. This costs a state copy and one seeding, and
+// never allocates. Pass rChanceRng to the engine playing the determinization (GameEngine::GetRng).
+void Determinize(const Observation &rObservation, Rng &rRng, CompactGameState &rGame, Rng &rChanceRng);
+
+// Sample count determinizations into pGames and pChanceRngs
+void Determinize(const Observation &rObservation, Rng &rRng, int32_t count, CompactGameState *pGames,
+                 Rng *pChanceRngs);
+
+// Sample count determinizations into the games [first_game_idx, first_game_idx + count) of a batch engine
+bool Determinize(const Observation &rObservation, Rng &rRng, BatchGameEngine &rEngine, int32_t first_game_idx,
+                 int32_t count);
+
+} // namespace lv
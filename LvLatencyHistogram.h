@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+namespace lv {
+
+inline int64_t GetSteadyClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Histogram of latencies in nanoseconds, with log-linear buckets
+//
+// Values below 16 have their own bucket, then every power of two is split in 16 buckets, so a bucket is never wider
+// than 1/16 of its values and percentiles are reported within 6.25%. Values from 2^40 ns (18 minutes) up share the
+// last bucket. One thread records, any thread may read or Add the counts at the same time: counters are relaxed
+// atomics that only their writer increments.
+class LatencyHistogram {
+public:
+    enum {
+        SUB_BUCKET_BITS = 4,
+        SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+        MAX_MAGNITUDE = 40, // Highest bit of the values with their own buckets
+        BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT,
+    };
+
+    static constexpr int32_t GetBucketIndex(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) {
+            return static_cast<int32_t>(value);
+        }
+        const int32_t magnitude = static_cast<int32_t>(std::bit_width(value)) - 1;
+        if (magnitude > MAX_MAGNITUDE) {
+            return BUCKET_COUNT - 1;
+        }
+        const int32_t shift = magnitude - SUB_BUCKET_BITS;
+        const int32_t sub_bucket_idx = static_cast<int32_t>((value >> shift) & (SUB_BUCKET_COUNT - 1));
+        return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub_bucket_idx;
+    }
+
+    // Highest value of a bucket
+    static constexpr uint64_t GetBucketUpperBound(int32_t bucket_idx) {
+        if (bucket_idx < SUB_BUCKET_COUNT) {
+            return static_cast<uint64_t>(bucket_idx);
+        }
+        const int32_t shift = bucket_idx / SUB_BUCKET_COUNT - 1;
+        const uint64_t lower_bound = static_cast<uint64_t>(SUB_BUCKET_COUNT + bucket_idx % SUB_BUCKET_COUNT) << shift;
+        return lower_bound + (uint64_t{1} << shift) - 1;
+    }
+
+    void Record(int64_t value) {
+        const uint64_t clamped_value = static_cast<uint64_t>(std::max<int64_t>(value, 0));
+        Increment(m_counts[GetBucketIndex(clamped_value)], 1);
+        Increment(m_count, 1);
+        Increment(m_sum, clamped_value);
+        if (clamped_value > m_max.load(std::memory_order_relaxed)) {
+            m_max.store(clamped_value, std::memory_order_relaxed);
+        }
+    }
+
+    // Add the counts of rOther, which may still be recording, to this histogram
+    void Add(const LatencyHistogram &rOther) {
+        for (int32_t bucket_idx = 0; bucket_idx < BUCKET_COUNT; ++bucket_idx) {
+            Increment(m_counts[bucket_idx], rOther.m_counts[bucket_idx].load(std::memory_order_relaxed));
+        }
+        Increment(m_count, rOther.m_count.load(std::memory_order_relaxed));
+        Increment(m_sum, rOther.m_sum.load(std::memory_order_relaxed));
+        m_max.store(std::max(m_max.load(std::memory_order_relaxed), rOther.m_max.load(std::memory_order_relaxed)),
+                    std::memory_order_relaxed);
+    }
+
+    void Clear() {
+        for (std::atomic<uint64_t> &rCount : m_counts) {
+            rCount.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t GetCount() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+
+    double GetMean() const {
+        const uint64_t count = GetCount();
+        return count > 0 ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / count : 0.0;
+    }
+
+    // Upper bound of the bucket holding the given fraction of the values, 0.99 for the 99th percentile
+    uint64_t GetPercentile(double fraction) const {
+        const uint64_t count = GetCount();
+        if (count == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(count) + 0.5));
+        uint64_t seen_count = 0;
+        for (int32_t bucket_idx = 0; bucket_idx < BUCKET_COUNT; ++bucket_idx) {
+            seen_count += m_counts[bucket_idx].load(std::memory_order_relaxed);
+            if (seen_count >= rank) {
+                return std::min(GetBucketUpperBound(bucket_idx), GetMax());
+            }
+        }
+        return GetMax();
+    }
+
+private:
+    // Single writer, a plain load and store rather than a locked read-modify-write
+    static void Increment(std::atomic<uint64_t> &rCounter, uint64_t delta) {
+        rCounter.store(rCounter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_counts{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+static_assert(LatencyHistogram::GetBucketIndex(LatencyHistogram::GetBucketUpperBound(100)) == 100,
+              "Bucket bounds must match bucket indices");
+
+} // namespace lv
@@ -0,0 +1,128 @@
+#include "LvMappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+lv::MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool lv::MappedFile::Open(const char* pPath, FileAccess access)
+{
+    Close();
+
+    const DWORD access_flag = access == FileAccess::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN;
+    HANDLE file_handle = CreateFileA(pPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL | access_flag, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    m_file_handle = file_handle;
+
+    // Empty files cannot be mapped, they are simply empty
+    if (file_size.QuadPart == 0) {
+        return true;
+    }
+
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        Close();
+        return false;
+    }
+    m_mapping_handle = mapping_handle;
+
+    m_pData = static_cast<const uint8_t *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (m_pData == nullptr) {
+        Close();
+        return false;
+    }
+    m_size = static_cast<size_t>(file_size.QuadPart);
+
+    return true;
+}
+
+void lv::MappedFile::Close()
+{
+    if (m_pData != nullptr) {
+        UnmapViewOfFile(m_pData);
+    }
+    if (m_mapping_handle != nullptr) {
+        CloseHandle(m_mapping_handle);
+    }
+    if (m_file_handle != nullptr) {
+        CloseHandle(m_file_handle);
+    }
+
+    m_pData = nullptr;
+    m_size = 0;
+    m_mapping_handle = nullptr;
+    m_file_handle = nullptr;
+}
+
+#else
+
+bool lv::MappedFile::Open(const char* pPath, FileAccess access)
+{
+    Close();
+
+    const int fd = open(pPath, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // Empty files cannot be mapped, they are simply empty
+    if (file_stat.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void *pData = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (pData == MAP_FAILED) {
+        return false;
+    }
+
+    madvise(pData, static_cast<size_t>(file_stat.st_size),
+            access == FileAccess::Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+    m_pData = static_cast<const uint8_t *>(pData);
+    m_size = static_cast<size_t>(file_stat.st_size);
+
+    return true;
+}
+
+void lv::MappedFile::Close()
+{
+    if (m_pData != nullptr) {
+        munmap(const_cast<uint8_t *>(m_pData), m_size);
+    }
+
+    m_pData = nullptr;
+    m_size = 0;
+}
+
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lv {
+
+// How the mapping will be read, given to the system as a paging hint
+enum class FileAccess : int32_t {
+    Sequential = 0, // Front to back, such as record streams: read ahead and drop what was read
+    Random,         // Scattered lookups, such as binary searches: only the pages touched
+};
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool Open(const char *pPath, FileAccess access = FileAccess::Sequential);
+    void Close();
+
+    const uint8_t *GetData() const { return m_pData; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    const uint8_t *m_pData = nullptr;
+    size_t m_size = 0;
+
+#ifdef _WIN32
+    void *m_file_handle = nullptr;
+    void *m_mapping_handle = nullptr;
+#endif
+};
+
+} // namespace lv
@@ -0,0 +1,312 @@
+#include "LvMctsAgent.h"
+#include "LvUtils.h"
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// Upper bound on the number of moves of a game, every move allocates at least one dice
+enum { MAX_GAME_MOVE_COUNT = static_cast<int32_t>(lv::ROUND_COUNT) * lv::MAX_PLAYER_COUNT * (lv::DICE_COUNT + 4) };
+
+// Iterations between two deadline checks
+enum { DEADLINE_CHECK_INTERVAL = 64 };
+
+// Win share of every player at the end of a game
+void GetRewards(const lv::CompactGameState &rGame, std::array<float, lv::MAX_PLAYER_COUNT> &rRewards)
+{
+    const uint32_t winner_mask = lv::GetWinnerMask(rGame);
+    int32_t winner_count = 0;
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        winner_count += (winner_mask >> player_idx) & 1;
+    }
+    for (int32_t player_idx = 0; player_idx < lv::MAX_PLAYER_COUNT; ++player_idx) {
+        rRewards[player_idx] = ((winner_mask >> player_idx) & 1) ? 1.0f / winner_count : 0.0f;
+    }
+}
+
+} // namespace
+
+lv::MctsAgent::MctsAgent() : MctsAgent(MctsConfig{}) {}
+
+lv::MctsAgent::MctsAgent(const MctsConfig& rConfig) : m_config(rConfig)
+{
+    m_trees.resize(std::max(1, m_config.thread_count));
+    for (Tree &rTree : m_trees) {
+        rTree.nodes.reserve(m_config.max_node_count);
+        ResetTree(rTree);
+    }
+    if (m_config.pNetwork != nullptr) {
+        m_pEvaluator =
+            std::make_unique<BatchedNetworkEvaluator>(*m_config.pNetwork, static_cast<int32_t>(m_trees.size()));
+    }
+}
+
+void lv::MctsAgent::OnGameStart(const CompactGameState& rGame, PlayerIdx player_idx, uint64_t seed)
+{
+    Rng seed_rng{seed};
+    for (Tree &rTree : m_trees) {
+        rTree.rng.Seed(seed_rng());
+        ResetTree(rTree);
+    }
+    m_pending_move_count = 0;
+    m_pending_overflow = false;
+}
+
+void lv::MctsAgent::OnMovePlayed(const CompactGameState& rGame, PlayerIdx player_idx, DiceValue dice)
+{
+    if (m_pending_move_count < static_cast<int32_t>(m_pending_moves.size())) {
+        m_pending_moves[m_pending_move_count++] = dice;
+    } else {
+        m_pending_overflow = true;
+    }
+}
+
+lv::DiceValue lv::MctsAgent::ChooseDice(const CompactGameState& rGame, const LegalMoveList& rMoves)
+{
+    // No choice to make
+    if (rMoves.count == 1) {
+        return rMoves.moves[0].dice;
+    }
+
+    for (Tree &rTree : m_trees) {
+        AdvanceRoot(rTree);
+    }
+    m_pending_move_count = 0;
+    m_pending_overflow = false;
+
+    if (!GetObservation(rGame, rGame.current_turn.player_idx, m_observation)) {
+        return rMoves.moves[0].dice;
+    }
+    const Observation &rObservation = m_observation;
+
+    // Every thread is a client of the evaluator until its search is over
+    if (m_pEvaluator != nullptr) {
+        for (size_t tree_idx = 0; tree_idx < m_trees.size(); ++tree_idx) {
+            m_pEvaluator->AddClient();
+        }
+    }
+
+    // Root parallelism, every thread grows its own tree
+    if (m_trees.size() == 1) {
+        Search(m_trees[0], rObservation);
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(m_trees.size());
+        for (Tree &rTree : m_trees) {
+            threads.emplace_back([this, &rTree, &rObservation]() { Search(rTree, rObservation); });
+        }
+        for (std::thread &rThread : threads) {
+            rThread.join();
+        }
+    }
+
+    // Most visited move over every tree
+    m_root_visit_counts.fill(0);
+    m_last_iteration_count = 0;
+    for (const Tree &rTree : m_trees) {
+        const Node &rRoot = rTree.nodes[rTree.root];
+        for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+            if (rRoot.children[face_idx] != INVALID_NODE) {
+                m_root_visit_counts[face_idx] += rTree.nodes[rRoot.children[face_idx]].visit_count;
+            }
+        }
+        m_last_iteration_count += rTree.iteration_count;
+    }
+
+    DiceValue best_dice = rMoves.moves[0].dice;
+    uint32_t best_visit_count = 0;
+    for (int32_t move_idx = 0; move_idx < rMoves.count; ++move_idx) {
+        const DiceValue dice = rMoves.moves[move_idx].dice;
+        const uint32_t visit_count = m_root_visit_counts[static_cast<int32_t>(dice) - 1];
+        if (visit_count > best_visit_count) {
+            best_dice = dice;
+            best_visit_count = visit_count;
+        }
+    }
+
+    return best_dice;
+}
+
+void lv::MctsAgent::ResetTree(Tree& rTree)
+{
+    rTree.nodes.clear();
+    rTree.nodes.emplace_back();
+    rTree.root = 0;
+}
+
+void lv::MctsAgent::AdvanceRoot(Tree& rTree)
+{
+    // Start over when reuse is disabled or when the pool is getting full, nodes of discarded branches are only
+    // reclaimed by a reset
+    if (!m_config.reuse_tree || m_pending_overflow ||
+        rTree.nodes.size() * 2 > static_cast<size_t>(m_config.max_node_count)) {
+        ResetTree(rTree);
+        return;
+    }
+
+    for (int32_t move_idx = 0; move_idx < m_pending_move_count; ++move_idx) {
+        const uint32_t child = rTree.nodes[rTree.root].children[static_cast<int32_t>(m_pending_moves[move_idx]) - 1];
+        if (child == INVALID_NODE) {
+            ResetTree(rTree);
+            return;
+        }
+        rTree.root = child;
+    }
+}
+
+void lv::MctsAgent::Search(Tree& rTree, const Observation& rRoot) const
+{
+    using Clock = std::chrono::steady_clock;
+    const bool has_deadline = m_config.time_budget_ms > 0.0;
+    const Clock::time_point deadline =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                           std::chrono::duration<double, std::milli>(m_config.time_budget_ms));
+
+    // Without any budget, fall back to the default iteration count
+    const int64_t iteration_count =
+        m_config.iteration_count > 0 || has_deadline ? m_config.iteration_count : MctsConfig{}.iteration_count;
+
+    rTree.iteration_count = 0;
+    while (iteration_count == 0 || rTree.iteration_count < iteration_count) {
+        if (has_deadline && rTree.iteration_count % DEADLINE_CHECK_INTERVAL == 0 && Clock::now() >= deadline) {
+            break;
+        }
+        RunIteration(rTree, rRoot);
+        ++rTree.iteration_count;
+    }
+
+    if (m_pEvaluator != nullptr) {
+        m_pEvaluator->RemoveClient();
+    }
+}
+
+void lv::MctsAgent::RunIteration(Tree& rTree, const Observation& rRoot) const
+{
+    // Sample this iteration's hidden information
+    CompactGameState game;
+    Determinize(rRoot, rTree.rng, game, rTree.engine.GetRng());
+    LegalMoveList moves{};
+
+    std::array<uint32_t, MAX_GAME_MOVE_COUNT + 1> path{};
+    int32_t path_length = 0;
+    path[path_length++] = rTree.root;
+
+    // Selection and expansion
+    uint32_t node_idx = rTree.root;
+    bool expanded = false;
+    while (!expanded && !rTree.engine.IsGameOver(game)) {
+        if (rTree.engine.GetLegalMoves(game, moves) == 0) {
+            return;
+        }
+
+        // Expand one untried move if the pool has room left
+        std::array<int32_t, CASINO_COUNT> untried{};
+        uint32_t untried_count = 0;
+        for (int32_t move_idx = 0; move_idx < moves.count; ++move_idx) {
+            if (rTree.nodes[node_idx].children[static_cast<int32_t>(moves.moves[move_idx].dice) - 1] == INVALID_NODE) {
+                untried[untried_count++] = move_idx;
+            }
+        }
+
+        DiceValue dice = DiceValue::Invalid;
+        if (untried_count > 0 && rTree.nodes.size() < static_cast<size_t>(m_config.max_node_count)) {
+            dice = moves.moves[untried[rTree.rng.NextBelow(untried_count)]].dice;
+
+            Node child{};
+            child.player_idx = game.current_turn.player_idx;
+            const uint32_t child_idx = static_cast<uint32_t>(rTree.nodes.size());
+            rTree.nodes.push_back(child);
+            rTree.nodes[node_idx].children[static_cast<int32_t>(dice) - 1] = child_idx;
+            expanded = true;
+        } else {
+            // UCB over the children available with this roll
+            const Node &rNode = rTree.nodes[node_idx];
+            float best_score = -1.0f;
+            for (int32_t move_idx = 0; move_idx < moves.count; ++move_idx) {
+                const uint32_t child_idx = rNode.children[static_cast<int32_t>(moves.moves[move_idx].dice) - 1];
+                if (child_idx == INVALID_NODE) {
+                    continue;
+                }
+                Node &rChild = rTree.nodes[child_idx];
+                ++rChild.availability_count;
+
+                // A child expanded by an iteration that returned before backpropagating has no visit yet, it is
+                // played first like an untried move
+                if (rChild.visit_count == 0) {
+                    if (best_score < std::numeric_limits<float>::max()) {
+                        best_score = std::numeric_limits<float>::max();
+                        dice = moves.moves[move_idx].dice;
+                    }
+                    continue;
+                }
+
+                const float score =
+                    rChild.total_reward / rChild.visit_count +
+                    static_cast<float>(m_config.exploration) *
+                        std::sqrt(std::log(static_cast<float>(rChild.availability_count)) / rChild.visit_count);
+                if (score > best_score) {
+                    best_score = score;
+                    dice = moves.moves[move_idx].dice;
+                }
+            }
+            if (dice == DiceValue::Invalid) {
+                // Every legal move is untried and the pool is full, play on without the tree
+                break;
+            }
+        }
+
+        node_idx = rTree.nodes[node_idx].children[static_cast<int32_t>(dice) - 1];
+        path[path_length++] = node_idx;
+        if (expanded) {
+            rTree.nodes[node_idx].availability_count = 1;
+        }
+
+        if (!rTree.engine.PlayMove(game, dice)) {
+            return;
+        }
+    }
+
+    // Random playout to the end of the game, unless the network values the leaf
+    std::array<float, MAX_PLAYER_COUNT> rewards{};
+    if (rTree.engine.IsGameOver(game) || !EvaluateLeaf(game, rewards)) {
+        while (!rTree.engine.IsGameOver(game)) {
+            if (rTree.engine.GetLegalMoves(game, moves) == 0) {
+                return;
+            }
+            const DiceValue dice = moves.moves[rTree.rng.NextBelow(static_cast<uint32_t>(moves.count))].dice;
+            if (!rTree.engine.PlayMove(game, dice)) {
+                return;
+            }
+        }
+        GetRewards(game, rewards);
+    }
+
+    // Backpropagation, every node holds the reward of the player who moved into it
+    for (int32_t path_idx = 0; path_idx < path_length; ++path_idx) {
+        Node &rNode = rTree.nodes[path[path_idx]];
+        ++rNode.visit_count;
+        rNode.total_reward += rewards[rNode.player_idx];
+    }
+}
+
+bool lv::MctsAgent::EvaluateLeaf(const CompactGameState& rGame, std::array<float, MAX_PLAYER_COUNT>& rRewards) const
+{
+    if (m_pEvaluator == nullptr || rGame.player_count <= 0) {
+        return false;
+    }
+
+    // Win shares come by seat, numbered from the player to move
+    const PlayerIdx perspective_idx = rGame.current_turn.player_idx;
+    NetworkOutput output{};
+    if (!m_pEvaluator->Evaluate(rGame, perspective_idx, output)) {
+        return false;
+    }
+    rRewards.fill(0.0f);
+    for (int32_t seat_idx = 0; seat_idx < rGame.player_count; ++seat_idx) {
+        rRewards[(perspective_idx + seat_idx) % rGame.player_count] = output.win_shares[seat_idx];
+    }
+    return true;
+}
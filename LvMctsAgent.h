@@ -0,0 +1,87 @@
+#pragma once
+
+#include "LvAgent.h"
+#include "LvGameEngine.h"
+#include "LvInformationSet.h"
+#include "LvNeuralNetwork.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace lv {
+
+struct MctsConfig {
+    int32_t iteration_count = 2000; // Playouts per decision and per thread, 0 for no limit
+    double time_budget_ms = 0.0;    // Time per decision, 0 for no limit
+    double exploration = 0.7;       // UCB exploration constant, rewards are win shares in [0, 1]
+    int32_t thread_count = 1;       // Root parallelism, each thread searches its own tree
+    bool reuse_tree = true;         // Keep the subtree of the moves played since the last decision
+    int32_t max_node_count = 1 << 18;
+    const NeuralNetwork *pNetwork = nullptr; // Values leaves instead of random playouts, must outlive the agent
+};
+
+// Information set Monte Carlo tree search agent (single observer, open loop)
+//
+// The only hidden information is chance: future rolls and the bank order, which SetupRound shuffles before dealing.
+// Nodes are therefore keyed by the sequence of dice values played. The search only sees the player's Observation of
+// the root, and every iteration starts from its own determinization of it (see Determinize) played forward with
+// GameEngine::PlayMove. The determinization is a CompactGameState of a few hundred bytes on the stack, so nothing is
+// taken back at the end of an iteration, the next one starts from a fresh copy. Since the legal moves depend on the
+// roll, children are selected with UCB over availability counts. Leaves are valued by a random playout to the end of
+// the game, or by the win shares of a network when the configuration has one, the evaluations of every thread
+// batched together.
+class MctsAgent : public Agent {
+public:
+    MctsAgent();
+    explicit MctsAgent(const MctsConfig &rConfig);
+
+    void OnGameStart(const CompactGameState &rGame, PlayerIdx player_idx, uint64_t seed) override;
+    DiceValue ChooseDice(const CompactGameState &rGame, const LegalMoveList &rMoves) override;
+    void OnMovePlayed(const CompactGameState &rGame, PlayerIdx player_idx, DiceValue dice) override;
+
+    // Root statistics of the last decision, summed over every thread
+    const std::array<uint32_t, CASINO_COUNT> &GetRootVisitCounts() const { return m_root_visit_counts; }
+    int64_t GetLastIterationCount() const { return m_last_iteration_count; }
+
+private:
+    enum : uint32_t { INVALID_NODE = 0xFFFFFFFF };
+
+    struct Node {
+        std::array<uint32_t, CASINO_COUNT> children{INVALID_NODE, INVALID_NODE, INVALID_NODE,
+                                                    INVALID_NODE, INVALID_NODE, INVALID_NODE};
+        uint32_t visit_count = 0;
+        uint32_t availability_count = 0;
+        float total_reward = 0.0f; // Sum of the win shares of the player who played the move leading here
+        PlayerIdx player_idx = 0;
+    };
+
+    struct Tree {
+        std::vector<Node> nodes;
+        uint32_t root = INVALID_NODE;
+        GameEngine engine{0};
+        Rng rng;
+        int64_t iteration_count = 0;
+    };
+
+    void ResetTree(Tree &rTree);
+    void AdvanceRoot(Tree &rTree);
+    void Search(Tree &rTree, const Observation &rRoot) const;
+    void RunIteration(Tree &rTree, const Observation &rRoot) const;
+    bool EvaluateLeaf(const CompactGameState &rGame, std::array<float, MAX_PLAYER_COUNT> &rRewards) const;
+
+    MctsConfig m_config;
+    std::vector<Tree> m_trees;
+    std::unique_ptr<BatchedNetworkEvaluator> m_pEvaluator;
+    Observation m_observation;
+
+    // Moves played since the last decision, used to reuse the tree
+    std::array<DiceValue, 512> m_pending_moves{};
+    int32_t m_pending_move_count = 0;
+    bool m_pending_overflow = false;
+
+    std::array<uint32_t, CASINO_COUNT> m_root_visit_counts{};
+    int64_t m_last_iteration_count = 0;
+};
+
+} // namespace lv
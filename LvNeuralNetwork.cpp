@@ -0,0 +1,346 @@
+#include "LvNeuralNetwork.h"
+#include "LvMappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Batched inputs sharing every row of weights loaded
+enum { BATCH_BLOCK_SIZE = 4 };
+
+uint32_t ReadUint32(const uint8_t *pData)
+{
+    uint32_t value = 0;
+    std::memcpy(&value, pData, sizeof(value));
+    return value;
+}
+
+// Bounds checked reader of the network file
+class FileReader {
+public:
+    FileReader(const uint8_t *pData, size_t size) : m_pData(pData), m_size(size) {}
+
+    const uint8_t *Read(size_t size) {
+        if (size > m_size - m_offset) {
+            return nullptr;
+        }
+        const uint8_t *pData = m_pData + m_offset;
+        m_offset += size;
+        return pData;
+    }
+
+    template <typename T> bool ReadArray(std::vector<T> &rValues, size_t count) {
+        const uint8_t *pData = Read(count * sizeof(T));
+        if (pData == nullptr) {
+            return false;
+        }
+        rValues.resize(count);
+        if (count > 0) {
+            std::memcpy(rValues.data(), pData, count * sizeof(T));
+        }
+        return true;
+    }
+
+    bool Skip(size_t size) { return Read(size) != nullptr; }
+    size_t GetOffset() const { return m_offset; }
+    bool IsAtEnd() const { return m_offset == m_size; }
+
+private:
+    const uint8_t *m_pData = nullptr;
+    size_t m_size = 0;
+    size_t m_offset = 0;
+};
+
+// Add every input of a block times its row of weights to the outputs of the block
+template <typename Weight>
+void AccumulateBlock(const Weight *pWeights, int32_t input_count, int32_t output_count, const float *pInputs,
+                     int32_t block_size, float *pOutputs)
+{
+    for (int32_t input_idx = 0; input_idx < input_count; ++input_idx) {
+        const Weight *pRow = pWeights + static_cast<size_t>(input_idx) * output_count;
+        for (int32_t row_idx = 0; row_idx < block_size; ++row_idx) {
+            const float input = pInputs[row_idx * input_count + input_idx];
+            if (input == 0.0f) {
+                continue;
+            }
+            float *pRowOutputs = pOutputs + row_idx * output_count;
+            for (int32_t output_idx = 0; output_idx < output_count; ++output_idx) {
+                pRowOutputs[output_idx] += input * static_cast<float>(pRow[output_idx]);
+            }
+        }
+    }
+}
+
+void Softmax(const float *pLogits, int32_t count, float *pValues)
+{
+    if (count <= 0) {
+        return;
+    }
+    const float max_logit = *std::max_element(pLogits, pLogits + count);
+    float sum = 0.0f;
+    for (int32_t idx = 0; idx < count; ++idx) {
+        pValues[idx] = std::exp(pLogits[idx] - max_logit);
+        sum += pValues[idx];
+    }
+    for (int32_t idx = 0; idx < count; ++idx) {
+        pValues[idx] /= sum;
+    }
+}
+
+lv::NeuralNetwork &GetSharedNetwork()
+{
+    static lv::NeuralNetwork network;
+    return network;
+}
+
+} // namespace
+
+bool lv::NeuralNetwork::Open(const char* pPath)
+{
+    Close();
+
+    MappedFile file;
+    if (!file.Open(pPath) || file.GetSize() < NETWORK_FILE_HEADER_SIZE) {
+        return false;
+    }
+
+    FileReader reader{file.GetData(), file.GetSize()};
+    const uint8_t *pHeader = reader.Read(NETWORK_FILE_HEADER_SIZE);
+    const uint32_t version = ReadUint32(pHeader + 4);
+    const uint32_t feature_layout_version = ReadUint32(pHeader + 8);
+    const uint32_t input_count = ReadUint32(pHeader + 12);
+    const uint32_t layer_count = ReadUint32(pHeader + 16);
+    if (std::memcmp(pHeader, "LVNN", 4) != 0 || version != NETWORK_FILE_VERSION ||
+        feature_layout_version != FEATURE_LAYOUT_VERSION || input_count != FEATURE_COUNT || layer_count == 0 ||
+        layer_count > NETWORK_MAX_LAYER_COUNT) {
+        return false;
+    }
+
+    m_layers.resize(layer_count);
+    m_max_layer_size = FEATURE_COUNT;
+    int32_t previous_output_count = FEATURE_COUNT;
+    for (Layer &rLayer : m_layers) {
+        const uint8_t *pLayerHeader = reader.Read(NETWORK_LAYER_HEADER_SIZE);
+        if (pLayerHeader == nullptr) {
+            Close();
+            return false;
+        }
+        const uint32_t layer_input_count = ReadUint32(pLayerHeader);
+        const uint32_t layer_output_count = ReadUint32(pLayerHeader + 4);
+        const uint32_t weight_type = ReadUint32(pLayerHeader + 8);
+        const uint32_t activation = ReadUint32(pLayerHeader + 12);
+        if (layer_input_count != static_cast<uint32_t>(previous_output_count) || layer_output_count == 0 ||
+            layer_output_count > NETWORK_MAX_LAYER_SIZE ||
+            weight_type > static_cast<uint32_t>(NetworkWeightType::Int8) ||
+            activation > static_cast<uint32_t>(NetworkActivation::Relu)) {
+            Close();
+            return false;
+        }
+
+        rLayer.input_count = static_cast<int32_t>(layer_input_count);
+        rLayer.output_count = static_cast<int32_t>(layer_output_count);
+        rLayer.weight_type = static_cast<NetworkWeightType>(weight_type);
+        rLayer.activation = static_cast<NetworkActivation>(activation);
+
+        const size_t weight_count = static_cast<size_t>(rLayer.input_count) * rLayer.output_count;
+        bool ok = reader.ReadArray(rLayer.biases, rLayer.output_count);
+        if (rLayer.weight_type == NetworkWeightType::Int8) {
+            ok = ok && reader.ReadArray(rLayer.scales, rLayer.output_count) &&
+                 reader.ReadArray(rLayer.int8_weights, weight_count);
+        } else {
+            ok = ok && reader.ReadArray(rLayer.weights, weight_count);
+        }
+        ok = ok && reader.Skip((4 - reader.GetOffset() % 4) % 4);
+        if (!ok) {
+            Close();
+            return false;
+        }
+
+        m_max_layer_size = std::max(m_max_layer_size, rLayer.output_count);
+        previous_output_count = rLayer.output_count;
+    }
+
+    if (previous_output_count != NETWORK_OUTPUT_COUNT || !reader.IsAtEnd()) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void lv::NeuralNetwork::Close()
+{
+    m_layers.clear();
+    m_max_layer_size = 0;
+}
+
+void lv::NeuralNetwork::Evaluate(const float* pInputs, int32_t batch_size, float* pOutputs,
+                                 NetworkWorkspace& rWorkspace) const
+{
+    if (m_layers.empty() || batch_size <= 0) {
+        return;
+    }
+
+    const size_t activation_count = static_cast<size_t>(batch_size) * m_max_layer_size;
+    for (std::vector<float> &rActivations : rWorkspace.activations) {
+        if (rActivations.size() < activation_count) {
+            rActivations.resize(activation_count);
+        }
+    }
+
+    const float *pLayerInputs = pInputs;
+    for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++layer_idx) {
+        float *pLayerOutputs =
+            layer_idx + 1 == m_layers.size() ? pOutputs : rWorkspace.activations[layer_idx % 2].data();
+        EvaluateLayer(m_layers[layer_idx], pLayerInputs, batch_size, pLayerOutputs);
+        pLayerInputs = pLayerOutputs;
+    }
+}
+
+void lv::NeuralNetwork::GetOutput(const float* pRawOutputs, int32_t player_count, NetworkOutput& rOutput)
+{
+    player_count = std::clamp<int32_t>(player_count, 1, MAX_PLAYER_COUNT);
+    rOutput.win_shares.fill(0.0f);
+    Softmax(pRawOutputs, player_count, rOutput.win_shares.data());
+    Softmax(pRawOutputs + NETWORK_VALUE_OUTPUT_COUNT, CASINO_COUNT, rOutput.policy.data());
+}
+
+void lv::NeuralNetwork::EvaluateLayer(const Layer& rLayer, const float* pInputs, int32_t batch_size,
+                                      float* pOutputs)
+{
+    const int32_t input_count = rLayer.input_count;
+    const int32_t output_count = rLayer.output_count;
+    const bool is_int8 = rLayer.weight_type == NetworkWeightType::Int8;
+
+    for (int32_t block_start = 0; block_start < batch_size; block_start += BATCH_BLOCK_SIZE) {
+        const int32_t block_size = std::min<int32_t>(BATCH_BLOCK_SIZE, batch_size - block_start);
+        const float *pBlockInputs = pInputs + static_cast<size_t>(block_start) * input_count;
+        float *pBlockOutputs = pOutputs + static_cast<size_t>(block_start) * output_count;
+
+        std::fill(pBlockOutputs, pBlockOutputs + block_size * output_count, 0.0f);
+        if (is_int8) {
+            AccumulateBlock(rLayer.int8_weights.data(), input_count, output_count, pBlockInputs, block_size,
+                            pBlockOutputs);
+        } else {
+            AccumulateBlock(rLayer.weights.data(), input_count, output_count, pBlockInputs, block_size,
+                            pBlockOutputs);
+        }
+
+        for (int32_t row_idx = 0; row_idx < block_size; ++row_idx) {
+            float *pRowOutputs = pBlockOutputs + row_idx * output_count;
+            if (is_int8) {
+                for (int32_t output_idx = 0; output_idx < output_count; ++output_idx) {
+                    pRowOutputs[output_idx] *= rLayer.scales[output_idx];
+                }
+            }
+            for (int32_t output_idx = 0; output_idx < output_count; ++output_idx) {
+                pRowOutputs[output_idx] += rLayer.biases[output_idx];
+            }
+            if (rLayer.activation == NetworkActivation::Relu) {
+                for (int32_t output_idx = 0; output_idx < output_count; ++output_idx) {
+                    pRowOutputs[output_idx] = std::max(pRowOutputs[output_idx], 0.0f);
+                }
+            }
+        }
+    }
+}
+
+lv::BatchedNetworkEvaluator::BatchedNetworkEvaluator(const NeuralNetwork& rNetwork, int32_t max_batch_size,
+                                                     double max_wait_us)
+    : m_network(rNetwork), m_max_batch_size(std::max(1, max_batch_size)), m_max_wait_us(max_wait_us)
+{
+    m_inputs.resize(static_cast<size_t>(m_max_batch_size) * FEATURE_COUNT);
+    m_outputs.resize(static_cast<size_t>(m_max_batch_size) * NETWORK_OUTPUT_COUNT);
+    m_requests.resize(m_max_batch_size);
+    m_player_counts.resize(m_max_batch_size);
+}
+
+void lv::BatchedNetworkEvaluator::AddClient()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_client_count;
+}
+
+void lv::BatchedNetworkEvaluator::RemoveClient()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_client_count = std::max(0, m_client_count - 1);
+    // The clients left may all be waiting already
+    if (m_pending_count > 0 && m_pending_count >= m_client_count) {
+        RunBatch();
+    }
+}
+
+bool lv::BatchedNetworkEvaluator::Evaluate(const CompactGameState& rGame, PlayerIdx perspective_idx,
+                                           NetworkOutput& rOutput)
+{
+    alignas(64) std::array<float, FEATURE_COUNT> features;
+    if (!EncodeFeatures(rGame, perspective_idx, features.data())) {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const int32_t slot_idx = m_pending_count++;
+    std::copy(features.begin(), features.end(), m_inputs.begin() + static_cast<size_t>(slot_idx) * FEATURE_COUNT);
+    m_requests[slot_idx] = &rOutput;
+    m_player_counts[slot_idx] = rGame.player_count;
+
+    if (m_pending_count >= std::min(std::max(1, m_client_count), m_max_batch_size)) {
+        RunBatch();
+        return true;
+    }
+
+    // Wait for the batch to be completed, or evaluate it as it is
+    const uint64_t batch_idx = m_batch_count;
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                              std::chrono::duration<double, std::micro>(m_max_wait_us));
+    while (m_batch_count == batch_idx) {
+        if (m_batch_done.wait_until(lock, deadline) == std::cv_status::timeout && m_batch_count == batch_idx) {
+            RunBatch();
+        }
+    }
+
+    return true;
+}
+
+uint64_t lv::BatchedNetworkEvaluator::GetBatchCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_batch_count;
+}
+
+uint64_t lv::BatchedNetworkEvaluator::GetEvaluationCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_evaluation_count;
+}
+
+void lv::BatchedNetworkEvaluator::RunBatch()
+{
+    // Called with the lock held, the other clients of the batch are waiting anyway
+    m_network.Evaluate(m_inputs.data(), m_pending_count, m_outputs.data(), m_workspace);
+    for (int32_t slot_idx = 0; slot_idx < m_pending_count; ++slot_idx) {
+        NeuralNetwork::GetOutput(m_outputs.data() + static_cast<size_t>(slot_idx) * NETWORK_OUTPUT_COUNT,
+                                 m_player_counts[slot_idx], *m_requests[slot_idx]);
+    }
+
+    m_evaluation_count += m_pending_count;
+    m_pending_count = 0;
+    ++m_batch_count;
+    m_batch_done.notify_all();
+}
+
+bool lv::OpenSharedNeuralNetwork(const char* pPath)
+{
+    return GetSharedNetwork().Open(pPath);
+}
+
+const lv::NeuralNetwork* lv::GetSharedNeuralNetwork()
+{
+    const NeuralNetwork &rNetwork = GetSharedNetwork();
+    return rNetwork.IsOpen() ? &rNetwork : nullptr;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "LvFeatureEncoder.h"
+#include "LvPublic.h"
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace lv {
+
+// Value and policy network
+//
+// A small multilayer perceptron evaluated on the CPU without any dependency: the input is a row of LvFeatureEncoder.h,
+// dense layers follow, and the last one outputs a value logit for every seat (seen from the encoded player, see
+// EncodeFeatures) then a policy logit for every face. Weights are float or int8 with a float scale per output, int8
+// ones are converted and accumulated as float.
+//
+// Weights are stored input major, so a layer adds every input times its row of weights to the outputs: the loops over
+// the outputs are independent and vectorize, inputs at 0 (most features, and activations cut by ReLU) are skipped,
+// and every row of weights is applied to a block of batched inputs while it is in the cache.
+//
+// BatchedNetworkEvaluator gathers the evaluations of several search threads into one batch. The thread completing a
+// batch evaluates it for everyone, so that no thread is dedicated to the network.
+
+enum { NETWORK_VALUE_OUTPUT_COUNT = MAX_PLAYER_COUNT };
+enum { NETWORK_POLICY_OUTPUT_COUNT = CASINO_COUNT };
+enum { NETWORK_OUTPUT_COUNT = static_cast<int32_t>(NETWORK_VALUE_OUTPUT_COUNT) + NETWORK_POLICY_OUTPUT_COUNT };
+enum { NETWORK_MAX_LAYER_COUNT = 8 };
+enum { NETWORK_MAX_LAYER_SIZE = 1024 };
+
+// File: 32 bytes header ("LVNN", uint32 version, uint32 feature layout version, uint32 input count, uint32 layer
+// count, 12 reserved bytes), then every layer: 16 bytes header (uint32 input count, uint32 output count, uint32
+// weight type, uint32 activation), float biases, float scales for int8 weights, weights[input][output], zero padding
+// to a multiple of 4 bytes. Little endian.
+enum { NETWORK_FILE_VERSION = 1 };
+enum { NETWORK_FILE_HEADER_SIZE = 32 };
+enum { NETWORK_LAYER_HEADER_SIZE = 16 };
+
+enum class NetworkWeightType : uint32_t {
+    Float = 0,
+    Int8 = 1,
+};
+
+enum class NetworkActivation : uint32_t {
+    None = 0,
+    Relu = 1,
+};
+
+// Network outputs of one state, seats numbered from the encoded player
+struct NetworkOutput {
+    std::array<float, MAX_PLAYER_COUNT> win_shares{}; // Softmax over the seats of the table
+    std::array<float, CASINO_COUNT> policy{};         // Softmax over every face, legal or not
+};
+
+// Activations of a batch, kept between evaluations so that they only allocate once
+struct NetworkWorkspace {
+    std::vector<float> activations[2];
+};
+
+class NeuralNetwork {
+public:
+    bool Open(const char *pPath);
+    void Close();
+
+    bool IsOpen() const { return !m_layers.empty(); }
+    int32_t GetLayerCount() const { return static_cast<int32_t>(m_layers.size()); }
+
+    // Raw outputs of batch_size rows of FEATURE_COUNT inputs into batch_size rows of NETWORK_OUTPUT_COUNT outputs
+    void Evaluate(const float *pInputs, int32_t batch_size, float *pOutputs, NetworkWorkspace &rWorkspace) const;
+
+    // Softmaxes of one row of raw outputs
+    static void GetOutput(const float *pRawOutputs, int32_t player_count, NetworkOutput &rOutput);
+
+private:
+    struct Layer {
+        int32_t input_count = 0;
+        int32_t output_count = 0;
+        NetworkWeightType weight_type = NetworkWeightType::Float;
+        NetworkActivation activation = NetworkActivation::None;
+        std::vector<float> biases;
+        std::vector<float> scales;
+        std::vector<float> weights;
+        std::vector<int8_t> int8_weights;
+    };
+
+    static void EvaluateLayer(const Layer &rLayer, const float *pInputs, int32_t batch_size, float *pOutputs);
+
+    std::vector<Layer> m_layers;
+    int32_t m_max_layer_size = 0;
+};
+
+// Evaluations of several threads batched together
+//
+// Clients are the threads that may be waiting on an evaluation. A batch is evaluated once every client has a request
+// in it, once it holds max_batch_size requests, or by the first request waiting more than max_wait_us, so a client
+// that goes away or stops evaluating only slows the others down for that long.
+class BatchedNetworkEvaluator {
+public:
+    BatchedNetworkEvaluator(const NeuralNetwork &rNetwork, int32_t max_batch_size, double max_wait_us = 200.0);
+
+    void AddClient();
+    void RemoveClient();
+
+    // Outputs of rGame seen by perspective_idx, fails if the state can't be encoded
+    bool Evaluate(const CompactGameState &rGame, PlayerIdx perspective_idx, NetworkOutput &rOutput);
+
+    uint64_t GetBatchCount() const;
+    uint64_t GetEvaluationCount() const;
+
+private:
+    void RunBatch();
+
+    const NeuralNetwork &m_network;
+    const int32_t m_max_batch_size;
+    const double m_max_wait_us;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_batch_done;
+    int32_t m_client_count = 0;
+    int32_t m_pending_count = 0;
+    uint64_t m_batch_count = 0; // Also identifies the batch being filled
+    uint64_t m_evaluation_count = 0;
+
+    std::vector<float> m_inputs;
+    std::vector<float> m_outputs;
+    std::vector<NetworkOutput *> m_requests;
+    std::vector<int32_t> m_player_counts;
+    NetworkWorkspace m_workspace;
+};
+
+// Network shared by the search agents of the process, opened once at startup
+bool OpenSharedNeuralNetwork(const char *pPath);
+const NeuralNetwork *GetSharedNeuralNetwork();
+
+} // namespace lv
@@ -3,14 +3,13 @@
 #include <cstdint>
 #include <vector>
 #include <array>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
 
 namespace lv {
 
-enum { MAX_PLAYER_COUNT = 5 };
 enum { CASINO_COUNT = 6 };
-enum { DICE_COUNT = 8};
-enum { ROUND_COUNT = 4};
-enum { CASINO_MIN_MONEY_VALUE = 50};
 
 enum class DiceValue : int32_t {
     Invalid = 0,
@@ -29,11 +28,15 @@ enum class Color : int32_t {
     Green = 3,
     Black = 4,
     White = 5,
+    Yellow = 6, // Sixth seat of the variants with more players than the standard game
 };
 
 constexpr DiceValue DICE_VALUE_MIN = DiceValue::_1;
 constexpr DiceValue DICE_VALUE_MAX = DiceValue::_6;
 
+constexpr Color COLOR_MIN = Color::Red;
+constexpr Color COLOR_MAX = Color::Yellow;
+
 static_assert(CASINO_COUNT == static_cast<int32_t>(DICE_VALUE_MAX),
               "CASINO_COUNT must be equal to DICE_VALUE_MAX");
 
@@ -54,33 +57,208 @@ enum class Bill : int32_t {
     _90 = 90,
 };
 
+// Containers of GameState
+//
+// They take their memory from a std::pmr::memory_resource, the default one unless the state is built with an
+// allocator, e.g. on a std::pmr::unsynchronized_pool_resource owned by a worker thread so that games don't go through
+// the global heap and its locks. Every container of a state uses the state's resource, players added later included,
+// and keeps it when assigned. Copies constructed without an allocator use the default resource.
+
+using StateAllocator = std::pmr::polymorphic_allocator<std::byte>;
+using BillVector = std::pmr::vector<Bill>;
+using DiceVector = std::pmr::vector<DiceValue>;
+
 struct PlayerState {
+    using allocator_type = StateAllocator;
+
     PlayerIdx idx = 0;
     Color color = Color::Invalid;
-    std::vector<Bill> bills;
+    BillVector bills;
     int32_t dices = 0;
     int32_t white_dices = 0;
+
+    PlayerState() = default;
+    PlayerState(const PlayerState &) = default;
+    PlayerState(PlayerState &&) = default;
+    explicit PlayerState(const allocator_type &rAllocator) : bills(rAllocator) {}
+    PlayerState(const PlayerState &rOther, const allocator_type &rAllocator)
+        : idx(rOther.idx), color(rOther.color), bills(rOther.bills, rAllocator), dices(rOther.dices),
+          white_dices(rOther.white_dices) {}
+    PlayerState(PlayerState &&rOther, const allocator_type &rAllocator)
+        : idx(rOther.idx), color(rOther.color), bills(std::move(rOther.bills), rAllocator), dices(rOther.dices),
+          white_dices(rOther.white_dices) {}
+
+    PlayerState &operator=(const PlayerState &) = default;
+    PlayerState &operator=(PlayerState &&) = default;
 };
 
 struct NeutralPlayerState {
-    std::vector<Bill> bills;
+    using allocator_type = StateAllocator;
+
+    BillVector bills;
+
+    NeutralPlayerState() = default;
+    explicit NeutralPlayerState(const allocator_type &rAllocator) : bills(rAllocator) {}
+};
+
+// Number of bill denominations, bills are indexed from 0 (Bill::_10) to BILL_TYPE_COUNT - 1 (Bill::_90)
+enum { BILL_TYPE_COUNT = 9 };
+
+struct BankEntry {
+    Bill bill = Bill::Invalid;
+    int32_t count = 0;
+};
+
+struct ExtraWhiteDiceEntry {
+    int32_t player_count = 0;
+    int32_t white_dice_count = 0;
+};
+
+// Rules of a game variant
+//
+// GameEngine, RulesChecker and the state types are templates on the rules, named Basic*, so that every variant gets
+// its own code with the rules folded into constants. The names without the prefix and the constants below are the
+// standard game's. Casinos stay one per face of a dice and bills go from 10 to 90.
+// Every variant is compiled in, see LV_FOR_EACH_RULES.
+
+enum { RULES_MAX_PLAYER_COUNT_LIMIT = 8 }; // Player masks and engine events hold this many players
+
+struct RulesConfig {
+    const char *pName = nullptr;
+    int32_t max_player_count = 0;
+    int32_t dice_count = 0; // Dices of every player
+    int32_t round_count = 0;
+    int32_t casino_min_money_value = 0;
+    std::array<BankEntry, BILL_TYPE_COUNT> bank_init_stock{};
+
+    // White dices of every player, the neutral player is only there when they get some
+    std::array<ExtraWhiteDiceEntry, RULES_MAX_PLAYER_COUNT_LIMIT - 1> extra_white_dices{};
+};
+
+inline constexpr RulesConfig STANDARD_RULES = {
+    "standard", 5, 8, 4, 50,
+    {{{Bill::_10, 6}, {Bill::_20, 8}, {Bill::_30, 8}, {Bill::_40, 6}, {Bill::_50, 6}, {Bill::_60, 5}, {Bill::_70, 5},
+      {Bill::_80, 5}, {Bill::_90, 5}}},
+    {{{2, 4}, {3, 2}, {4, 2}, {5, 0}}},
+};
+
+// Casinos worth at least 70 out of a bank heavy in high bills
+inline constexpr RulesConfig BIG_MONEY_RULES = {
+    "big-money", 5, 8, 4, 70,
+    {{{Bill::_10, 4}, {Bill::_20, 6}, {Bill::_30, 6}, {Bill::_40, 6}, {Bill::_50, 6}, {Bill::_60, 8}, {Bill::_70, 8},
+      {Bill::_80, 8}, {Bill::_90, 8}}},
+    {{{2, 4}, {3, 2}, {4, 2}, {5, 0}}},
+};
+
+// Up to 6 players, without the neutral player from 5 players on
+inline constexpr RulesConfig SIX_PLAYER_RULES = {
+    "six-player", 6, 8, 4, 50,
+    {{{Bill::_10, 6}, {Bill::_20, 8}, {Bill::_30, 8}, {Bill::_40, 6}, {Bill::_50, 6}, {Bill::_60, 5}, {Bill::_70, 5},
+      {Bill::_80, 5}, {Bill::_90, 5}}},
+    {{{2, 4}, {3, 2}, {4, 2}, {5, 0}, {6, 0}}},
+};
+
+// Three longer rounds of 10 dices per player
+inline constexpr RulesConfig TEN_DICE_RULES = {
+    "ten-dice", 5, 10, 3, 50,
+    {{{Bill::_10, 6}, {Bill::_20, 8}, {Bill::_30, 8}, {Bill::_40, 6}, {Bill::_50, 6}, {Bill::_60, 5}, {Bill::_70, 5},
+      {Bill::_80, 5}, {Bill::_90, 5}}},
+    {{{2, 4}, {3, 2}, {4, 2}, {5, 0}}},
 };
 
-struct CasinoState {
+// Calls X(rules) for every variant, to instantiate the templates on each of them
+#define LV_FOR_EACH_RULES(X) \
+    X(STANDARD_RULES)        \
+    X(BIG_MONEY_RULES)       \
+    X(SIX_PLAYER_RULES)      \
+    X(TEN_DICE_RULES)
+
+constexpr int32_t GetBankInitBillCount(const RulesConfig &rRules) {
+    int32_t count = 0;
+    for (const BankEntry &rEntry : rRules.bank_init_stock) {
+        count += rEntry.count;
+    }
+    return count;
+}
+
+constexpr int32_t GetExtraWhiteDiceCount(const RulesConfig &rRules, int32_t player_count) {
+    for (const ExtraWhiteDiceEntry &rEntry : rRules.extra_white_dices) {
+        if (player_count == rEntry.player_count) {
+            return rEntry.white_dice_count;
+        }
+    }
+    return 0;
+}
+
+// Constants of a variant, rules that can't hold in the state types are rejected here
+template <const RulesConfig &RULES> struct RulesTraits {
+    static_assert(RULES.max_player_count >= 2 && RULES.max_player_count <= RULES_MAX_PLAYER_COUNT_LIMIT,
+                  "Player count out of range");
+    static_assert(RULES.max_player_count <= static_cast<int32_t>(COLOR_MAX),
+                  "Player colors are seat indices + 1, every seat needs a color");
+    static_assert(RULES.dice_count > 0 && RULES.dice_count < 128, "Dice counts are stored in bytes");
+    static_assert(RULES.round_count > 0, "A game needs a round");
+
+    enum : int32_t {
+        MAX_PLAYER_COUNT = RULES.max_player_count,
+        DICE_COUNT = RULES.dice_count,
+        ROUND_COUNT = RULES.round_count,
+        CASINO_MIN_MONEY_VALUE = RULES.casino_min_money_value,
+        BANK_BILL_COUNT = GetBankInitBillCount(RULES),
+        CASINO_NEUTRAL_WINNER = MAX_PLAYER_COUNT, // Bidder index of the neutral player
+        CASINO_BIDDER_COUNT = MAX_PLAYER_COUNT + 1,
+    };
+
+    static_assert(BANK_BILL_COUNT <= 255, "Bank bill counts are stored in bytes");
+
+    static constexpr const std::array<BankEntry, BILL_TYPE_COUNT> &BANK_INIT_STOCK_TABLE = RULES.bank_init_stock;
+
+    static constexpr int32_t GetExtraWhiteDiceCount(int32_t player_count) {
+        return lv::GetExtraWhiteDiceCount(RULES, player_count);
+    }
+    static constexpr bool IsNeutralPlayerPresent(int32_t player_count) {
+        return GetExtraWhiteDiceCount(player_count) > 0;
+    }
+};
+
+using StandardRulesTraits = RulesTraits<STANDARD_RULES>;
+
+enum { MAX_PLAYER_COUNT = StandardRulesTraits::MAX_PLAYER_COUNT };
+enum { DICE_COUNT = StandardRulesTraits::DICE_COUNT };
+enum { ROUND_COUNT = StandardRulesTraits::ROUND_COUNT };
+enum { CASINO_MIN_MONEY_VALUE = StandardRulesTraits::CASINO_MIN_MONEY_VALUE };
+enum { BANK_BILL_COUNT = StandardRulesTraits::BANK_BILL_COUNT };
+
+inline constexpr const std::array<BankEntry, BILL_TYPE_COUNT> &BANK_INIT_STOCK_TABLE = STANDARD_RULES.bank_init_stock;
+inline constexpr const auto &EXTRA_WHITE_DICE_COUNT_TABLE = STANDARD_RULES.extra_white_dices;
+
+template <const RulesConfig &RULES> struct BasicCasinoState {
+    using allocator_type = StateAllocator;
+
     CasinoIdx idx = 0;
     DiceValue dice = DiceValue::Invalid;
-    std::vector<Bill> bills;
-    std::array<int32_t, MAX_PLAYER_COUNT> dice_bets{};
+    BillVector bills;
+    std::array<int32_t, RulesTraits<RULES>::MAX_PLAYER_COUNT> dice_bets{};
     int32_t neutral_dice_bet = 0;
+
+    BasicCasinoState() = default;
+    explicit BasicCasinoState(const allocator_type &rAllocator) : bills(rAllocator) {}
 };
 
 struct PlayerTurnState {
+    using allocator_type = StateAllocator;
+
     PlayerIdx player_idx = 0;
-    std::vector<DiceValue> dices;
-    std::vector<DiceValue> white_dices;
+    DiceVector dices;
+    DiceVector white_dices;
+
+    PlayerTurnState() = default;
+    explicit PlayerTurnState(const allocator_type &rAllocator) : dices(rAllocator), white_dices(rAllocator) {}
 };
 
-struct GameState {
+template <const RulesConfig &RULES> struct BasicGameState {
+    using allocator_type = StateAllocator;
+
     int32_t round = 0;
 
     PlayerIdx first_player_idx = 0;
@@ -88,41 +266,159 @@ struct GameState {
     int32_t player_count = 0;
     bool neutral_player_present = false;
 
-    std::vector<PlayerState> players{};
-    std::array<CasinoState, CASINO_COUNT> casinos{};
+    std::pmr::vector<PlayerState> players{};
+    std::array<BasicCasinoState<RULES>, CASINO_COUNT> casinos{};
     NeutralPlayerState neutral_player{};
 
     PlayerTurnState current_turn{};
 
-    std::vector<Bill> bank{};  
+    BillVector bank{};
+
+    uint64_t hash = 0; // See LvStateHash.h
+
+    BasicGameState() = default;
+    explicit BasicGameState(const allocator_type &rAllocator)
+        : players(rAllocator), casinos(MakeCasinos(rAllocator, std::make_index_sequence<CASINO_COUNT>{})),
+          neutral_player(rAllocator), current_turn(rAllocator), bank(rAllocator) {}
+
+    // Empty state of player_count players, as left by SetupInitGameState before it deals anything. Containers are
+    // cleared in place and keep their capacity, so that a worker playing game after game on one state stops
+    // allocating after the first games.
+    void Reset(int32_t player_count) {
+        round = 0;
+        first_player_idx = 0;
+        this->player_count = 0;
+        neutral_player_present = false;
+        players.resize(player_count);
+        for (PlayerState &rPlayer : players) {
+            rPlayer.idx = 0;
+            rPlayer.color = Color::Invalid;
+            rPlayer.bills.clear();
+            rPlayer.dices = 0;
+            rPlayer.white_dices = 0;
+        }
+        for (BasicCasinoState<RULES> &rCasino : casinos) {
+            rCasino.idx = 0;
+            rCasino.dice = DiceValue::Invalid;
+            rCasino.bills.clear();
+            rCasino.dice_bets.fill(0);
+            rCasino.neutral_dice_bet = 0;
+        }
+        neutral_player.bills.clear();
+        current_turn.player_idx = 0;
+        current_turn.dices.clear();
+        current_turn.white_dices.clear();
+        bank.clear();
+        hash = 0;
+    }
+
+private:
+    template <size_t... CASINO_INDICES>
+    static std::array<BasicCasinoState<RULES>, CASINO_COUNT> MakeCasinos(const allocator_type &rAllocator,
+                                                                        std::index_sequence<CASINO_INDICES...>) {
+        return {((void)CASINO_INDICES, BasicCasinoState<RULES>(rAllocator))...};
+    }
 };
 
-struct BankEntry {
-    Bill bill = Bill::Invalid;
-    int32_t count = 0;
+using CasinoState = BasicCasinoState<STANDARD_RULES>;
+using GameState = BasicGameState<STANDARD_RULES>;
+
+// Compact game state
+//
+// Fixed-size and trivially copyable variant of GameState meant for hot simulation loops, copying it is a plain memcpy.
+// Bills are stored as per-denomination counts, dices as per-face counts and the bank as an array of bill indices.
+// Players and casinos are implicitly indexed by their position, player colors are always idx + 1.
+
+using BillCounts = std::array<uint8_t, BILL_TYPE_COUNT>;
+using DiceCounts = std::array<uint8_t, CASINO_COUNT>;
+
+struct CompactPlayerState {
+    BillCounts bills{};
+    int8_t dices = 0;
+    int8_t white_dices = 0;
+
+    bool operator==(const CompactPlayerState &) const = default;
 };
-constexpr BankEntry BANK_INIT_STOCK_TABLE[] = {
-    {Bill::_10, 6},
-    {Bill::_20, 8},
-    {Bill::_30, 8},
-    {Bill::_40, 6},
-    {Bill::_50, 6},
-    {Bill::_60, 5},
-    {Bill::_70, 5},
-    {Bill::_80, 5},
-    {Bill::_90, 5},
+
+template <const RulesConfig &RULES> struct BasicCompactCasinoState {
+    BillCounts bills{};
+    std::array<int8_t, RulesTraits<RULES>::MAX_PLAYER_COUNT> dice_bets{};
+    int8_t neutral_dice_bet = 0;
+
+    bool operator==(const BasicCompactCasinoState &) const = default;
 };
 
-struct ExtraWhiteDiceEntry {
+struct CompactPlayerTurnState {
+    PlayerIdx player_idx = 0;
+    DiceCounts dices{};       // Number of rolled player dices per face, face 1 at index 0
+    DiceCounts white_dices{}; // Number of rolled white dices per face, face 1 at index 0
+
+    bool operator==(const CompactPlayerTurnState &) const = default;
+};
+
+template <const RulesConfig &RULES> struct BasicCompactGameState {
+    int32_t round = 0;
+
+    PlayerIdx first_player_idx = 0;
+
     int32_t player_count = 0;
-    int32_t white_dice_count = 0;
+    bool neutral_player_present = false;
+
+    std::array<CompactPlayerState, RulesTraits<RULES>::MAX_PLAYER_COUNT> players{};
+    std::array<BasicCompactCasinoState<RULES>, CASINO_COUNT> casinos{};
+    BillCounts neutral_player_bills{};
+
+    CompactPlayerTurnState current_turn{};
+
+    // Bill indices, the top of the bank is at bank[bank_size - 1]
+    int32_t bank_size = 0;
+    std::array<uint8_t, RulesTraits<RULES>::BANK_BILL_COUNT> bank{};
+
+    uint64_t hash = 0; // See LvStateHash.h
+
+    bool operator==(const BasicCompactGameState &) const = default;
+};
+
+using CompactCasinoState = BasicCompactCasinoState<STANDARD_RULES>;
+using CompactGameState = BasicCompactGameState<STANDARD_RULES>;
+
+static_assert(std::is_trivially_copyable_v<CompactGameState>, "CompactGameState must be trivially copyable");
+
+// Legal moves of a turn
+//
+// A move allocates every rolled dice of one value, so there is at most one legal move per face.
+
+struct LegalMove {
+    DiceValue dice = DiceValue::Invalid;
+    uint8_t dice_count = 0;       // Player dices allocated by the move
+    uint8_t white_dice_count = 0; // White dices allocated by the move
 };
 
-constexpr ExtraWhiteDiceEntry EXTRA_WHITE_DICE_COUNT_TABLE[] = {
-    {2, 4},
-    {3, 2},
-    {4, 2},
-    {5, 0},
+struct LegalMoveList {
+    std::array<LegalMove, CASINO_COUNT> moves{};
+    int32_t count = 0;
+};
+
+// Parts of a compact game state modified by GameEngine calls, see GameEngine::SetChangeTracker
+struct StateChanges {
+    enum : uint32_t {
+        BANK = 1 << 0,
+        NEUTRAL_PLAYER = 1 << 1,
+        TURN = 1 << 2,
+        HEADER = 1 << 3, // Round, player count, first player
+    };
+
+    uint32_t casino_mask = 0; // One bit per casino
+    uint32_t player_mask = 0; // One bit per player
+    uint32_t flags = 0;
+
+    static constexpr StateChanges All() {
+        return {(1u << CASINO_COUNT) - 1, (1u << RULES_MAX_PLAYER_COUNT_LIMIT) - 1,
+                BANK | NEUTRAL_PLAYER | TURN | HEADER};
+    }
+
+    bool Any() const { return casino_mask != 0 || player_mask != 0 || flags != 0; }
+    void Clear() { *this = {}; }
 };
 
 } // namespace lv
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace lv {
+
+// Small and fast seedable random number generator (xoshiro256**)
+//
+// Satisfies UniformRandomBitGenerator so it can be used with the standard algorithms, but the engine uses NextBelow
+// and its own shuffle so that a given seed produces the same game on every platform and standard library.
+class Rng {
+public:
+    using result_type = uint64_t;
+    using StateType = std::array<uint64_t, 4>;
+
+    constexpr Rng() { Seed(0); }
+    constexpr explicit Rng(uint64_t seed) { Seed(seed); }
+
+    // Expand a 64-bit seed into the full generator state with splitmix64
+    constexpr void Seed(uint64_t seed) {
+        for (uint64_t &rWord : m_state) {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            rWord = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() {
+        const uint64_t result = Rotl(m_state[1] * 5, 7) * 9;
+        const uint64_t t = m_state[1] << 17;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = Rotl(m_state[3], 45);
+
+        return result;
+    }
+
+    // Uniform value in [0, bound), bound must not be 0 (Lemire's multiply-shift with rejection)
+    constexpr uint32_t NextBelow(uint32_t bound) {
+        uint64_t product = ((*this)() >> 32) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            const uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                product = ((*this)() >> 32) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // Raw state access, used to snapshot and restore the generator
+    constexpr const StateType &GetState() const { return m_state; }
+    constexpr void SetState(const StateType &rState) { m_state = rState; }
+
+    constexpr bool operator==(const Rng &) const = default;
+
+private:
+    static constexpr uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    StateType m_state{};
+};
+
+// Fisher-Yates shuffle driven by Rng::NextBelow, portable unlike std::shuffle
+template <typename T> constexpr void Shuffle(T *pBegin, int32_t count, Rng &rRng) {
+    for (int32_t i = count - 1; i > 0; --i) {
+        const int32_t j = static_cast<int32_t>(rRng.NextBelow(static_cast<uint32_t>(i + 1)));
+        T tmp = pBegin[i];
+        pBegin[i] = pBegin[j];
+        pBegin[j] = tmp;
+    }
+}
+
+} // namespace lv
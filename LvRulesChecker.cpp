@@ -5,23 +5,63 @@
 #include <array>
 #include <vector>
 #include <algorithm>
-#include <set>
 
-bool lv::RulesChecker::ValidateGameState(const GameState& rGame) const
+const char *lv::GetRulesViolationName(RulesViolation violation)
+{
+    switch (violation) {
+    case RulesViolation::None: return "None";
+    case RulesViolation::PlayerCount: return "PlayerCount";
+    case RulesViolation::PlayerVectorSize: return "PlayerVectorSize";
+    case RulesViolation::NeutralPlayerPresence: return "NeutralPlayerPresence";
+    case RulesViolation::PlayerDiceCount: return "PlayerDiceCount";
+    case RulesViolation::NeutralDiceCount: return "NeutralDiceCount";
+    case RulesViolation::BankSize: return "BankSize";
+    case RulesViolation::BillCount: return "BillCount";
+    case RulesViolation::PlayerIndex: return "PlayerIndex";
+    case RulesViolation::CasinoIndex: return "CasinoIndex";
+    case RulesViolation::FirstPlayerIndex: return "FirstPlayerIndex";
+    case RulesViolation::CurrentPlayerIndex: return "CurrentPlayerIndex";
+    case RulesViolation::TurnDiceCount: return "TurnDiceCount";
+    case RulesViolation::TurnWhiteDiceCount: return "TurnWhiteDiceCount";
+    case RulesViolation::PlayerColor: return "PlayerColor";
+    case RulesViolation::WhitePlayerColor: return "WhitePlayerColor";
+    case RulesViolation::CasinoDiceValue: return "CasinoDiceValue";
+    case RulesViolation::NegativeRound: return "NegativeRound";
+    case RulesViolation::RoundCount: return "RoundCount";
+    case RulesViolation::CasinoMoneyValue: return "CasinoMoneyValue";
+    case RulesViolation::NegativeDiceCount: return "NegativeDiceCount";
+    }
+    return "Unknown";
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicRulesChecker<RULES>::ValidateGameState(const GameState& rGame) const
+{
+    return CheckGameState(rGame) == RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+bool lv::BasicRulesChecker<RULES>::ValidateGameState(const CompactGameState& rGame) const
+{
+    return CheckGameState(rGame) == RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicRulesChecker<RULES>::CheckGameState(const GameState& rGame) const
 {
     // It's a game for 2-5 players
     if (rGame.player_count < 2 || rGame.player_count > MAX_PLAYER_COUNT) {
-        return false;
+        return RulesViolation::PlayerCount;
     }
 
     // The players vector must have the correct size
-    if (rGame.players.size() != rGame.player_count) {
-        return false;
+    if (rGame.players.size() != static_cast<size_t>(rGame.player_count)) {
+        return RulesViolation::PlayerVectorSize;
     }
 
-    // Neutral player is present only if there's less than 5 players
-    if (rGame.neutral_player_present && rGame.player_count == MAX_PLAYER_COUNT) {
-        return false;
+    // Neutral player is present only if players get white dices, when there's less than 5 players
+    if (rGame.neutral_player_present && !Rules::IsNeutralPlayerPresent(rGame.player_count)) {
+        return RulesViolation::NeutralPlayerPresence;
     }
 
     // Each active player has 8 dices, which must either be in player's stock or in a casino
@@ -35,21 +75,14 @@ bool lv::RulesChecker::ValidateGameState(const GameState& rGame) const
         }
 
         if (dices != DICE_COUNT) {
-            return false;
+            return RulesViolation::PlayerDiceCount;
         }
     }
 
     // Compute the expected neutral player dice count
-    int32_t neutral_dices = 0;
-    for (const ExtraWhiteDiceEntry& rEntry : EXTRA_WHITE_DICE_COUNT_TABLE) {
-        if (rGame.player_count == rEntry.player_count) {
-            neutral_dices = rEntry.white_dice_count * rGame.player_count;
-            break;
-        }
-    }
+    const int32_t neutral_dices = GetExtraWhiteDiceCount(rGame.player_count) * rGame.player_count;
 
     // The neutral dices must either be in a player stocks's or allocated to a casino
-    PlayerIdx neutral_player_idx = rGame.player_count + 1;
     if (rGame.neutral_player_present) {
         int32_t dices = 0;
         for (const auto &rCasino : rGame.casinos) {
@@ -59,131 +92,528 @@ bool lv::RulesChecker::ValidateGameState(const GameState& rGame) const
             dices += rPlayer.white_dices;
         }
         if (dices != neutral_dices) {
-            return false;
+            return RulesViolation::NeutralDiceCount;
         }
     }
 
     // Each bank note bill must be either in the bank, in a casino or in a player's stock
-    for (const BankEntry& rInitBankEntry : BANK_INIT_STOCK_TABLE) {
-        const size_t expected_count = rInitBankEntry.count;
-        const Bill bill = rInitBankEntry.bill;
-
-        size_t current_count = 0;
-
-        // Check bank
-        current_count = std::count(rGame.bank.begin(), rGame.bank.end(), bill);
-
-        // Check casinos
-        for (const CasinoState &rCasino : rGame.casinos) {
-            for (const Bill &rCasinoBill : rCasino.bills) {
-                if (rCasinoBill == bill) {
-                    ++current_count;
-                }
+    std::array<int32_t, BILL_TYPE_COUNT> bill_counts{};
+    bool unknown_bill = false;
+    const auto count_bills = [&](const BillVector &rBills) {
+        for (const Bill bill : rBills) {
+            const int32_t bill_idx = GetBillIndex(bill);
+            if (bill_idx < 0 || bill_idx >= BILL_TYPE_COUNT) {
+                unknown_bill = true;
+                continue;
             }
+            ++bill_counts[bill_idx];
         }
+    };
 
-        // Check players
-        for (const PlayerState &rPlayer : rGame.players) {
-            for (const Bill &rPlayerBill : rPlayer.bills) {
-                if (rPlayerBill == bill) {
-                    ++current_count;
-                }
-            }
-        }
-
-        // Check neutral player
-        for (const Bill &rNeutralPlayerBill : rGame.neutral_player.bills) {
-            if (rNeutralPlayerBill == bill) {
-                ++current_count;
-            }
-        }
+    count_bills(rGame.bank);
+    for (const CasinoState &rCasino : rGame.casinos) {
+        count_bills(rCasino.bills);
+    }
+    for (const PlayerState &rPlayer : rGame.players) {
+        count_bills(rPlayer.bills);
+    }
+    count_bills(rGame.neutral_player.bills);
 
-        // Check if the count is correct
-        if (current_count != expected_count) {
-            return false;
+    if (unknown_bill) {
+        return RulesViolation::BillCount;
+    }
+    for (const BankEntry& rInitBankEntry : BANK_INIT_STOCK_TABLE) {
+        if (bill_counts[GetBillIndex(rInitBankEntry.bill)] != rInitBankEntry.count) {
+            return RulesViolation::BillCount;
         }
     }
 
     // Players index must match the index in the game state
     for (PlayerIdx player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
         if (rGame.players[player_idx].idx != player_idx) {
-            return false;
+            return RulesViolation::PlayerIndex;
         }
     }
 
     // Casinos index must match the index in the game state
     for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
         if (rGame.casinos[casino_idx].idx != casino_idx) {
-            return false;
+            return RulesViolation::CasinoIndex;
         }
     }
 
     // The first player index must be a valid player index
     if (rGame.first_player_idx < 0 || rGame.first_player_idx >= rGame.players.size()) {
-        return false;
+        return RulesViolation::FirstPlayerIndex;
     }
 
     // The current turn player index must be a valid player index
     if (rGame.current_turn.player_idx < 0 || rGame.current_turn.player_idx >= rGame.players.size()) {
-        return false;
+        return RulesViolation::CurrentPlayerIndex;
     }
 
     // The current turn player must have the correct number of dices
-    if (rGame.current_turn.dices.size() != rGame.players[rGame.current_turn.player_idx].dices) {
-        return false;
+    const PlayerState &rTurnPlayer = rGame.players[rGame.current_turn.player_idx];
+    if (rGame.current_turn.dices.size() != static_cast<size_t>(rTurnPlayer.dices)) {
+        return RulesViolation::TurnDiceCount;
     }
 
     // The current turn player must have the correct number of white dices
-    if (rGame.current_turn.white_dices.size() != rGame.players[rGame.current_turn.player_idx].white_dices) {
-        return false;
+    if (rGame.current_turn.white_dices.size() != static_cast<size_t>(rTurnPlayer.white_dices)) {
+        return RulesViolation::TurnWhiteDiceCount;
     }
 
-    // Each player must have an unique color
-    std::set<Color> colors;
+    // Each player must have a valid and unique color
+    uint32_t color_mask = 0;
     for (const PlayerState &rPlayer : rGame.players) {
-        if (colors.find(rPlayer.color) != colors.end()) {
-            return false;
+        if (rPlayer.color < COLOR_MIN || rPlayer.color > COLOR_MAX) {
+            return RulesViolation::PlayerColor;
+        }
+        const uint32_t color_bit = 1u << static_cast<uint32_t>(rPlayer.color);
+        if (color_mask & color_bit) {
+            return RulesViolation::PlayerColor;
         }
-        colors.insert(rPlayer.color);
+        color_mask |= color_bit;
     }
 
     // If neutral player is present, then no player can be white
     if (rGame.neutral_player_present) {
-        if (colors.find(Color::White) != colors.end()) {
-            return false;
+        if (color_mask & (1u << static_cast<uint32_t>(Color::White))) {
+            return RulesViolation::WhitePlayerColor;
         }
     }
 
     // Each casino dice value must match it's index
     for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
         if (rGame.casinos[casino_idx].dice != static_cast<DiceValue>(casino_idx + 1)) {
-            return false;
+            return RulesViolation::CasinoDiceValue;
         }
     }
 
     // Game's round must be positive
     if (rGame.round < 0) {
-        return false;
+        return RulesViolation::NegativeRound;
     }
 
     // Game's round must be less than the round count
     if (rGame.round >= ROUND_COUNT) {
-        return false;
+        return RulesViolation::RoundCount;
     }
 
     // Casino value must be at least 50
     for (const CasinoState &rCasino : rGame.casinos) {
         if (GetCasinoMoneyValue(rCasino) < CASINO_MIN_MONEY_VALUE) {
-            return false;
+            return RulesViolation::CasinoMoneyValue;
         }
     }
 
     // Players cannot have a negative amount of dices or white dices
     for (const PlayerState &rPlayer : rGame.players) {
         if (rPlayer.dices < 0 || rPlayer.white_dices < 0) {
-            return false;
+            return RulesViolation::NegativeDiceCount;
+        }
+    }
+
+    return RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicRulesChecker<RULES>::CheckGameState(const CompactGameState& rGame) const
+{
+    return CheckCompactGameState(rGame, false);
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicRulesChecker<RULES>::CheckFinalGameState(const CompactGameState& rGame) const
+{
+    return CheckCompactGameState(rGame, true);
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicRulesChecker<RULES>::CheckCompactGameState(const CompactGameState& rGame,
+                                                                       bool game_over) const
+{
+    // It's a game for 2-5 players
+    if (rGame.player_count < 2 || rGame.player_count > MAX_PLAYER_COUNT) {
+        return RulesViolation::PlayerCount;
+    }
+
+    // Neutral player is present only if players get white dices, when there's less than 5 players
+    if (rGame.neutral_player_present && !Rules::IsNeutralPlayerPresent(rGame.player_count)) {
+        return RulesViolation::NeutralPlayerPresence;
+    }
+
+    // Each active player has 8 dices, which must either be in player's stock or in a casino
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        int32_t dices = rGame.players[player_idx].dices;
+
+        for (const auto &rCasino : rGame.casinos) {
+            dices += rCasino.dice_bets[player_idx];
+        }
+
+        if (dices != DICE_COUNT) {
+            return RulesViolation::PlayerDiceCount;
+        }
+    }
+
+    // Compute the expected neutral player dice count
+    const int32_t neutral_dices = GetExtraWhiteDiceCount(rGame.player_count) * rGame.player_count;
+
+    // The neutral dices must either be in a player stocks's or allocated to a casino
+    if (rGame.neutral_player_present) {
+        int32_t dices = 0;
+        for (const auto &rCasino : rGame.casinos) {
+            dices += rCasino.neutral_dice_bet;
+        }
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            dices += rGame.players[player_idx].white_dices;
+        }
+        if (dices != neutral_dices) {
+            return RulesViolation::NeutralDiceCount;
+        }
+    }
+
+    // Each bank note bill must be either in the bank, in a casino or in a player's stock
+    if (rGame.bank_size < 0 || rGame.bank_size > BANK_BILL_COUNT) {
+        return RulesViolation::BankSize;
+    }
+
+    std::array<int32_t, BILL_TYPE_COUNT> bill_counts{};
+    for (int32_t bank_idx = 0; bank_idx < rGame.bank_size; ++bank_idx) {
+        if (rGame.bank[bank_idx] >= BILL_TYPE_COUNT) {
+            return RulesViolation::BankSize;
+        }
+        ++bill_counts[rGame.bank[bank_idx]];
+    }
+    for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+        for (const CompactCasinoState &rCasino : rGame.casinos) {
+            bill_counts[bill_idx] += rCasino.bills[bill_idx];
+        }
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            bill_counts[bill_idx] += rGame.players[player_idx].bills[bill_idx];
+        }
+        bill_counts[bill_idx] += rGame.neutral_player_bills[bill_idx];
+    }
+
+    for (const BankEntry &rInitBankEntry : BANK_INIT_STOCK_TABLE) {
+        if (bill_counts[GetBillIndex(rInitBankEntry.bill)] != rInitBankEntry.count) {
+            return RulesViolation::BillCount;
+        }
+    }
+
+    // The first player index must be a valid player index
+    if (rGame.first_player_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return RulesViolation::FirstPlayerIndex;
+    }
+
+    // The current turn player index must be a valid player index
+    if (rGame.current_turn.player_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return RulesViolation::CurrentPlayerIndex;
+    }
+
+    // The current turn player must have the correct number of dices and white dices, a finished game has no turn
+    // left and keeps the last roll
+    int32_t turn_dices = 0;
+    int32_t turn_white_dices = 0;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        turn_dices += rGame.current_turn.dices[face_idx];
+        turn_white_dices += rGame.current_turn.white_dices[face_idx];
+    }
+    if (!game_over && turn_dices != rGame.players[rGame.current_turn.player_idx].dices) {
+        return RulesViolation::TurnDiceCount;
+    }
+    if (!game_over && turn_white_dices != rGame.players[rGame.current_turn.player_idx].white_dices) {
+        return RulesViolation::TurnWhiteDiceCount;
+    }
+
+    // Game's round must be positive
+    if (rGame.round < 0) {
+        return RulesViolation::NegativeRound;
+    }
+
+    // Game's round must be less than the round count, and equal to it once the game is over
+    if (game_over ? rGame.round != ROUND_COUNT : rGame.round >= ROUND_COUNT) {
+        return RulesViolation::RoundCount;
+    }
+
+    // Casino value must be at least 50, every bill has been paid out once the game is over
+    for (const CompactCasinoState &rCasino : rGame.casinos) {
+        const int32_t money_value = GetCasinoMoneyValue(rCasino);
+        if (game_over ? money_value != 0 : money_value < CASINO_MIN_MONEY_VALUE) {
+            return RulesViolation::CasinoMoneyValue;
+        }
+    }
+
+    // Players cannot have a negative amount of dices or white dices
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        if (rGame.players[player_idx].dices < 0 || rGame.players[player_idx].white_dices < 0) {
+            return RulesViolation::NegativeDiceCount;
+        }
+    }
+
+    return RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::Reset(const CompactGameState& rGame)
+{
+    m_bank = {};
+    m_casinos = {};
+    m_players = {};
+    m_neutral_player = {};
+    m_totals = {};
+
+    RefreshBank(rGame);
+    for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        RefreshCasino(rGame, casino_idx);
+    }
+    for (PlayerIdx player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+        RefreshPlayer(rGame, player_idx);
+    }
+    RefreshNeutralPlayer(rGame);
+
+    return CheckFull(rGame);
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::Update(const CompactGameState& rGame,
+                                                                   const StateChanges& rChanges)
+{
+    // The player count decides which players take part in the totals, start over
+    if (rChanges.flags & StateChanges::HEADER) {
+        RulesViolation violation = Reset(rGame);
+        if (violation != RulesViolation::None) {
+            return violation;
+        }
+        return CheckHeader(rGame);
+    }
+
+    if (rChanges.flags & StateChanges::BANK) {
+        if (rGame.bank_size < 0 || rGame.bank_size > BANK_BILL_COUNT) {
+            return RulesViolation::BankSize;
+        }
+        for (int32_t bank_idx = 0; bank_idx < rGame.bank_size; ++bank_idx) {
+            if (rGame.bank[bank_idx] >= BILL_TYPE_COUNT) {
+                return RulesViolation::BankSize;
+            }
+        }
+        RefreshBank(rGame);
+    }
+    if (rChanges.flags & StateChanges::NEUTRAL_PLAYER) {
+        RefreshNeutralPlayer(rGame);
+    }
+    for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        if (rChanges.casino_mask & (1u << casino_idx)) {
+            RefreshCasino(rGame, casino_idx);
+        }
+    }
+    for (PlayerIdx player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+        if (rChanges.player_mask & (1u << player_idx)) {
+            RefreshPlayer(rGame, player_idx);
+        }
+    }
+
+    RulesViolation violation = CheckTotals(rGame);
+    if (violation != RulesViolation::None) {
+        return violation;
+    }
+
+    // Per part invariants, only for what changed
+    for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        if (rChanges.casino_mask & (1u << casino_idx)) {
+            violation = CheckCasino(rGame, casino_idx);
+            if (violation != RulesViolation::None) {
+                return violation;
+            }
+        }
+    }
+    for (PlayerIdx player_idx = 0; player_idx < static_cast<PlayerIdx>(rGame.player_count); ++player_idx) {
+        if (rChanges.player_mask & (1u << player_idx)) {
+            violation = CheckPlayer(rGame, player_idx);
+            if (violation != RulesViolation::None) {
+                return violation;
+            }
+        }
+    }
+
+    // The turn depends on the current player's stock as well
+    const PlayerIdx current_player_idx = rGame.current_turn.player_idx;
+    const bool current_player_changed =
+        current_player_idx < MAX_PLAYER_COUNT && (rChanges.player_mask & (1u << current_player_idx)) != 0;
+    if ((rChanges.flags & StateChanges::TURN) || current_player_changed) {
+        return CheckTurn(rGame);
+    }
+
+    return RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::CheckFull(const CompactGameState& rGame) const
+{
+    return BasicRulesChecker<RULES>().CheckGameState(rGame);
+}
+
+template <const lv::RulesConfig &RULES>
+void lv::BasicIncrementalRulesChecker<RULES>::RefreshBank(const CompactGameState& rGame)
+{
+    Contribution contribution{};
+    const int32_t bank_size = std::clamp<int32_t>(rGame.bank_size, 0, BANK_BILL_COUNT);
+    for (int32_t bank_idx = 0; bank_idx < bank_size; ++bank_idx) {
+        if (rGame.bank[bank_idx] < BILL_TYPE_COUNT) {
+            ++contribution.bills[rGame.bank[bank_idx]];
+        }
+    }
+    Replace(m_bank, contribution);
+}
+
+template <const lv::RulesConfig &RULES>
+void lv::BasicIncrementalRulesChecker<RULES>::RefreshCasino(const CompactGameState& rGame, CasinoIdx casino_idx)
+{
+    const CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+
+    Contribution contribution{};
+    for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+        contribution.bills[bill_idx] = rCasino.bills[bill_idx];
+    }
+    for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+        contribution.player_dices[player_idx] = rCasino.dice_bets[player_idx];
+    }
+    contribution.neutral_dices = rCasino.neutral_dice_bet;
+    Replace(m_casinos[casino_idx], contribution);
+}
+
+template <const lv::RulesConfig &RULES>
+void lv::BasicIncrementalRulesChecker<RULES>::RefreshPlayer(const CompactGameState& rGame, PlayerIdx player_idx)
+{
+    // Players past the player count are not part of the game
+    Contribution contribution{};
+    if (player_idx < static_cast<PlayerIdx>(rGame.player_count)) {
+        const CompactPlayerState &rPlayer = rGame.players[player_idx];
+        for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+            contribution.bills[bill_idx] = rPlayer.bills[bill_idx];
         }
+        contribution.player_dices[player_idx] = rPlayer.dices;
+        contribution.neutral_dices = rPlayer.white_dices;
     }
+    Replace(m_players[player_idx], contribution);
+}
+
+template <const lv::RulesConfig &RULES>
+void lv::BasicIncrementalRulesChecker<RULES>::RefreshNeutralPlayer(const CompactGameState& rGame)
+{
+    Contribution contribution{};
+    for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+        contribution.bills[bill_idx] = rGame.neutral_player_bills[bill_idx];
+    }
+    Replace(m_neutral_player, contribution);
+}
+
+template <const lv::RulesConfig &RULES>
+void lv::BasicIncrementalRulesChecker<RULES>::Replace(Contribution& rContribution, const Contribution& rNew)
+{
+    for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+        m_totals.bills[bill_idx] += rNew.bills[bill_idx] - rContribution.bills[bill_idx];
+    }
+    for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+        m_totals.player_dices[player_idx] += rNew.player_dices[player_idx] - rContribution.player_dices[player_idx];
+    }
+    m_totals.neutral_dices += rNew.neutral_dices - rContribution.neutral_dices;
 
-    return true;
+    rContribution = rNew;
 }
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::CheckHeader(const CompactGameState& rGame) const
+{
+    if (rGame.player_count < 2 || rGame.player_count > MAX_PLAYER_COUNT) {
+        return RulesViolation::PlayerCount;
+    }
+    if (rGame.neutral_player_present && !Rules::IsNeutralPlayerPresent(rGame.player_count)) {
+        return RulesViolation::NeutralPlayerPresence;
+    }
+    if (rGame.first_player_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return RulesViolation::FirstPlayerIndex;
+    }
+    if (rGame.round < 0) {
+        return RulesViolation::NegativeRound;
+    }
+    if (rGame.round >= ROUND_COUNT) {
+        return RulesViolation::RoundCount;
+    }
+
+    return RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::CheckTotals(const CompactGameState& rGame) const
+{
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        if (m_totals.player_dices[player_idx] != DICE_COUNT) {
+            return RulesViolation::PlayerDiceCount;
+        }
+    }
+
+    if (rGame.neutral_player_present &&
+        m_totals.neutral_dices != GetExtraWhiteDiceCount(rGame.player_count) * rGame.player_count) {
+        return RulesViolation::NeutralDiceCount;
+    }
+
+    for (const BankEntry &rInitBankEntry : BANK_INIT_STOCK_TABLE) {
+        if (m_totals.bills[GetBillIndex(rInitBankEntry.bill)] != rInitBankEntry.count) {
+            return RulesViolation::BillCount;
+        }
+    }
+
+    return RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::CheckCasino(const CompactGameState& rGame,
+                                                                        CasinoIdx casino_idx) const
+{
+    if (GetCasinoMoneyValue(rGame.casinos[casino_idx]) < CASINO_MIN_MONEY_VALUE) {
+        return RulesViolation::CasinoMoneyValue;
+    }
+
+    return RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::CheckPlayer(const CompactGameState& rGame,
+                                                                        PlayerIdx player_idx) const
+{
+    if (rGame.players[player_idx].dices < 0 || rGame.players[player_idx].white_dices < 0) {
+        return RulesViolation::NegativeDiceCount;
+    }
+
+    return RulesViolation::None;
+}
+
+template <const lv::RulesConfig &RULES>
+lv::RulesViolation lv::BasicIncrementalRulesChecker<RULES>::CheckTurn(const CompactGameState& rGame) const
+{
+    if (rGame.current_turn.player_idx >= static_cast<PlayerIdx>(rGame.player_count)) {
+        return RulesViolation::CurrentPlayerIndex;
+    }
+
+    int32_t turn_dices = 0;
+    int32_t turn_white_dices = 0;
+    for (int32_t face_idx = 0; face_idx < CASINO_COUNT; ++face_idx) {
+        turn_dices += rGame.current_turn.dices[face_idx];
+        turn_white_dices += rGame.current_turn.white_dices[face_idx];
+    }
+    if (turn_dices != rGame.players[rGame.current_turn.player_idx].dices) {
+        return RulesViolation::TurnDiceCount;
+    }
+    if (turn_white_dices != rGame.players[rGame.current_turn.player_idx].white_dices) {
+        return RulesViolation::TurnWhiteDiceCount;
+    }
+
+    return RulesViolation::None;
+}
+
+#define LV_INSTANTIATE_RULES_CHECKER(RULES)                  \
+    template class lv::BasicRulesChecker<lv::RULES>;         \
+    template class lv::BasicIncrementalRulesChecker<lv::RULES>;
+
+LV_FOR_EACH_RULES(LV_INSTANTIATE_RULES_CHECKER)
@@ -4,8 +4,139 @@
 
 namespace lv {
 
-class RulesChecker {
+// Rules invariant broken by a game state
+enum class RulesViolation : int32_t {
+    None = 0,
+    PlayerCount,
+    PlayerVectorSize,
+    NeutralPlayerPresence,
+    PlayerDiceCount,
+    NeutralDiceCount,
+    BankSize,
+    BillCount,
+    PlayerIndex,
+    CasinoIndex,
+    FirstPlayerIndex,
+    CurrentPlayerIndex,
+    TurnDiceCount,
+    TurnWhiteDiceCount,
+    PlayerColor,
+    WhitePlayerColor,
+    CasinoDiceValue,
+    NegativeRound,
+    RoundCount,
+    CasinoMoneyValue,
+    NegativeDiceCount,
+};
+
+const char *GetRulesViolationName(RulesViolation violation);
+
+// Checks of a variant, see RulesConfig. Defined in LvRulesChecker.cpp for every variant of LV_FOR_EACH_RULES.
+template <const RulesConfig &RULES> class BasicRulesChecker {
 public:
+    using Rules = RulesTraits<RULES>;
+    using GameState = BasicGameState<RULES>;
+    using CompactGameState = BasicCompactGameState<RULES>;
+    using CasinoState = BasicCasinoState<RULES>;
+    using CompactCasinoState = BasicCompactCasinoState<RULES>;
+
+    // The variant's constants, they hide the standard ones in the definitions of the members
+    enum : int32_t {
+        MAX_PLAYER_COUNT = Rules::MAX_PLAYER_COUNT,
+        DICE_COUNT = Rules::DICE_COUNT,
+        ROUND_COUNT = Rules::ROUND_COUNT,
+        CASINO_MIN_MONEY_VALUE = Rules::CASINO_MIN_MONEY_VALUE,
+        BANK_BILL_COUNT = Rules::BANK_BILL_COUNT,
+    };
+
     bool ValidateGameState(const GameState &state) const;
+    bool ValidateGameState(const CompactGameState &state) const;
+
+    // Same checks, reporting the first invariant that is broken
+    RulesViolation CheckGameState(const GameState &state) const;
+    RulesViolation CheckGameState(const CompactGameState &state) const;
+
+    // Checks of a game over after its last EndRound: the round is ROUND_COUNT, every dice is back with its player and
+    // every casino has paid out. The turn is left from the last move and isn't checked.
+    RulesViolation CheckFinalGameState(const CompactGameState &state) const;
+
+private:
+    RulesViolation CheckCompactGameState(const CompactGameState &rGame, bool game_over) const;
+
+    static constexpr const std::array<BankEntry, BILL_TYPE_COUNT> &BANK_INIT_STOCK_TABLE = RULES.bank_init_stock;
+
+    static constexpr int32_t GetExtraWhiteDiceCount(int32_t player_count) {
+        return Rules::GetExtraWhiteDiceCount(player_count);
+    }
 };
-} // namespace lv
\ No newline at end of file
+
+using RulesChecker = BasicRulesChecker<STANDARD_RULES>;
+
+// Incremental validation of a compact game state
+//
+// Keeps the contribution of every part of the state (bank, each casino, each player, neutral player) to the running
+// invariants: bill totals per denomination, dice totals per player and neutral dice total. Update only refreshes the
+// parts flagged in the StateChanges recorded by GameEngine (see GameEngine::SetChangeTracker) and checks the
+// invariants from the running totals. CheckFull runs the complete BasicRulesChecker on demand.
+template <const RulesConfig &RULES> class BasicIncrementalRulesChecker {
+public:
+    using Rules = RulesTraits<RULES>;
+    using GameState = BasicGameState<RULES>;
+    using CompactGameState = BasicCompactGameState<RULES>;
+    using CasinoState = BasicCasinoState<RULES>;
+    using CompactCasinoState = BasicCompactCasinoState<RULES>;
+
+    // The variant's constants, they hide the standard ones in the definitions of the members
+    enum : int32_t {
+        MAX_PLAYER_COUNT = Rules::MAX_PLAYER_COUNT,
+        DICE_COUNT = Rules::DICE_COUNT,
+        ROUND_COUNT = Rules::ROUND_COUNT,
+        CASINO_MIN_MONEY_VALUE = Rules::CASINO_MIN_MONEY_VALUE,
+        BANK_BILL_COUNT = Rules::BANK_BILL_COUNT,
+    };
+
+    // Rebuild every contribution from the state
+    RulesViolation Reset(const CompactGameState &rGame);
+
+    // Refresh the changed parts and check the running invariants
+    RulesViolation Update(const CompactGameState &rGame, const StateChanges &rChanges);
+
+    RulesViolation CheckFull(const CompactGameState &rGame) const;
+
+private:
+    void RefreshBank(const CompactGameState &rGame);
+    void RefreshCasino(const CompactGameState &rGame, CasinoIdx casino_idx);
+    void RefreshPlayer(const CompactGameState &rGame, PlayerIdx player_idx);
+    void RefreshNeutralPlayer(const CompactGameState &rGame);
+    RulesViolation CheckHeader(const CompactGameState &rGame) const;
+    RulesViolation CheckTotals(const CompactGameState &rGame) const;
+    RulesViolation CheckCasino(const CompactGameState &rGame, CasinoIdx casino_idx) const;
+    RulesViolation CheckPlayer(const CompactGameState &rGame, PlayerIdx player_idx) const;
+    RulesViolation CheckTurn(const CompactGameState &rGame) const;
+
+    // Contribution of one part of the state to the running totals
+    struct Contribution {
+        std::array<int32_t, BILL_TYPE_COUNT> bills{};
+        std::array<int32_t, MAX_PLAYER_COUNT> player_dices{};
+        int32_t neutral_dices = 0;
+    };
+
+    void Replace(Contribution &rContribution, const Contribution &rNew);
+
+    Contribution m_bank{};
+    std::array<Contribution, CASINO_COUNT> m_casinos{};
+    std::array<Contribution, MAX_PLAYER_COUNT> m_players{};
+    Contribution m_neutral_player{};
+
+    Contribution m_totals{};
+
+    static constexpr const std::array<BankEntry, BILL_TYPE_COUNT> &BANK_INIT_STOCK_TABLE = RULES.bank_init_stock;
+
+    static constexpr int32_t GetExtraWhiteDiceCount(int32_t player_count) {
+        return Rules::GetExtraWhiteDiceCount(player_count);
+    }
+};
+
+using IncrementalRulesChecker = BasicIncrementalRulesChecker<STANDARD_RULES>;
+
+} // namespace lv
@@ -0,0 +1,349 @@
+#include "LvServerProtocol.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// macOS has no MSG_NOSIGNAL, servers ignore SIGPIPE there
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+
+// Start of the value of "key" in a flat JSON object, npos when missing. Strings holding a key followed by a colon
+// don't happen in the protocol, so a plain search is enough.
+size_t FindJsonValue(std::string_view line, std::string_view key)
+{
+    size_t search_pos = 0;
+    while (true) {
+        const size_t key_pos = line.find(key, search_pos);
+        if (key_pos == std::string_view::npos) {
+            return std::string_view::npos;
+        }
+        search_pos = key_pos + 1;
+
+        // The key must be quoted and followed by a colon
+        size_t pos = key_pos + key.size();
+        if (key_pos == 0 || line[key_pos - 1] != '"' || pos >= line.size() || line[pos] != '"') {
+            continue;
+        }
+        ++pos;
+        while (pos < line.size() && line[pos] == ' ') {
+            ++pos;
+        }
+        if (pos >= line.size() || line[pos] != ':') {
+            continue;
+        }
+        ++pos;
+        while (pos < line.size() && line[pos] == ' ') {
+            ++pos;
+        }
+        return pos;
+    }
+}
+
+// Integer at pos, advancing pos past it
+bool ParseJsonInt(std::string_view line, size_t &rPos, int64_t &rValue)
+{
+    size_t pos = rPos;
+    const bool negative = pos < line.size() && line[pos] == '-';
+    pos += negative;
+
+    const size_t digits_pos = pos;
+    uint64_t value = 0;
+    while (pos < line.size() && line[pos] >= '0' && line[pos] <= '9' && pos - digits_pos < 18) {
+        value = value * 10 + static_cast<uint64_t>(line[pos] - '0');
+        ++pos;
+    }
+    if (pos == digits_pos || (pos < line.size() && line[pos] >= '0' && line[pos] <= '9')) {
+        return false;
+    }
+
+    rValue = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    rPos = pos;
+    return true;
+}
+
+#ifndef _WIN32
+
+bool SetNonBlocking(int fd)
+{
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+void SetNoDelay(int fd)
+{
+    const int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+bool MakeUnixAddress(const lv::ServerAddress &rAddress, sockaddr_un &rUnixAddress)
+{
+    rUnixAddress = {};
+    rUnixAddress.sun_family = AF_UNIX;
+    if (rAddress.path.empty() || rAddress.path.size() >= sizeof(rUnixAddress.sun_path)) {
+        return false;
+    }
+    std::memcpy(rUnixAddress.sun_path, rAddress.path.c_str(), rAddress.path.size() + 1);
+    return true;
+}
+
+bool MakeTcpAddress(const lv::ServerAddress &rAddress, sockaddr_in &rTcpAddress)
+{
+    rTcpAddress = {};
+    rTcpAddress.sin_family = AF_INET;
+    rTcpAddress.sin_port = htons(static_cast<uint16_t>(rAddress.port));
+    return inet_pton(AF_INET, rAddress.host.c_str(), &rTcpAddress.sin_addr) == 1;
+}
+
+#endif
+
+} // namespace
+
+bool lv::ParseServerAddress(const char* pText, ServerAddress& rAddress)
+{
+    rAddress = {};
+    std::string_view text = pText;
+
+    if (text.substr(0, 5) == "unix:") {
+        rAddress.is_unix = true;
+        rAddress.path = text.substr(5);
+        return !rAddress.path.empty();
+    }
+    if (text.substr(0, 4) == "tcp:") {
+        text.remove_prefix(4);
+    }
+
+    // Port alone, or host and port
+    const size_t colon_pos = text.rfind(':');
+    if (colon_pos != std::string_view::npos) {
+        rAddress.host = text.substr(0, colon_pos);
+        text.remove_prefix(colon_pos + 1);
+    }
+    size_t pos = 0;
+    int64_t port = 0;
+    if (!ParseJsonInt(text, pos, port) || pos != text.size() || port <= 0 || port > 65535) {
+        return false;
+    }
+    rAddress.port = static_cast<int32_t>(port);
+
+    return !rAddress.host.empty();
+}
+
+#ifdef _WIN32
+
+int lv::OpenListenSocket(const ServerAddress& rAddress) { return INVALID_SOCKET_FD; }
+
+int lv::ConnectSocket(const ServerAddress& rAddress) { return INVALID_SOCKET_FD; }
+
+int lv::AcceptSocket(int listen_fd) { return INVALID_SOCKET_FD; }
+
+void lv::CloseSocket(int fd) {}
+
+bool lv::SendAll(int fd, std::string_view data) { return false; }
+
+int64_t lv::ReceiveSome(int fd, char* pBuffer, size_t size) { return -1; }
+
+int64_t lv::SendSome(int fd, std::string_view data) { return -1; }
+
+#else
+
+int lv::OpenListenSocket(const ServerAddress& rAddress)
+{
+    const int fd = socket(rAddress.is_unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return INVALID_SOCKET_FD;
+    }
+
+    bool bound = false;
+    if (rAddress.is_unix) {
+        sockaddr_un unix_address{};
+        if (MakeUnixAddress(rAddress, unix_address)) {
+            unlink(unix_address.sun_path);
+            bound = bind(fd, reinterpret_cast<const sockaddr *>(&unix_address), sizeof(unix_address)) == 0;
+        }
+    } else {
+        const int enable = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in tcp_address{};
+        if (MakeTcpAddress(rAddress, tcp_address)) {
+            bound = bind(fd, reinterpret_cast<const sockaddr *>(&tcp_address), sizeof(tcp_address)) == 0;
+        }
+    }
+
+    if (!bound || listen(fd, SOMAXCONN) != 0 || !SetNonBlocking(fd)) {
+        close(fd);
+        return INVALID_SOCKET_FD;
+    }
+
+    return fd;
+}
+
+int lv::ConnectSocket(const ServerAddress& rAddress)
+{
+    const int fd = socket(rAddress.is_unix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return INVALID_SOCKET_FD;
+    }
+
+    bool connected = false;
+    if (rAddress.is_unix) {
+        sockaddr_un unix_address{};
+        connected = MakeUnixAddress(rAddress, unix_address) &&
+                    connect(fd, reinterpret_cast<const sockaddr *>(&unix_address), sizeof(unix_address)) == 0;
+    } else {
+        sockaddr_in tcp_address{};
+        connected = MakeTcpAddress(rAddress, tcp_address) &&
+                    connect(fd, reinterpret_cast<const sockaddr *>(&tcp_address), sizeof(tcp_address)) == 0;
+        SetNoDelay(fd);
+    }
+
+    if (!connected) {
+        close(fd);
+        return INVALID_SOCKET_FD;
+    }
+
+    return fd;
+}
+
+int lv::AcceptSocket(int listen_fd)
+{
+    sockaddr_storage address{};
+    socklen_t address_size = sizeof(address);
+    const int fd = accept(listen_fd, reinterpret_cast<sockaddr *>(&address), &address_size);
+    if (fd < 0) {
+        return INVALID_SOCKET_FD;
+    }
+
+    if (!SetNonBlocking(fd)) {
+        close(fd);
+        return INVALID_SOCKET_FD;
+    }
+    if (address.ss_family == AF_INET) {
+        SetNoDelay(fd);
+    }
+
+    return fd;
+}
+
+void lv::CloseSocket(int fd)
+{
+    if (fd != INVALID_SOCKET_FD) {
+        close(fd);
+    }
+}
+
+bool lv::SendAll(int fd, std::string_view data)
+{
+    while (!data.empty()) {
+        const ssize_t sent_size = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (sent_size <= 0) {
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(sent_size));
+    }
+    return true;
+}
+
+int64_t lv::ReceiveSome(int fd, char* pBuffer, size_t size)
+{
+    const ssize_t received_size = recv(fd, pBuffer, size, 0);
+    if (received_size > 0) {
+        return received_size;
+    }
+    if (received_size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return 0;
+    }
+    return -1;
+}
+
+int64_t lv::SendSome(int fd, std::string_view data)
+{
+    const ssize_t sent_size = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (sent_size >= 0) {
+        return sent_size;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        return 0;
+    }
+    return -1;
+}
+
+#endif
+
+bool lv::GetJsonInt(std::string_view line, std::string_view key, int64_t& rValue)
+{
+    size_t pos = FindJsonValue(line, key);
+    return pos != std::string_view::npos && ParseJsonInt(line, pos, rValue);
+}
+
+bool lv::GetJsonBool(std::string_view line, std::string_view key, bool& rValue)
+{
+    const size_t pos = FindJsonValue(line, key);
+    if (pos == std::string_view::npos) {
+        return false;
+    }
+
+    const std::string_view value = line.substr(pos);
+    if (value.substr(0, 4) == "true") {
+        rValue = true;
+        return true;
+    }
+    if (value.substr(0, 5) == "false") {
+        rValue = false;
+        return true;
+    }
+    return false;
+}
+
+bool lv::GetJsonString(std::string_view line, std::string_view key, std::string_view& rValue)
+{
+    const size_t pos = FindJsonValue(line, key);
+    if (pos == std::string_view::npos || line[pos] != '"') {
+        return false;
+    }
+
+    const size_t end_pos = line.find('"', pos + 1);
+    if (end_pos == std::string_view::npos) {
+        return false;
+    }
+
+    rValue = line.substr(pos + 1, end_pos - pos - 1);
+    return true;
+}
+
+int32_t lv::GetJsonIntArray(std::string_view line, std::string_view key, int32_t* pValues, int32_t max_count)
+{
+    size_t pos = FindJsonValue(line, key);
+    if (pos == std::string_view::npos || line[pos] != '[') {
+        return -1;
+    }
+    ++pos;
+
+    int32_t count = 0;
+    while (pos < line.size() && line[pos] != ']') {
+        int64_t value = 0;
+        if (count >= max_count || !ParseJsonInt(line, pos, value)) {
+            return -1;
+        }
+        pValues[count++] = static_cast<int32_t>(value);
+
+        while (pos < line.size() && (line[pos] == ',' || line[pos] == ' ')) {
+            ++pos;
+        }
+    }
+
+    return pos < line.size() ? count : -1;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace lv {
+
+// Line protocol of the game server (see LvGameServer.h)
+//
+// Every request and every response is one flat JSON object on its own line: numbers, booleans, strings without
+// escapes and arrays of integers, no nested objects. Every request gets exactly one response, in order, echoing its
+// "id". Requests:
+//
+//   {"id":1,"op":"new","players":3,"seat":0,"bots":"greedy","seed":42}   players, seat, bots and seed are optional
+//   {"id":2,"op":"move","game":256,"dice":4}
+//   {"id":3,"op":"state","game":256}
+//   {"id":4,"op":"close","game":256}
+//   {"id":5,"op":"stats"}
+//
+// "new" starts a game where seat is the client's and bots play the other seats, "move" plays the client's move. Both
+// let the bots play until it's the client's turn again or the game is over, and answer with the state:
+//
+//   {"id":2,"ok":true,"game":256,"round":0,"player":0,"seat":0,"over":false,"bot_moves":2,"bot_dices":[3,5],
+//    "dices":[0,2,1,0,3,0],"white_dices":[0,0,1,0,0,1],"money":[0,0,0],
+//    "casino1_bills":[60,10],"casino1_bets":[0,0,0], ... "casino6_bills":[90],"casino6_bets":[0,2,1],
+//    "neutral_bets":[0,0,1,0,0,0]}
+//
+// bot_dices are the faces the bots played since the previous response, in order, and are empty for "state". dices and
+// white_dices are the counts per face rolled for the current player, money the money of every player. Casinos are
+// numbered by their face: casinoN_bills are the values of the bills on casino N, highest first, casinoN_bets the dices
+// of every player on it, and neutral_bets the white dices on every casino.
+// Errors answer {"id":2,"ok":false,"error":"illegal_move"}. "stats" answers the number of games and, for every
+// request type, the count and the latency percentiles in microseconds: "move_count", "move_p50_us", "move_p99_us",
+// "move_p999_us", "move_max_us" and so on.
+
+enum { SERVER_MAX_LINE_LENGTH = 4096 };
+
+// "tcp:HOST:PORT", "HOST:PORT" or "unix:PATH"
+struct ServerAddress {
+    bool is_unix = false;
+    std::string host = "127.0.0.1";
+    int32_t port = 0;
+    std::string path;
+};
+
+bool ParseServerAddress(const char *pText, ServerAddress &rAddress);
+
+// Sockets are plain file descriptors, POSIX only: on Windows these fail
+enum { INVALID_SOCKET_FD = -1 };
+
+// Non-blocking listening socket, a stale Unix socket file is replaced
+int OpenListenSocket(const ServerAddress &rAddress);
+
+// Blocking connected socket, without Nagle's algorithm on TCP
+int ConnectSocket(const ServerAddress &rAddress);
+
+// Non-blocking accepted socket, INVALID_SOCKET_FD when there is no pending connection
+int AcceptSocket(int listen_fd);
+
+void CloseSocket(int fd);
+
+// Send all of data on a blocking socket, false once the connection is lost
+bool SendAll(int fd, std::string_view data);
+
+// Bytes received or sent, 0 when a non-blocking socket would block, -1 once the connection is closed or lost
+int64_t ReceiveSome(int fd, char *pBuffer, size_t size);
+int64_t SendSome(int fd, std::string_view data);
+
+// Values of a request or response line, false when the key is missing or holds another type
+bool GetJsonInt(std::string_view line, std::string_view key, int64_t &rValue);
+bool GetJsonBool(std::string_view line, std::string_view key, bool &rValue);
+bool GetJsonString(std::string_view line, std::string_view key, std::string_view &rValue);
+
+// Number of integers read into pValues, -1 when the key is missing, isn't an array or has more than max_count values
+int32_t GetJsonIntArray(std::string_view line, std::string_view key, int32_t *pValues, int32_t max_count);
+
+} // namespace lv
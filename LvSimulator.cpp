@@ -0,0 +1,248 @@
+#include "LvSimulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Number of games a worker claims at once, keeps the shared counter out of the hot loop
+enum { GAME_CHUNK_SIZE = 256 };
+
+void AddOutcome(lv::SimulationResult &rResult, const lv::GameOutcome &rOutcome, int32_t player_count)
+{
+    int32_t winner_count = 0;
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        if (rOutcome.winner_mask & (1u << player_idx)) {
+            ++winner_count;
+        }
+    }
+
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        lv::SeatStats &rSeat = rResult.seats[player_idx];
+        const int32_t money = rOutcome.money[player_idx];
+
+        if (rOutcome.winner_mask & (1u << player_idx)) {
+            rSeat.wins += 1.0 / winner_count;
+        }
+        if (rResult.game_count == 0) {
+            rSeat.min_money = money;
+            rSeat.max_money = money;
+        } else {
+            rSeat.min_money = std::min(rSeat.min_money, money);
+            rSeat.max_money = std::max(rSeat.max_money, money);
+        }
+        rSeat.total_money += money;
+        rSeat.total_money_squared += static_cast<int64_t>(money) * money;
+        ++rSeat.score_histogram[std::clamp(money / lv::SCORE_BUCKET_WIDTH, 0, lv::SCORE_BUCKET_COUNT - 1)];
+    }
+
+    rResult.turn_count += rOutcome.turn_count;
+    ++rResult.game_count;
+}
+
+void MergeResult(lv::SimulationResult &rTotal, const lv::SimulationResult &rPartial)
+{
+    if (rPartial.game_count == 0) {
+        rTotal.failed_game_count += rPartial.failed_game_count;
+        return;
+    }
+
+    for (int32_t player_idx = 0; player_idx < lv::MAX_PLAYER_COUNT; ++player_idx) {
+        lv::SeatStats &rSeat = rTotal.seats[player_idx];
+        const lv::SeatStats &rPartialSeat = rPartial.seats[player_idx];
+
+        if (rTotal.game_count == 0) {
+            rSeat.min_money = rPartialSeat.min_money;
+            rSeat.max_money = rPartialSeat.max_money;
+        } else {
+            rSeat.min_money = std::min(rSeat.min_money, rPartialSeat.min_money);
+            rSeat.max_money = std::max(rSeat.max_money, rPartialSeat.max_money);
+        }
+        rSeat.wins += rPartialSeat.wins;
+        rSeat.total_money += rPartialSeat.total_money;
+        rSeat.total_money_squared += rPartialSeat.total_money_squared;
+        for (int32_t bucket_idx = 0; bucket_idx < lv::SCORE_BUCKET_COUNT; ++bucket_idx) {
+            rSeat.score_histogram[bucket_idx] += rPartialSeat.score_histogram[bucket_idx];
+        }
+    }
+
+    rTotal.game_count += rPartial.game_count;
+    rTotal.failed_game_count += rPartial.failed_game_count;
+    rTotal.turn_count += rPartial.turn_count;
+}
+
+} // namespace
+
+uint64_t lv::GetGameSeed(uint64_t base_seed, int64_t game_idx)
+{
+    // splitmix64 finalizer, so neighbouring games get unrelated seeds
+    uint64_t z = base_seed + (static_cast<uint64_t>(game_idx) + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+bool lv::PlayGame(GameEngine& rEngine, CompactGameState& rGame, int32_t player_count, Agent* const* ppAgents,
+                  uint64_t agent_seed, GameOutcome& rOutcome, GameRecordBuilder* pRecord)
+{
+    rOutcome = {};
+
+    if (!rEngine.SetupInitGameState(rGame, player_count)) {
+        return false;
+    }
+
+    for (PlayerIdx player_idx = 0; player_idx < static_cast<PlayerIdx>(player_count); ++player_idx) {
+        ppAgents[player_idx]->OnGameStart(rGame, player_idx, GetGameSeed(agent_seed, player_idx));
+    }
+
+    if (!rEngine.SetupRound(rGame) || !rEngine.StartRound(rGame)) {
+        return false;
+    }
+    if (pRecord != nullptr) {
+        pRecord->BeginRound(rGame);
+    }
+
+    LegalMoveList moves{};
+
+    while (!rEngine.IsGameOver(rGame)) {
+        if (rEngine.GetLegalMoves(rGame, moves) == 0) {
+            return false;
+        }
+
+        const PlayerIdx player_idx = rGame.current_turn.player_idx;
+        const DiceValue dice = ppAgents[player_idx]->ChooseDice(rGame, moves);
+        const int32_t round = rGame.round;
+        if (pRecord != nullptr) {
+            pRecord->AddTurn(rGame, dice);
+        }
+        if (!rEngine.PlayMove(rGame, dice)) {
+            return false;
+        }
+        ++rOutcome.turn_count;
+
+        // PlayMove already set up the next round when this move ended one
+        if (pRecord != nullptr && rGame.round != round) {
+            pRecord->EndRound(rGame);
+            if (!rEngine.IsGameOver(rGame)) {
+                pRecord->BeginRound(rGame);
+            }
+        }
+
+        for (PlayerIdx agent_idx = 0; agent_idx < static_cast<PlayerIdx>(player_count); ++agent_idx) {
+            ppAgents[agent_idx]->OnMovePlayed(rGame, player_idx, dice);
+        }
+    }
+
+    // Find the winners
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        rOutcome.money[player_idx] = GetPlayerMoneyValue(rGame.players[player_idx]);
+    }
+    rOutcome.winner_mask = GetWinnerMask(rGame);
+
+    return true;
+}
+
+bool lv::RunSimulation(const SimulationConfig& rConfig, SimulationResult& rResult)
+{
+    rResult = {};
+
+    // Validate configuration
+    if (rConfig.game_count < 0 || rConfig.thread_count < 0) {
+        return false;
+    }
+    if (rConfig.player_count < 2 || rConfig.player_count > MAX_PLAYER_COUNT) {
+        return false;
+    }
+    for (int32_t player_idx = 0; player_idx < rConfig.player_count; ++player_idx) {
+        if (rConfig.agents[player_idx] == nullptr) {
+            return false;
+        }
+    }
+
+    int32_t thread_count = rConfig.thread_count;
+    if (thread_count == 0) {
+        thread_count = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+    }
+
+    std::atomic<int64_t> next_game_idx{0};
+    std::vector<SimulationResult> worker_results(thread_count);
+
+    auto worker_fn = [&](SimulationResult &rWorkerResult) {
+        SimulationResult local_result{};
+        GameEngine engine{0};
+        CompactGameState game{};
+        GameOutcome outcome{};
+        GameRecordBuilder record{};
+        GameRecordBuilder *pRecord = rConfig.pRecordWriter != nullptr ? &record : nullptr;
+
+        // Every worker has its own agents
+        std::array<std::unique_ptr<Agent>, MAX_PLAYER_COUNT> agents{};
+        std::array<Agent *, MAX_PLAYER_COUNT> agent_ptrs{};
+        for (int32_t player_idx = 0; player_idx < rConfig.player_count; ++player_idx) {
+            agents[player_idx] = rConfig.agents[player_idx]();
+            agent_ptrs[player_idx] = agents[player_idx].get();
+        }
+
+        while (true) {
+            const int64_t first_game_idx = next_game_idx.fetch_add(GAME_CHUNK_SIZE, std::memory_order_relaxed);
+            if (first_game_idx >= rConfig.game_count) {
+                break;
+            }
+            const int64_t last_game_idx = std::min<int64_t>(first_game_idx + GAME_CHUNK_SIZE, rConfig.game_count);
+
+            for (int64_t game_idx = first_game_idx; game_idx < last_game_idx; ++game_idx) {
+                // Engine and agents use separate streams, so changing an agent doesn't change the dices it's given
+                const uint64_t game_seed = GetGameSeed(rConfig.base_seed, game_idx);
+                engine.Seed(game_seed);
+
+                if (pRecord != nullptr) {
+                    pRecord->BeginGame(game_seed, rConfig.player_count);
+                }
+
+                if (!PlayGame(engine, game, rConfig.player_count, agent_ptrs.data(), ~game_seed, outcome, pRecord)) {
+                    ++local_result.failed_game_count;
+                    continue;
+                }
+
+                if (pRecord != nullptr) {
+                    pRecord->EndGame();
+                    if (!rConfig.pRecordWriter->Write(record)) {
+                        ++local_result.failed_game_count;
+                        continue;
+                    }
+                }
+
+                AddOutcome(local_result, outcome, rConfig.player_count);
+            }
+        }
+
+        rWorkerResult = local_result;
+    };
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+    for (int32_t thread_idx = 0; thread_idx < thread_count; ++thread_idx) {
+        threads.emplace_back(worker_fn, std::ref(worker_results[thread_idx]));
+    }
+    for (std::thread &rThread : threads) {
+        rThread.join();
+    }
+
+    const auto end_time = std::chrono::steady_clock::now();
+
+    for (const SimulationResult &rWorkerResult : worker_results) {
+        MergeResult(rResult, rWorkerResult);
+    }
+
+    rResult.elapsed_seconds = std::chrono::duration<double>(end_time - start_time).count();
+    if (rResult.elapsed_seconds > 0.0) {
+        rResult.games_per_second = rResult.game_count / rResult.elapsed_seconds;
+    }
+
+    return rResult.failed_game_count == 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "LvAgent.h"
+#include "LvGameEngine.h"
+#include "LvGameRecord.h"
+#include "LvUtils.h"
+
+#include <array>
+
+namespace lv {
+
+using SeatAgents = std::array<AgentFactoryFn, MAX_PLAYER_COUNT>;
+
+struct GameOutcome {
+    std::array<int32_t, MAX_PLAYER_COUNT> money{};
+    uint32_t winner_mask = 0; // One bit per player holding the highest amount of money
+    int32_t turn_count = 0;
+};
+
+// Seed of game game_idx of a simulation, games can be replayed individually from it
+uint64_t GetGameSeed(uint64_t base_seed, int64_t game_idx);
+
+// Play a complete game with rEngine, which must already be seeded.
+// ppAgents holds one agent per seat, each one is started with GetGameSeed(agent_seed, seat).
+// Rounds and turns are added to pRecord when set, the caller begins and ends the record.
+bool PlayGame(GameEngine &rEngine, CompactGameState &rGame, int32_t player_count, Agent *const *ppAgents,
+              uint64_t agent_seed, GameOutcome &rOutcome, GameRecordBuilder *pRecord = nullptr);
+
+enum { SCORE_BUCKET_WIDTH = 50 };
+enum { SCORE_BUCKET_COUNT = GetBankInitMoneyValue() / SCORE_BUCKET_WIDTH + 1 };
+
+struct SimulationConfig {
+    int64_t game_count = 0;
+    int32_t thread_count = 0; // 0 uses every hardware thread
+    int32_t player_count = 2;
+    uint64_t base_seed = 0;
+    SeatAgents agents{};
+    GameRecordWriter *pRecordWriter = nullptr; // Every game played is written to it when set
+};
+
+struct SeatStats {
+    double wins = 0.0; // Tied games count as a fraction of a win
+    int64_t total_money = 0;
+    int64_t total_money_squared = 0;
+    int32_t min_money = 0;
+    int32_t max_money = 0;
+    std::array<int64_t, SCORE_BUCKET_COUNT> score_histogram{};
+};
+
+struct SimulationResult {
+    int64_t game_count = 0;
+    int64_t failed_game_count = 0;
+    int64_t turn_count = 0;
+    std::array<SeatStats, MAX_PLAYER_COUNT> seats{};
+    double elapsed_seconds = 0.0;
+    double games_per_second = 0.0;
+};
+
+// Play rConfig.game_count games spread over a pool of worker threads.
+// Each worker owns its engine and game state and accumulates its own statistics, which are merged at the end.
+bool RunSimulation(const SimulationConfig &rConfig, SimulationResult &rResult);
+
+} // namespace lv
@@ -0,0 +1,210 @@
+#include "LvStateConversion.h"
+#include "LvStateHash.h"
+#include "LvUtils.h"
+
+#include <cstddef>
+#include <limits>
+
+namespace {
+
+bool ToBillCounts(const lv::BillVector &rBills, lv::BillCounts &rCounts)
+{
+    rCounts.fill(0);
+    for (const lv::Bill &rBill : rBills) {
+        const int32_t bill_idx = lv::GetBillIndex(rBill);
+        if (bill_idx < 0 || bill_idx >= lv::BILL_TYPE_COUNT || lv::GetBillFromIndex(bill_idx) != rBill) {
+            return false;
+        }
+        if (rCounts[bill_idx] == std::numeric_limits<uint8_t>::max()) {
+            return false;
+        }
+        ++rCounts[bill_idx];
+    }
+    return true;
+}
+
+void ToBillVector(const lv::BillCounts &rCounts, lv::BillVector &rBills)
+{
+    rBills.clear();
+    for (int32_t bill_idx = 0; bill_idx < lv::BILL_TYPE_COUNT; ++bill_idx) {
+        rBills.insert(rBills.end(), rCounts[bill_idx], lv::GetBillFromIndex(bill_idx));
+    }
+}
+
+bool ToDiceCounts(const lv::DiceVector &rDices, lv::DiceCounts &rCounts)
+{
+    rCounts.fill(0);
+    for (const lv::DiceValue &rDice : rDices) {
+        if (rDice < lv::DICE_VALUE_MIN || rDice > lv::DICE_VALUE_MAX) {
+            return false;
+        }
+        uint8_t &rCount = rCounts[static_cast<int32_t>(rDice) - 1];
+        if (rCount == std::numeric_limits<uint8_t>::max()) {
+            return false;
+        }
+        ++rCount;
+    }
+    return true;
+}
+
+void ToDiceVector(const lv::DiceCounts &rCounts, lv::DiceVector &rDices)
+{
+    rDices.clear();
+    for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT; ++face_idx) {
+        rDices.insert(rDices.end(), rCounts[face_idx], static_cast<lv::DiceValue>(face_idx + 1));
+    }
+}
+
+bool FitsInt8(int32_t value)
+{
+    return value >= std::numeric_limits<int8_t>::min() && value <= std::numeric_limits<int8_t>::max();
+}
+
+} // namespace
+
+bool lv::ToCompactGameState(const GameState& rGame, CompactGameState& rCompact)
+{
+    rCompact = {};
+
+    if (rGame.player_count < 0 || rGame.player_count > MAX_PLAYER_COUNT ||
+        rGame.players.size() != static_cast<size_t>(rGame.player_count)) {
+        return false;
+    }
+
+    rCompact.round = rGame.round;
+    rCompact.first_player_idx = rGame.first_player_idx;
+    rCompact.player_count = rGame.player_count;
+    rCompact.neutral_player_present = rGame.neutral_player_present;
+
+    // Players, colors are implicit in the compact representation
+    for (PlayerIdx player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
+        const PlayerState &rPlayer = rGame.players[player_idx];
+        CompactPlayerState &rCompactPlayer = rCompact.players[player_idx];
+
+        if (rPlayer.idx != player_idx || rPlayer.color != static_cast<Color>(player_idx + 1)) {
+            return false;
+        }
+        if (!FitsInt8(rPlayer.dices) || !FitsInt8(rPlayer.white_dices)) {
+            return false;
+        }
+        if (!ToBillCounts(rPlayer.bills, rCompactPlayer.bills)) {
+            return false;
+        }
+        rCompactPlayer.dices = static_cast<int8_t>(rPlayer.dices);
+        rCompactPlayer.white_dices = static_cast<int8_t>(rPlayer.white_dices);
+    }
+
+    // Casinos
+    for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const CasinoState &rCasino = rGame.casinos[casino_idx];
+        CompactCasinoState &rCompactCasino = rCompact.casinos[casino_idx];
+
+        if (rCasino.idx != casino_idx || rCasino.dice != static_cast<DiceValue>(casino_idx + 1)) {
+            return false;
+        }
+        if (!ToBillCounts(rCasino.bills, rCompactCasino.bills)) {
+            return false;
+        }
+        for (PlayerIdx player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+            if (!FitsInt8(rCasino.dice_bets[player_idx])) {
+                return false;
+            }
+            rCompactCasino.dice_bets[player_idx] = static_cast<int8_t>(rCasino.dice_bets[player_idx]);
+        }
+        if (!FitsInt8(rCasino.neutral_dice_bet)) {
+            return false;
+        }
+        rCompactCasino.neutral_dice_bet = static_cast<int8_t>(rCasino.neutral_dice_bet);
+    }
+
+    // Neutral player
+    if (!ToBillCounts(rGame.neutral_player.bills, rCompact.neutral_player_bills)) {
+        return false;
+    }
+
+    // Current turn
+    rCompact.current_turn.player_idx = rGame.current_turn.player_idx;
+    if (!ToDiceCounts(rGame.current_turn.dices, rCompact.current_turn.dices)) {
+        return false;
+    }
+    if (!ToDiceCounts(rGame.current_turn.white_dices, rCompact.current_turn.white_dices)) {
+        return false;
+    }
+
+    // Bank, order is preserved
+    if (rGame.bank.size() > BANK_BILL_COUNT) {
+        return false;
+    }
+    for (const Bill &rBill : rGame.bank) {
+        const int32_t bill_idx = GetBillIndex(rBill);
+        if (bill_idx < 0 || bill_idx >= BILL_TYPE_COUNT || GetBillFromIndex(bill_idx) != rBill) {
+            return false;
+        }
+        rCompact.bank[rCompact.bank_size++] = static_cast<uint8_t>(bill_idx);
+    }
+
+    // Hashed again rather than copied, the source may have been built by hand
+    rCompact.hash = ComputeHash(rCompact);
+
+    return true;
+}
+
+bool lv::ToGameState(const CompactGameState& rCompact, GameState& rGame)
+{
+    if (rCompact.player_count < 0 || rCompact.player_count > MAX_PLAYER_COUNT) {
+        return false;
+    }
+    if (rCompact.bank_size < 0 || rCompact.bank_size > BANK_BILL_COUNT) {
+        return false;
+    }
+
+    rGame.round = rCompact.round;
+    rGame.first_player_idx = rCompact.first_player_idx;
+    rGame.player_count = rCompact.player_count;
+    rGame.neutral_player_present = rCompact.neutral_player_present;
+
+    // Players
+    rGame.players.resize(rCompact.player_count);
+    for (PlayerIdx player_idx = 0; player_idx < rGame.players.size(); ++player_idx) {
+        const CompactPlayerState &rCompactPlayer = rCompact.players[player_idx];
+        PlayerState &rPlayer = rGame.players[player_idx];
+
+        rPlayer.idx = player_idx;
+        rPlayer.color = static_cast<Color>(player_idx + 1);
+        ToBillVector(rCompactPlayer.bills, rPlayer.bills);
+        rPlayer.dices = rCompactPlayer.dices;
+        rPlayer.white_dices = rCompactPlayer.white_dices;
+    }
+
+    // Casinos
+    for (CasinoIdx casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const CompactCasinoState &rCompactCasino = rCompact.casinos[casino_idx];
+        CasinoState &rCasino = rGame.casinos[casino_idx];
+
+        rCasino.idx = casino_idx;
+        rCasino.dice = static_cast<DiceValue>(casino_idx + 1);
+        ToBillVector(rCompactCasino.bills, rCasino.bills);
+        for (PlayerIdx player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+            rCasino.dice_bets[player_idx] = rCompactCasino.dice_bets[player_idx];
+        }
+        rCasino.neutral_dice_bet = rCompactCasino.neutral_dice_bet;
+    }
+
+    // Neutral player
+    ToBillVector(rCompact.neutral_player_bills, rGame.neutral_player.bills);
+
+    // Current turn
+    rGame.current_turn.player_idx = rCompact.current_turn.player_idx;
+    ToDiceVector(rCompact.current_turn.dices, rGame.current_turn.dices);
+    ToDiceVector(rCompact.current_turn.white_dices, rGame.current_turn.white_dices);
+
+    // Bank
+    rGame.bank.clear();
+    for (int32_t bank_idx = 0; bank_idx < rCompact.bank_size; ++bank_idx) {
+        rGame.bank.push_back(GetBillFromIndex(rCompact.bank[bank_idx]));
+    }
+
+    rGame.hash = ComputeHash(rCompact);
+
+    return true;
+}
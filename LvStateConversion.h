@@ -0,0 +1,15 @@
+#pragma once
+
+#include "LvPublic.h"
+
+namespace lv {
+
+// Convert a game state to its compact representation.
+// Fails if the state cannot be represented, e.g. non-canonical player colors or out of range values.
+bool ToCompactGameState(const GameState &rGame, CompactGameState &rCompact);
+
+// Convert a compact game state back to the regular representation.
+// Turn dices are expanded in ascending face order.
+bool ToGameState(const CompactGameState &rCompact, GameState &rGame);
+
+} // namespace lv
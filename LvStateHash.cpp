@@ -0,0 +1,87 @@
+#include "LvStateHash.h"
+
+#include <algorithm>
+
+template <const lv::RulesConfig &RULES> uint64_t lv::ComputeHash(const BasicCompactGameState<RULES>& rGame)
+{
+    using Rules = RulesTraits<RULES>;
+    using BillOwners = HashBillOwners<RULES>;
+    constexpr const BasicHashKeys<RULES> &HASH_KEYS = RULES_HASH_KEYS<RULES>;
+
+    uint64_t hash = GetHashDelta(HASH_KEYS.round, rGame.round) +
+                    GetHashDelta(HASH_KEYS.first_player, static_cast<int32_t>(rGame.first_player_idx)) +
+                    GetHashDelta(HASH_KEYS.current_player, static_cast<int32_t>(rGame.current_turn.player_idx));
+
+    const int32_t player_count = std::min<int32_t>(rGame.player_count, Rules::MAX_PLAYER_COUNT);
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        const CompactPlayerState &rPlayer = rGame.players[player_idx];
+        hash += GetHashDelta(HASH_KEYS.dices[player_idx], rPlayer.dices);
+        hash += GetHashDelta(HASH_KEYS.white_dices[player_idx], rPlayer.white_dices);
+        for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+            hash += GetHashDelta(HASH_KEYS.bills[player_idx][bill_idx], rPlayer.bills[bill_idx]);
+        }
+    }
+
+    for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+        hash += GetHashDelta(HASH_KEYS.bills[BillOwners::NEUTRAL][bill_idx], rGame.neutral_player_bills[bill_idx]);
+    }
+
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const BasicCompactCasinoState<RULES> &rCasino = rGame.casinos[casino_idx];
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            hash += GetHashDelta(HASH_KEYS.dice_bets[casino_idx][player_idx], rCasino.dice_bets[player_idx]);
+        }
+        hash += GetHashDelta(HASH_KEYS.dice_bets[casino_idx][Rules::CASINO_NEUTRAL_WINNER], rCasino.neutral_dice_bet);
+        for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+            hash += GetHashDelta(HASH_KEYS.bills[BillOwners::CASINO + casino_idx][bill_idx],
+                                 rCasino.bills[bill_idx]);
+        }
+    }
+
+    return hash;
+}
+
+template <const lv::RulesConfig &RULES> uint64_t lv::ComputeHash(const BasicGameState<RULES>& rGame)
+{
+    using Rules = RulesTraits<RULES>;
+    using BillOwners = HashBillOwners<RULES>;
+    constexpr const BasicHashKeys<RULES> &HASH_KEYS = RULES_HASH_KEYS<RULES>;
+
+    uint64_t hash = GetHashDelta(HASH_KEYS.round, rGame.round) +
+                    GetHashDelta(HASH_KEYS.first_player, static_cast<int32_t>(rGame.first_player_idx)) +
+                    GetHashDelta(HASH_KEYS.current_player, static_cast<int32_t>(rGame.current_turn.player_idx));
+
+    const int32_t player_count =
+        std::min<int32_t>(static_cast<int32_t>(rGame.players.size()), Rules::MAX_PLAYER_COUNT);
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        const PlayerState &rPlayer = rGame.players[player_idx];
+        hash += GetHashDelta(HASH_KEYS.dices[player_idx], rPlayer.dices);
+        hash += GetHashDelta(HASH_KEYS.white_dices[player_idx], rPlayer.white_dices);
+        for (const Bill bill : rPlayer.bills) {
+            hash += HASH_KEYS.bills[player_idx][GetBillIndex(bill)];
+        }
+    }
+
+    for (const Bill bill : rGame.neutral_player.bills) {
+        hash += HASH_KEYS.bills[BillOwners::NEUTRAL][GetBillIndex(bill)];
+    }
+
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const BasicCasinoState<RULES> &rCasino = rGame.casinos[casino_idx];
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            hash += GetHashDelta(HASH_KEYS.dice_bets[casino_idx][player_idx], rCasino.dice_bets[player_idx]);
+        }
+        hash += GetHashDelta(HASH_KEYS.dice_bets[casino_idx][Rules::CASINO_NEUTRAL_WINNER], rCasino.neutral_dice_bet);
+        for (const Bill bill : rCasino.bills) {
+            hash += HASH_KEYS.bills[BillOwners::CASINO + casino_idx][GetBillIndex(bill)];
+        }
+    }
+
+    return hash;
+}
+
+#define LV_INSTANTIATE_HASH(RULES)                                                                                    \
+    template uint64_t lv::ComputeHash<lv::RULES>(const BasicCompactGameState<lv::RULES> &rGame);                     \
+    template uint64_t lv::ComputeHash<lv::RULES>(const BasicGameState<lv::RULES> &rGame);
+
+LV_FOR_EACH_RULES(LV_INSTANTIATE_HASH)
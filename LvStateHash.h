@@ -0,0 +1,99 @@
+#pragma once
+
+#include "LvPublic.h"
+#include "LvUtils.h"
+
+#include <array>
+
+namespace lv {
+
+// Zobrist hashing of game states
+//
+// Every counter of the state has a random 64-bit key: round, first player, current player, dices and white dices left
+// to each player, bet of every bidder on every casino, and number of bills of each denomination held by each player,
+// the neutral player and each casino. The hash is the sum modulo 2^64 of every key times its counter, so a mutator
+// updates it with one multiply-add per counter it changes, without looking at the previous value. Chance is left
+// out, the current roll and the bank (whose content follows from the other bills), so a state and its Observation
+// hash the same.
+//
+// GameEngine keeps CompactGameState::hash and GameState::hash up to date in every mutator, ComputeHash recomputes it
+// from scratch, e.g. for states built by hand.
+
+// Bill owners, players come first with their own index
+template <const RulesConfig &RULES> struct HashBillOwners {
+    enum : int32_t {
+        NEUTRAL = RulesTraits<RULES>::MAX_PLAYER_COUNT,
+        CASINO = RulesTraits<RULES>::MAX_PLAYER_COUNT + 1, // Casino 0, then one per casino
+        COUNT = CASINO + CASINO_COUNT,
+    };
+
+    // Casino winners are bill owners as they are (see GetCasinoWinners)
+    static_assert(static_cast<int32_t>(NEUTRAL) == static_cast<int32_t>(RulesTraits<RULES>::CASINO_NEUTRAL_WINNER),
+                  "The neutral player must be the same bidder and bill owner");
+};
+
+enum : int32_t {
+    HASH_NEUTRAL_BILL_OWNER = HashBillOwners<STANDARD_RULES>::NEUTRAL,
+    HASH_CASINO_BILL_OWNER = HashBillOwners<STANDARD_RULES>::CASINO,
+    HASH_BILL_OWNER_COUNT = HashBillOwners<STANDARD_RULES>::COUNT,
+};
+
+template <const RulesConfig &RULES> struct BasicHashKeys {
+    using Rules = RulesTraits<RULES>;
+
+    uint64_t round = 0;
+    uint64_t first_player = 0;
+    uint64_t current_player = 0;
+    std::array<uint64_t, Rules::MAX_PLAYER_COUNT> dices{};
+    std::array<uint64_t, Rules::MAX_PLAYER_COUNT> white_dices{};
+    std::array<std::array<uint64_t, Rules::CASINO_BIDDER_COUNT>, CASINO_COUNT> dice_bets{}; // Neutral bet last
+    std::array<std::array<uint64_t, BILL_TYPE_COUNT>, HashBillOwners<RULES>::COUNT> bills{};
+};
+
+using HashKeys = BasicHashKeys<STANDARD_RULES>;
+
+// Fixed keys, drawn with splitmix64 so that hashes are the same on every platform. Every variant draws from the same
+// seed, the standard keys don't depend on the other variants.
+template <const RulesConfig &RULES> constexpr BasicHashKeys<RULES> MakeHashKeys() {
+    BasicHashKeys<RULES> keys{};
+    uint64_t seed = 0x4C61735665676173ull;
+    auto next_fn = [&seed]() {
+        seed += 0x9E3779B97F4A7C15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    };
+
+    keys.round = next_fn();
+    keys.first_player = next_fn();
+    keys.current_player = next_fn();
+    for (size_t player_idx = 0; player_idx < keys.dices.size(); ++player_idx) {
+        keys.dices[player_idx] = next_fn();
+        keys.white_dices[player_idx] = next_fn();
+    }
+    for (auto &rCasinoKeys : keys.dice_bets) {
+        for (uint64_t &rKey : rCasinoKeys) {
+            rKey = next_fn();
+        }
+    }
+    for (auto &rOwnerKeys : keys.bills) {
+        for (uint64_t &rKey : rOwnerKeys) {
+            rKey = next_fn();
+        }
+    }
+    return keys;
+}
+
+template <const RulesConfig &RULES> inline constexpr BasicHashKeys<RULES> RULES_HASH_KEYS = MakeHashKeys<RULES>();
+
+inline constexpr const HashKeys &HASH_KEYS = RULES_HASH_KEYS<STANDARD_RULES>;
+
+// Hash change of the counter of key going up by delta, which may be negative
+constexpr uint64_t GetHashDelta(uint64_t key, int64_t delta) { return key * static_cast<uint64_t>(delta); }
+
+// Defined for every variant of LV_FOR_EACH_RULES
+template <const RulesConfig &RULES> uint64_t ComputeHash(const BasicCompactGameState<RULES> &rGame);
+template <const RulesConfig &RULES> uint64_t ComputeHash(const BasicGameState<RULES> &rGame);
+
+} // namespace lv
@@ -0,0 +1,175 @@
+#include "LvStateSymmetry.h"
+#include "LvStateHash.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Bills, neutral bet and bets of the players in the high word, one nibble each, the dices rolled on the face in the
+// low one. Bills and bet counts are below 16.
+struct CasinoSortKey {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+
+    bool operator>(const CasinoSortKey &rOther) const {
+        return hi != rOther.hi ? hi > rOther.hi : lo > rOther.lo;
+    }
+};
+
+static_assert(lv::BILL_TYPE_COUNT * 4 + 4 + lv::MAX_PLAYER_COUNT * 4 <= 64,
+              "Casino sort keys hold one nibble per count");
+
+// Bets on every casino, one nibble each
+using PlayerSortKey = uint64_t;
+
+bool HasDicesLeft(const lv::CompactPlayerState &rPlayer)
+{
+    return rPlayer.dices > 0 || rPlayer.white_dices > 0;
+}
+
+// Stable insertion sort, highest key first: a handful of indices, without the buffer of std::stable_sort
+template <typename Key, size_t SIZE>
+void SortByKeys(uint8_t *pBegin, uint8_t *pEnd, const std::array<Key, SIZE> &rKeys)
+{
+    for (uint8_t *pCurrent = pBegin + 1; pCurrent < pEnd; ++pCurrent) {
+        const uint8_t idx = *pCurrent;
+        uint8_t *pInsert = pCurrent;
+        while (pInsert > pBegin && rKeys[idx] > rKeys[*(pInsert - 1)]) {
+            *pInsert = *(pInsert - 1);
+            --pInsert;
+        }
+        *pInsert = idx;
+    }
+}
+
+} // namespace
+
+void lv::Canonicalize(const CompactGameState& rGame, SymmetryScope scope, CompactGameState& rCanonical,
+                      StateSymmetry& rSymmetry)
+{
+    const int32_t player_count = std::clamp<int32_t>(rGame.player_count, 0, MAX_PLAYER_COUNT);
+
+    // Seats in turn order from the current player, players without dices left last. Their order is only known once
+    // casinos are sorted, so casinos are compared on the sorted bets of idle players.
+    std::array<uint8_t, MAX_PLAYER_COUNT> players{};
+    int32_t active_player_count = 0;
+    if (scope == SymmetryScope::Game) {
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            players[player_idx] = static_cast<uint8_t>(player_idx);
+        }
+        active_player_count = player_count;
+    } else {
+        const int32_t current_player_idx = static_cast<int32_t>(rGame.current_turn.player_idx);
+        int32_t idle_player_count = 0;
+        for (int32_t offset = 0; offset < player_count; ++offset) {
+            const int32_t player_idx = (current_player_idx + offset) % player_count;
+            if (HasDicesLeft(rGame.players[player_idx])) {
+                players[active_player_count++] = static_cast<uint8_t>(player_idx);
+            }
+        }
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            if (!HasDicesLeft(rGame.players[player_idx])) {
+                players[active_player_count + idle_player_count++] = static_cast<uint8_t>(player_idx);
+            }
+        }
+    }
+
+    std::array<CasinoSortKey, CASINO_COUNT> casino_keys{};
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        CasinoSortKey &rKey = casino_keys[casino_idx];
+        for (int32_t bill_idx = BILL_TYPE_COUNT - 1; bill_idx >= 0; --bill_idx) {
+            rKey.hi = (rKey.hi << 4) | (rCasino.bills[bill_idx] & 0xF);
+        }
+        rKey.hi = (rKey.hi << 4) | (static_cast<uint8_t>(rCasino.neutral_dice_bet) & 0xF);
+        std::array<uint8_t, MAX_PLAYER_COUNT> bets{};
+        for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+            bets[seat_idx] = static_cast<uint8_t>(rCasino.dice_bets[players[seat_idx]]) & 0xF;
+        }
+        for (int32_t seat_idx = active_player_count + 1; seat_idx < player_count; ++seat_idx) {
+            for (int32_t insert_idx = seat_idx; insert_idx > active_player_count; --insert_idx) {
+                if (bets[insert_idx] <= bets[insert_idx - 1]) {
+                    break;
+                }
+                std::swap(bets[insert_idx], bets[insert_idx - 1]);
+            }
+        }
+        for (const uint8_t bet : bets) {
+            rKey.hi = (rKey.hi << 4) | bet;
+        }
+        rKey.lo = (static_cast<uint64_t>(rGame.current_turn.dices[casino_idx]) << 8) |
+                  rGame.current_turn.white_dices[casino_idx];
+    }
+
+    // Richest casinos first
+    std::array<uint8_t, CASINO_COUNT> casinos{};
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        casinos[casino_idx] = static_cast<uint8_t>(casino_idx);
+    }
+    SortByKeys(casinos.data(), casinos.data() + CASINO_COUNT, casino_keys);
+
+    // Idle players by their bets on the sorted casinos, highest first
+    if (active_player_count < player_count) {
+        std::array<PlayerSortKey, MAX_PLAYER_COUNT> player_keys{};
+        for (int32_t seat_idx = active_player_count; seat_idx < player_count; ++seat_idx) {
+            const uint8_t player_idx = players[seat_idx];
+            for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+                const int8_t bet = rGame.casinos[casinos[casino_idx]].dice_bets[player_idx];
+                player_keys[player_idx] = (player_keys[player_idx] << 4) | (static_cast<uint8_t>(bet) & 0xF);
+            }
+        }
+        SortByKeys(players.data() + active_player_count, players.data() + player_count, player_keys);
+    }
+
+    rSymmetry = {};
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        rSymmetry.original_casinos[casino_idx] = casinos[casino_idx];
+        rSymmetry.canonical_casinos[casinos[casino_idx]] = static_cast<uint8_t>(casino_idx);
+    }
+    for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+        rSymmetry.original_players[seat_idx] = players[seat_idx];
+        rSymmetry.canonical_players[players[seat_idx]] = static_cast<uint8_t>(seat_idx);
+    }
+
+    rCanonical = rGame;
+    for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+        rCanonical.players[seat_idx] = rGame.players[players[seat_idx]];
+    }
+    for (int32_t casino_idx = 0; casino_idx < CASINO_COUNT; ++casino_idx) {
+        const CompactCasinoState &rCasino = rGame.casinos[casinos[casino_idx]];
+        CompactCasinoState &rCanonicalCasino = rCanonical.casinos[casino_idx];
+        rCanonicalCasino.bills = rCasino.bills;
+        rCanonicalCasino.neutral_dice_bet = rCasino.neutral_dice_bet;
+        for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+            rCanonicalCasino.dice_bets[seat_idx] = rCasino.dice_bets[players[seat_idx]];
+        }
+        rCanonical.current_turn.dices[casino_idx] = rGame.current_turn.dices[casinos[casino_idx]];
+        rCanonical.current_turn.white_dices[casino_idx] = rGame.current_turn.white_dices[casinos[casino_idx]];
+    }
+    if (rGame.current_turn.player_idx < static_cast<PlayerIdx>(player_count)) {
+        rCanonical.current_turn.player_idx = rSymmetry.canonical_players[rGame.current_turn.player_idx];
+    }
+    if (rGame.first_player_idx < static_cast<PlayerIdx>(player_count)) {
+        rCanonical.first_player_idx = rSymmetry.canonical_players[rGame.first_player_idx];
+    }
+
+    if (scope == SymmetryScope::Round) {
+        rCanonical.round = 0;
+        rCanonical.first_player_idx = 0;
+        rCanonical.neutral_player_bills = {};
+        for (CompactPlayerState &rPlayer : rCanonical.players) {
+            rPlayer.bills = {};
+        }
+    }
+
+    rCanonical.hash = 0;
+}
+
+uint64_t lv::ComputeCanonicalHash(const CompactGameState& rGame, SymmetryScope scope)
+{
+    CompactGameState canonical{};
+    StateSymmetry symmetry{};
+    Canonicalize(rGame, scope, canonical, symmetry);
+    return ComputeHash(canonical);
+}
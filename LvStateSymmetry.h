@@ -0,0 +1,54 @@
+#pragma once
+
+#include "LvPublic.h"
+
+#include <array>
+
+namespace lv {
+
+// Symmetries of game states
+//
+// Dices fall on every face with the same probability, so casinos can be relabeled: swapping two casinos, with their
+// bills, bets and the dices rolled on their faces, gives a state that plays the same once moves are relabeled too.
+// Players generally can't be renumbered, seats set the turn order and the first player of every round. Until the end
+// of the round however, players without dices left only wait for the payouts, and the others play in turn from the
+// current one: the round scope renumbers players from the current one in turn order, the idle ones last, and drops
+// what doesn't matter before the payouts (round, first player, bills already won).
+//
+// Canonicalize sorts casinos, and in the round scope idle players, by their content, so that equivalent states share
+// one canonical state and hash: caches and tablebases keyed on it hold each class of states once. Ties between
+// casinos that only differ by the bets of idle players are broken by casino index, so a few equivalent states keep
+// distinct canonical forms, while different states never share one. States in the GameState representation go
+// through ToCompactGameState first.
+
+enum class SymmetryScope : int32_t {
+    Game = 0, // Casinos only, the canonical state plays the rest of the game the same
+    Round,    // Casinos and players, the canonical state only plays the same until the end of the round
+};
+
+// Relabeling from a state to its canonical state, both ways
+struct StateSymmetry {
+    std::array<uint8_t, CASINO_COUNT> canonical_casinos{};     // Canonical casino of every casino
+    std::array<uint8_t, CASINO_COUNT> original_casinos{};      // Casino of every canonical casino
+    std::array<uint8_t, MAX_PLAYER_COUNT> canonical_players{}; // Canonical seat of every player
+    std::array<uint8_t, MAX_PLAYER_COUNT> original_players{};  // Player of every canonical seat
+
+    DiceValue ToCanonical(DiceValue dice) const {
+        return static_cast<DiceValue>(canonical_casinos[static_cast<int32_t>(dice) - 1] + 1);
+    }
+    DiceValue ToOriginal(DiceValue dice) const {
+        return static_cast<DiceValue>(original_casinos[static_cast<int32_t>(dice) - 1] + 1);
+    }
+    PlayerIdx ToCanonical(PlayerIdx player_idx) const { return canonical_players[player_idx]; }
+    PlayerIdx ToOriginal(PlayerIdx player_idx) const { return original_players[player_idx]; }
+};
+
+// Canonical state of rGame and the relabeling to it. rCanonical.hash is left at 0, hashing takes longer than the
+// rest and callers with keys of their own don't need it.
+void Canonicalize(const CompactGameState &rGame, SymmetryScope scope, CompactGameState &rCanonical,
+                  StateSymmetry &rSymmetry);
+
+// Zobrist hash of the canonical state (see LvStateHash.h), the same for every symmetric state
+uint64_t ComputeCanonicalHash(const CompactGameState &rGame, SymmetryScope scope);
+
+} // namespace lv
@@ -0,0 +1,408 @@
+#include "LvTournament.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+namespace {
+
+// Number of games a worker claims at once, like the simulator
+enum { GAME_CHUNK_SIZE = 16 };
+
+enum { RATING_MAX_ITERATION_COUNT = 10000 };
+constexpr double RATING_TOLERANCE = 1e-10;
+constexpr double ELO_PER_NATURAL_UNIT = 400.0 / 2.302585092994046; // 400 / ln(10)
+
+// Entrants of a table, the seats of a game are a rotation of them
+struct TournamentTable {
+    int32_t player_count = 0;
+    std::array<int32_t, lv::MAX_PLAYER_COUNT> entrants{};
+};
+
+// One game of a round: a deal played by a table under one rotation of its seats
+struct TournamentGame {
+    int32_t table_idx = 0;
+    int32_t deal_idx = 0;
+    int32_t rotation = 0;
+};
+
+// Results so far, pair entries are those of the row entrant against the column entrant
+struct TournamentTotals {
+    int32_t entrant_count = 0;
+    std::vector<double> pair_scores;
+    std::vector<int64_t> pair_counts;
+    std::vector<int64_t> game_counts;
+    std::vector<int64_t> total_money;
+    int64_t game_count = 0;
+    int64_t failed_game_count = 0;
+
+    explicit TournamentTotals(int32_t entrant_count)
+        : entrant_count(entrant_count), pair_scores(entrant_count * entrant_count),
+          pair_counts(entrant_count * entrant_count), game_counts(entrant_count), total_money(entrant_count) {}
+
+    void Add(const TournamentTotals &rOther) {
+        for (size_t pair_idx = 0; pair_idx < pair_scores.size(); ++pair_idx) {
+            pair_scores[pair_idx] += rOther.pair_scores[pair_idx];
+            pair_counts[pair_idx] += rOther.pair_counts[pair_idx];
+        }
+        for (int32_t entrant_idx = 0; entrant_idx < entrant_count; ++entrant_idx) {
+            game_counts[entrant_idx] += rOther.game_counts[entrant_idx];
+            total_money[entrant_idx] += rOther.total_money[entrant_idx];
+        }
+        game_count += rOther.game_count;
+        failed_game_count += rOther.failed_game_count;
+    }
+};
+
+// Every combination of player_count entrants
+void AddRoundRobinTables(int32_t entrant_count, int32_t player_count, std::vector<TournamentTable> &rTables)
+{
+    TournamentTable table{player_count};
+    std::iota(table.entrants.begin(), table.entrants.begin() + player_count, 0);
+
+    while (true) {
+        rTables.push_back(table);
+
+        // Next combination in lexicographic order
+        int32_t seat_idx = player_count - 1;
+        while (seat_idx >= 0 && table.entrants[seat_idx] == entrant_count - player_count + seat_idx) {
+            --seat_idx;
+        }
+        if (seat_idx < 0) {
+            break;
+        }
+        ++table.entrants[seat_idx];
+        for (int32_t next_seat_idx = seat_idx + 1; next_seat_idx < player_count; ++next_seat_idx) {
+            table.entrants[next_seat_idx] = table.entrants[next_seat_idx - 1] + 1;
+        }
+    }
+}
+
+// Entrants of neighbouring ratings, highest first. The last table is filled with the entrants right above it, who
+// play two tables that round.
+void AddSwissTables(const std::vector<int32_t> &rRanking, int32_t player_count, std::vector<TournamentTable> &rTables)
+{
+    const int32_t entrant_count = static_cast<int32_t>(rRanking.size());
+    for (int32_t first_idx = 0; first_idx < entrant_count; first_idx += player_count) {
+        const int32_t table_first_idx = std::min(first_idx, entrant_count - player_count);
+        TournamentTable table{player_count};
+        for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+            table.entrants[seat_idx] = rRanking[table_first_idx + seat_idx];
+        }
+        rTables.push_back(table);
+    }
+}
+
+// Inverse of a symmetric positive definite matrix, in place, by Gauss-Jordan elimination
+bool InvertMatrix(std::vector<double> &rMatrix, int32_t size)
+{
+    std::vector<double> inverse(size * size);
+    for (int32_t idx = 0; idx < size; ++idx) {
+        inverse[idx * size + idx] = 1.0;
+    }
+
+    for (int32_t column = 0; column < size; ++column) {
+        const double pivot = rMatrix[column * size + column];
+        if (!(std::fabs(pivot) > 1e-300)) {
+            return false;
+        }
+        for (int32_t idx = 0; idx < size; ++idx) {
+            rMatrix[column * size + idx] /= pivot;
+            inverse[column * size + idx] /= pivot;
+        }
+        for (int32_t row = 0; row < size; ++row) {
+            const double factor = rMatrix[row * size + column];
+            if (row == column || factor == 0.0) {
+                continue;
+            }
+            for (int32_t idx = 0; idx < size; ++idx) {
+                rMatrix[row * size + idx] -= factor * rMatrix[column * size + idx];
+                inverse[row * size + idx] -= factor * inverse[column * size + idx];
+            }
+        }
+    }
+
+    rMatrix = std::move(inverse);
+    return true;
+}
+
+// Bradley-Terry fit by minorization-maximization (Hunter 2004), then the bounds from the Fisher information.
+// The information matrix is singular along the common offset of all ratings, the bounds are those of ratings
+// averaging 0: (H + J / n)^-1 - J / n, J being the matrix of ones.
+void FitRatings(const TournamentTotals &rTotals, double confidence_z, lv::TournamentResult &rResult)
+{
+    const int32_t entrant_count = rTotals.entrant_count;
+    const auto pair_idx = [entrant_count](int32_t row, int32_t column) { return row * entrant_count + column; };
+
+    // Every pair starts with one virtual tie
+    std::vector<double> wins(entrant_count);
+    std::vector<double> pair_counts(entrant_count * entrant_count);
+    for (int32_t row = 0; row < entrant_count; ++row) {
+        for (int32_t column = 0; column < entrant_count; ++column) {
+            if (row != column) {
+                wins[row] += rTotals.pair_scores[pair_idx(row, column)] + 0.5;
+                pair_counts[pair_idx(row, column)] =
+                    static_cast<double>(rTotals.pair_counts[pair_idx(row, column)]) + 1.0;
+            }
+        }
+    }
+
+    std::vector<double> strengths(entrant_count, 1.0);
+    for (int32_t iteration = 0; iteration < RATING_MAX_ITERATION_COUNT; ++iteration) {
+        double max_change = 0.0;
+        double log_sum = 0.0;
+        for (int32_t row = 0; row < entrant_count; ++row) {
+            double denominator = 0.0;
+            for (int32_t column = 0; column < entrant_count; ++column) {
+                if (row != column) {
+                    denominator += pair_counts[pair_idx(row, column)] / (strengths[row] + strengths[column]);
+                }
+            }
+            const double strength = wins[row] / denominator;
+            max_change = std::max(max_change, std::fabs(std::log(strength / strengths[row])));
+            strengths[row] = strength;
+            log_sum += std::log(strength);
+        }
+
+        // Geometric mean of 1, ratings average 0
+        const double scale = std::exp(-log_sum / entrant_count);
+        for (double &rStrength : strengths) {
+            rStrength *= scale;
+        }
+        if (max_change < RATING_TOLERANCE) {
+            break;
+        }
+    }
+
+    std::vector<double> information(entrant_count * entrant_count, 1.0 / entrant_count);
+    for (int32_t row = 0; row < entrant_count; ++row) {
+        for (int32_t column = 0; column < entrant_count; ++column) {
+            if (row == column) {
+                continue;
+            }
+            const double probability = strengths[row] / (strengths[row] + strengths[column]);
+            const double pair_information = pair_counts[pair_idx(row, column)] * probability * (1.0 - probability);
+            information[pair_idx(row, row)] += pair_information;
+            information[pair_idx(row, column)] -= pair_information;
+        }
+    }
+    const bool has_bounds = InvertMatrix(information, entrant_count);
+
+    for (int32_t entrant_idx = 0; entrant_idx < entrant_count; ++entrant_idx) {
+        lv::TournamentEntrantResult &rEntrant = rResult.entrants[entrant_idx];
+        rEntrant.rating = ELO_PER_NATURAL_UNIT * std::log(strengths[entrant_idx]);
+        const double variance = information[pair_idx(entrant_idx, entrant_idx)] - 1.0 / entrant_count;
+        rEntrant.rating_bound =
+            has_bounds ? confidence_z * ELO_PER_NATURAL_UNIT * std::sqrt(std::max(variance, 0.0)) : HUGE_VAL;
+
+        int64_t result_count = 0;
+        double score = 0.0;
+        for (int32_t other_idx = 0; other_idx < entrant_count; ++other_idx) {
+            result_count += rTotals.pair_counts[pair_idx(entrant_idx, other_idx)];
+            score += rTotals.pair_scores[pair_idx(entrant_idx, other_idx)];
+        }
+        rEntrant.game_count = rTotals.game_counts[entrant_idx];
+        rEntrant.score = result_count > 0 ? score / result_count : 0.0;
+        rEntrant.mean_money = rEntrant.game_count > 0
+                                  ? static_cast<double>(rTotals.total_money[entrant_idx]) / rEntrant.game_count
+                                  : 0.0;
+    }
+}
+
+} // namespace
+
+const char *lv::GetTournamentFormatName(TournamentFormat format)
+{
+    switch (format) {
+    case TournamentFormat::RoundRobin: return "round robin";
+    case TournamentFormat::Swiss: return "swiss";
+    }
+    return "unknown";
+}
+
+bool lv::RunTournament(const TournamentConfig& rConfig, TournamentResult& rResult)
+{
+    rResult = {};
+
+    // Validate configuration
+    const int32_t entrant_count = static_cast<int32_t>(rConfig.entrants.size());
+    if (entrant_count < 2 || entrant_count > TOURNAMENT_MAX_ENTRANT_COUNT) {
+        return false;
+    }
+    for (const AgentEntry &rEntrant : rConfig.entrants) {
+        if (rEntrant.factory == nullptr) {
+            return false;
+        }
+    }
+    if (rConfig.player_counts.empty() || rConfig.deal_count <= 0 || rConfig.max_game_count < 0 ||
+        rConfig.thread_count < 0) {
+        return false;
+    }
+    for (const int32_t player_count : rConfig.player_counts) {
+        if (player_count < 2 || player_count > MAX_PLAYER_COUNT || player_count > entrant_count) {
+            return false;
+        }
+    }
+
+    int32_t thread_count = rConfig.thread_count;
+    if (thread_count == 0) {
+        thread_count = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+    }
+
+    rResult.entrants.resize(entrant_count);
+    for (int32_t entrant_idx = 0; entrant_idx < entrant_count; ++entrant_idx) {
+        rResult.entrants[entrant_idx].pName = rConfig.entrants[entrant_idx].pName;
+    }
+
+    // Workers keep their agents and totals from round to round
+    struct Worker {
+        GameEngine engine{0};
+        CompactGameState game{};
+        std::vector<std::unique_ptr<Agent>> agents;
+        TournamentTotals totals;
+
+        explicit Worker(int32_t entrant_count) : totals(entrant_count) {}
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int32_t thread_idx = 0; thread_idx < thread_count; ++thread_idx) {
+        workers.push_back(std::make_unique<Worker>(entrant_count));
+        for (const AgentEntry &rEntrant : rConfig.entrants) {
+            workers.back()->agents.push_back(rEntrant.factory());
+        }
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    std::vector<int32_t> ranking(entrant_count);
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::vector<TournamentTable> tables;
+    std::vector<TournamentGame> games;
+    TournamentTotals totals{entrant_count};
+
+    while (totals.game_count < rConfig.max_game_count) {
+        tables.clear();
+        for (const int32_t player_count : rConfig.player_counts) {
+            if (rConfig.format == TournamentFormat::Swiss) {
+                AddSwissTables(ranking, player_count, tables);
+            } else {
+                AddRoundRobinTables(entrant_count, player_count, tables);
+            }
+        }
+
+        // Deal by deal, so that a round cut to the games left keeps whole deals while it can
+        games.clear();
+        for (int32_t deal_idx = 0; deal_idx < rConfig.deal_count; ++deal_idx) {
+            for (int32_t table_idx = 0; table_idx < static_cast<int32_t>(tables.size()); ++table_idx) {
+                for (int32_t rotation = 0; rotation < tables[table_idx].player_count; ++rotation) {
+                    games.push_back(TournamentGame{table_idx, deal_idx, rotation});
+                }
+            }
+        }
+        const int64_t game_budget = rConfig.max_game_count - totals.game_count;
+        if (static_cast<int64_t>(games.size()) > game_budget) {
+            games.resize(static_cast<size_t>(game_budget));
+        }
+
+        // Every table of the round plays the same deals
+        const int64_t first_deal_idx = static_cast<int64_t>(rResult.round_count) * rConfig.deal_count;
+        std::atomic<int64_t> next_game_idx{0};
+
+        auto worker_fn = [&](Worker &rWorker) {
+            GameOutcome outcome{};
+            std::array<Agent *, MAX_PLAYER_COUNT> seat_agents{};
+            TournamentTotals &rTotals = rWorker.totals;
+
+            while (true) {
+                const int64_t first_game_idx = next_game_idx.fetch_add(GAME_CHUNK_SIZE, std::memory_order_relaxed);
+                if (first_game_idx >= static_cast<int64_t>(games.size())) {
+                    break;
+                }
+                const int64_t last_game_idx =
+                    std::min<int64_t>(first_game_idx + GAME_CHUNK_SIZE, static_cast<int64_t>(games.size()));
+
+                for (int64_t game_idx = first_game_idx; game_idx < last_game_idx; ++game_idx) {
+                    const TournamentGame &rGame = games[game_idx];
+                    const TournamentTable &rTable = tables[rGame.table_idx];
+                    const int32_t player_count = rTable.player_count;
+
+                    std::array<int32_t, MAX_PLAYER_COUNT> seat_entrants{};
+                    for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+                        seat_entrants[seat_idx] = rTable.entrants[(seat_idx + rGame.rotation) % player_count];
+                        seat_agents[seat_idx] = rWorker.agents[seat_entrants[seat_idx]].get();
+                    }
+
+                    const uint64_t game_seed = GetGameSeed(rConfig.base_seed, first_deal_idx + rGame.deal_idx);
+                    rWorker.engine.Seed(game_seed);
+                    if (!PlayGame(rWorker.engine, rWorker.game, player_count, seat_agents.data(), ~game_seed,
+                                  outcome)) {
+                        ++rTotals.failed_game_count;
+                        continue;
+                    }
+
+                    for (int32_t seat_idx = 0; seat_idx < player_count; ++seat_idx) {
+                        const int32_t entrant_idx = seat_entrants[seat_idx];
+                        ++rTotals.game_counts[entrant_idx];
+                        rTotals.total_money[entrant_idx] += outcome.money[seat_idx];
+                        for (int32_t other_seat_idx = seat_idx + 1; other_seat_idx < player_count; ++other_seat_idx) {
+                            const int32_t other_idx = seat_entrants[other_seat_idx];
+                            const int32_t money = outcome.money[seat_idx];
+                            const int32_t other_money = outcome.money[other_seat_idx];
+                            const double score = money > other_money ? 1.0 : money == other_money ? 0.5 : 0.0;
+                            rTotals.pair_scores[entrant_idx * entrant_count + other_idx] += score;
+                            rTotals.pair_scores[other_idx * entrant_count + entrant_idx] += 1.0 - score;
+                            ++rTotals.pair_counts[entrant_idx * entrant_count + other_idx];
+                            ++rTotals.pair_counts[other_idx * entrant_count + entrant_idx];
+                        }
+                    }
+                    ++rTotals.game_count;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for (int32_t thread_idx = 0; thread_idx < thread_count; ++thread_idx) {
+            threads.emplace_back(worker_fn, std::ref(*workers[thread_idx]));
+        }
+        for (std::thread &rThread : threads) {
+            rThread.join();
+        }
+
+        totals = TournamentTotals{entrant_count};
+        for (const std::unique_ptr<Worker> &rWorker : workers) {
+            totals.Add(rWorker->totals);
+        }
+        ++rResult.round_count;
+        if (totals.failed_game_count > 0) {
+            break;
+        }
+
+        FitRatings(totals, rConfig.confidence_z, rResult);
+
+        std::stable_sort(ranking.begin(), ranking.end(), [&rResult](int32_t left_idx, int32_t right_idx) {
+            return rResult.entrants[left_idx].rating > rResult.entrants[right_idx].rating;
+        });
+
+        if (rConfig.target_precision > 0.0) {
+            rResult.converged = std::all_of(rResult.entrants.begin(), rResult.entrants.end(),
+                                            [&rConfig](const TournamentEntrantResult &rEntrant) {
+                                                return rEntrant.rating_bound <= rConfig.target_precision;
+                                            });
+            if (rResult.converged) {
+                break;
+            }
+        }
+    }
+
+    rResult.game_count = totals.game_count;
+    rResult.failed_game_count = totals.failed_game_count;
+    rResult.elapsed_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    return rResult.failed_game_count == 0;
+}
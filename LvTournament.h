@@ -0,0 +1,71 @@
+#pragma once
+
+#include "LvAgent.h"
+#include "LvSimulator.h"
+
+#include <vector>
+
+namespace lv {
+
+// Rating tournament between agents
+//
+// A round seats the entrants at tables of every requested player count: every combination of entrants in round robin,
+// entrants of neighbouring ratings in Swiss. Every table plays the same deals, one engine seed each, under every
+// rotation of its seats, so that pairings are compared on common random numbers and no entrant gets a luckier seat
+// or deal than another. Every game is scored pairwise on GetPlayerMoneyValue (a win, a tie or a loss against every
+// other player of the table).
+//
+// Ratings are the maximum likelihood Bradley-Terry fit of all the pairwise results on the Elo scale, averaging 0,
+// with confidence bounds from the Fisher information of the fit. The fit only depends on the results, so ratings
+// don't depend on the order games are played in, nor on the thread count. Every pair of entrants starts with one
+// virtual tie, which keeps ratings finite when an entrant wins or loses everything. Pairs of a multi-player game are
+// counted as independent results, so bounds of multi-player tournaments are somewhat optimistic.
+//
+// The tournament stops after the round where every rating is known within target_precision, or once max_game_count
+// games have been played. A round that would go past max_game_count only plays its first deals, every table and
+// rotation of a deal before the next, and the last deal may then be incomplete.
+
+enum class TournamentFormat : int32_t {
+    RoundRobin = 0,
+    Swiss,
+};
+
+enum { TOURNAMENT_MAX_ENTRANT_COUNT = 32 };
+
+struct TournamentConfig {
+    std::vector<AgentEntry> entrants;
+    TournamentFormat format = TournamentFormat::RoundRobin;
+    std::vector<int32_t> player_counts{2};
+    int32_t deal_count = 16; // Deals every table plays per round, under every rotation of its seats
+    int64_t max_game_count = 10000; // The last round is cut to the games left, whole deals first
+    double target_precision = 0.0; // Elo points at confidence_z, 0 plays every game
+    double confidence_z = 1.96;
+    int32_t thread_count = 0; // 0 uses every hardware thread
+    uint64_t base_seed = 0;
+};
+
+struct TournamentEntrantResult {
+    const char *pName = nullptr;
+    double rating = 0.0; // Elo points, entrants average 0
+    double rating_bound = 0.0; // Half width of the confidence interval of the rating
+    int64_t game_count = 0;
+    double score = 0.0; // Fraction of the pairwise results won, ties count half
+    double mean_money = 0.0;
+};
+
+struct TournamentResult {
+    std::vector<TournamentEntrantResult> entrants; // In the order of the configuration
+    int32_t round_count = 0;
+    int64_t game_count = 0;
+    int64_t failed_game_count = 0;
+    bool converged = false; // Every rating is within target_precision
+    double elapsed_seconds = 0.0;
+};
+
+const char *GetTournamentFormatName(TournamentFormat format);
+
+// Play rounds over a pool of worker threads until the ratings converge or the games run out.
+// Each worker owns its engine and one agent per entrant, results are merged after every round.
+bool RunTournament(const TournamentConfig &rConfig, TournamentResult &rResult);
+
+} // namespace lv
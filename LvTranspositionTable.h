@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace lv {
+
+// Fixed-size hash table that many threads read and write without locks
+//
+// Direct mapped: a key only goes to the entry of its low bits, and storing replaces whatever was there. Every entry is
+// a handful of 64-bit atomic words: the value, and a check word holding the key xor every value word (lockless
+// hashing). A reader racing with a writer may load words of two different stores, the check word then doesn't match
+// the key and the probe misses, so a probe never returns a torn value. Loads and stores are relaxed, the check is
+// what keeps the value consistent, and the key 0 is reserved for empty entries.
+//
+// Keys are meant to be good 64-bit hashes such as CompactGameState::hash, different keys of the same entry only
+// collide if they are equal, values are copied as raw bytes.
+template <typename T> class TranspositionTable {
+public:
+    static_assert(std::is_trivially_copyable_v<T>, "Transposition table values are copied as raw bytes");
+
+    enum { VALUE_WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t) };
+
+    explicit TranspositionTable(int32_t size_log2)
+        : m_entries(std::make_unique<Entry[]>(size_t{1} << size_log2)), m_mask((uint64_t{1} << size_log2) - 1) {
+        Clear();
+    }
+
+    int64_t GetSize() const { return static_cast<int64_t>(m_mask + 1); }
+
+    bool Probe(uint64_t key, T &rValue) const {
+        const Entry &rEntry = m_entries[key & m_mask];
+
+        std::array<uint64_t, VALUE_WORD_COUNT> words{};
+        uint64_t check = rEntry.check.load(std::memory_order_relaxed);
+        for (int32_t word_idx = 0; word_idx < VALUE_WORD_COUNT; ++word_idx) {
+            words[word_idx] = rEntry.words[word_idx].load(std::memory_order_relaxed);
+            check ^= words[word_idx];
+        }
+        if (check != key || key == 0) {
+            return false;
+        }
+
+        std::memcpy(static_cast<void *>(&rValue), words.data(), sizeof(T));
+        return true;
+    }
+
+    void Store(uint64_t key, const T &rValue) {
+        Entry &rEntry = m_entries[key & m_mask];
+
+        std::array<uint64_t, VALUE_WORD_COUNT> words{};
+        std::memcpy(words.data(), &rValue, sizeof(T));
+
+        uint64_t check = key;
+        for (int32_t word_idx = 0; word_idx < VALUE_WORD_COUNT; ++word_idx) {
+            rEntry.words[word_idx].store(words[word_idx], std::memory_order_relaxed);
+            check ^= words[word_idx];
+        }
+        rEntry.check.store(check, std::memory_order_relaxed);
+    }
+
+    // Not synchronized with concurrent stores, call it between searches
+    void Clear() {
+        for (uint64_t entry_idx = 0; entry_idx <= m_mask; ++entry_idx) {
+            Entry &rEntry = m_entries[entry_idx];
+            rEntry.check.store(0, std::memory_order_relaxed);
+            for (std::atomic<uint64_t> &rWord : rEntry.words) {
+                rWord.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check{0};
+        std::array<std::atomic<uint64_t>, VALUE_WORD_COUNT> words{};
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Entries need lock-free 64-bit atomics");
+
+    std::unique_ptr<Entry[]> m_entries;
+    uint64_t m_mask = 0;
+};
+
+} // namespace lv
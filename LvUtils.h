@@ -2,9 +2,11 @@
 
 #include "LvPublic.h"
 
+#include <algorithm>
+
 namespace lv {
 
-constexpr int32_t GetCasinoMoneyValue(const CasinoState &rCasino) {
+template <const RulesConfig &RULES> constexpr int32_t GetCasinoMoneyValue(const BasicCasinoState<RULES> &rCasino) {
     int32_t value = 0;
     for (const Bill &rBill : rCasino.bills) {
         value += static_cast<int32_t>(rBill);
@@ -20,4 +22,156 @@ constexpr int32_t GetPlayerMoneyValue(const PlayerState &rPlayer) {
     return value;
 }
 
+constexpr int32_t GetBankInitMoneyValue(const RulesConfig &rRules) {
+    int32_t value = 0;
+    for (const BankEntry &rEntry : rRules.bank_init_stock) {
+        value += static_cast<int32_t>(rEntry.bill) * rEntry.count;
+    }
+    return value;
+}
+
+constexpr int32_t GetBankInitMoneyValue() { return GetBankInitMoneyValue(STANDARD_RULES); }
+
+constexpr int32_t GetExtraWhiteDiceCount(int32_t player_count) {
+    return GetExtraWhiteDiceCount(STANDARD_RULES, player_count);
+}
+
+constexpr int32_t GetBillIndex(Bill bill) {
+    return static_cast<int32_t>(bill) / 10 - 1;
+}
+
+constexpr Bill GetBillFromIndex(int32_t bill_idx) {
+    return static_cast<Bill>((bill_idx + 1) * 10);
+}
+
+constexpr int32_t GetBillCountsMoneyValue(const BillCounts &rBills) {
+    int32_t value = 0;
+    for (int32_t bill_idx = 0; bill_idx < BILL_TYPE_COUNT; ++bill_idx) {
+        value += rBills[bill_idx] * static_cast<int32_t>(GetBillFromIndex(bill_idx));
+    }
+    return value;
+}
+
+template <const RulesConfig &RULES>
+constexpr int32_t GetCasinoMoneyValue(const BasicCompactCasinoState<RULES> &rCasino) {
+    return GetBillCountsMoneyValue(rCasino.bills);
+}
+
+constexpr int32_t GetPlayerMoneyValue(const CompactPlayerState &rPlayer) {
+    return GetBillCountsMoneyValue(rPlayer.bills);
+}
+
+enum : int32_t { CASINO_NEUTRAL_WINNER = MAX_PLAYER_COUNT, CASINO_BIDDER_COUNT = MAX_PLAYER_COUNT + 1 };
+
+// Bidders of a casino in the order they win its bills, the first one takes the highest bill. The neutral player bids
+// after the PLAYER_COUNT players of the variant, CASINO_NEUTRAL_WINNER in the standard game.
+template <size_t PLAYER_COUNT> struct BasicCasinoWinners {
+    std::array<int8_t, PLAYER_COUNT + 1> bidders{}; // Player indices or PLAYER_COUNT for the neutral player
+    int32_t count = 0;
+};
+
+using CasinoWinners = BasicCasinoWinners<MAX_PLAYER_COUNT>;
+
+// Equal bets cancel each other, the neutral bet included, then the remaining bets win by decreasing value. The bills
+// left once every winner has one go back to the bank.
+// Every bet is ranked once, without branches, instead of settling the casino one bill at a time.
+template <typename Bet, size_t PLAYER_COUNT>
+constexpr BasicCasinoWinners<PLAYER_COUNT> GetCasinoWinners(const std::array<Bet, PLAYER_COUNT> &rBets, Bet neutral_bet,
+                                                            int32_t player_count) {
+    constexpr int32_t CASINO_NEUTRAL_WINNER = PLAYER_COUNT;
+    constexpr int32_t CASINO_BIDDER_COUNT = PLAYER_COUNT + 1;
+
+    std::array<Bet, CASINO_BIDDER_COUNT> bets{};
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        bets[player_idx] = rBets[player_idx];
+    }
+    bets[CASINO_NEUTRAL_WINNER] = neutral_bet;
+
+    std::array<bool, CASINO_BIDDER_COUNT> unique{};
+    for (int32_t bidder_idx = 0; bidder_idx < CASINO_BIDDER_COUNT; ++bidder_idx) {
+        bool is_unique = bets[bidder_idx] > 0;
+        for (int32_t other_idx = 0; other_idx < CASINO_BIDDER_COUNT; ++other_idx) {
+            is_unique &= (other_idx == bidder_idx) | (bets[other_idx] != bets[bidder_idx]);
+        }
+        unique[bidder_idx] = is_unique;
+    }
+
+    // The last slot takes the cancelled bets
+    std::array<int8_t, CASINO_BIDDER_COUNT + 1> ranked{};
+    int32_t count = 0;
+    for (int32_t bidder_idx = 0; bidder_idx < CASINO_BIDDER_COUNT; ++bidder_idx) {
+        int32_t rank = 0;
+        for (int32_t other_idx = 0; other_idx < CASINO_BIDDER_COUNT; ++other_idx) {
+            rank += unique[other_idx] & (bets[other_idx] > bets[bidder_idx]);
+        }
+        ranked[unique[bidder_idx] ? rank : CASINO_BIDDER_COUNT] = static_cast<int8_t>(bidder_idx);
+        count += unique[bidder_idx];
+    }
+
+    BasicCasinoWinners<PLAYER_COUNT> winners{};
+    for (int32_t rank = 0; rank < CASINO_BIDDER_COUNT; ++rank) {
+        winners.bidders[rank] = ranked[rank];
+    }
+    winners.count = count;
+    return winners;
+}
+
+// Bills of a casino by rank, 0 for the highest one: entry bill_idx counts the bills of that value or higher
+using RankedBillCounts = std::array<int32_t, BILL_TYPE_COUNT>;
+
+// Returns the number of bills
+constexpr int32_t GetRankedBillCounts(const BillCounts &rBills, RankedBillCounts &rRankedBills) {
+    int32_t bill_count = 0;
+    for (int32_t bill_idx = BILL_TYPE_COUNT - 1; bill_idx >= 0; --bill_idx) {
+        bill_count += rBills[bill_idx];
+        rRankedBills[bill_idx] = bill_count;
+    }
+    return bill_count;
+}
+
+// Index of the bill of a rank, the highest value with more bills than rank at or above it
+constexpr int32_t GetRankedBillIndex(const RankedBillCounts &rRankedBills, int32_t rank) {
+    int32_t bill_idx = -1;
+    for (int32_t ranked_bill_count : rRankedBills) {
+        bill_idx += ranked_bill_count > rank;
+    }
+    return bill_idx;
+}
+
+// Money each player wins from a casino's bills given the final bets, neutral winnings are dropped
+template <typename Bet, size_t PLAYER_COUNT>
+constexpr void GetCasinoPayouts(const BillCounts &rBills, const std::array<Bet, PLAYER_COUNT> &rBets, Bet neutral_bet,
+                                int32_t player_count, std::array<int32_t, PLAYER_COUNT> &rPayouts) {
+    const BasicCasinoWinners<PLAYER_COUNT> winners = GetCasinoWinners(rBets, neutral_bet, player_count);
+    RankedBillCounts ranked_bills{};
+    const int32_t paid_count = std::min(winners.count, GetRankedBillCounts(rBills, ranked_bills));
+
+    std::array<int32_t, PLAYER_COUNT + 1> payouts{};
+    for (int32_t rank = 0; rank < paid_count; ++rank) {
+        payouts[winners.bidders[rank]] +=
+            static_cast<int32_t>(GetBillFromIndex(GetRankedBillIndex(ranked_bills, rank)));
+    }
+
+    for (size_t player_idx = 0; player_idx < PLAYER_COUNT; ++player_idx) {
+        rPayouts[player_idx] = payouts[player_idx];
+    }
+}
+
+// One bit per player holding the highest amount of money
+template <const RulesConfig &RULES> constexpr uint32_t GetWinnerMask(const BasicCompactGameState<RULES> &rGame) {
+    int32_t best_money = -1;
+    uint32_t winner_mask = 0;
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        const int32_t money = GetPlayerMoneyValue(rGame.players[player_idx]);
+        if (money > best_money) {
+            best_money = money;
+            winner_mask = 0;
+        }
+        if (money == best_money) {
+            winner_mask |= 1u << player_idx;
+        }
+    }
+    return winner_mask;
+}
+
 } // namespace lv
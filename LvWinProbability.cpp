@@ -0,0 +1,317 @@
+#include "LvWinProbability.h"
+#include "LvSimulator.h"
+#include "LvStateConversion.h"
+#include "LvStateHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint64_t MixKey(uint64_t key, uint64_t value)
+{
+    return lv::GetGameSeed(key, static_cast<int64_t>(value));
+}
+
+uint64_t MixKey(uint64_t key, double value)
+{
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return MixKey(key, bits);
+}
+
+enum : uint64_t { CACHE_CHECK_KEY_SEED = 0x5851F42D4C957F2Dull };
+
+uint64_t MixKey(uint64_t key, const lv::DiceCounts &rCounts)
+{
+    for (const uint8_t count : rCounts) {
+        key = MixKey(key, static_cast<uint64_t>(count));
+    }
+    return key;
+}
+
+// Cache key of an estimation from base_key, every setting changes the result. ComputeHash leaves out the current
+// roll, which changes the moves of the player to play.
+uint64_t GetCacheKey(const lv::Observation &rObservation, const lv::WinProbabilityConfig &rConfig, uint64_t base_key)
+{
+    uint64_t key = MixKey(base_key, lv::ComputeHash(rObservation.game));
+    key = MixKey(key, static_cast<uint64_t>(rObservation.game.player_count));
+    key = MixKey(key, rObservation.game.current_turn.dices);
+    key = MixKey(key, rObservation.game.current_turn.white_dices);
+    key = MixKey(key, static_cast<uint64_t>(rConfig.max_rollout_count));
+    key = MixKey(key, rConfig.time_budget_ms);
+    key = MixKey(key, rConfig.target_half_width);
+    key = MixKey(key, rConfig.confidence_z);
+    key = MixKey(key, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(rConfig.rollout_agent)));
+    key = MixKey(key, rConfig.seed);
+    return key;
+}
+
+// Share of the win of every player at the end of a game
+void GetWinShares(const lv::CompactGameState &rGame, std::array<float, lv::MAX_PLAYER_COUNT> &rShares)
+{
+    const uint32_t winner_mask = lv::GetWinnerMask(rGame);
+    int32_t winner_count = 0;
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        winner_count += (winner_mask >> player_idx) & 1;
+    }
+    for (int32_t player_idx = 0; player_idx < lv::MAX_PLAYER_COUNT; ++player_idx) {
+        rShares[player_idx] = ((winner_mask >> player_idx) & 1) ? 1.0f / winner_count : 0.0f;
+    }
+}
+
+} // namespace
+
+lv::WinProbabilityEstimator::WinProbabilityEstimator(int32_t thread_count)
+{
+    if (thread_count <= 0) {
+        thread_count = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+    }
+
+    m_workers.resize(thread_count);
+    m_threads.reserve(thread_count);
+    for (Worker &rWorker : m_workers) {
+        m_threads.emplace_back([this, &rWorker]() { WorkerLoop(rWorker); });
+    }
+}
+
+lv::WinProbabilityEstimator::~WinProbabilityEstimator()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_job_mutex);
+        m_shutdown = true;
+    }
+    m_job_start.notify_all();
+    for (std::thread &rThread : m_threads) {
+        rThread.join();
+    }
+}
+
+bool lv::WinProbabilityEstimator::Estimate(const CompactGameState& rGame, const WinProbabilityConfig& rConfig,
+                                           WinProbabilityResult& rResult)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start_time = Clock::now();
+
+    rResult = {};
+    if (rConfig.max_rollout_count <= 0 || rGame.player_count < 2 || rGame.player_count > MAX_PLAYER_COUNT) {
+        return false;
+    }
+
+    Observation observation{};
+    if (!GetObservation(rGame, rGame.current_turn.player_idx, observation)) {
+        return false;
+    }
+
+    // Nothing left to chance, see GameEngine::IsGameOver
+    if (observation.game.round >= ROUND_COUNT) {
+        std::array<float, MAX_PLAYER_COUNT> shares{};
+        GetWinShares(observation.game, shares);
+        rResult.win_probabilities = shares;
+        rResult.lower_bounds = shares;
+        rResult.upper_bounds = shares;
+        rResult.converged = true;
+        return true;
+    }
+
+    const uint64_t cache_key = GetCacheKey(observation, rConfig, 0);
+    const uint64_t cache_check_key = GetCacheKey(observation, rConfig, CACHE_CHECK_KEY_SEED);
+    CacheEntry entry{};
+    if (m_cache.Probe(cache_key, entry) && entry.check_key == cache_check_key) {
+        rResult = entry.result;
+        rResult.cached = true;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> estimate_lock(m_estimate_mutex);
+
+    // The viewers of a game ask about the same states, the estimation may have been done while waiting
+    if (m_cache.Probe(cache_key, entry) && entry.check_key == cache_check_key) {
+        rResult = entry.result;
+        rResult.cached = true;
+        return true;
+    }
+
+    Totals totals{};
+    {
+        std::unique_lock<std::mutex> lock(m_job_mutex);
+        m_observation = observation;
+        m_config = rConfig;
+        m_deadline = start_time + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double, std::milli>(rConfig.time_budget_ms));
+        m_next_rollout_idx.store(0, std::memory_order_relaxed);
+        m_stop.store(false, std::memory_order_relaxed);
+        m_totals = {};
+        m_running_worker_count = static_cast<int32_t>(m_workers.size());
+        ++m_job_idx;
+        m_job_start.notify_all();
+
+        m_job_done.wait(lock, [this]() { return m_running_worker_count == 0; });
+        totals = m_totals;
+    }
+
+    GetResult(totals, rResult);
+    if (totals.failed_rollout_count > 0) {
+        return false;
+    }
+
+    m_cache.Store(cache_key, CacheEntry{cache_check_key, rResult});
+    return true;
+}
+
+bool lv::WinProbabilityEstimator::Estimate(const GameState& rGame, const WinProbabilityConfig& rConfig,
+                                           WinProbabilityResult& rResult)
+{
+    CompactGameState compact{};
+    if (!ToCompactGameState(rGame, compact)) {
+        rResult = {};
+        return false;
+    }
+    return Estimate(compact, rConfig, rResult);
+}
+
+void lv::WinProbabilityEstimator::WorkerLoop(Worker& rWorker)
+{
+    uint64_t job_idx = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_job_mutex);
+            m_job_start.wait(lock, [this, job_idx]() { return m_shutdown || m_job_idx != job_idx; });
+            if (m_shutdown) {
+                return;
+            }
+            job_idx = m_job_idx;
+        }
+
+        RunRollouts(rWorker);
+
+        std::lock_guard<std::mutex> lock(m_job_mutex);
+        if (--m_running_worker_count == 0) {
+            m_job_done.notify_one();
+        }
+    }
+}
+
+void lv::WinProbabilityEstimator::RunRollouts(Worker& rWorker)
+{
+    const WinProbabilityConfig &rConfig = m_config;
+    const bool has_deadline = rConfig.time_budget_ms > 0.0;
+
+    // Agents are kept from one estimation to the next as long as the factory doesn't change
+    if (rWorker.agent_factory != rConfig.rollout_agent) {
+        rWorker.agent_factory = rConfig.rollout_agent;
+        for (std::unique_ptr<Agent> &rAgent : rWorker.agents) {
+            rAgent = rConfig.rollout_agent != nullptr ? rConfig.rollout_agent() : nullptr;
+        }
+    }
+
+    std::array<float, MAX_PLAYER_COUNT> shares{};
+    while (!m_stop.load(std::memory_order_relaxed)) {
+        const int64_t first_rollout_idx = m_next_rollout_idx.fetch_add(ROLLOUT_CHUNK_SIZE, std::memory_order_relaxed);
+        if (first_rollout_idx >= rConfig.max_rollout_count ||
+            (has_deadline && first_rollout_idx > 0 && std::chrono::steady_clock::now() >= m_deadline)) {
+            break;
+        }
+        const int64_t last_rollout_idx =
+            std::min<int64_t>(first_rollout_idx + ROLLOUT_CHUNK_SIZE, rConfig.max_rollout_count);
+
+        Totals chunk{};
+        for (int64_t rollout_idx = first_rollout_idx; rollout_idx < last_rollout_idx; ++rollout_idx) {
+            if (!PlayRollout(rWorker, rollout_idx, shares)) {
+                ++chunk.failed_rollout_count;
+                continue;
+            }
+            for (int32_t player_idx = 0; player_idx < m_observation.game.player_count; ++player_idx) {
+                chunk.shares[player_idx] += shares[player_idx];
+                chunk.squared_shares[player_idx] += shares[player_idx] * shares[player_idx];
+            }
+            ++chunk.rollout_count;
+        }
+
+        std::lock_guard<std::mutex> lock(m_job_mutex);
+        for (int32_t player_idx = 0; player_idx < MAX_PLAYER_COUNT; ++player_idx) {
+            m_totals.shares[player_idx] += chunk.shares[player_idx];
+            m_totals.squared_shares[player_idx] += chunk.squared_shares[player_idx];
+        }
+        m_totals.rollout_count += chunk.rollout_count;
+        m_totals.failed_rollout_count += chunk.failed_rollout_count;
+        if (m_totals.failed_rollout_count > 0 || IsConverged(m_totals)) {
+            m_stop.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool lv::WinProbabilityEstimator::PlayRollout(Worker& rWorker, int64_t rollout_idx,
+                                              std::array<float, MAX_PLAYER_COUNT>& rShares)
+{
+    GameEngine &rEngine = rWorker.engine;
+    CompactGameState &rGame = rWorker.game;
+    const uint64_t rollout_seed = GetGameSeed(m_config.seed, rollout_idx);
+    Rng rng{rollout_seed};
+    Determinize(m_observation, rng, rGame, rEngine.GetRng());
+
+    const bool use_agents = rWorker.agent_factory != nullptr;
+    if (use_agents) {
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            rWorker.agents[player_idx]->OnGameStart(rGame, static_cast<PlayerIdx>(player_idx),
+                                                    GetGameSeed(rollout_seed, player_idx));
+        }
+    }
+
+    LegalMoveList moves{};
+    while (!rEngine.IsGameOver(rGame)) {
+        if (rEngine.GetLegalMoves(rGame, moves) == 0) {
+            return false;
+        }
+        const PlayerIdx player_idx = rGame.current_turn.player_idx;
+        const DiceValue dice = use_agents ? rWorker.agents[player_idx]->ChooseDice(rGame, moves)
+                                          : moves.moves[rng.NextBelow(static_cast<uint32_t>(moves.count))].dice;
+        if (!rEngine.PlayMove(rGame, dice)) {
+            return false;
+        }
+        if (use_agents) {
+            for (int32_t agent_idx = 0; agent_idx < rGame.player_count; ++agent_idx) {
+                rWorker.agents[agent_idx]->OnMovePlayed(rGame, player_idx, dice);
+            }
+        }
+    }
+
+    GetWinShares(rGame, rShares);
+    return true;
+}
+
+bool lv::WinProbabilityEstimator::IsConverged(const Totals& rTotals) const
+{
+    if (m_config.target_half_width <= 0.0 || rTotals.rollout_count < MIN_ROLLOUT_COUNT) {
+        return false;
+    }
+
+    WinProbabilityResult result{};
+    GetResult(rTotals, result);
+    return result.converged;
+}
+
+void lv::WinProbabilityEstimator::GetResult(const Totals& rTotals, WinProbabilityResult& rResult) const
+{
+    rResult = {};
+    rResult.rollout_count = rTotals.rollout_count;
+    if (rTotals.rollout_count == 0) {
+        return;
+    }
+
+    const double count = static_cast<double>(rTotals.rollout_count);
+    bool converged = m_config.target_half_width > 0.0;
+    for (int32_t player_idx = 0; player_idx < m_observation.game.player_count; ++player_idx) {
+        const double mean = rTotals.shares[player_idx] / count;
+        const double variance =
+            count > 1.0 ? std::max(0.0, (rTotals.squared_shares[player_idx] - count * mean * mean) / (count - 1.0))
+                        : 0.25;
+        const double half_width = m_config.confidence_z * std::sqrt(variance / count);
+        rResult.win_probabilities[player_idx] = static_cast<float>(mean);
+        rResult.lower_bounds[player_idx] = static_cast<float>(std::max(0.0, mean - half_width));
+        rResult.upper_bounds[player_idx] = static_cast<float>(std::min(1.0, mean + half_width));
+        converged = converged && half_width <= m_config.target_half_width;
+    }
+    rResult.converged = converged;
+}
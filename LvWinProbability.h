@@ -0,0 +1,124 @@
+#pragma once
+
+#include "LvAgent.h"
+#include "LvGameEngine.h"
+#include "LvInformationSet.h"
+#include "LvTranspositionTable.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lv {
+
+// Monte Carlo win probabilities of a game in progress
+//
+// Every rollout plays the game to its end from a determinization of the current player's observation (see
+// Determinize), so the bank order a spectator can't see is resampled too, with random moves or with a rollout agent.
+// A win counts 1, ties are split, and the probability of each player is the mean of their shares with a normal
+// confidence interval from the sample variance.
+//
+// The estimator owns a pool of worker threads that live across estimations, each with its engine, state and rollout
+// agents. Rollouts are claimed in chunks from one shared counter, which balances independent rollouts of similar
+// cost as well as work stealing would. After every chunk the totals are merged and the estimation stops once the
+// intervals are tight enough, the rollouts run out or the deadline passes. Rollout i is seeded from
+// GetGameSeed(seed, i) whatever thread plays it, so playing the whole budget gives the same result on any pool.
+//
+// Estimations from many threads are served one at a time on the whole pool. Results are cached on the observed state,
+// current roll included, and the configuration, so that the viewers of a game asking about the same state share one
+// estimation.
+
+struct WinProbabilityConfig {
+    int64_t max_rollout_count = 100000;
+    double time_budget_ms = 10.0;    // From the call, checked between chunks, 0 for no deadline
+    double target_half_width = 0.01; // Stop once every interval is this tight, 0 plays the whole budget
+    double confidence_z = 1.96;
+    AgentFactoryFn rollout_agent = nullptr; // Random moves when null
+    uint64_t seed = 0;
+};
+
+struct WinProbabilityResult {
+    std::array<float, MAX_PLAYER_COUNT> win_probabilities{};
+    std::array<float, MAX_PLAYER_COUNT> lower_bounds{};
+    std::array<float, MAX_PLAYER_COUNT> upper_bounds{};
+    int64_t rollout_count = 0; // 0 when the game is over, the result is exact then
+    bool converged = false;    // Every interval is within target_half_width
+    bool cached = false;
+};
+
+class WinProbabilityEstimator {
+public:
+    enum { ROLLOUT_CHUNK_SIZE = 32 }; // The first chunk is played whatever the deadline
+    enum { MIN_ROLLOUT_COUNT = 256 }; // Rollouts before intervals are trusted to stop
+    enum { CACHE_SIZE_LOG2 = 12 };
+
+    explicit WinProbabilityEstimator(int32_t thread_count = 0); // 0 uses every hardware thread
+    ~WinProbabilityEstimator();
+
+    WinProbabilityEstimator(const WinProbabilityEstimator &) = delete;
+    WinProbabilityEstimator &operator=(const WinProbabilityEstimator &) = delete;
+
+    // Fails if the state isn't a valid game in progress or if a rollout fails
+    bool Estimate(const CompactGameState &rGame, const WinProbabilityConfig &rConfig, WinProbabilityResult &rResult);
+    bool Estimate(const GameState &rGame, const WinProbabilityConfig &rConfig, WinProbabilityResult &rResult);
+
+    int32_t GetThreadCount() const { return static_cast<int32_t>(m_threads.size()); }
+
+private:
+    // Win shares summed over rollouts
+    struct Totals {
+        std::array<double, MAX_PLAYER_COUNT> shares{};
+        std::array<double, MAX_PLAYER_COUNT> squared_shares{};
+        int64_t rollout_count = 0;
+        int64_t failed_rollout_count = 0;
+    };
+
+    // The table key picks the slot, check_key is a second hash of the same inputs that a hit must match as well
+    struct CacheEntry {
+        uint64_t check_key = 0;
+        WinProbabilityResult result{};
+    };
+
+    struct Worker {
+        GameEngine engine{0};
+        CompactGameState game{};
+        AgentFactoryFn agent_factory = nullptr;
+        std::array<std::unique_ptr<Agent>, MAX_PLAYER_COUNT> agents{};
+    };
+
+    void WorkerLoop(Worker &rWorker);
+    void RunRollouts(Worker &rWorker);
+    bool PlayRollout(Worker &rWorker, int64_t rollout_idx, std::array<float, MAX_PLAYER_COUNT> &rShares);
+    bool IsConverged(const Totals &rTotals) const;
+    void GetResult(const Totals &rTotals, WinProbabilityResult &rResult) const;
+
+    std::vector<Worker> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // One estimation at a time
+    std::mutex m_estimate_mutex;
+
+    // Current job, written by Estimate before waking the workers
+    Observation m_observation{};
+    WinProbabilityConfig m_config{};
+    std::chrono::steady_clock::time_point m_deadline{};
+    std::atomic<int64_t> m_next_rollout_idx{0};
+    std::atomic<bool> m_stop{false};
+
+    std::mutex m_job_mutex;
+    std::condition_variable m_job_start;
+    std::condition_variable m_job_done;
+    uint64_t m_job_idx = 0;
+    int32_t m_running_worker_count = 0;
+    bool m_shutdown = false;
+    Totals m_totals{}; // Merged under m_job_mutex
+
+    TranspositionTable<CacheEntry> m_cache{CACHE_SIZE_LOG2};
+};
+
+} // namespace lv
@@ -0,0 +1,665 @@
+// Benchmarks of the engine hot paths and of full game throughput
+//
+// Every micro benchmark runs on a pool of states taken from random games, for both game state representations and
+// every player count. Steps that consume their input (AllocateDices, DistributeCasinoBills) restore it on each
+// operation, which is part of the measured time. FullGameRules plays random games on every rules variant of
+// LV_FOR_EACH_RULES and checks each round against the variant's rules. Results are printed as a table, or as
+// JSON / CSV to compare commits.
+
+#include "LvBatchGameEngine.h"
+#include "LvFeatureEncoder.h"
+#include "LvGameEngine.h"
+#include "LvInformationSet.h"
+#include "LvRulesChecker.h"
+#include "LvSimulator.h"
+#include "LvStateConversion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lv {
+
+// Access to the engine's private steps
+class GameEngineBenchmark {
+public:
+    static bool RollDices(GameEngine &rEngine, DiceCounts &rDices, int32_t dice_count) {
+        return rEngine.RollDices(rDices, dice_count);
+    }
+    static bool RollDices(GameEngine &rEngine, DiceVector &rDices, int32_t dice_count) {
+        return rEngine.RollDices(rDices, dice_count);
+    }
+    static void ShuffleBank(GameEngine &rEngine, CompactGameState &rGame) { rEngine.ShuffleBank(rGame); }
+    static void ShuffleBank(GameEngine &rEngine, GameState &rGame) { rEngine.ShuffleBank(rGame.bank); }
+    static bool DistributeCasinoBills(GameEngine &rEngine, CompactGameState &rGame) {
+        return rEngine.DistributeCasinoBills(rGame);
+    }
+    static bool DistributeCasinoBills(GameEngine &rEngine, GameState &rGame) {
+        return rEngine.DistributeCasinoBills(rGame);
+    }
+};
+
+} // namespace lv
+
+namespace {
+
+enum { STATE_POOL_SIZE = 1024 };
+enum { BATCH_GAME_COUNT = 1024 };
+enum { BENCHMARK_REPETITION_COUNT = 5 };
+
+struct BenchmarkConfig {
+    double min_seconds = 0.25; // Per repetition
+    int64_t game_count = 20000;
+    int32_t thread_count = 0;
+    std::string filter;
+    std::string format = "text";
+    std::string output_path;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    std::string state; // "compact", "vector", "pool", the rules variant of FullGameRules or empty
+    int32_t player_count = 0;
+    int32_t thread_count = 1;
+    int64_t op_count = 0;
+    double ns_per_op = 0.0;
+    double ops_per_second = 0.0;
+};
+
+// Keeps the results of the measured code alive
+volatile uint64_t g_sink = 0;
+
+// Run fn(op_count) in batches until each repetition lasts config.min_seconds, report the median repetition
+template <typename Fn>
+BenchmarkResult Measure(const BenchmarkConfig &rConfig, const char *pName, const char *pState, int32_t player_count,
+                        Fn &&fn)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Find a batch size lasting about a tenth of a repetition
+    int64_t batch_op_count = 16;
+    while (true) {
+        const auto start = Clock::now();
+        g_sink = g_sink + fn(batch_op_count);
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= rConfig.min_seconds / 10 || batch_op_count >= (int64_t{1} << 40)) {
+            break;
+        }
+        batch_op_count *= 2;
+    }
+
+    std::vector<double> ns_per_op;
+    int64_t total_op_count = 0;
+    for (int32_t repetition = 0; repetition < BENCHMARK_REPETITION_COUNT; ++repetition) {
+        int64_t op_count = 0;
+        const auto start = Clock::now();
+        double seconds = 0.0;
+        while (seconds < rConfig.min_seconds) {
+            g_sink = g_sink + fn(batch_op_count);
+            op_count += batch_op_count;
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        ns_per_op.push_back(seconds * 1e9 / op_count);
+        total_op_count += op_count;
+    }
+    std::sort(ns_per_op.begin(), ns_per_op.end());
+
+    BenchmarkResult result{};
+    result.name = pName;
+    result.state = pState;
+    result.player_count = player_count;
+    result.op_count = total_op_count;
+    result.ns_per_op = ns_per_op[ns_per_op.size() / 2];
+    result.ops_per_second = 1e9 / result.ns_per_op;
+
+    return result;
+}
+
+// States taken from random games: mid-round ones with dices to play, and rounds whose dices are all allocated
+void GenerateStates(int32_t player_count, std::vector<lv::CompactGameState> &rMidRoundStates,
+                    std::vector<lv::CompactGameState> &rEndRoundStates)
+{
+    lv::GameEngine engine{static_cast<uint64_t>(player_count)};
+    lv::Rng rng{~static_cast<uint64_t>(player_count)};
+    lv::CompactGameState game{};
+    lv::LegalMoveList moves{};
+
+    rMidRoundStates.clear();
+    rEndRoundStates.clear();
+
+    while (rMidRoundStates.size() < STATE_POOL_SIZE || rEndRoundStates.size() < STATE_POOL_SIZE) {
+        engine.SetupInitGameState(game, player_count);
+        engine.SetupRound(game);
+        engine.StartRound(game);
+
+        while (!engine.IsGameOver(game)) {
+            if (rMidRoundStates.size() < STATE_POOL_SIZE && rng.NextBelow(8) == 0) {
+                rMidRoundStates.push_back(game);
+            }
+
+            engine.GetLegalMoves(game, moves);
+            engine.AllocateDices(game, moves.moves[rng.NextBelow(moves.count)].dice);
+
+            if (!engine.IsRoundOver(game)) {
+                engine.AdvanceToNextPlayer(game);
+                continue;
+            }
+
+            if (rEndRoundStates.size() < STATE_POOL_SIZE) {
+                rEndRoundStates.push_back(game);
+            }
+            engine.EndRound(game);
+            if (!engine.IsGameOver(game)) {
+                engine.SetupRound(game);
+                engine.StartRound(game);
+            }
+        }
+    }
+}
+
+std::vector<lv::GameState> ToGameStates(const std::vector<lv::CompactGameState> &rStates)
+{
+    std::vector<lv::GameState> states(rStates.size());
+    for (size_t state_idx = 0; state_idx < rStates.size(); ++state_idx) {
+        lv::ToGameState(rStates[state_idx], states[state_idx]);
+    }
+    return states;
+}
+
+// Same benchmarks for both state representations
+template <typename State>
+void RunStepBenchmarks(const BenchmarkConfig &rConfig, const char *pState, int32_t player_count,
+                       const std::vector<State> &rMidRoundStates, const std::vector<State> &rEndRoundStates,
+                       std::vector<BenchmarkResult> &rResults)
+{
+    using Access = lv::GameEngineBenchmark;
+
+    const auto is_selected = [&](const char *pName) {
+        return rConfig.filter.empty() || std::strstr(pName, rConfig.filter.c_str()) != nullptr;
+    };
+
+    lv::GameEngine engine{1234};
+    const lv::RulesChecker checker{};
+    const int32_t white_dice_count = lv::GetExtraWhiteDiceCount(player_count);
+
+    if (is_selected("RollDices")) {
+        State game = rMidRoundStates[0];
+        rResults.push_back(Measure(rConfig, "RollDices", pState, player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                Access::RollDices(engine, game.current_turn.dices, lv::DICE_COUNT);
+                Access::RollDices(engine, game.current_turn.white_dices, white_dice_count);
+                checksum += static_cast<uint64_t>(game.current_turn.dices[0]);
+            }
+            return checksum;
+        }));
+    }
+
+    if (is_selected("ShuffleBank")) {
+        State game{};
+        engine.SetupInitGameState(game, player_count);
+        rResults.push_back(Measure(rConfig, "ShuffleBank", pState, player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                Access::ShuffleBank(engine, game);
+                checksum += static_cast<uint64_t>(game.bank[0]);
+            }
+            return checksum;
+        }));
+    }
+
+    if (is_selected("AllocateDices")) {
+        std::vector<State> states = rMidRoundStates;
+        std::vector<lv::DiceValue> moves(states.size());
+        lv::Rng rng{5678};
+        for (size_t state_idx = 0; state_idx < states.size(); ++state_idx) {
+            lv::LegalMoveList legal_moves{};
+            engine.GetLegalMoves(states[state_idx], legal_moves);
+            moves[state_idx] = legal_moves.moves[rng.NextBelow(legal_moves.count)].dice;
+        }
+
+        rResults.push_back(Measure(rConfig, "AllocateDices", pState, player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                State &rGame = states[op_idx % states.size()];
+                const lv::DiceValue dice = moves[op_idx % states.size()];
+                const auto previous_turn = rGame.current_turn;
+                const uint64_t previous_hash = rGame.hash;
+                const auto &rPlayer = rGame.players[rGame.current_turn.player_idx];
+                const int32_t dices = rPlayer.dices;
+                const int32_t white_dices = rPlayer.white_dices;
+                auto &rCasino = rGame.casinos[static_cast<int32_t>(dice) - 1];
+                const int32_t dice_bet = rCasino.dice_bets[previous_turn.player_idx];
+                const int32_t neutral_dice_bet = rCasino.neutral_dice_bet;
+
+                checksum += engine.AllocateDices(rGame, dice);
+
+                // Take the move back
+                auto &rAllocatedPlayer = rGame.players[previous_turn.player_idx];
+                rAllocatedPlayer.dices = static_cast<decltype(rAllocatedPlayer.dices)>(dices);
+                rAllocatedPlayer.white_dices = static_cast<decltype(rAllocatedPlayer.white_dices)>(white_dices);
+                rCasino.dice_bets[previous_turn.player_idx] =
+                    static_cast<typename std::remove_reference_t<decltype(rCasino.dice_bets)>::value_type>(dice_bet);
+                rCasino.neutral_dice_bet = static_cast<decltype(rCasino.neutral_dice_bet)>(neutral_dice_bet);
+                rGame.current_turn = previous_turn;
+                rGame.hash = previous_hash;
+            }
+            return checksum;
+        }));
+    }
+
+    if (is_selected("DistributeCasinoBills")) {
+        State game = rEndRoundStates[0];
+        rResults.push_back(Measure(rConfig, "DistributeCasinoBills", pState, player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                game = rEndRoundStates[op_idx % rEndRoundStates.size()];
+                checksum += Access::DistributeCasinoBills(engine, game);
+            }
+            return checksum;
+        }));
+    }
+
+    if (is_selected("AdvanceToNextPlayer")) {
+        std::vector<State> states = rMidRoundStates;
+        rResults.push_back(Measure(rConfig, "AdvanceToNextPlayer", pState, player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                State &rGame = states[op_idx % states.size()];
+                checksum += engine.AdvanceToNextPlayer(rGame);
+                checksum += rGame.current_turn.player_idx;
+            }
+            return checksum;
+        }));
+    }
+
+    if (is_selected("ValidateGameState")) {
+        rResults.push_back(Measure(rConfig, "ValidateGameState", pState, player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                checksum += checker.ValidateGameState(rMidRoundStates[op_idx % rMidRoundStates.size()]);
+            }
+            return checksum;
+        }));
+    }
+}
+
+// Search state sampling, compared to a plain state copy
+void RunDeterminizeBenchmarks(const BenchmarkConfig &rConfig, int32_t player_count,
+                              const std::vector<lv::CompactGameState> &rMidRoundStates,
+                              std::vector<BenchmarkResult> &rResults)
+{
+    const auto is_selected = [&](const char *pName) {
+        return rConfig.filter.empty() || std::strstr(pName, rConfig.filter.c_str()) != nullptr;
+    };
+
+    lv::CompactGameState game{};
+    lv::Rng rng{1234};
+    lv::Rng chance_rng{};
+
+    if (is_selected("CopyState")) {
+        rResults.push_back(Measure(rConfig, "CopyState", "compact", player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                game = rMidRoundStates[op_idx % rMidRoundStates.size()];
+                checksum += game.bank[0];
+            }
+            return checksum;
+        }));
+    }
+
+    if (is_selected("Determinize")) {
+        lv::Observation observation{};
+        lv::GetObservation(rMidRoundStates[0], rMidRoundStates[0].current_turn.player_idx, observation);
+        rResults.push_back(Measure(rConfig, "Determinize", "compact", player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; ++op_idx) {
+                lv::Determinize(observation, rng, game, chance_rng);
+                checksum += game.bank[0] + chance_rng.GetState()[0];
+            }
+            return checksum;
+        }));
+    }
+
+    // One op is a state, encoded in batches of up to the whole pool
+    if (is_selected("EncodeFeatures")) {
+        const int32_t state_count = static_cast<int32_t>(rMidRoundStates.size());
+        std::vector<int8_t> raw_features(static_cast<size_t>(state_count) * lv::FEATURE_COUNT);
+        std::vector<float> features(raw_features.size());
+        rResults.push_back(Measure(rConfig, "EncodeFeaturesInt8", "compact", player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; op_idx += state_count) {
+                const int32_t batch_size = static_cast<int32_t>(std::min<int64_t>(state_count, op_count - op_idx));
+                checksum += lv::EncodeFeatureBatch(rMidRoundStates.data(), nullptr, batch_size, raw_features.data());
+                checksum += static_cast<uint64_t>(raw_features[lv::FEATURE_TURN_DICES_OFFSET]);
+            }
+            return checksum;
+        }));
+        rResults.push_back(Measure(rConfig, "EncodeFeaturesFloat", "compact", player_count, [&](int64_t op_count) {
+            uint64_t checksum = 0;
+            for (int64_t op_idx = 0; op_idx < op_count; op_idx += state_count) {
+                const int32_t batch_size = static_cast<int32_t>(std::min<int64_t>(state_count, op_count - op_idx));
+                checksum += lv::EncodeFeatureBatch(rMidRoundStates.data(), nullptr, batch_size, features.data());
+                checksum += static_cast<uint64_t>(features[lv::FEATURE_TURN_DICES_OFFSET]);
+            }
+            return checksum;
+        }));
+    }
+}
+
+// Full games with random agents, through the simulator
+BenchmarkResult RunGameBenchmark(const BenchmarkConfig &rConfig, int32_t player_count, int32_t thread_count)
+{
+    lv::SimulationConfig simulation_config{};
+    simulation_config.game_count = rConfig.game_count;
+    simulation_config.thread_count = thread_count;
+    simulation_config.player_count = player_count;
+    simulation_config.agents.fill(lv::FindAgent("random"));
+
+    lv::SimulationResult simulation_result{};
+    lv::RunSimulation(simulation_config, simulation_result);
+
+    BenchmarkResult result{};
+    result.name = "FullGame";
+    result.player_count = player_count;
+    result.thread_count = thread_count;
+    result.op_count = simulation_result.game_count;
+    result.ops_per_second = simulation_result.games_per_second;
+    result.ns_per_op = result.ops_per_second > 0.0 ? 1e9 / result.ops_per_second : 0.0;
+
+    return result;
+}
+
+// Full games with random moves in a batch engine, a lane starts a new game as soon as its game is over
+BenchmarkResult RunBatchGameBenchmark(const BenchmarkConfig &rConfig, int32_t player_count)
+{
+    using Clock = std::chrono::steady_clock;
+
+    lv::BatchGameEngine batch{BATCH_GAME_COUNT, player_count};
+    std::vector<lv::DiceValue> moves(BATCH_GAME_COUNT, lv::DiceValue{});
+    lv::Rng move_rng{static_cast<uint64_t>(player_count)};
+    lv::LegalMoveList legal_moves{};
+
+    const auto start = Clock::now();
+
+    int64_t started_game_count = 0;
+    for (int32_t game_idx = 0; game_idx < BATCH_GAME_COUNT && started_game_count < rConfig.game_count; ++game_idx) {
+        batch.SetupGame(game_idx, static_cast<uint64_t>(started_game_count++));
+    }
+
+    while (batch.GetRunningGameCount() > 0) {
+        for (int32_t game_idx = 0; game_idx < BATCH_GAME_COUNT; ++game_idx) {
+            if (batch.IsGameOver(game_idx) && started_game_count < rConfig.game_count) {
+                batch.SetupGame(game_idx, static_cast<uint64_t>(started_game_count++));
+            }
+            if (batch.GetLegalMoves(game_idx, legal_moves) > 0) {
+                moves[game_idx] = legal_moves.moves[move_rng.NextBelow(legal_moves.count)].dice;
+            }
+        }
+        if (!batch.PlayMoves(moves.data())) {
+            break;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    BenchmarkResult result{};
+    result.name = "FullGameBatch";
+    result.state = "compact";
+    result.player_count = player_count;
+    result.op_count = started_game_count;
+    result.ops_per_second = seconds > 0.0 ? static_cast<double>(started_game_count) / seconds : 0.0;
+    result.ns_per_op = result.ops_per_second > 0.0 ? 1e9 / result.ops_per_second : 0.0;
+
+    return result;
+}
+
+// Full games with random moves on one vector state, its containers on the default heap or on a pool of the thread.
+// SetupInitGameState resets the state in place, so allocations stop once its containers reached their size.
+BenchmarkResult RunVectorGameBenchmark(const BenchmarkConfig &rConfig, int32_t player_count, bool use_pool)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::pmr::unsynchronized_pool_resource pool{};
+    const lv::StateAllocator allocator{use_pool ? &pool : std::pmr::get_default_resource()};
+
+    lv::GameEngine engine{static_cast<uint64_t>(player_count)};
+    lv::GameState game{allocator};
+    lv::Rng move_rng{static_cast<uint64_t>(player_count)};
+    lv::LegalMoveList legal_moves{};
+
+    const auto start = Clock::now();
+
+    int64_t game_count = 0;
+    for (; game_count < rConfig.game_count; ++game_count) {
+        if (!engine.SetupInitGameState(game, player_count) || !engine.SetupRound(game) || !engine.StartRound(game)) {
+            break;
+        }
+        while (!engine.IsGameOver(game)) {
+            engine.GetLegalMoves(game, legal_moves);
+            engine.AllocateDices(game, legal_moves.moves[move_rng.NextBelow(legal_moves.count)].dice);
+            if (!engine.IsRoundOver(game)) {
+                engine.AdvanceToNextPlayer(game);
+            } else if (engine.EndRound(game) && !engine.IsGameOver(game)) {
+                engine.SetupRound(game);
+                engine.StartRound(game);
+            }
+        }
+        g_sink = g_sink + game.hash;
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    BenchmarkResult result{};
+    result.name = "FullGameVector";
+    result.state = use_pool ? "pool" : "vector";
+    result.player_count = player_count;
+    result.op_count = game_count;
+    result.ops_per_second = seconds > 0.0 ? static_cast<double>(game_count) / seconds : 0.0;
+    result.ns_per_op = result.ops_per_second > 0.0 ? 1e9 / result.ops_per_second : 0.0;
+
+    return result;
+}
+
+// Full games with random moves on a rules variant, every round checked against the variant's rules before it ends
+template <const lv::RulesConfig &RULES>
+BenchmarkResult RunRulesGameBenchmark(const BenchmarkConfig &rConfig, int32_t player_count)
+{
+    using Clock = std::chrono::steady_clock;
+
+    lv::BasicGameEngine<RULES> engine{static_cast<uint64_t>(player_count)};
+    const lv::BasicRulesChecker<RULES> checker{};
+    lv::BasicCompactGameState<RULES> game{};
+    lv::Rng move_rng{static_cast<uint64_t>(player_count)};
+    lv::LegalMoveList legal_moves{};
+
+    const auto start = Clock::now();
+
+    int64_t game_count = 0;
+    lv::RulesViolation violation = lv::RulesViolation::None;
+    while (game_count < rConfig.game_count && violation == lv::RulesViolation::None) {
+        if (!engine.SetupInitGameState(game, player_count) || !engine.SetupRound(game) || !engine.StartRound(game)) {
+            break;
+        }
+        ++game_count;
+
+        while (!engine.IsGameOver(game) && violation == lv::RulesViolation::None) {
+            engine.GetLegalMoves(game, legal_moves);
+            engine.AllocateDices(game, legal_moves.moves[move_rng.NextBelow(legal_moves.count)].dice);
+            if (!engine.IsRoundOver(game)) {
+                engine.AdvanceToNextPlayer(game);
+                continue;
+            }
+
+            violation = checker.CheckGameState(game);
+            engine.EndRound(game);
+            if (!engine.IsGameOver(game)) {
+                engine.SetupRound(game);
+                engine.StartRound(game);
+            }
+        }
+        g_sink = g_sink + lv::GetPlayerMoneyValue(game.players[0]);
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (violation != lv::RulesViolation::None) {
+        fprintf(stderr, "%s rules, %d players: %s in game %lld\n", RULES.pName, player_count,
+                lv::GetRulesViolationName(violation), static_cast<long long>(game_count));
+    }
+
+    BenchmarkResult result{};
+    result.name = "FullGameRules";
+    result.state = RULES.pName;
+    result.player_count = player_count;
+    result.op_count = game_count;
+    result.ops_per_second = seconds > 0.0 ? static_cast<double>(game_count) / seconds : 0.0;
+    result.ns_per_op = result.ops_per_second > 0.0 ? 1e9 / result.ops_per_second : 0.0;
+
+    return result;
+}
+
+template <const lv::RulesConfig &RULES>
+void RunRulesGameBenchmarks(const BenchmarkConfig &rConfig, std::vector<BenchmarkResult> &rResults)
+{
+    for (int32_t player_count = 2; player_count <= lv::RulesTraits<RULES>::MAX_PLAYER_COUNT; ++player_count) {
+        rResults.push_back(RunRulesGameBenchmark<RULES>(rConfig, player_count));
+    }
+}
+
+void WriteResults(FILE *pFile, const std::string &rFormat, const std::vector<BenchmarkResult> &rResults)
+{
+    if (rFormat == "json") {
+        fprintf(pFile, "{\n  \"version\": 1,\n  \"results\": [\n");
+        for (size_t result_idx = 0; result_idx < rResults.size(); ++result_idx) {
+            const BenchmarkResult &rResult = rResults[result_idx];
+            fprintf(pFile,
+                    "    {\"name\": \"%s\", \"state\": \"%s\", \"players\": %d, \"threads\": %d, \"ops\": %lld, "
+                    "\"ns_per_op\": %.3f, \"ops_per_second\": %.1f}%s\n",
+                    rResult.name.c_str(), rResult.state.c_str(), rResult.player_count, rResult.thread_count,
+                    static_cast<long long>(rResult.op_count), rResult.ns_per_op, rResult.ops_per_second,
+                    result_idx + 1 < rResults.size() ? "," : "");
+        }
+        fprintf(pFile, "  ]\n}\n");
+    } else if (rFormat == "csv") {
+        fprintf(pFile, "name,state,players,threads,ops,ns_per_op,ops_per_second\n");
+        for (const BenchmarkResult &rResult : rResults) {
+            fprintf(pFile, "%s,%s,%d,%d,%lld,%.3f,%.1f\n", rResult.name.c_str(), rResult.state.c_str(),
+                    rResult.player_count, rResult.thread_count, static_cast<long long>(rResult.op_count),
+                    rResult.ns_per_op, rResult.ops_per_second);
+        }
+    } else {
+        fprintf(pFile, "%-24s %-10s %7s %7s %14s %16s\n", "Benchmark", "State", "Players", "Threads", "ns/op",
+                "ops/s");
+        for (const BenchmarkResult &rResult : rResults) {
+            fprintf(pFile, "%-24s %-10s %7d %7d %14.2f %16.0f\n", rResult.name.c_str(), rResult.state.c_str(),
+                    rResult.player_count, rResult.thread_count, rResult.ns_per_op, rResult.ops_per_second);
+        }
+    }
+}
+
+void PrintUsage()
+{
+    printf("Usage: LasVegBenchmark [options]\n"
+           "  --min-time S     Minimum duration of each of the %d repetitions, in seconds (default 0.25)\n"
+           "  --games N        Games played by the full game benchmarks (default 20000)\n"
+           "  --threads N      Threads of the multithreaded full game benchmark, 0 for all (default 0)\n"
+           "  --filter TEXT    Only run the benchmarks whose name contains TEXT\n"
+           "  --format F       text, json or csv (default text)\n"
+           "  --output PATH    Write the results to PATH instead of the standard output\n",
+           BENCHMARK_REPETITION_COUNT);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    BenchmarkConfig config{};
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--min-time") == 0 && has_value) {
+            config.min_seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--games") == 0 && has_value) {
+            config.game_count = std::strtoll(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+            config.thread_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+            config.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--format") == 0 && has_value) {
+            config.format = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+            config.output_path = argv[++i];
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (config.format != "text" && config.format != "json" && config.format != "csv") {
+        PrintUsage();
+        return 1;
+    }
+
+    int32_t thread_count = config.thread_count;
+    if (thread_count == 0) {
+        thread_count = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()));
+    }
+
+    std::vector<BenchmarkResult> results;
+    std::vector<lv::CompactGameState> mid_round_states;
+    std::vector<lv::CompactGameState> end_round_states;
+
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        GenerateStates(player_count, mid_round_states, end_round_states);
+
+        RunStepBenchmarks(config, "compact", player_count, mid_round_states, end_round_states, results);
+        RunStepBenchmarks(config, "vector", player_count, ToGameStates(mid_round_states),
+                          ToGameStates(end_round_states), results);
+        RunDeterminizeBenchmarks(config, player_count, mid_round_states, results);
+
+        if (config.filter.empty() || std::strstr("FullGame", config.filter.c_str()) != nullptr) {
+            results.push_back(RunGameBenchmark(config, player_count, 1));
+            if (thread_count > 1) {
+                results.push_back(RunGameBenchmark(config, player_count, thread_count));
+            }
+        }
+        if (config.filter.empty() || std::strstr("FullGameBatch", config.filter.c_str()) != nullptr) {
+            results.push_back(RunBatchGameBenchmark(config, player_count));
+        }
+        if (config.filter.empty() || std::strstr("FullGameVector", config.filter.c_str()) != nullptr) {
+            results.push_back(RunVectorGameBenchmark(config, player_count, false));
+            results.push_back(RunVectorGameBenchmark(config, player_count, true));
+        }
+    }
+
+    // Every rules variant, compact states only
+    if (config.filter.empty() || std::strstr("FullGameRules", config.filter.c_str()) != nullptr) {
+#define LV_RUN_RULES_GAME_BENCHMARKS(RULES) RunRulesGameBenchmarks<lv::RULES>(config, results);
+        LV_FOR_EACH_RULES(LV_RUN_RULES_GAME_BENCHMARKS)
+#undef LV_RUN_RULES_GAME_BENCHMARKS
+    }
+
+    FILE *pFile = stdout;
+    if (!config.output_path.empty()) {
+        pFile = std::fopen(config.output_path.c_str(), "w");
+        if (pFile == nullptr) {
+            printf("Cannot open '%s'\n", config.output_path.c_str());
+            return 1;
+        }
+    }
+
+    WriteResults(pFile, config.format, results);
+
+    if (pFile != stdout) {
+        std::fclose(pFile);
+    }
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+#include "LvGameServer.h"
+#include "LvRandom.h"
+#include "LvSimulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Load generator of the game server: every connection keeps a number of games going, one request in flight per game,
+// and measures the latency of every request from sending it to reading its response
+
+namespace {
+
+struct LoadConfig {
+    lv::ServerAddress address;
+    int32_t connection_count = 4;
+    int32_t games_per_connection = 64;
+    double seconds = 5.0;
+    int32_t player_count = 2;
+    std::string bot_name = "greedy";
+    uint64_t seed = 0;
+};
+
+struct ConnectionResult {
+    bool connected = false;
+    int64_t error_count = 0;
+    int64_t game_count = 0;     // Finished games
+    int64_t bot_move_count = 0; // Moves the server played for its bots
+    std::array<lv::LatencyHistogram, lv::SERVER_REQUEST_TYPE_COUNT> latencies{};
+};
+
+// What a game of the load generator waits for
+enum class SlotStep : int32_t {
+    New,
+    Move,
+    Close,
+    Done,
+};
+
+struct Slot {
+    SlotStep step = SlotStep::New;
+    int64_t send_ns = 0;
+};
+
+void AppendRequest(std::string &rOutput, Slot &rSlot, int32_t slot_idx, SlotStep step, const char *pRequest)
+{
+    rSlot.step = step;
+    rSlot.send_ns = lv::GetSteadyClockNs();
+    rOutput += "{\"id\":";
+    rOutput += std::to_string(slot_idx);
+    rOutput += ',';
+    rOutput += pRequest;
+    rOutput += "}\n";
+}
+
+void AppendNewRequest(const LoadConfig &rConfig, std::string &rOutput, Slot &rSlot, int32_t slot_idx)
+{
+    const std::string request = "\"op\":\"new\",\"players\":" + std::to_string(rConfig.player_count) +
+                                ",\"seat\":0,\"bots\":\"" + rConfig.bot_name + "\"";
+    AppendRequest(rOutput, rSlot, slot_idx, SlotStep::New, request.c_str());
+}
+
+void RunConnection(const LoadConfig &rConfig, int32_t connection_idx, int64_t end_ns, ConnectionResult &rResult)
+{
+    const int fd = lv::ConnectSocket(rConfig.address);
+    if (fd == lv::INVALID_SOCKET_FD) {
+        return;
+    }
+    rResult.connected = true;
+
+    lv::Rng rng{lv::GetGameSeed(rConfig.seed, connection_idx)};
+    std::vector<Slot> slots(rConfig.games_per_connection);
+    std::string output;
+    std::string input;
+    std::vector<char> buffer(64 * 1024);
+    int32_t active_count = rConfig.games_per_connection;
+
+    for (int32_t slot_idx = 0; slot_idx < rConfig.games_per_connection; ++slot_idx) {
+        AppendNewRequest(rConfig, output, slots[slot_idx], slot_idx);
+    }
+
+    while (active_count > 0) {
+        if (!output.empty() && !lv::SendAll(fd, output)) {
+            break;
+        }
+        output.clear();
+
+        const int64_t received_size = lv::ReceiveSome(fd, buffer.data(), buffer.size());
+        if (received_size <= 0) {
+            break;
+        }
+        const int64_t receive_ns = lv::GetSteadyClockNs();
+        const bool stopping = receive_ns >= end_ns;
+        input.append(buffer.data(), static_cast<size_t>(received_size));
+
+        size_t line_pos = 0;
+        while (true) {
+            const size_t end_pos = input.find('\n', line_pos);
+            if (end_pos == std::string::npos) {
+                break;
+            }
+            const std::string_view line(input.data() + line_pos, end_pos - line_pos);
+            line_pos = end_pos + 1;
+
+            int64_t slot_idx = -1;
+            if (!lv::GetJsonInt(line, "id", slot_idx) || slot_idx < 0 || slot_idx >= rConfig.games_per_connection) {
+                ++rResult.error_count;
+                continue;
+            }
+            Slot &rSlot = slots[slot_idx];
+            const lv::ServerRequestType type = rSlot.step == SlotStep::New    ? lv::ServerRequestType::New
+                                               : rSlot.step == SlotStep::Move ? lv::ServerRequestType::Move
+                                                                              : lv::ServerRequestType::Close;
+            rResult.latencies[static_cast<int32_t>(type)].Record(receive_ns - rSlot.send_ns);
+
+            bool ok = false;
+            int64_t game_id = 0;
+            bool over = false;
+            if (!lv::GetJsonBool(line, "ok", ok) || !ok) {
+                ++rResult.error_count;
+            }
+            if (rSlot.step == SlotStep::Close || !ok || !lv::GetJsonInt(line, "game", game_id) ||
+                !lv::GetJsonBool(line, "over", over)) {
+                // Start another game, or stop once the time is up
+                if (stopping) {
+                    rSlot.step = SlotStep::Done;
+                    --active_count;
+                } else {
+                    AppendNewRequest(rConfig, output, rSlot, static_cast<int32_t>(slot_idx));
+                }
+                continue;
+            }
+
+            int64_t bot_move_count = 0;
+            lv::GetJsonInt(line, "bot_moves", bot_move_count);
+            rResult.bot_move_count += bot_move_count;
+
+            // Games still going once the time is up are closed
+            const std::string game_text = std::to_string(game_id);
+            if (over || stopping) {
+                rResult.game_count += over;
+                AppendRequest(output, rSlot, static_cast<int32_t>(slot_idx), SlotStep::Close,
+                              ("\"op\":\"close\",\"game\":" + game_text).c_str());
+                continue;
+            }
+
+            // Play a random rolled face
+            std::array<int32_t, lv::CASINO_COUNT> dices{};
+            std::array<int32_t, lv::CASINO_COUNT> white_dices{};
+            lv::GetJsonIntArray(line, "dices", dices.data(), lv::CASINO_COUNT);
+            lv::GetJsonIntArray(line, "white_dices", white_dices.data(), lv::CASINO_COUNT);
+            std::array<int32_t, lv::CASINO_COUNT> faces{};
+            int32_t face_count = 0;
+            for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT; ++face_idx) {
+                if (dices[face_idx] > 0 || white_dices[face_idx] > 0) {
+                    faces[face_count++] = face_idx + 1;
+                }
+            }
+            const int32_t dice = face_count > 0 ? faces[rng.NextBelow(static_cast<uint32_t>(face_count))] : 1;
+            AppendRequest(output, rSlot, static_cast<int32_t>(slot_idx), SlotStep::Move,
+                          ("\"op\":\"move\",\"game\":" + game_text + ",\"dice\":" + std::to_string(dice)).c_str());
+        }
+        input.erase(0, line_pos);
+    }
+
+    lv::CloseSocket(fd);
+}
+
+// Ask the server for its own statistics
+std::string GetServerStats(const LoadConfig &rConfig)
+{
+    const int fd = lv::ConnectSocket(rConfig.address);
+    if (fd == lv::INVALID_SOCKET_FD || !lv::SendAll(fd, "{\"id\":0,\"op\":\"stats\"}\n")) {
+        lv::CloseSocket(fd);
+        return {};
+    }
+
+    std::string response;
+    std::vector<char> buffer(4096);
+    while (response.find('\n') == std::string::npos) {
+        const int64_t received_size = lv::ReceiveSome(fd, buffer.data(), buffer.size());
+        if (received_size <= 0) {
+            break;
+        }
+        response.append(buffer.data(), static_cast<size_t>(received_size));
+    }
+    lv::CloseSocket(fd);
+
+    return response;
+}
+
+void PrintUsage()
+{
+    printf("Usage: LasVegServerLoad [options]\n"
+           "  --address A      Server address, tcp:HOST:PORT, HOST:PORT or unix:PATH (default tcp:127.0.0.1:7777)\n"
+           "  --connections N  Connections, each on its own thread (default 4)\n"
+           "  --games N        Games kept going by every connection, one request in flight each (default 64)\n"
+           "  --seconds S      Duration of the load (default 5)\n"
+           "  --players N      Player count, 2 to 5 (default 2)\n"
+           "  --bots NAME      Agent playing the server's seats (default greedy)\n"
+           "  --seed N         Seed of the moves played (default 0)\n");
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    LoadConfig config{};
+    lv::ParseServerAddress("tcp:127.0.0.1:7777", config.address);
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--address") == 0 && has_value) {
+            if (!lv::ParseServerAddress(argv[++i], config.address)) {
+                PrintUsage();
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--connections") == 0 && has_value) {
+            config.connection_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--games") == 0 && has_value) {
+            config.games_per_connection = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && has_value) {
+            config.seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--players") == 0 && has_value) {
+            config.player_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--bots") == 0 && has_value) {
+            config.bot_name = argv[++i];
+        } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (config.connection_count <= 0 || config.games_per_connection <= 0) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<ConnectionResult>> results;
+    for (int32_t connection_idx = 0; connection_idx < config.connection_count; ++connection_idx) {
+        results.push_back(std::make_unique<ConnectionResult>());
+    }
+
+    const int64_t start_ns = lv::GetSteadyClockNs();
+    const int64_t end_ns = start_ns + static_cast<int64_t>(config.seconds * 1e9);
+
+    std::vector<std::thread> threads;
+    for (int32_t connection_idx = 0; connection_idx < config.connection_count; ++connection_idx) {
+        threads.emplace_back(RunConnection, std::cref(config), connection_idx, end_ns,
+                             std::ref(*results[connection_idx]));
+    }
+    for (std::thread &rThread : threads) {
+        rThread.join();
+    }
+
+    const double elapsed_seconds = (lv::GetSteadyClockNs() - start_ns) / 1e9;
+
+    // Merge the connections
+    auto pTotal = std::make_unique<ConnectionResult>();
+    int32_t connected_count = 0;
+    for (const std::unique_ptr<ConnectionResult> &rResult : results) {
+        connected_count += rResult->connected;
+        pTotal->error_count += rResult->error_count;
+        pTotal->game_count += rResult->game_count;
+        pTotal->bot_move_count += rResult->bot_move_count;
+        for (int32_t type_idx = 0; type_idx < lv::SERVER_REQUEST_TYPE_COUNT; ++type_idx) {
+            pTotal->latencies[type_idx].Add(rResult->latencies[type_idx]);
+        }
+    }
+    if (connected_count == 0) {
+        printf("Cannot connect to the server\n");
+        return 1;
+    }
+
+    const uint64_t move_count = pTotal->latencies[static_cast<int32_t>(lv::ServerRequestType::Move)].GetCount();
+    printf("Connections: %d, games finished: %lld, errors: %lld, %.2f s\n", connected_count,
+           static_cast<long long>(pTotal->game_count), static_cast<long long>(pTotal->error_count), elapsed_seconds);
+    printf("Client moves: %.0f/s, bot moves: %.0f/s\n", move_count / elapsed_seconds,
+           pTotal->bot_move_count / elapsed_seconds);
+    printf("%-8s %12s %10s %10s %10s %10s %10s\n", "Request", "Count", "Mean us", "p50 us", "p99 us", "p99.9 us",
+           "Max us");
+    for (int32_t type_idx = 0; type_idx < lv::SERVER_REQUEST_TYPE_COUNT; ++type_idx) {
+        const lv::LatencyHistogram &rLatencies = pTotal->latencies[type_idx];
+        if (rLatencies.GetCount() == 0) {
+            continue;
+        }
+        printf("%-8s %12llu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+               lv::GetServerRequestTypeName(static_cast<lv::ServerRequestType>(type_idx)),
+               static_cast<unsigned long long>(rLatencies.GetCount()), rLatencies.GetMean() / 1000.0,
+               rLatencies.GetPercentile(0.5) / 1000.0, rLatencies.GetPercentile(0.99) / 1000.0,
+               rLatencies.GetPercentile(0.999) / 1000.0, rLatencies.GetMax() / 1000.0);
+    }
+
+    const std::string server_stats = GetServerStats(config);
+    if (!server_stats.empty()) {
+        printf("Server: %s", server_stats.c_str());
+    }
+
+    return pTotal->error_count == 0 ? 0 : 1;
+}
@@ -1,39 +1,522 @@
-#include "LvGameEngine.h"
-#include "LvRulesChecker.h"
+#include "LvEndgameSolver.h"
+#include "LvGameReplay.h"
+#include "LvMappedFile.h"
+#include "LvNeuralNetwork.h"
+#include "LvSimulator.h"
+#include "LvTournament.h"
+#include "LvWinProbability.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
 
-int main()
+namespace {
+
+void PrintUsage()
+{
+    printf("Usage: LasVeg [options]\n"
+           "  --games N        Number of games to play (default 10000)\n"
+           "  --threads N      Worker threads, 0 for all hardware threads (default 0)\n"
+           "  --players N      Player count, 2 to 5 (default 2)\n"
+           "  --seed N         Base seed, game i is played with GetGameSeed(seed, i) (default 0)\n"
+           "  --agents LIST    Comma separated agent per seat, the last one fills the remaining seats\n"
+           "                   (default first)\n"
+           "  --record PATH    Append every game played to a game record file\n"
+           "  --replay PATH    Replay and verify every game of a game record file, then exit\n"
+           "  --game N         With --replay, only show game N of the file, at the turn given by --turn\n"
+           "  --turn N         Turn of --game to show (default 0)\n"
+           "  --tablebase PATH Endgame tablebase looked up by the endgame agents\n"
+           "  --build-tablebase PATH\n"
+           "                   Play the games on one thread and write every endgame position reached to a\n"
+           "                   tablebase file, then exit\n"
+           "  --tablebase-dice N\n"
+           "                   Dices left in the round up to which --build-tablebase solves positions (default 4)\n"
+           "  --network PATH   Value and policy network of the mcts-nn agents\n"
+           "  --tournament LIST\n"
+           "                   Rate the comma separated agents against each other, --games is the maximum game\n"
+           "                   count, then exit\n"
+           "  --tournament-format F\n"
+           "                   roundrobin or swiss (default roundrobin)\n"
+           "  --tournament-players LIST\n"
+           "                   Comma separated player counts of the tables (default 2)\n"
+           "  --tournament-deals N\n"
+           "                   Deals every table plays per round, under every seat rotation (default 16)\n"
+           "  --tournament-precision ELO\n"
+           "                   Stop once every rating is known within ELO points at 95%% confidence (default 0,\n"
+           "                   play every game)\n"
+           "Agents:");
+    for (int32_t agent_idx = 0; agent_idx < lv::AGENT_TABLE_SIZE; ++agent_idx) {
+        printf(" %s", lv::AGENT_TABLE[agent_idx].pName);
+    }
+    printf("\n");
+}
+
+bool ParseAgents(const char *pList, lv::SeatAgents &rAgents, std::array<std::string, lv::MAX_PLAYER_COUNT> &rNames)
+{
+    std::string list = pList;
+    size_t seat_idx = 0;
+    size_t start = 0;
+    while (seat_idx < lv::MAX_PLAYER_COUNT && start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        rNames[seat_idx] = list.substr(start, end - start);
+        rAgents[seat_idx] = lv::FindAgent(rNames[seat_idx].c_str());
+        if (rAgents[seat_idx] == nullptr) {
+            printf("Unknown agent '%s'\n", rNames[seat_idx].c_str());
+            return false;
+        }
+        ++seat_idx;
+        start = end + 1;
+    }
+
+    // The last agent fills the remaining seats
+    for (; seat_idx < lv::MAX_PLAYER_COUNT; ++seat_idx) {
+        rNames[seat_idx] = rNames[seat_idx - 1];
+        rAgents[seat_idx] = rAgents[seat_idx - 1];
+    }
+
+    return true;
+}
+
+// Money value below which the given fraction of the games ended, from the score histogram
+int32_t GetScorePercentile(const lv::SeatStats &rSeat, int64_t game_count, double fraction)
+{
+    const int64_t target = static_cast<int64_t>(std::ceil(game_count * fraction));
+    int64_t count = 0;
+    for (int32_t bucket_idx = 0; bucket_idx < lv::SCORE_BUCKET_COUNT; ++bucket_idx) {
+        count += rSeat.score_histogram[bucket_idx];
+        if (count >= target) {
+            return bucket_idx * lv::SCORE_BUCKET_WIDTH;
+        }
+    }
+    return (lv::SCORE_BUCKET_COUNT - 1) * lv::SCORE_BUCKET_WIDTH;
+}
+
+// Parse a comma separated list of agents or numbers, pFn(item) returns false on an invalid item
+template <typename Fn> bool ParseList(const char *pList, Fn &&fn)
+{
+    const std::string list = pList;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        if (!fn(list.substr(start, end - start))) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+// Play a rating tournament between agents and print the ratings, best first
+int RunTournament(lv::TournamentConfig &rConfig)
+{
+    lv::TournamentResult result{};
+    if (!lv::RunTournament(rConfig, result)) {
+        if (result.failed_game_count > 0) {
+            printf("Tournament failed (%lld games failed)\n", static_cast<long long>(result.failed_game_count));
+        } else {
+            printf("Invalid tournament, it needs 2 to %d agents and player counts up to the agent count\n",
+                   lv::TOURNAMENT_MAX_ENTRANT_COUNT);
+        }
+        return 1;
+    }
+
+    printf("Tournament (%s): %d rounds, %lld games, %.3f s, %s\n", lv::GetTournamentFormatName(rConfig.format),
+           result.round_count, static_cast<long long>(result.game_count), result.elapsed_seconds,
+           rConfig.target_precision <= 0.0 ? "all games played"
+           : result.converged              ? "ratings converged"
+                                           : "ratings not converged");
+
+    std::vector<lv::TournamentEntrantResult> entrants = result.entrants;
+    std::stable_sort(entrants.begin(), entrants.end(),
+                     [](const lv::TournamentEntrantResult &rLeft, const lv::TournamentEntrantResult &rRight) {
+                         return rLeft.rating > rRight.rating;
+                     });
+    for (const lv::TournamentEntrantResult &rEntrant : entrants) {
+        printf("%-12s rating %7.1f +- %5.1f, score %.4f, money mean %.1f, games %lld\n", rEntrant.pName,
+               rEntrant.rating, rEntrant.rating_bound, rEntrant.score, rEntrant.mean_money,
+               static_cast<long long>(rEntrant.game_count));
+    }
+
+    return 0;
+}
+
+// Replay every game of a record file through the engine and check it
+int RunReplay(const char *pPath)
+{
+    lv::MappedFile file;
+    if (!file.Open(pPath)) {
+        printf("Cannot open '%s'\n", pPath);
+        return 1;
+    }
+
+    lv::GameRecordReader reader(file.GetData(), file.GetSize());
+    if (!reader.IsValid()) {
+        printf("'%s' is not a game record file\n", pPath);
+        return 1;
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    lv::GameEngine engine{0};
+    lv::CompactGameState game{};
+    lv::GameRecordView record{};
+    int64_t game_count = 0;
+    int64_t turn_count = 0;
+    int64_t failed_game_count = 0;
+
+    while (reader.NextGame(record)) {
+        const lv::ReplayReport report = lv::ReplayGameRecord(record, engine, game);
+        if (report.error != lv::ReplayError::None) {
+            if (failed_game_count == 0) {
+                printf("Game %lld (seed %llu) failed at round %d turn %d: %s %s\n", static_cast<long long>(game_count),
+                       static_cast<unsigned long long>(record.seed), report.round, report.turn_idx,
+                       lv::GetReplayErrorName(report.error), lv::GetRulesViolationName(report.violation));
+            }
+            ++failed_game_count;
+        }
+        ++game_count;
+        turn_count += record.turn_count;
+    }
+
+    const double elapsed_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    printf("Replayed games: %lld, turns: %lld, failed: %lld, %.3f s, %.0f games/s, %.2f bytes/turn\n",
+           static_cast<long long>(game_count), static_cast<long long>(turn_count),
+           static_cast<long long>(failed_game_count), elapsed_seconds,
+           elapsed_seconds > 0.0 ? game_count / elapsed_seconds : 0.0,
+           turn_count > 0 ? static_cast<double>(file.GetSize()) / turn_count : 0.0);
+
+    if (reader.HasError()) {
+        printf("Record file is truncated\n");
+        return 1;
+    }
+
+    return failed_game_count == 0 ? 0 : 1;
+}
+
+void PrintGameState(const lv::CompactGameState &rGame)
+{
+    printf("Round %d, first player %u, current player %u\n", rGame.round, rGame.first_player_idx,
+           rGame.current_turn.player_idx);
+
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        const lv::CompactPlayerState &rPlayer = rGame.players[player_idx];
+        printf("  Player %d: money %d, dices %d, white dices %d\n", player_idx, lv::GetPlayerMoneyValue(rPlayer),
+               rPlayer.dices, rPlayer.white_dices);
+    }
+    if (rGame.neutral_player_present) {
+        printf("  Neutral player: money %d\n", lv::GetBillCountsMoneyValue(rGame.neutral_player_bills));
+    }
+
+    for (lv::CasinoIdx casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+        const lv::CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        printf("  Casino %u: bills", casino_idx + 1);
+        for (int32_t bill_idx = lv::BILL_TYPE_COUNT - 1; bill_idx >= 0; --bill_idx) {
+            for (int32_t i = 0; i < rCasino.bills[bill_idx]; ++i) {
+                printf(" %d", static_cast<int32_t>(lv::GetBillFromIndex(bill_idx)));
+            }
+        }
+        printf(", bets");
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            printf(" %d", rCasino.dice_bets[player_idx]);
+        }
+        if (rGame.neutral_player_present) {
+            printf(" neutral %d", rCasino.neutral_dice_bet);
+        }
+        printf("\n");
+    }
+
+    printf("  Rolled:");
+    for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT; ++face_idx) {
+        printf(" %d:%d+%d", face_idx + 1, rGame.current_turn.dices[face_idx], rGame.current_turn.white_dices[face_idx]);
+    }
+    printf("\n");
+}
+
+// Show one game of a record file at the given turn
+int RunInspect(const char *pPath, int64_t game_idx, int32_t turn_idx)
+{
+    lv::MappedFile file;
+    if (!file.Open(pPath)) {
+        printf("Cannot open '%s'\n", pPath);
+        return 1;
+    }
+
+    lv::GameRecordIndex index;
+    if (!index.Build(file.GetData(), file.GetSize())) {
+        printf("'%s' is not a valid game record file\n", pPath);
+        return 1;
+    }
+
+    lv::GameRecordView record{};
+    if (!index.FindGame(game_idx, record)) {
+        printf("No game %lld, the file holds %lld games\n", static_cast<long long>(game_idx),
+               static_cast<long long>(index.GetGameCount()));
+        return 1;
+    }
+
+    lv::GameReplay replay;
+    const lv::ReplayReport report = replay.Load(record);
+    printf("Game %lld, seed %llu, %d players, %d turns\n", static_cast<long long>(game_idx),
+           static_cast<unsigned long long>(record.seed), record.player_count, record.turn_count);
+    if (report.error != lv::ReplayError::None) {
+        printf("Replay failed at round %d turn %d: %s %s\n", report.round, report.turn_idx,
+               lv::GetReplayErrorName(report.error), lv::GetRulesViolationName(report.violation));
+    }
+
+    if (!replay.SeekTurn(turn_idx)) {
+        printf("Turn %d cannot be reached, %d turns replayed\n", turn_idx, replay.GetTurnCount());
+        return 1;
+    }
+
+    printf("Before turn %d", turn_idx);
+    if (turn_idx < replay.GetTurnCount()) {
+        printf(", recorded move %d", static_cast<int32_t>(replay.GetRecordedMove(turn_idx)));
+    }
+    printf("\n");
+    PrintGameState(replay.GetGame());
+
+    lv::WinProbabilityEstimator estimator;
+    lv::WinProbabilityResult win_probability{};
+    if (estimator.Estimate(replay.GetGame(), lv::WinProbabilityConfig{}, win_probability)) {
+        printf("Win probabilities (%lld rollouts):\n", static_cast<long long>(win_probability.rollout_count));
+        for (int32_t player_idx = 0; player_idx < replay.GetGame().player_count; ++player_idx) {
+            printf("  Player %d: %.3f [%.3f, %.3f]\n", player_idx, win_probability.win_probabilities[player_idx],
+                   win_probability.lower_bounds[player_idx], win_probability.upper_bounds[player_idx]);
+        }
+    }
+
+    return report.error == lv::ReplayError::None ? 0 : 1;
+}
+
+// Solves every position with at most max_dice_count dices left before handing the move to the agent
+class TablebaseRecorderAgent : public lv::Agent {
+public:
+    TablebaseRecorderAgent(lv::Agent *pAgent, lv::EndgameSolver *pSolver) : m_pAgent(pAgent), m_pSolver(pSolver) {}
+
+    void OnGameStart(const lv::CompactGameState &rGame, lv::PlayerIdx player_idx, uint64_t seed) override {
+        m_pAgent->OnGameStart(rGame, player_idx, seed);
+    }
+
+    lv::DiceValue ChooseDice(const lv::CompactGameState &rGame, const lv::LegalMoveList &rMoves) override {
+        lv::PlayerPayouts values{};
+        m_pSolver->Solve(rGame, values);
+        return m_pAgent->ChooseDice(rGame, rMoves);
+    }
+
+private:
+    lv::Agent *m_pAgent = nullptr;
+    lv::EndgameSolver *m_pSolver = nullptr;
+};
+
+// Play the games of rConfig and write the endgame positions they reach to a tablebase file
+int RunBuildTablebase(const lv::SimulationConfig &rConfig, int32_t max_dice_count, const char *pPath)
 {
-	lv::GameState game{};
+    const auto start_time = std::chrono::steady_clock::now();
 
-	lv::GameEngine engine{};
-    lv::RulesChecker checker{};
+    lv::EndgameTablebaseBuilder builder;
+    lv::EndgameSolver solver(max_dice_count, lv::EndgameSolver::DEFAULT_MEMO_SIZE_LOG2);
+    solver.SetTablebaseBuilder(&builder);
 
-	engine.SetupInitGameState(game, 2);
-    while (!engine.IsGameOver(game)) {
-        engine.SetupRound(game);
-        engine.StartRound(game);
-        while (!engine.IsRoundOver(game)) {
-            lv::DiceValue dice{};
+    std::array<std::unique_ptr<lv::Agent>, lv::MAX_PLAYER_COUNT> agents{};
+    std::array<std::unique_ptr<lv::Agent>, lv::MAX_PLAYER_COUNT> recorders{};
+    std::array<lv::Agent *, lv::MAX_PLAYER_COUNT> seat_agents{};
+    for (int32_t player_idx = 0; player_idx < rConfig.player_count; ++player_idx) {
+        agents[player_idx] = rConfig.agents[player_idx]();
+        recorders[player_idx] = std::make_unique<TablebaseRecorderAgent>(agents[player_idx].get(), &solver);
+        seat_agents[player_idx] = recorders[player_idx].get();
+    }
 
-            if (!game.current_turn.dices.empty()) {
-                dice = game.current_turn.dices[0];
-            } else if (!game.current_turn.white_dices.empty()) {
-                dice = game.current_turn.white_dices[0];
+    lv::GameEngine engine{0};
+    lv::CompactGameState game{};
+    lv::GameOutcome outcome{};
+    for (int64_t game_idx = 0; game_idx < rConfig.game_count; ++game_idx) {
+        const uint64_t game_seed = lv::GetGameSeed(rConfig.base_seed, game_idx);
+        engine.Seed(game_seed);
+        if (!lv::PlayGame(engine, game, rConfig.player_count, seat_agents.data(), ~game_seed, outcome)) {
+            printf("Game %lld failed\n", static_cast<long long>(game_idx));
+            return 1;
+        }
+    }
+
+    if (!builder.Write(pPath, solver.GetMaxDiceCount(), solver.HasCanonicalKeys())) {
+        printf("Cannot write '%s'\n", pPath);
+        return 1;
+    }
+
+    const double elapsed_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    printf("Tablebase: %lld positions, %llu solved, %.3f s\n", static_cast<long long>(builder.GetEntryCount()),
+           static_cast<unsigned long long>(solver.GetSolvedCount()), elapsed_seconds);
+
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    lv::SimulationConfig config{};
+    config.game_count = 10000;
+    std::array<std::string, lv::MAX_PLAYER_COUNT> agent_names{};
+    ParseAgents("first", config.agents, agent_names);
+    const char *pRecordPath = nullptr;
+    const char *pReplayPath = nullptr;
+    int64_t inspect_game_idx = -1;
+    int32_t inspect_turn_idx = 0;
+    const char *pTablebasePath = nullptr;
+    const char *pBuildTablebasePath = nullptr;
+    int32_t tablebase_dice_count = 4;
+    const char *pNetworkPath = nullptr;
+    lv::TournamentConfig tournament_config{};
+    bool run_tournament = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--games") == 0 && has_value) {
+            config.game_count = std::strtoll(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+            config.thread_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--players") == 0 && has_value) {
+            config.player_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            config.base_seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--agents") == 0 && has_value) {
+            if (!ParseAgents(argv[++i], config.agents, agent_names)) {
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--record") == 0 && has_value) {
+            pRecordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && has_value) {
+            pReplayPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--game") == 0 && has_value) {
+            inspect_game_idx = std::strtoll(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--turn") == 0 && has_value) {
+            inspect_turn_idx = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tablebase") == 0 && has_value) {
+            pTablebasePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--build-tablebase") == 0 && has_value) {
+            pBuildTablebasePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--tablebase-dice") == 0 && has_value) {
+            tablebase_dice_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--network") == 0 && has_value) {
+            pNetworkPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--tournament") == 0 && has_value) {
+            run_tournament = true;
+            const bool valid = ParseList(argv[++i], [&tournament_config](const std::string &rName) {
+                const lv::AgentFactoryFn factory = lv::FindAgent(rName.c_str());
+                if (factory == nullptr) {
+                    printf("Unknown agent '%s'\n", rName.c_str());
+                    return false;
+                }
+                for (int32_t agent_idx = 0; agent_idx < lv::AGENT_TABLE_SIZE; ++agent_idx) {
+                    if (lv::AGENT_TABLE[agent_idx].factory == factory) {
+                        tournament_config.entrants.push_back(lv::AGENT_TABLE[agent_idx]);
+                    }
+                }
+                return true;
+            });
+            if (!valid) {
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--tournament-format") == 0 && has_value) {
+            const char *pFormat = argv[++i];
+            if (std::strcmp(pFormat, "roundrobin") == 0) {
+                tournament_config.format = lv::TournamentFormat::RoundRobin;
+            } else if (std::strcmp(pFormat, "swiss") == 0) {
+                tournament_config.format = lv::TournamentFormat::Swiss;
+            } else {
+                PrintUsage();
+                return 1;
             }
-            engine.AllocateDices(game, dice);
-            engine.AdvanceToNextPlayer(game);
+        } else if (std::strcmp(argv[i], "--tournament-players") == 0 && has_value) {
+            tournament_config.player_counts.clear();
+            ParseList(argv[++i], [&tournament_config](const std::string &rCount) {
+                tournament_config.player_counts.push_back(std::atoi(rCount.c_str()));
+                return true;
+            });
+        } else if (std::strcmp(argv[i], "--tournament-deals") == 0 && has_value) {
+            tournament_config.deal_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tournament-precision") == 0 && has_value) {
+            tournament_config.target_precision = std::atof(argv[++i]);
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (pReplayPath != nullptr) {
+        if (inspect_game_idx >= 0) {
+            return RunInspect(pReplayPath, inspect_game_idx, inspect_turn_idx);
         }
-        engine.EndRound(game);
+        return RunReplay(pReplayPath);
     }
 
-    engine.SetupRound(game);
-    if (checker.ValidateGameState(game)) {
-        printf("Game state is valid\n");
-    } else {
-        printf("Game state is invalid\n");
+    if (pTablebasePath != nullptr && !lv::OpenSharedEndgameTablebase(pTablebasePath)) {
+        printf("'%s' is not a valid endgame tablebase\n", pTablebasePath);
+        return 1;
+    }
+    if (pNetworkPath != nullptr && !lv::OpenSharedNeuralNetwork(pNetworkPath)) {
+        printf("'%s' is not a valid network\n", pNetworkPath);
+        return 1;
+    }
+    if (pBuildTablebasePath != nullptr) {
+        return RunBuildTablebase(config, tablebase_dice_count, pBuildTablebasePath);
+    }
+    if (run_tournament) {
+        tournament_config.max_game_count = config.game_count;
+        tournament_config.thread_count = config.thread_count;
+        tournament_config.base_seed = config.base_seed;
+        return RunTournament(tournament_config);
+    }
+
+    lv::GameRecordWriter record_writer;
+    if (pRecordPath != nullptr) {
+        if (!record_writer.Open(pRecordPath)) {
+            printf("Cannot open '%s', or it isn't a version %d game record\n", pRecordPath, lv::GAME_RECORD_VERSION);
+            return 1;
+        }
+        config.pRecordWriter = &record_writer;
+    }
+
+    lv::SimulationResult result{};
+    const bool success = lv::RunSimulation(config, result);
+    if (!record_writer.Close()) {
+        printf("Cannot write '%s'\n", pRecordPath);
+        return 1;
+    }
+    if (!success) {
+        printf("Simulation failed (%lld games failed)\n", static_cast<long long>(result.failed_game_count));
+        return 1;
+    }
+
+    printf("Games: %lld, turns: %lld, %.3f s, %.0f games/s\n", static_cast<long long>(result.game_count),
+           static_cast<long long>(result.turn_count), result.elapsed_seconds, result.games_per_second);
+
+    for (int32_t player_idx = 0; player_idx < config.player_count; ++player_idx) {
+        const lv::SeatStats &rSeat = result.seats[player_idx];
+        const double game_count = static_cast<double>(std::max<int64_t>(result.game_count, 1));
+        const double mean = rSeat.total_money / game_count;
+        const double variance = std::max(0.0, rSeat.total_money_squared / game_count - mean * mean);
+
+        printf("Seat %d (%s): win rate %.4f, money mean %.1f stddev %.1f min %d p10 %d p50 %d p90 %d max %d\n",
+               player_idx, agent_names[player_idx].c_str(), rSeat.wins / game_count, mean, std::sqrt(variance),
+               rSeat.min_money, GetScorePercentile(rSeat, result.game_count, 0.1),
+               GetScorePercentile(rSeat, result.game_count, 0.5), GetScorePercentile(rSeat, result.game_count, 0.9),
+               rSeat.max_money);
     }
 
-	return 0;
-}
\ No newline at end of file
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "LvEndgameSolver.h"
+#include "LvGameServer.h"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t s_stop_requested = 0;
+
+void OnStopSignal(int signal_number)
+{
+    s_stop_requested = 1;
+}
+
+void PrintUsage()
+{
+    printf("Usage: LasVegServer [options]\n"
+           "  --address A      tcp:HOST:PORT, HOST:PORT or unix:PATH (default tcp:127.0.0.1:7777)\n"
+           "  --workers N      Worker threads, 0 for all hardware threads (default 0)\n"
+           "  --max-games N    Games served at once over every worker (default 100000)\n"
+           "  --seed N         Base seed of the games started without a seed (default 0)\n"
+           "  --stats S        Print the statistics every S seconds, 0 only on exit (default 0)\n"
+           "  --tablebase PATH Endgame tablebase looked up by the endgame bots\n"
+           "The protocol is described in LvServerProtocol.h, stop the server with Ctrl+C\n");
+}
+
+void PrintStats(const lv::GameServer &rServer)
+{
+    auto pStats = std::make_unique<lv::GameServerStats>();
+    rServer.GetStats(*pStats);
+
+    printf("Games: %lld, connections: %lld\n", static_cast<long long>(pStats->game_count),
+           static_cast<long long>(pStats->connection_count));
+    printf("%-8s %12s %10s %10s %10s %10s %10s\n", "Request", "Count", "Mean us", "p50 us", "p99 us", "p99.9 us",
+           "Max us");
+    for (int32_t type_idx = 0; type_idx < lv::SERVER_REQUEST_TYPE_COUNT; ++type_idx) {
+        const lv::LatencyHistogram &rLatencies = pStats->latencies[type_idx];
+        if (rLatencies.GetCount() == 0) {
+            continue;
+        }
+        printf("%-8s %12llu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+               lv::GetServerRequestTypeName(static_cast<lv::ServerRequestType>(type_idx)),
+               static_cast<unsigned long long>(rLatencies.GetCount()), rLatencies.GetMean() / 1000.0,
+               rLatencies.GetPercentile(0.5) / 1000.0, rLatencies.GetPercentile(0.99) / 1000.0,
+               rLatencies.GetPercentile(0.999) / 1000.0, rLatencies.GetMax() / 1000.0);
+    }
+    fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    lv::GameServerConfig config{};
+    lv::ParseServerAddress("tcp:127.0.0.1:7777", config.address);
+    double stats_interval_seconds = 0.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--address") == 0 && has_value) {
+            if (!lv::ParseServerAddress(argv[++i], config.address)) {
+                PrintUsage();
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--workers") == 0 && has_value) {
+            config.worker_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max-games") == 0 && has_value) {
+            config.max_game_count = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            config.base_seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--stats") == 0 && has_value) {
+            stats_interval_seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tablebase") == 0 && has_value) {
+            if (!lv::OpenSharedEndgameTablebase(argv[++i])) {
+                printf("'%s' is not a valid endgame tablebase\n", argv[i]);
+                return 1;
+            }
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, OnStopSignal);
+    std::signal(SIGTERM, OnStopSignal);
+#ifdef SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    lv::GameServer server(config);
+    if (!server.Start()) {
+        printf("Cannot serve on %s\n", config.address.is_unix ? config.address.path.c_str()
+                                                              : config.address.host.c_str());
+        return 1;
+    }
+    printf("Serving\n");
+    fflush(stdout);
+
+    const auto stats_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(stats_interval_seconds));
+    auto next_stats_time = std::chrono::steady_clock::now() + stats_interval;
+    while (s_stop_requested == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (stats_interval_seconds > 0.0 && std::chrono::steady_clock::now() >= next_stats_time) {
+            next_stats_time += stats_interval;
+            PrintStats(server);
+        }
+    }
+
+    server.Stop();
+    PrintStats(server);
+
+    return 0;
+}
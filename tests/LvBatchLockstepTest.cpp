@@ -0,0 +1,121 @@
+// BatchGameEngine against GameEngine
+//
+// Every lane must go through the same states and consume its generator exactly like a GameEngine given the same seed
+// and moves. For every player count, a batch of games is played with random moves next to one GameEngine per game,
+// and every lane's state and generator are compared after every step. Half the lanes start with SetupGame, the others
+// with SetGameState from a game already played for a few moves, with a generator of their own. Lanes that finish
+// early keep being compared while the others go on.
+
+#include "LvTests.h"
+
+#include "LvBatchGameEngine.h"
+#include "LvGameEngine.h"
+#include "LvSimulator.h"
+
+#include <vector>
+
+namespace {
+
+enum { LOCKSTEP_GAME_COUNT = 67 }; // Not a multiple of the lane blocks, the last block is partly used
+enum { LOCKSTEP_REPETITION_COUNT = 3 };
+enum { MAX_WARMUP_MOVE_COUNT = 40 };
+
+bool PlayRandomMove(lv::GameEngine &rEngine, lv::CompactGameState &rGame, lv::Rng &rMoveRng, lv::DiceValue &rMove)
+{
+    lv::LegalMoveList moves{};
+    if (rEngine.GetLegalMoves(rGame, moves) == 0) {
+        return false;
+    }
+    rMove = moves.moves[rMoveRng.NextBelow(static_cast<uint32_t>(moves.count))].dice;
+    return rEngine.PlayMove(rGame, rMove);
+}
+
+bool CheckLanes(const lv::BatchGameEngine &rBatch, const std::vector<lv::GameEngine> &rEngines,
+                const std::vector<lv::CompactGameState> &rGames, int32_t step_idx)
+{
+    for (int32_t game_idx = 0; game_idx < rBatch.GetGameCount(); ++game_idx) {
+        lv::CompactGameState lane_game{};
+        rBatch.GetGameState(game_idx, lane_game);
+        LV_TEST_CHECK(lane_game == rGames[game_idx], "%d players, game %d, step %d", rBatch.GetPlayerCount(),
+                      game_idx, step_idx);
+        LV_TEST_CHECK(rBatch.GetRng(game_idx) == rEngines[game_idx].GetRng(), "%d players, game %d, step %d",
+                      rBatch.GetPlayerCount(), game_idx, step_idx);
+        LV_TEST_CHECK(rBatch.IsGameOver(game_idx) == rEngines[game_idx].IsGameOver(rGames[game_idx]),
+                      "%d players, game %d, step %d", rBatch.GetPlayerCount(), game_idx, step_idx);
+    }
+    return true;
+}
+
+bool RunLockstep(int32_t player_count, uint64_t seed)
+{
+    lv::BatchGameEngine batch{LOCKSTEP_GAME_COUNT, player_count};
+    std::vector<lv::GameEngine> engines;
+    std::vector<lv::CompactGameState> games(LOCKSTEP_GAME_COUNT);
+    lv::Rng move_rng{seed};
+
+    engines.reserve(LOCKSTEP_GAME_COUNT);
+    for (int32_t game_idx = 0; game_idx < LOCKSTEP_GAME_COUNT; ++game_idx) {
+        const uint64_t game_seed = lv::GetGameSeed(seed, game_idx);
+        lv::GameEngine &rEngine = engines.emplace_back(game_seed);
+        lv::CompactGameState &rGame = games[game_idx];
+        LV_TEST_CHECK(rEngine.SetupInitGameState(rGame, player_count) && rEngine.SetupRound(rGame) &&
+                          rEngine.StartRound(rGame),
+                      "%d players, game %d", player_count, game_idx);
+
+        if (game_idx % 2 == 0) {
+            LV_TEST_CHECK(batch.SetupGame(game_idx, game_seed), "%d players, game %d", player_count, game_idx);
+            continue;
+        }
+
+        // Some moves in, then on with a generator of its own
+        const uint32_t warmup_move_count = move_rng.NextBelow(MAX_WARMUP_MOVE_COUNT);
+        lv::DiceValue move{};
+        for (uint32_t i = 0; i < warmup_move_count && !rEngine.IsGameOver(rGame); ++i) {
+            LV_TEST_CHECK(PlayRandomMove(rEngine, rGame, move_rng, move), "%d players, game %d", player_count,
+                          game_idx);
+        }
+        rEngine.Seed(lv::GetGameSeed(game_seed, 1));
+        LV_TEST_CHECK(batch.SetGameState(game_idx, rGame, rEngine.GetRng()), "%d players, game %d", player_count,
+                      game_idx);
+    }
+
+    if (!CheckLanes(batch, engines, games, 0)) {
+        return false;
+    }
+
+    std::vector<lv::DiceValue> moves(LOCKSTEP_GAME_COUNT, lv::DiceValue::Invalid);
+    for (int32_t step_idx = 1; batch.GetRunningGameCount() > 0; ++step_idx) {
+        for (int32_t game_idx = 0; game_idx < LOCKSTEP_GAME_COUNT; ++game_idx) {
+            moves[game_idx] = lv::DiceValue::Invalid;
+            if (!engines[game_idx].IsGameOver(games[game_idx])) {
+                LV_TEST_CHECK(PlayRandomMove(engines[game_idx], games[game_idx], move_rng, moves[game_idx]),
+                              "%d players, game %d, step %d", player_count, game_idx, step_idx);
+            }
+        }
+        LV_TEST_CHECK(batch.PlayMoves(moves.data()), "%d players, step %d", player_count, step_idx);
+
+        if (!CheckLanes(batch, engines, games, step_idx)) {
+            return false;
+        }
+    }
+
+    for (int32_t game_idx = 0; game_idx < LOCKSTEP_GAME_COUNT; ++game_idx) {
+        LV_TEST_CHECK(engines[game_idx].IsGameOver(games[game_idx]), "%d players, game %d", player_count, game_idx);
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool TestBatchLockstep()
+{
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        for (int32_t repetition_idx = 0; repetition_idx < LOCKSTEP_REPETITION_COUNT; ++repetition_idx) {
+            if (!RunLockstep(player_count, lv::GetGameSeed(player_count, repetition_idx))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
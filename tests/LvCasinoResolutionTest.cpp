@@ -0,0 +1,308 @@
+// Casino resolution against the previous engine
+//
+// DistributeCasinoBills used to settle a casino one bill at a time, re-running the tie cancellation of
+// SettleNextCasinoBill for every bill. That loop is kept here as the reference. Every bet combination of 0 to
+// DICE_COUNT dices for 2 to 5 players plus the neutral bet, with random casino bills, must give the same winners in
+// the same order and the same bills back to the bank:
+// - through GetCasinoWinners with GetRankedBillCounts, and GetCasinoPayouts
+// - through EndRound on both game state representations, six combinations at a time, one per casino, which also
+//   checks the incremental hash
+
+#include "LvTests.h"
+
+#include "LvGameEngine.h"
+#include "LvStateConversion.h"
+#include "LvStateHash.h"
+#include "LvUtils.h"
+
+#include <array>
+#include <vector>
+
+namespace {
+
+enum { REFERENCE_NO_WINNER = -1 };
+enum { MAX_CASINO_BILL_COUNT = 5 };
+
+using Bets = std::array<int32_t, lv::MAX_PLAYER_COUNT>;
+
+// Who wins the next (highest) bill of a casino, as the engine did before GetCasinoWinners. Equal bets cancel each
+// other, starting with the players tied with the neutral bet, then the highest remaining bet wins and is settled.
+int32_t SettleNextCasinoBill(Bets &rBets, int32_t &rNeutralBet, int32_t player_count)
+{
+    // Cancel all equal bets
+    // Start by cancelling the neutral bet
+    if (rNeutralBet > 0) {
+        bool neutral_bet_canceled = false;
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            if (rBets[player_idx] == rNeutralBet) {
+                rBets[player_idx] = 0;
+                neutral_bet_canceled = true;
+            }
+        }
+        if (neutral_bet_canceled) {
+            rNeutralBet = 0;
+        }
+    }
+
+    // Cancel equal player bets
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        const int32_t bet = rBets[player_idx];
+        if (bet > 0) {
+            for (int32_t other_player_idx = player_idx + 1; other_player_idx < player_count; ++other_player_idx) {
+                if (bet == rBets[other_player_idx]) {
+                    rBets[player_idx] = 0;
+                    rBets[other_player_idx] = 0;
+                }
+            }
+        }
+    }
+
+    // Find the player with the highest bet
+    int32_t highest_bet = 0;
+    int32_t winner = REFERENCE_NO_WINNER;
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        if (rBets[player_idx] > highest_bet) {
+            highest_bet = rBets[player_idx];
+            winner = player_idx;
+        }
+    }
+
+    // Check if the neutral player has the highest bet
+    if (rNeutralBet > highest_bet) {
+        winner = lv::CASINO_NEUTRAL_WINNER;
+    }
+
+    // The winning bet is settled
+    if (winner == lv::CASINO_NEUTRAL_WINNER) {
+        rNeutralBet = 0;
+    } else if (winner != REFERENCE_NO_WINNER) {
+        rBets[winner] = 0;
+    }
+
+    return winner;
+}
+
+// Outcome of one casino, bill indices in the order they were handed out
+struct Settlement {
+    std::array<std::vector<int32_t>, lv::CASINO_BIDDER_COUNT> won_bills;
+    std::vector<int32_t> returned_bills; // In the order they are put back in the bank
+
+    bool operator==(const Settlement &) const = default;
+};
+
+// The previous DistributeCasinoBills loop of one casino
+Settlement SettleCasinoPerBill(const lv::BillCounts &rBills, Bets bets, int32_t neutral_bet, int32_t player_count)
+{
+    Settlement settlement{};
+    lv::BillCounts bills = rBills;
+
+    // Bills are counted per denomination, so walk them from the highest value down
+    int32_t bill_idx = lv::BILL_TYPE_COUNT - 1;
+    while (true) {
+        while (bill_idx >= 0 && bills[bill_idx] == 0) {
+            --bill_idx;
+        }
+        if (bill_idx < 0) {
+            break;
+        }
+
+        // Take the bill with highest value
+        --bills[bill_idx];
+
+        const int32_t winner = SettleNextCasinoBill(bets, neutral_bet, player_count);
+
+        // Was there any bet ? If not, the remaining bills go back to the bank
+        if (winner == REFERENCE_NO_WINNER) {
+            ++bills[bill_idx];
+            for (int32_t remaining_bill_idx = 0; remaining_bill_idx < lv::BILL_TYPE_COUNT; ++remaining_bill_idx) {
+                for (; bills[remaining_bill_idx] > 0; --bills[remaining_bill_idx]) {
+                    settlement.returned_bills.push_back(remaining_bill_idx);
+                }
+            }
+            break;
+        }
+
+        settlement.won_bills[winner].push_back(bill_idx);
+    }
+
+    return settlement;
+}
+
+// The same casino through GetCasinoWinners and GetRankedBillCounts, as DistributeCasinoBills does now
+Settlement SettleCasinoByRank(const lv::BillCounts &rBills, const Bets &rBets, int32_t neutral_bet,
+                              int32_t player_count)
+{
+    Settlement settlement{};
+
+    const lv::CasinoWinners winners = lv::GetCasinoWinners(rBets, neutral_bet, player_count);
+    lv::RankedBillCounts ranked_bills{};
+    const int32_t bill_count = lv::GetRankedBillCounts(rBills, ranked_bills);
+    const int32_t paid_count = std::min(winners.count, bill_count);
+
+    for (int32_t rank = 0; rank < paid_count; ++rank) {
+        settlement.won_bills[winners.bidders[rank]].push_back(lv::GetRankedBillIndex(ranked_bills, rank));
+    }
+    for (int32_t rank = bill_count - 1; rank >= paid_count; --rank) {
+        settlement.returned_bills.push_back(lv::GetRankedBillIndex(ranked_bills, rank));
+    }
+
+    return settlement;
+}
+
+// One bet combination with its casino bills
+struct CasinoCase {
+    lv::BillCounts bills{};
+    Bets bets{};
+    int32_t neutral_bet = 0;
+    Settlement expected{};
+};
+
+// Bets of combination combination_idx, one base DICE_COUNT + 1 digit per player then the neutral bet
+void DecodeBets(int64_t combination_idx, int32_t player_count, CasinoCase &rCase)
+{
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        rCase.bets[player_idx] = static_cast<int32_t>(combination_idx % (lv::DICE_COUNT + 1));
+        combination_idx /= lv::DICE_COUNT + 1;
+    }
+    rCase.neutral_bet = static_cast<int32_t>(combination_idx);
+}
+
+void DrawCasinoBills(lv::Rng &rRng, lv::BillCounts &rBills)
+{
+    rBills = {};
+    const uint32_t bill_count = 1 + rRng.NextBelow(MAX_CASINO_BILL_COUNT);
+    for (uint32_t i = 0; i < bill_count; ++i) {
+        ++rBills[rRng.NextBelow(lv::BILL_TYPE_COUNT)];
+    }
+}
+
+const char *GetCaseText(const CasinoCase &rCase, int32_t player_count)
+{
+    static char text[256];
+    int32_t length = std::snprintf(text, sizeof(text), "bets");
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        length += std::snprintf(text + length, sizeof(text) - length, " %d", rCase.bets[player_idx]);
+    }
+    length += std::snprintf(text + length, sizeof(text) - length, ", neutral %d, bills", rCase.neutral_bet);
+    for (int32_t bill_idx = 0; bill_idx < lv::BILL_TYPE_COUNT; ++bill_idx) {
+        length += std::snprintf(text + length, sizeof(text) - length, " %d", rCase.bills[bill_idx]);
+    }
+    return text;
+}
+
+// Resolve up to CASINO_COUNT cases at the end of a round of both state representations
+bool CheckEndRound(lv::GameEngine &rEngine, const CasinoCase *pCases, int32_t case_count, int32_t player_count)
+{
+    lv::CompactGameState compact{};
+    LV_TEST_CHECK(rEngine.SetupInitGameState(compact, player_count), "%d players", player_count);
+    compact.bank_size = 0;
+    for (lv::CompactPlayerState &rPlayer : compact.players) {
+        rPlayer.dices = 0;
+        rPlayer.white_dices = 0;
+    }
+    for (int32_t case_idx = 0; case_idx < case_count; ++case_idx) {
+        lv::CompactCasinoState &rCasino = compact.casinos[case_idx];
+        rCasino.bills = pCases[case_idx].bills;
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            rCasino.dice_bets[player_idx] = static_cast<int8_t>(pCases[case_idx].bets[player_idx]);
+        }
+        rCasino.neutral_dice_bet = static_cast<int8_t>(pCases[case_idx].neutral_bet);
+    }
+    compact.hash = lv::ComputeHash(compact);
+
+    lv::GameState game{};
+    LV_TEST_CHECK(lv::ToGameState(compact, game), "%d players", player_count);
+    game.hash = lv::ComputeHash(game);
+
+    LV_TEST_CHECK(rEngine.EndRound(compact), "%d players", player_count);
+    LV_TEST_CHECK(rEngine.EndRound(game), "%d players", player_count);
+
+    // What every bidder and the bank should hold, casino after casino
+    std::array<lv::BillCounts, lv::CASINO_BIDDER_COUNT> expected_counts{};
+    std::array<lv::BillVector, lv::CASINO_BIDDER_COUNT> expected_bills{};
+    lv::BillVector expected_bank;
+    for (int32_t case_idx = 0; case_idx < case_count; ++case_idx) {
+        const Settlement &rExpected = pCases[case_idx].expected;
+        for (int32_t bidder_idx = 0; bidder_idx < lv::CASINO_BIDDER_COUNT; ++bidder_idx) {
+            for (const int32_t bill_idx : rExpected.won_bills[bidder_idx]) {
+                ++expected_counts[bidder_idx][bill_idx];
+                expected_bills[bidder_idx].push_back(lv::GetBillFromIndex(bill_idx));
+            }
+        }
+        for (const int32_t bill_idx : rExpected.returned_bills) {
+            expected_bank.push_back(lv::GetBillFromIndex(bill_idx));
+        }
+    }
+
+    const char *pFirstCase = GetCaseText(pCases[0], player_count);
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        LV_TEST_CHECK(compact.players[player_idx].bills == expected_counts[player_idx], "compact, player %d, from %s",
+                      player_idx, pFirstCase);
+        LV_TEST_CHECK(game.players[player_idx].bills == expected_bills[player_idx], "vector, player %d, from %s",
+                      player_idx, pFirstCase);
+    }
+    LV_TEST_CHECK(compact.neutral_player_bills == expected_counts[lv::CASINO_NEUTRAL_WINNER], "compact, from %s",
+                  pFirstCase);
+    LV_TEST_CHECK(game.neutral_player.bills == expected_bills[lv::CASINO_NEUTRAL_WINNER], "vector, from %s",
+                  pFirstCase);
+
+    LV_TEST_CHECK(compact.bank_size == static_cast<int32_t>(expected_bank.size()), "compact, from %s", pFirstCase);
+    for (int32_t bank_idx = 0; bank_idx < compact.bank_size; ++bank_idx) {
+        LV_TEST_CHECK(lv::GetBillFromIndex(compact.bank[bank_idx]) == expected_bank[bank_idx],
+                      "compact, bank %d, from %s", bank_idx, pFirstCase);
+    }
+    LV_TEST_CHECK(game.bank == expected_bank, "vector, from %s", pFirstCase);
+
+    LV_TEST_CHECK(compact.hash == lv::ComputeHash(compact), "compact, from %s", pFirstCase);
+    LV_TEST_CHECK(game.hash == lv::ComputeHash(game), "vector, from %s", pFirstCase);
+
+    return true;
+}
+
+} // namespace
+
+bool TestCasinoResolution()
+{
+    lv::GameEngine engine{0};
+    lv::Rng rng{0};
+
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        int64_t combination_count = 1;
+        for (int32_t bidder_idx = 0; bidder_idx <= player_count; ++bidder_idx) {
+            combination_count *= lv::DICE_COUNT + 1;
+        }
+
+        std::array<CasinoCase, lv::CASINO_COUNT> cases{};
+        int32_t case_count = 0;
+        for (int64_t combination_idx = 0; combination_idx < combination_count; ++combination_idx) {
+            CasinoCase &rCase = cases[case_count];
+            rCase = {};
+            DecodeBets(combination_idx, player_count, rCase);
+            DrawCasinoBills(rng, rCase.bills);
+            rCase.expected = SettleCasinoPerBill(rCase.bills, rCase.bets, rCase.neutral_bet, player_count);
+
+            const Settlement ranked = SettleCasinoByRank(rCase.bills, rCase.bets, rCase.neutral_bet, player_count);
+            LV_TEST_CHECK(ranked == rCase.expected, "%s", GetCaseText(rCase, player_count));
+
+            std::array<int32_t, lv::MAX_PLAYER_COUNT> payouts{};
+            lv::GetCasinoPayouts(rCase.bills, rCase.bets, rCase.neutral_bet, player_count, payouts);
+            for (int32_t player_idx = 0; player_idx < lv::MAX_PLAYER_COUNT; ++player_idx) {
+                int32_t expected_payout = 0;
+                for (const int32_t bill_idx : rCase.expected.won_bills[player_idx]) {
+                    expected_payout += static_cast<int32_t>(lv::GetBillFromIndex(bill_idx));
+                }
+                LV_TEST_CHECK(payouts[player_idx] == expected_payout, "player %d, %s", player_idx,
+                              GetCaseText(rCase, player_count));
+            }
+
+            if (++case_count == lv::CASINO_COUNT || combination_idx == combination_count - 1) {
+                if (!CheckEndRound(engine, cases.data(), case_count, player_count)) {
+                    return false;
+                }
+                case_count = 0;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,141 @@
+// Dice roll histograms against the multinomial distribution
+//
+// RollDiceCountsFromTable draws a histogram of n dices from an alias table weighted by n! / (c1! ... c6!) out of 6^n.
+// For every dice count from 1 to 8, seeded rolls are counted per histogram and compared with these exact
+// probabilities by a chi-square test, histograms expected fewer than MIN_EXPECTED_COUNT times being pooled into one
+// class. Counts of the table range go through RollDiceCountsFromTable, the smaller ones through the per dice draws of
+// RollDiceCounts. The bound is about 6 standard deviations above the degrees of freedom, a wrong weight of a few
+// percent on a likely histogram exceeds it by far.
+
+#include "LvTests.h"
+
+#include "LvDiceRoll.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+enum { MAX_CHECKED_DICE_COUNT = 8 };
+constexpr int32_t ROLL_COUNT = 1 << 22;
+constexpr double MIN_EXPECTED_COUNT = 8.0;
+enum { HISTOGRAM_KEY_BASE = MAX_CHECKED_DICE_COUNT + 1 };
+
+struct Histogram {
+    lv::DiceCounts counts{};
+    double probability = 0.0;
+};
+
+int32_t GetHistogramKey(const lv::DiceCounts &rCounts)
+{
+    int32_t key = 0;
+    for (int32_t face_idx = lv::CASINO_COUNT - 1; face_idx >= 0; --face_idx) {
+        key = key * HISTOGRAM_KEY_BASE + rCounts[face_idx];
+    }
+    return key;
+}
+
+// Every histogram of dice_count dices with its multinomial probability
+std::vector<Histogram> GetHistograms(int32_t dice_count)
+{
+    std::vector<Histogram> histograms;
+    lv::DiceCounts counts{};
+    auto add_fn = [&](auto &&rSelf, int32_t face_idx, int32_t dice_left) -> void {
+        if (face_idx == lv::CASINO_COUNT - 1) {
+            counts[face_idx] = static_cast<uint8_t>(dice_left);
+            double probability = std::tgamma(dice_count + 1.0);
+            for (int32_t dice_idx = 0; dice_idx < dice_count; ++dice_idx) {
+                probability /= static_cast<int32_t>(lv::CASINO_COUNT);
+            }
+            for (const uint8_t count : counts) {
+                probability /= std::tgamma(count + 1.0);
+            }
+            histograms.push_back({counts, probability});
+            return;
+        }
+        for (int32_t count = 0; count <= dice_left; ++count) {
+            counts[face_idx] = static_cast<uint8_t>(count);
+            rSelf(rSelf, face_idx + 1, dice_left - count);
+        }
+    };
+    add_fn(add_fn, 0, dice_count);
+    return histograms;
+}
+
+bool CheckDiceCount(int32_t dice_count, lv::Rng &rRng)
+{
+    const std::vector<Histogram> histograms = GetHistograms(dice_count);
+    double probability_sum = 0.0;
+    for (const Histogram &rHistogram : histograms) {
+        probability_sum += rHistogram.probability;
+    }
+    LV_TEST_CHECK(std::abs(probability_sum - 1.0) < 1e-9, "%d dices: probabilities sum to %f", dice_count,
+                  probability_sum);
+
+    int32_t key_count = 1;
+    for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT; ++face_idx) {
+        key_count *= HISTOGRAM_KEY_BASE;
+    }
+    std::vector<int32_t> histogram_indices(static_cast<size_t>(key_count), -1);
+    for (size_t histogram_idx = 0; histogram_idx < histograms.size(); ++histogram_idx) {
+        histogram_indices[GetHistogramKey(histograms[histogram_idx].counts)] = static_cast<int32_t>(histogram_idx);
+    }
+
+    std::vector<int64_t> roll_counts(histograms.size(), 0);
+    for (int32_t roll_idx = 0; roll_idx < ROLL_COUNT; ++roll_idx) {
+        lv::DiceCounts counts{};
+        if (dice_count >= lv::DICE_ROLL_TABLE_MIN_DICE_COUNT) {
+            lv::RollDiceCountsFromTable(rRng, dice_count, counts);
+        } else {
+            lv::RollDiceCounts(rRng, dice_count, counts);
+        }
+        int32_t rolled_dice_count = 0;
+        for (const uint8_t count : counts) {
+            rolled_dice_count += count;
+        }
+        LV_TEST_CHECK(rolled_dice_count == dice_count, "%d dices: roll %d has %d dices", dice_count, roll_idx,
+                      rolled_dice_count);
+        ++roll_counts[histogram_indices[GetHistogramKey(counts)]];
+    }
+
+    // Chi-square over the histograms expected often enough, the others pooled
+    double chi_square = 0.0;
+    int32_t class_count = 0;
+    double pooled_expected = 0.0;
+    int64_t pooled_count = 0;
+    for (size_t histogram_idx = 0; histogram_idx < histograms.size(); ++histogram_idx) {
+        const double expected = histograms[histogram_idx].probability * ROLL_COUNT;
+        if (expected < MIN_EXPECTED_COUNT) {
+            pooled_expected += expected;
+            pooled_count += roll_counts[histogram_idx];
+            continue;
+        }
+        const double deviation = static_cast<double>(roll_counts[histogram_idx]) - expected;
+        chi_square += deviation * deviation / expected;
+        ++class_count;
+    }
+    if (pooled_expected > 0.0) {
+        const double deviation = static_cast<double>(pooled_count) - pooled_expected;
+        chi_square += deviation * deviation / pooled_expected;
+        ++class_count;
+    }
+
+    const double degrees_of_freedom = class_count - 1;
+    const double bound = degrees_of_freedom + 6.0 * std::sqrt(2.0 * degrees_of_freedom);
+    LV_TEST_CHECK(chi_square < bound, "%d dices: chi-square %f over %d classes, bound %f", dice_count, chi_square,
+                  class_count, bound);
+    return true;
+}
+
+} // namespace
+
+bool TestDiceRoll()
+{
+    lv::Rng rng{25};
+    for (int32_t dice_count = 1; dice_count <= MAX_CHECKED_DICE_COUNT; ++dice_count) {
+        if (!CheckDiceCount(dice_count, rng)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,264 @@
+// EndgameSolver against brute-force expectimax, and the tablebase round trip
+//
+// Positions of random games with at most MAX_SOLVED_DICE_COUNT dices left in the round are solved exactly by a plain
+// expectimax that rolls every face sequence of the player to move, allocates every face rolled, ties going to the
+// lowest one, and pays the casinos out with GetCasinoPayouts once nobody has any dice left. It shares nothing with
+// the solver beyond GameEngine::AllocateDices: no roll histograms, no canonical states, no memo. Solve and ChooseDice
+// must give the same values for every player. The solver keys the original states, with canonical keys ties would go
+// to the lowest face of the canonical state instead, which changes the values of the tied allocations.
+//
+// The positions the solver went through are then written with EndgameTablebaseBuilder::Write, opened again and
+// probed: every position is found, and a solver looking them up gives the same values without solving anything.
+
+#include "LvTests.h"
+
+#include "LvEndgameSolver.h"
+#include "LvUtils.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum { MAX_SOLVED_DICE_COUNT = 4 };
+enum { POSITION_COUNT_PER_PLAYER_COUNT = 24 };
+enum { MAX_GAME_COUNT_PER_PLAYER_COUNT = 64 };
+
+// Values closer than that are tied, summing the same rolls in another order differs in the last bits
+constexpr double TIE_TOLERANCE = 1e-6;
+
+using Values = std::array<double, lv::MAX_PLAYER_COUNT>;
+
+bool IsNear(double expected, double actual)
+{
+    return std::abs(expected - actual) <= 1e-3 * std::max(1.0, std::abs(expected));
+}
+
+int32_t GetRoundDiceCount(const lv::CompactGameState &rGame)
+{
+    int32_t dice_count = 0;
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        dice_count += rGame.players[player_idx].dices + rGame.players[player_idx].white_dices;
+    }
+    return dice_count;
+}
+
+void GetRoundPayouts(const lv::CompactGameState &rGame, Values &rValues)
+{
+    rValues = {};
+    for (const lv::CompactCasinoState &rCasino : rGame.casinos) {
+        std::array<int32_t, lv::MAX_PLAYER_COUNT> payouts{};
+        lv::GetCasinoPayouts(rCasino.bills, rCasino.dice_bets, rCasino.neutral_dice_bet, rGame.player_count, payouts);
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            rValues[player_idx] += payouts[player_idx];
+        }
+    }
+}
+
+void SolveRoll(lv::GameEngine &rEngine, const lv::CompactGameState &rGame, Values &rValues);
+
+// Best face of the roll in rGame for the player to move, ties to the lowest face
+void SolveAllocation(lv::GameEngine &rEngine, const lv::CompactGameState &rGame, Values &rValues)
+{
+    const lv::PlayerIdx player_idx = rGame.current_turn.player_idx;
+    bool has_best = false;
+    for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT; ++face_idx) {
+        if (rGame.current_turn.dices[face_idx] == 0 && rGame.current_turn.white_dices[face_idx] == 0) {
+            continue;
+        }
+
+        lv::CompactGameState child = rGame;
+        rEngine.AllocateDices(child, static_cast<lv::DiceValue>(face_idx + 1));
+
+        // The next player with dices left rolls, the round is over once there's none
+        Values values{};
+        bool round_over = true;
+        for (int32_t offset = 1; offset <= child.player_count; ++offset) {
+            const lv::PlayerIdx next_player_idx = (player_idx + offset) % child.player_count;
+            const lv::CompactPlayerState &rPlayer = child.players[next_player_idx];
+            if (rPlayer.dices > 0 || rPlayer.white_dices > 0) {
+                child.current_turn.player_idx = next_player_idx;
+                SolveRoll(rEngine, child, values);
+                round_over = false;
+                break;
+            }
+        }
+        if (round_over) {
+            GetRoundPayouts(child, values);
+        }
+
+        if (!has_best || values[player_idx] > rValues[player_idx] + TIE_TOLERANCE) {
+            rValues = values;
+            has_best = true;
+        }
+    }
+}
+
+// Every face sequence of the dices of the player to move, equally likely
+void SolveRoll(lv::GameEngine &rEngine, const lv::CompactGameState &rGame, Values &rValues)
+{
+    const lv::CompactPlayerState &rPlayer = rGame.players[rGame.current_turn.player_idx];
+    const int32_t dice_count = rPlayer.dices + rPlayer.white_dices;
+    int64_t roll_count = 1;
+    for (int32_t i = 0; i < dice_count; ++i) {
+        roll_count *= lv::CASINO_COUNT;
+    }
+
+    rValues = {};
+    lv::CompactGameState rolled = rGame;
+    for (int64_t roll_idx = 0; roll_idx < roll_count; ++roll_idx) {
+        rolled.current_turn.dices = {};
+        rolled.current_turn.white_dices = {};
+        int64_t faces = roll_idx;
+        for (int32_t dice_idx = 0; dice_idx < dice_count; ++dice_idx) {
+            lv::DiceCounts &rCounts =
+                dice_idx < rPlayer.dices ? rolled.current_turn.dices : rolled.current_turn.white_dices;
+            ++rCounts[faces % lv::CASINO_COUNT];
+            faces /= lv::CASINO_COUNT;
+        }
+
+        Values values{};
+        SolveAllocation(rEngine, rolled, values);
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            rValues[player_idx] += values[player_idx] / static_cast<double>(roll_count);
+        }
+    }
+}
+
+bool PlayRandomMove(lv::GameEngine &rEngine, lv::CompactGameState &rGame, lv::Rng &rMoveRng)
+{
+    lv::LegalMoveList moves{};
+    if (rEngine.GetLegalMoves(rGame, moves) == 0) {
+        return false;
+    }
+    return rEngine.PlayMove(rGame, moves.moves[rMoveRng.NextBelow(static_cast<uint32_t>(moves.count))].dice);
+}
+
+// Positions of random games with few dices left in the round, the player to move has rolled
+bool CollectPositions(int32_t player_count, std::vector<lv::CompactGameState> &rPositions)
+{
+    lv::Rng move_rng{static_cast<uint64_t>(player_count)};
+    const size_t end_size = rPositions.size() + POSITION_COUNT_PER_PLAYER_COUNT;
+    for (int32_t game_idx = 0; game_idx < MAX_GAME_COUNT_PER_PLAYER_COUNT && rPositions.size() < end_size;
+         ++game_idx) {
+        lv::GameEngine engine{static_cast<uint64_t>(game_idx)};
+        lv::CompactGameState game{};
+        LV_TEST_CHECK(engine.SetupInitGameState(game, player_count) && engine.SetupRound(game) &&
+                          engine.StartRound(game),
+                      "%d players, game %d", player_count, game_idx);
+
+        while (!engine.IsGameOver(game) && rPositions.size() < end_size) {
+            const int32_t dice_count = GetRoundDiceCount(game);
+            if (dice_count > 0 && dice_count <= MAX_SOLVED_DICE_COUNT) {
+                rPositions.push_back(game);
+            }
+            LV_TEST_CHECK(PlayRandomMove(engine, game, move_rng), "%d players, game %d", player_count, game_idx);
+        }
+    }
+    LV_TEST_CHECK(rPositions.size() == end_size, "%d players, %zu positions", player_count, rPositions.size());
+    return true;
+}
+
+bool CheckValues(const Values &rExpected, const lv::PlayerPayouts &rActual, int32_t player_count,
+                 const char *pWhat, size_t position_idx)
+{
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        LV_TEST_CHECK(IsNear(rExpected[player_idx], rActual[player_idx]), "%s, position %zu, player %d: %f, not %f",
+                      pWhat, position_idx, player_idx, rActual[player_idx], rExpected[player_idx]);
+    }
+    return true;
+}
+
+bool CheckSolver(const std::vector<lv::CompactGameState> &rPositions, lv::EndgameTablebaseBuilder &rBuilder)
+{
+    lv::GameEngine engine{0};
+    lv::EndgameSolver solver{MAX_SOLVED_DICE_COUNT};
+    solver.SetTablebaseBuilder(&rBuilder);
+
+    for (size_t position_idx = 0; position_idx < rPositions.size(); ++position_idx) {
+        const lv::CompactGameState &rGame = rPositions[position_idx];
+
+        Values expected{};
+        SolveRoll(engine, rGame, expected);
+        lv::PlayerPayouts values{};
+        LV_TEST_CHECK(solver.Solve(rGame, values), "position %zu", position_idx);
+        if (!CheckValues(expected, values, rGame.player_count, "Solve", position_idx)) {
+            return false;
+        }
+
+        SolveAllocation(engine, rGame, expected);
+        lv::DiceValue dice = lv::DiceValue::Invalid;
+        LV_TEST_CHECK(solver.ChooseDice(rGame, dice, values), "position %zu", position_idx);
+        if (!CheckValues(expected, values, rGame.player_count, "ChooseDice", position_idx)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CheckTablebase(const std::vector<lv::CompactGameState> &rPositions, const lv::EndgameTablebaseBuilder &rBuilder)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "LasVegEndgameSolverTest.lveg").string();
+    LV_TEST_CHECK(rBuilder.Write(path.c_str(), MAX_SOLVED_DICE_COUNT, false), "%s", path.c_str());
+
+    lv::EndgameTablebase tablebase;
+    const bool opened = tablebase.Open(path.c_str());
+    std::remove(path.c_str()); // The mapping stays valid
+    LV_TEST_CHECK(opened, "%s", path.c_str());
+    LV_TEST_CHECK(tablebase.GetEntryCount() == rBuilder.GetEntryCount() &&
+                      tablebase.GetMaxDiceCount() == MAX_SOLVED_DICE_COUNT,
+                  "%lld entries, %d dices", static_cast<long long>(tablebase.GetEntryCount()),
+                  tablebase.GetMaxDiceCount());
+
+    lv::EndgameSolver reference_solver{MAX_SOLVED_DICE_COUNT};
+    lv::EndgameSolver tablebase_solver{MAX_SOLVED_DICE_COUNT};
+    tablebase_solver.SetTablebase(&tablebase);
+    for (size_t position_idx = 0; position_idx < rPositions.size(); ++position_idx) {
+        const lv::CompactGameState &rGame = rPositions[position_idx];
+
+        lv::PlayerPayouts probed_values{};
+        LV_TEST_CHECK(tablebase.Probe(reference_solver.GetKey(rGame), probed_values), "position %zu",
+                      position_idx);
+
+        lv::PlayerPayouts expected{};
+        lv::PlayerPayouts values{};
+        LV_TEST_CHECK(reference_solver.Solve(rGame, expected) && tablebase_solver.Solve(rGame, values),
+                      "position %zu", position_idx);
+        LV_TEST_CHECK(values == expected, "position %zu", position_idx);
+    }
+    LV_TEST_CHECK(tablebase_solver.GetSolvedCount() == 0 && tablebase_solver.GetTablebaseHitCount() > 0,
+                  "%llu solved, %llu tablebase hits",
+                  static_cast<unsigned long long>(tablebase_solver.GetSolvedCount()),
+                  static_cast<unsigned long long>(tablebase_solver.GetTablebaseHitCount()));
+
+    // Keyed on other states, a solver with canonical keys doesn't use it
+    lv::EndgameSolver canonical_solver{MAX_SOLVED_DICE_COUNT, lv::EndgameSolver::DEFAULT_MEMO_SIZE_LOG2, true};
+    canonical_solver.SetTablebase(&tablebase);
+    lv::PlayerPayouts canonical_values{};
+    LV_TEST_CHECK(!tablebase.HasCanonicalKeys() && canonical_solver.Solve(rPositions[0], canonical_values) &&
+                      canonical_solver.GetTablebaseHitCount() == 0,
+                  "%llu tablebase hits", static_cast<unsigned long long>(canonical_solver.GetTablebaseHitCount()));
+
+    lv::PlayerPayouts values{};
+    LV_TEST_CHECK(!tablebase.Probe(lv::EndgameKey{1, 2}, values), "unknown key");
+    return true;
+}
+
+} // namespace
+
+bool TestEndgameSolver()
+{
+    std::vector<lv::CompactGameState> positions;
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        if (!CollectPositions(player_count, positions)) {
+            return false;
+        }
+    }
+
+    lv::EndgameTablebaseBuilder builder;
+    return CheckSolver(positions, builder) && CheckTablebase(positions, builder);
+}
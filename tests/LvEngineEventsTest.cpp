@@ -0,0 +1,215 @@
+// Engine events of both state representations
+//
+// LasVegTests links an engine built with LV_ENABLE_ENGINE_EVENTS. Games of 2 to 5 players are played in lockstep on
+// the vector GameState, step by step, and on CompactGameState with PlayMove, two engines of the same seed given the
+// same moves. Both listeners must receive the same event stream, PlayMove emitting the events of the steps it goes
+// through.
+//
+// Before every EndRound of the vector game, the bills each casino was dealt and its bets give the BillAwarded events
+// expected: one per winner while bills last, by rank from the highest bill. The bills dealt must also be worth the
+// casino money values of the RoundSetup event, and every round must report one DiceAllocated event per move.
+
+#include "LvTests.h"
+
+#include "LvGameEngine.h"
+#include "LvSimulator.h"
+#include "LvUtils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum { GAME_COUNT_PER_PLAYER_COUNT = 8 };
+
+// Every event as a line of text, and the BillAwarded events on their own
+class EventRecorder : public lv::EngineEventListener {
+public:
+    void OnRoundSetup(const lv::RoundSetupEvent &rEvent) override {
+        std::string line = Format("RoundSetup %d %d", rEvent.round, rEvent.first_player_idx);
+        for (const int32_t value : rEvent.casino_money_values) {
+            line += Format(" %d", value);
+        }
+        m_lines.push_back(line);
+        m_casino_money_values = rEvent.casino_money_values;
+    }
+
+    void OnDiceRolled(const lv::DiceRolledEvent &rEvent) override {
+        std::string line = Format("DiceRolled %d %d", rEvent.round, rEvent.player_idx);
+        for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT; ++face_idx) {
+            line += Format(" %d/%d", rEvent.dices[face_idx], rEvent.white_dices[face_idx]);
+        }
+        m_lines.push_back(line);
+    }
+
+    void OnDiceAllocated(const lv::DiceAllocatedEvent &rEvent) override {
+        m_lines.push_back(Format("DiceAllocated %d %d %d %d %d", rEvent.round, rEvent.player_idx,
+                                 static_cast<int32_t>(rEvent.dice), rEvent.dice_count, rEvent.white_dice_count));
+        ++m_allocation_count;
+    }
+
+    void OnPlayerSkipped(const lv::PlayerSkippedEvent &rEvent) override {
+        m_lines.push_back(Format("PlayerSkipped %d %d", rEvent.round, rEvent.player_idx));
+    }
+
+    void OnBillAwarded(const lv::BillAwardedEvent &rEvent) override {
+        m_lines.push_back(Format("BillAwarded %d %d %d %d %d", rEvent.round, rEvent.casino_idx, rEvent.bidder_idx,
+                                 rEvent.rank, static_cast<int32_t>(rEvent.bill)));
+        m_bill_awards.push_back(rEvent);
+    }
+
+    void OnRoundEnd(const lv::RoundEndEvent &rEvent) override {
+        std::string line = Format("RoundEnd %d %d", rEvent.round, rEvent.neutral_money_value);
+        for (const int32_t value : rEvent.player_money_values) {
+            line += Format(" %d", value);
+        }
+        m_lines.push_back(line);
+    }
+
+    const std::vector<std::string> &GetLines() const { return m_lines; }
+    const std::array<int32_t, lv::CASINO_COUNT> &GetCasinoMoneyValues() const { return m_casino_money_values; }
+    int32_t GetAllocationCount() const { return m_allocation_count; }
+
+    // BillAwarded events since the last call
+    std::vector<lv::BillAwardedEvent> TakeBillAwards() {
+        std::vector<lv::BillAwardedEvent> bill_awards;
+        bill_awards.swap(m_bill_awards);
+        return bill_awards;
+    }
+
+private:
+    template <typename... Args> static std::string Format(const char *pFormat, Args... args) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), pFormat, args...);
+        return buffer;
+    }
+
+    std::vector<std::string> m_lines;
+    std::array<int32_t, lv::CASINO_COUNT> m_casino_money_values{};
+    int32_t m_allocation_count = 0;
+    std::vector<lv::BillAwardedEvent> m_bill_awards;
+};
+
+// BillAwarded events of the vector game's round end, from its casinos before EndRound
+std::vector<lv::BillAwardedEvent> GetExpectedBillAwards(const lv::GameState &rGame)
+{
+    std::vector<lv::BillAwardedEvent> bill_awards;
+    for (int32_t casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+        const lv::CasinoState &rCasino = rGame.casinos[casino_idx];
+        lv::BillCounts bills{};
+        for (const lv::Bill bill : rCasino.bills) {
+            ++bills[lv::GetBillIndex(bill)];
+        }
+        lv::RankedBillCounts ranked_bills{};
+        const int32_t bill_count = lv::GetRankedBillCounts(bills, ranked_bills);
+        const lv::CasinoWinners winners = lv::GetCasinoWinners(rCasino.dice_bets, rCasino.neutral_dice_bet,
+                                                               static_cast<int32_t>(rGame.players.size()));
+        for (int32_t rank = 0; rank < std::min(winners.count, bill_count); ++rank) {
+            bill_awards.push_back({rGame.round, static_cast<lv::CasinoIdx>(casino_idx), winners.bidders[rank], rank,
+                                   lv::GetBillFromIndex(lv::GetRankedBillIndex(ranked_bills, rank))});
+        }
+    }
+    return bill_awards;
+}
+
+bool CheckBillAwards(const std::vector<lv::BillAwardedEvent> &rExpected, int32_t round, EventRecorder &rRecorder)
+{
+    const std::vector<lv::BillAwardedEvent> bill_awards = rRecorder.TakeBillAwards();
+    LV_TEST_CHECK(bill_awards.size() == rExpected.size(), "round %d: %zu bills awarded, not %zu", round,
+                  bill_awards.size(), rExpected.size());
+    for (size_t award_idx = 0; award_idx < rExpected.size(); ++award_idx) {
+        const lv::BillAwardedEvent &rAward = bill_awards[award_idx];
+        const lv::BillAwardedEvent &rExpectedAward = rExpected[award_idx];
+        LV_TEST_CHECK(rAward.round == rExpectedAward.round && rAward.casino_idx == rExpectedAward.casino_idx &&
+                          rAward.bidder_idx == rExpectedAward.bidder_idx && rAward.rank == rExpectedAward.rank &&
+                          rAward.bill == rExpectedAward.bill,
+                      "round %d, award %zu: casino %d, bidder %d, rank %d, bill %d", round, award_idx,
+                      rAward.casino_idx, rAward.bidder_idx, rAward.rank, static_cast<int32_t>(rAward.bill));
+    }
+    return true;
+}
+
+bool PlayGame(int32_t player_count, uint64_t seed)
+{
+    lv::GameEngine engine{seed};
+    lv::GameEngine compact_engine{seed};
+    EventRecorder recorder;
+    EventRecorder compact_recorder;
+    engine.SetEventListener(&recorder);
+    compact_engine.SetEventListener(&compact_recorder);
+    lv::Rng move_rng{~seed};
+
+    lv::GameState game{};
+    lv::CompactGameState compact_game{};
+    LV_TEST_CHECK(engine.SetupInitGameState(game, player_count) && engine.SetupRound(game) && engine.StartRound(game),
+                  "%d players", player_count);
+    LV_TEST_CHECK(compact_engine.SetupInitGameState(compact_game, player_count) &&
+                      compact_engine.SetupRound(compact_game) && compact_engine.StartRound(compact_game),
+                  "%d players", player_count);
+
+    while (true) {
+        for (int32_t casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+            LV_TEST_CHECK(lv::GetCasinoMoneyValue(game.casinos[casino_idx]) ==
+                              recorder.GetCasinoMoneyValues()[casino_idx],
+                          "round %d, casino %d", game.round, casino_idx);
+        }
+
+        const int32_t round_allocation_count = recorder.GetAllocationCount();
+        int32_t move_count = 0;
+        while (!engine.IsRoundOver(game)) {
+            lv::LegalMoveList moves{};
+            LV_TEST_CHECK(engine.GetLegalMoves(game, moves) > 0, "round %d", game.round);
+            const lv::DiceValue dice = moves.moves[move_rng.NextBelow(static_cast<uint32_t>(moves.count))].dice;
+            LV_TEST_CHECK(engine.AllocateDices(game, dice), "round %d", game.round);
+            LV_TEST_CHECK(compact_engine.PlayMove(compact_game, dice), "round %d", game.round);
+            ++move_count;
+            if (!engine.IsRoundOver(game)) {
+                LV_TEST_CHECK(engine.AdvanceToNextPlayer(game), "round %d", game.round);
+            }
+        }
+        LV_TEST_CHECK(recorder.GetAllocationCount() - round_allocation_count == move_count, "round %d", game.round);
+
+        const std::vector<lv::BillAwardedEvent> expected_bill_awards = GetExpectedBillAwards(game);
+        const int32_t round = game.round;
+        LV_TEST_CHECK(engine.EndRound(game), "round %d", round);
+        if (!CheckBillAwards(expected_bill_awards, round, recorder)) {
+            return false;
+        }
+        if (engine.IsGameOver(game)) {
+            break;
+        }
+        LV_TEST_CHECK(engine.SetupRound(game) && engine.StartRound(game), "round %d", game.round);
+    }
+    LV_TEST_CHECK(compact_engine.IsGameOver(compact_game), "%d players", player_count);
+
+    const std::vector<std::string> &rLines = recorder.GetLines();
+    const std::vector<std::string> &rCompactLines = compact_recorder.GetLines();
+    for (size_t line_idx = 0; line_idx < std::max(rLines.size(), rCompactLines.size()); ++line_idx) {
+        const char *pLine = line_idx < rLines.size() ? rLines[line_idx].c_str() : "(none)";
+        const char *pCompactLine = line_idx < rCompactLines.size() ? rCompactLines[line_idx].c_str() : "(none)";
+        LV_TEST_CHECK(std::string(pLine) == pCompactLine, "event %zu: '%s', compact '%s'", line_idx, pLine,
+                      pCompactLine);
+    }
+    return true;
+}
+
+} // namespace
+
+bool TestEngineEvents()
+{
+#if !defined(LV_ENABLE_ENGINE_EVENTS)
+    LV_TEST_CHECK(false, "LasVegTests must link an engine built with LV_ENABLE_ENGINE_EVENTS");
+#endif
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        for (int32_t game_idx = 0; game_idx < GAME_COUNT_PER_PLAYER_COUNT; ++game_idx) {
+            if (!PlayGame(player_count, lv::GetGameSeed(static_cast<uint64_t>(player_count), game_idx))) {
+                std::fprintf(stderr, "  %d players, game %d\n", player_count, game_idx);
+                return false;
+            }
+        }
+    }
+    return true;
+}
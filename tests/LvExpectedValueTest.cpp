@@ -0,0 +1,149 @@
+// Expected casino payouts against brute-force enumeration
+//
+// ExpectedValueEvaluator::GetCasinoExpectedPayouts runs a dynamic program over bet values (GetPlayerExpectedPayout)
+// on binomial bet distributions. The reference here enumerates every way the remaining dices can fall, each dice in
+// the casino with probability 1 / 6 or elsewhere, and pays every outcome with GetCasinoPayouts. Every bet and dice
+// combination up to a few per bidder is checked for 3 to 5 players, neutral bet and white dices included, on random
+// casino bills. The second evaluation of a configuration comes from the cache and must not differ either.
+
+#include "LvTests.h"
+
+#include "LvExpectedValue.h"
+#include "LvUtils.h"
+
+#include <array>
+#include <cmath>
+
+namespace {
+
+enum { MAX_CASINO_BILL_COUNT = 5 };
+enum { MAX_ENUMERATED_DICE_COUNT = 16 }; // Remaining dices of every bidder together
+
+using Bets = std::array<int8_t, lv::MAX_PLAYER_COUNT>;
+
+// Largest bet and remaining dice count of every bidder for a player count, more players get fewer
+struct ConfigurationLimits {
+    int32_t player_count = 0;
+    int32_t max_bet = 0;
+    int32_t max_dice_count = 0;
+};
+
+constexpr ConfigurationLimits CONFIGURATION_LIMITS[] = {
+    {3, 2, 2},
+    {4, 2, 1},
+    {5, 1, 1},
+};
+
+constexpr double DICE_IN_CASINO_PROBABILITY = 1.0 / static_cast<int32_t>(lv::CASINO_COUNT);
+
+bool IsNear(double expected, double actual)
+{
+    return std::abs(expected - actual) <= 1e-5 * std::max(1.0, std::abs(expected));
+}
+
+// Expectation over every subset of the remaining dices falling in the casino, player dices first then white dices
+void GetReferencePayouts(const lv::CompactCasinoState &rCasino, const lv::PlayerDiceCounts &rRemainingDices,
+                         int32_t remaining_white_dices, int32_t player_count,
+                         std::array<double, lv::MAX_PLAYER_COUNT> &rPayouts)
+{
+    std::array<int32_t, MAX_ENUMERATED_DICE_COUNT> dice_bidders{};
+    int32_t dice_count = 0;
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        for (int32_t i = 0; i < rRemainingDices[player_idx]; ++i) {
+            dice_bidders[dice_count++] = player_idx;
+        }
+    }
+    for (int32_t i = 0; i < remaining_white_dices; ++i) {
+        dice_bidders[dice_count++] = player_count;
+    }
+
+    rPayouts = {};
+    for (uint32_t in_casino_mask = 0; in_casino_mask < (1u << dice_count); ++in_casino_mask) {
+        Bets bets = rCasino.dice_bets;
+        int8_t neutral_bet = rCasino.neutral_dice_bet;
+        double probability = 1.0;
+        for (int32_t dice_idx = 0; dice_idx < dice_count; ++dice_idx) {
+            if ((in_casino_mask >> dice_idx) & 1) {
+                ++(dice_bidders[dice_idx] == player_count ? neutral_bet : bets[dice_bidders[dice_idx]]);
+                probability *= DICE_IN_CASINO_PROBABILITY;
+            } else {
+                probability *= 1.0 - DICE_IN_CASINO_PROBABILITY;
+            }
+        }
+
+        std::array<int32_t, lv::MAX_PLAYER_COUNT> payouts{};
+        lv::GetCasinoPayouts(rCasino.bills, bets, neutral_bet, player_count, payouts);
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            rPayouts[player_idx] += probability * payouts[player_idx];
+        }
+    }
+}
+
+bool CheckConfigurations(const ConfigurationLimits &rLimits, lv::Rng &rRng)
+{
+    const int32_t player_count = rLimits.player_count;
+
+    // Mixed radix counter over the bet and remaining dices of every player, then of the neutral player
+    const int32_t digit_count = 2 * (player_count + 1);
+    std::array<int32_t, 2 * (lv::MAX_PLAYER_COUNT + 1)> digits{};
+    int64_t configuration_count = 0;
+    lv::ExpectedValueEvaluator evaluator{10};
+    while (true) {
+        lv::CompactCasinoState casino{};
+        lv::PlayerDiceCounts remaining_dices{};
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            casino.dice_bets[player_idx] = static_cast<int8_t>(digits[2 * player_idx]);
+            remaining_dices[player_idx] = static_cast<int8_t>(digits[2 * player_idx + 1]);
+        }
+        casino.neutral_dice_bet = static_cast<int8_t>(digits[2 * player_count]);
+        const int32_t remaining_white_dices = digits[2 * player_count + 1];
+
+        const int32_t bill_count = 1 + static_cast<int32_t>(rRng.NextBelow(MAX_CASINO_BILL_COUNT));
+        for (int32_t i = 0; i < bill_count; ++i) {
+            ++casino.bills[rRng.NextBelow(lv::BILL_TYPE_COUNT)];
+        }
+
+        std::array<double, lv::MAX_PLAYER_COUNT> expected{};
+        GetReferencePayouts(casino, remaining_dices, remaining_white_dices, player_count, expected);
+        for (int32_t evaluation_idx = 0; evaluation_idx < 2; ++evaluation_idx) {
+            lv::PlayerPayouts payouts{};
+            LV_TEST_CHECK(evaluator.GetCasinoExpectedPayouts(casino, remaining_dices, remaining_white_dices,
+                                                             player_count, payouts),
+                          "%d players, configuration %lld", player_count, static_cast<long long>(configuration_count));
+            for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+                LV_TEST_CHECK(IsNear(expected[player_idx], payouts[player_idx]),
+                              "%d players, configuration %lld, evaluation %d, player %d: %f, not %f", player_count,
+                              static_cast<long long>(configuration_count), evaluation_idx, player_idx,
+                              payouts[player_idx], expected[player_idx]);
+            }
+        }
+        ++configuration_count;
+
+        int32_t digit_idx = 0;
+        while (digit_idx < digit_count) {
+            const int32_t max_digit = digit_idx % 2 == 0 ? rLimits.max_bet : rLimits.max_dice_count;
+            if (++digits[digit_idx] <= max_digit) {
+                break;
+            }
+            digits[digit_idx++] = 0;
+        }
+        if (digit_idx == digit_count) {
+            break;
+        }
+    }
+    LV_TEST_CHECK(evaluator.GetCacheHitCount() > 0, "%d players", player_count);
+    return true;
+}
+
+} // namespace
+
+bool TestExpectedValue()
+{
+    lv::Rng rng{6};
+    for (const ConfigurationLimits &rLimits : CONFIGURATION_LIMITS) {
+        if (!CheckConfigurations(rLimits, rng)) {
+            return false;
+        }
+    }
+    return true;
+}
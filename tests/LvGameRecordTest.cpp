@@ -0,0 +1,278 @@
+// Game records written, read back and replayed
+//
+// Games of 2 to 5 players are played by random agents, recorded with GameRecordBuilder and appended to a record file
+// by GameRecordWriter, opened twice to append to an existing stream. Reading the file back with GameRecordReader
+// gives every game, and ReplayGameRecord replays each one without error, ending with the money the game ended with.
+// A file without the stream header of GAME_RECORD_VERSION is refused by GameRecordWriter::Open.
+//
+// One byte of a recorded game is then changed at a time, casino bills, chosen face, rolled dices, round result, turn
+// and round counts, and the replay must stop with the matching ReplayError. A truncated stream is a reader error.
+//
+// RankDiceCounts and UnrankDiceCounts must be inverse bijections between the 3003 histograms of up to 8 dices, and
+// the 210 of up to 4 dices, and the ranks below their count.
+
+#include "LvTests.h"
+
+#include "LvAgent.h"
+#include "LvGameRecord.h"
+#include "LvSimulator.h"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum { GAME_COUNT_PER_PLAYER_COUNT = 8 };
+
+struct RecordedGame {
+    int32_t player_count = 0;
+    lv::GameOutcome outcome{};
+};
+
+bool CheckDiceCountsRanks(int32_t max_dice_count, int32_t rank_count)
+{
+    // Every histogram of up to max_dice_count dices, the ones with too many dices must have no rank
+    std::vector<bool> ranked(rank_count, false);
+    int32_t histogram_count = 0;
+    lv::DiceCounts counts{};
+    const auto check_fn = [&](auto &&rSelf, int32_t face_idx, int32_t dice_count) -> bool {
+        if (face_idx == lv::CASINO_COUNT) {
+            const int32_t rank = lv::RankDiceCounts(counts, max_dice_count);
+            if (dice_count > max_dice_count) {
+                LV_TEST_CHECK(rank == -1, "%d dices, rank %d", dice_count, rank);
+                return true;
+            }
+            LV_TEST_CHECK(rank >= 0 && rank < rank_count && !ranked[rank], "max %d dices, rank %d", max_dice_count,
+                          rank);
+            ranked[rank] = true;
+            ++histogram_count;
+
+            lv::DiceCounts unranked{};
+            LV_TEST_CHECK(lv::UnrankDiceCounts(rank, max_dice_count, unranked) && unranked == counts,
+                          "max %d dices, rank %d", max_dice_count, rank);
+            return true;
+        }
+        for (int32_t count = 0; count + dice_count <= lv::DICE_COUNT; ++count) {
+            counts[face_idx] = static_cast<uint8_t>(count);
+            if (!rSelf(rSelf, face_idx + 1, dice_count + count)) {
+                return false;
+            }
+        }
+        counts[face_idx] = 0;
+        return true;
+    };
+    if (!check_fn(check_fn, 0, 0)) {
+        return false;
+    }
+    LV_TEST_CHECK(histogram_count == rank_count, "max %d dices, %d histograms", max_dice_count, histogram_count);
+
+    lv::DiceCounts unranked{};
+    LV_TEST_CHECK(!lv::UnrankDiceCounts(rank_count, max_dice_count, unranked) &&
+                      !lv::UnrankDiceCounts(-1, max_dice_count, unranked),
+                  "max %d dices", max_dice_count);
+    return true;
+}
+
+bool RecordGames(const std::string &rPath, std::vector<RecordedGame> &rGames)
+{
+    std::remove(rPath.c_str());
+
+    lv::GameRecordWriter writer;
+    lv::GameEngine engine{0};
+    lv::CompactGameState game{};
+    lv::GameRecordBuilder record{};
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        // The first player count starts the file, the others append to it
+        LV_TEST_CHECK(writer.Open(rPath.c_str()), "%s", rPath.c_str());
+
+        std::array<std::unique_ptr<lv::Agent>, lv::MAX_PLAYER_COUNT> agents{};
+        std::array<lv::Agent *, lv::MAX_PLAYER_COUNT> agent_ptrs{};
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            agents[player_idx] = std::make_unique<lv::RandomAgent>();
+            agent_ptrs[player_idx] = agents[player_idx].get();
+        }
+
+        for (int32_t game_idx = 0; game_idx < GAME_COUNT_PER_PLAYER_COUNT; ++game_idx) {
+            const uint64_t game_seed = lv::GetGameSeed(static_cast<uint64_t>(player_count), game_idx);
+            RecordedGame &rGame = rGames.emplace_back();
+            rGame.player_count = player_count;
+
+            engine.Seed(game_seed);
+            record.BeginGame(game_seed, player_count);
+            LV_TEST_CHECK(lv::PlayGame(engine, game, player_count, agent_ptrs.data(), ~game_seed, rGame.outcome,
+                                       &record),
+                          "%d players, game %d", player_count, game_idx);
+            record.EndGame();
+            LV_TEST_CHECK(writer.Write(record), "%d players, game %d", player_count, game_idx);
+        }
+        LV_TEST_CHECK(writer.Close(), "%s", rPath.c_str());
+    }
+    return true;
+}
+
+bool ReadFile(const std::string &rPath, std::vector<uint8_t> &rData)
+{
+    FILE *pFile = std::fopen(rPath.c_str(), "rb");
+    LV_TEST_CHECK(pFile != nullptr, "%s", rPath.c_str());
+    rData.resize(std::filesystem::file_size(rPath));
+    const bool read = std::fread(rData.data(), 1, rData.size(), pFile) == rData.size();
+    std::fclose(pFile);
+    LV_TEST_CHECK(read, "%s", rPath.c_str());
+    return true;
+}
+
+bool CheckReplays(const std::vector<uint8_t> &rData, const std::vector<RecordedGame> &rGames)
+{
+    lv::GameRecordReader reader{rData.data(), rData.size()};
+    LV_TEST_CHECK(reader.IsValid(), "%zu bytes", rData.size());
+
+    lv::GameEngine engine{0};
+    lv::CompactGameState game{};
+    lv::GameRecordView record{};
+    for (size_t game_idx = 0; game_idx < rGames.size(); ++game_idx) {
+        const RecordedGame &rGame = rGames[game_idx];
+        LV_TEST_CHECK(reader.NextGame(record), "game %zu", game_idx);
+        LV_TEST_CHECK(record.player_count == rGame.player_count && record.turn_count == rGame.outcome.turn_count,
+                      "game %zu: %d players, %d turns", game_idx, record.player_count, record.turn_count);
+
+        const lv::ReplayReport report = lv::ReplayGameRecord(record, engine, game);
+        LV_TEST_CHECK(report.error == lv::ReplayError::None, "game %zu: %s, round %d, turn %d", game_idx,
+                      lv::GetReplayErrorName(report.error), report.round, report.turn_idx);
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            LV_TEST_CHECK(lv::GetPlayerMoneyValue(game.players[player_idx]) == rGame.outcome.money[player_idx],
+                          "game %zu, player %d", game_idx, player_idx);
+        }
+    }
+    LV_TEST_CHECK(!reader.NextGame(record) && !reader.HasError(), "%zu games", rGames.size());
+    return true;
+}
+
+// First game of rData as a stream of its own
+bool GetFirstGame(const std::vector<uint8_t> &rData, std::vector<uint8_t> &rStream)
+{
+    lv::GameRecordReader reader{rData.data(), rData.size()};
+    lv::GameRecordView record{};
+    LV_TEST_CHECK(reader.NextGame(record), "%zu bytes", rData.size());
+    rStream.assign(rData.begin(), rData.begin() + static_cast<std::ptrdiff_t>(reader.GetOffset()));
+    return true;
+}
+
+bool CheckCorruption(const std::vector<uint8_t> &rStream, const char *pWhat, size_t offset, uint8_t value,
+                     lv::ReplayError expected_error)
+{
+    std::vector<uint8_t> corrupted = rStream;
+    corrupted[offset] = value;
+
+    lv::GameRecordReader reader{corrupted.data(), corrupted.size()};
+    lv::GameRecordView record{};
+    LV_TEST_CHECK(reader.NextGame(record), "%s", pWhat);
+
+    lv::GameEngine engine{0};
+    lv::CompactGameState game{};
+    const lv::ReplayReport report = lv::ReplayGameRecord(record, engine, game);
+    LV_TEST_CHECK(report.error == expected_error, "%s: %s, not %s", pWhat, lv::GetReplayErrorName(report.error),
+                  lv::GetReplayErrorName(expected_error));
+    return true;
+}
+
+bool CheckCorruptions(const std::vector<uint8_t> &rStream)
+{
+    lv::GameRecordReader reader{rStream.data(), rStream.size()};
+    lv::GameRecordView record{};
+    LV_TEST_CHECK(reader.NextGame(record), "%zu bytes", rStream.size());
+    const size_t payload_offset = static_cast<size_t>(record.pPayload - rStream.data());
+    const size_t header_offset = payload_offset - lv::GAME_RECORD_GAME_HEADER_SIZE;
+
+    lv::GameRecordRoundReader round_reader{record};
+    lv::GameRecordRound round{};
+    LV_TEST_CHECK(round_reader.NextRound(round), "first round");
+    const size_t turns_offset = static_cast<size_t>(round.pTurns - rStream.data());
+    const size_t result_offset = turns_offset + static_cast<size_t>(round.turn_count) * lv::GAME_RECORD_TURN_SIZE;
+
+    // The first casino has at least one bill, the nibble after its bill count is the lowest one
+    const uint8_t first_bill_byte = rStream[payload_offset];
+    const uint8_t other_bill_idx = static_cast<uint8_t>(((first_bill_byte >> 4) + 1) % lv::BILL_TYPE_COUNT);
+    if (!CheckCorruption(rStream, "casino bill", payload_offset,
+                         static_cast<uint8_t>((first_bill_byte & 0xF) | (other_bill_idx << 4)),
+                         lv::ReplayError::CasinoBills)) {
+        return false;
+    }
+
+    // A turn that didn't roll every face, moved to one it didn't roll
+    bool has_move = false;
+    for (int32_t turn_idx = 0; turn_idx < round.turn_count && !has_move; ++turn_idx) {
+        lv::GameRecordTurn turn{};
+        const size_t turn_offset = turns_offset + static_cast<size_t>(turn_idx) * lv::GAME_RECORD_TURN_SIZE;
+        LV_TEST_CHECK(lv::DecodeGameRecordTurn(rStream.data() + turn_offset, turn), "turn %d", turn_idx);
+        for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT && !has_move; ++face_idx) {
+            if (turn.dices[face_idx] == 0 && turn.white_dices[face_idx] == 0) {
+                const uint8_t face_byte = static_cast<uint8_t>((rStream[turn_offset] & ~7) | (face_idx + 1));
+                if (!CheckCorruption(rStream, "face", turn_offset, face_byte, lv::ReplayError::Move)) {
+                    return false;
+                }
+                has_move = true;
+            }
+        }
+    }
+    LV_TEST_CHECK(has_move, "%d turns", round.turn_count);
+
+    // Lowest bit of the rolled dices rank, the rank of another histogram of up to DICE_COUNT dices
+    if (!CheckCorruption(rStream, "roll", turns_offset, static_cast<uint8_t>(rStream[turns_offset] ^ 8),
+                         lv::ReplayError::Roll) ||
+        !CheckCorruption(rStream, "round result", result_offset, static_cast<uint8_t>(rStream[result_offset] ^ 1),
+                         lv::ReplayError::RoundResult) ||
+        !CheckCorruption(rStream, "round turn count", turns_offset - 2,
+                         static_cast<uint8_t>(rStream[turns_offset - 2] - 1), lv::ReplayError::TurnCount) ||
+        !CheckCorruption(rStream, "game turn count", header_offset + 12,
+                         static_cast<uint8_t>(rStream[header_offset + 12] ^ 1), lv::ReplayError::TurnCount) ||
+        !CheckCorruption(rStream, "round count", header_offset + 15,
+                         static_cast<uint8_t>(rStream[header_offset + 15] + 1), lv::ReplayError::Format)) {
+        return false;
+    }
+
+    // Cut in the middle of the game
+    const std::vector<uint8_t> truncated(rStream.begin(), rStream.end() - 1);
+    lv::GameRecordReader truncated_reader{truncated.data(), truncated.size()};
+    LV_TEST_CHECK(truncated_reader.IsValid() && !truncated_reader.NextGame(record) && truncated_reader.HasError(),
+                  "%zu bytes", truncated.size());
+    return true;
+}
+
+bool CheckForeignFiles(const std::string &rPath)
+{
+    const char *const pHeaders[] = {"Not a game record\n", "LVGR\x01\0\0\0"};
+    for (const char *pHeader : pHeaders) {
+        FILE *pFile = std::fopen(rPath.c_str(), "wb");
+        LV_TEST_CHECK(pFile != nullptr, "%s", rPath.c_str());
+        const bool written = std::fwrite(pHeader, 1, 8, pFile) == 8;
+        std::fclose(pFile);
+        LV_TEST_CHECK(written, "%s", rPath.c_str());
+
+        lv::GameRecordWriter writer;
+        LV_TEST_CHECK(!writer.Open(rPath.c_str()), "%s", rPath.c_str());
+        LV_TEST_CHECK(std::filesystem::file_size(rPath) == 8, "%s", rPath.c_str());
+    }
+    return true;
+}
+
+} // namespace
+
+bool TestGameRecord()
+{
+    if (!CheckDiceCountsRanks(8, 3003) || !CheckDiceCountsRanks(4, 210)) {
+        return false;
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "LasVegGameRecordTest.lvgr").string();
+    std::vector<RecordedGame> games;
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> stream;
+    const bool passed = RecordGames(path, games) && ReadFile(path, data) && CheckReplays(data, games) &&
+                        GetFirstGame(data, stream) && CheckCorruptions(stream) && CheckForeignFiles(path);
+    std::remove(path.c_str());
+    return passed;
+}
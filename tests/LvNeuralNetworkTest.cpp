@@ -0,0 +1,288 @@
+// Neural network files loaded and evaluated
+//
+// Small networks of two layers, FEATURE_COUNT inputs to a few ReLU units to NETWORK_OUTPUT_COUNT raw outputs, are
+// written to a LVNN file with float weights, then with int8 weights and scales, the hidden layer size leaving
+// padding after the int8 weights. NeuralNetwork::Open loads each file, and Evaluate on random sparse rows, one by one
+// and batched across BATCH_BLOCK_SIZE, must give the outputs computed here in double from the same weights.
+// GetOutput must turn known logits into their softmaxes.
+//
+// Every truncation of a valid file, a trailing byte, and every header field set to a wrong value must be refused,
+// leaving the network closed.
+
+#include "LvTests.h"
+
+#include "LvNeuralNetwork.h"
+#include "LvRandom.h"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum { ROW_COUNT = 9 }; // More than two blocks of the evaluator
+enum { NONZERO_INPUT_COUNT = 24 };
+
+struct TestLayer {
+    int32_t input_count = 0;
+    int32_t output_count = 0;
+    lv::NetworkWeightType weight_type = lv::NetworkWeightType::Float;
+    lv::NetworkActivation activation = lv::NetworkActivation::None;
+    std::vector<float> biases;
+    std::vector<float> scales;
+    std::vector<float> weights; // Int8 ones as their integer values
+};
+
+float GetRandomFloat(lv::Rng &rRng)
+{
+    return static_cast<float>(rRng.NextBelow(2001)) / 1000.0f - 1.0f;
+}
+
+TestLayer MakeLayer(int32_t input_count, int32_t output_count, lv::NetworkWeightType weight_type,
+                    lv::NetworkActivation activation, lv::Rng &rRng)
+{
+    TestLayer layer{input_count, output_count, weight_type, activation, {}, {}, {}};
+    for (int32_t output_idx = 0; output_idx < output_count; ++output_idx) {
+        layer.biases.push_back(GetRandomFloat(rRng));
+        if (weight_type == lv::NetworkWeightType::Int8) {
+            layer.scales.push_back(static_cast<float>(1 + rRng.NextBelow(100)) / 1024.0f);
+        }
+    }
+    for (int32_t weight_idx = 0; weight_idx < input_count * output_count; ++weight_idx) {
+        if (weight_type == lv::NetworkWeightType::Int8) {
+            layer.weights.push_back(static_cast<float>(static_cast<int32_t>(rRng.NextBelow(255)) - 127));
+        } else {
+            layer.weights.push_back(GetRandomFloat(rRng));
+        }
+    }
+    return layer;
+}
+
+void AppendUint32(std::vector<uint8_t> &rData, uint32_t value)
+{
+    for (int32_t byte_idx = 0; byte_idx < 4; ++byte_idx) {
+        rData.push_back(static_cast<uint8_t>(value >> (8 * byte_idx)));
+    }
+}
+
+void AppendFloats(std::vector<uint8_t> &rData, const std::vector<float> &rValues)
+{
+    for (const float value : rValues) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        AppendUint32(rData, bits);
+    }
+}
+
+std::vector<uint8_t> MakeNetworkFile(const std::vector<TestLayer> &rLayers)
+{
+    std::vector<uint8_t> data{'L', 'V', 'N', 'N'};
+    AppendUint32(data, lv::NETWORK_FILE_VERSION);
+    AppendUint32(data, lv::FEATURE_LAYOUT_VERSION);
+    AppendUint32(data, lv::FEATURE_COUNT);
+    AppendUint32(data, static_cast<uint32_t>(rLayers.size()));
+    data.resize(lv::NETWORK_FILE_HEADER_SIZE, 0);
+
+    for (const TestLayer &rLayer : rLayers) {
+        AppendUint32(data, static_cast<uint32_t>(rLayer.input_count));
+        AppendUint32(data, static_cast<uint32_t>(rLayer.output_count));
+        AppendUint32(data, static_cast<uint32_t>(rLayer.weight_type));
+        AppendUint32(data, static_cast<uint32_t>(rLayer.activation));
+        AppendFloats(data, rLayer.biases);
+        if (rLayer.weight_type == lv::NetworkWeightType::Int8) {
+            AppendFloats(data, rLayer.scales);
+            for (const float weight : rLayer.weights) {
+                data.push_back(static_cast<uint8_t>(static_cast<int8_t>(weight)));
+            }
+        } else {
+            AppendFloats(data, rLayer.weights);
+        }
+        data.resize((data.size() + 3) / 4 * 4, 0);
+    }
+    return data;
+}
+
+// Bytes of a layer in the file, header and padding included
+size_t GetLayerSize(const TestLayer &rLayer)
+{
+    size_t size = lv::NETWORK_LAYER_HEADER_SIZE + 4 * rLayer.biases.size() + 4 * rLayer.scales.size();
+    size += rLayer.weight_type == lv::NetworkWeightType::Int8 ? rLayer.weights.size() : 4 * rLayer.weights.size();
+    return (size + 3) / 4 * 4;
+}
+
+bool WriteFile(const std::string &rPath, const std::vector<uint8_t> &rData)
+{
+    std::FILE *pFile = std::fopen(rPath.c_str(), "wb");
+    LV_TEST_CHECK(pFile != nullptr, "%s", rPath.c_str());
+    const bool written = std::fwrite(rData.data(), 1, rData.size(), pFile) == rData.size();
+    std::fclose(pFile);
+    LV_TEST_CHECK(written, "%s", rPath.c_str());
+    return true;
+}
+
+// Outputs of one row, layer by layer in double
+std::vector<double> GetReferenceOutputs(const std::vector<TestLayer> &rLayers, const float *pInputs)
+{
+    std::vector<double> values(pInputs, pInputs + lv::FEATURE_COUNT);
+    for (const TestLayer &rLayer : rLayers) {
+        std::vector<double> outputs(rLayer.output_count, 0.0);
+        for (int32_t output_idx = 0; output_idx < rLayer.output_count; ++output_idx) {
+            double sum = 0.0;
+            for (int32_t input_idx = 0; input_idx < rLayer.input_count; ++input_idx) {
+                sum += values[input_idx] * rLayer.weights[input_idx * rLayer.output_count + output_idx];
+            }
+            if (rLayer.weight_type == lv::NetworkWeightType::Int8) {
+                sum *= rLayer.scales[output_idx];
+            }
+            sum += rLayer.biases[output_idx];
+            if (rLayer.activation == lv::NetworkActivation::Relu) {
+                sum = std::max(sum, 0.0);
+            }
+            outputs[output_idx] = sum;
+        }
+        values = outputs;
+    }
+    return values;
+}
+
+bool CheckEvaluation(const std::string &rPath, const std::vector<TestLayer> &rLayers, lv::Rng &rRng)
+{
+    LV_TEST_CHECK(WriteFile(rPath, MakeNetworkFile(rLayers)), "%s", rPath.c_str());
+    lv::NeuralNetwork network;
+    LV_TEST_CHECK(network.Open(rPath.c_str()) && network.GetLayerCount() == static_cast<int32_t>(rLayers.size()),
+                  "%s", rPath.c_str());
+
+    std::vector<float> inputs(static_cast<size_t>(ROW_COUNT) * lv::FEATURE_COUNT, 0.0f);
+    for (int32_t row_idx = 0; row_idx < ROW_COUNT; ++row_idx) {
+        for (int32_t i = 0; i < NONZERO_INPUT_COUNT; ++i) {
+            inputs[row_idx * lv::FEATURE_COUNT + rRng.NextBelow(lv::FEATURE_COUNT)] = GetRandomFloat(rRng);
+        }
+    }
+
+    lv::NetworkWorkspace workspace;
+    std::vector<float> batch_outputs(static_cast<size_t>(ROW_COUNT) * lv::NETWORK_OUTPUT_COUNT);
+    network.Evaluate(inputs.data(), ROW_COUNT, batch_outputs.data(), workspace);
+    for (int32_t row_idx = 0; row_idx < ROW_COUNT; ++row_idx) {
+        const float *pRowInputs = inputs.data() + row_idx * lv::FEATURE_COUNT;
+        const std::vector<double> expected = GetReferenceOutputs(rLayers, pRowInputs);
+        std::array<float, lv::NETWORK_OUTPUT_COUNT> outputs{};
+        network.Evaluate(pRowInputs, 1, outputs.data(), workspace);
+        for (int32_t output_idx = 0; output_idx < lv::NETWORK_OUTPUT_COUNT; ++output_idx) {
+            const double tolerance = 1e-4 * std::max(1.0, std::abs(expected[output_idx]));
+            const float batch_output = batch_outputs[row_idx * lv::NETWORK_OUTPUT_COUNT + output_idx];
+            LV_TEST_CHECK(std::abs(outputs[output_idx] - expected[output_idx]) <= tolerance &&
+                              batch_output == outputs[output_idx],
+                          "%s, row %d, output %d: %f batched %f, not %f", rPath.c_str(), row_idx, output_idx,
+                          outputs[output_idx], batch_output, expected[output_idx]);
+        }
+    }
+    return true;
+}
+
+bool CheckOutput()
+{
+    // Logits 0 and ln 2 give shares 1 / 3 and 2 / 3, equal logits a uniform policy
+    std::array<float, lv::NETWORK_OUTPUT_COUNT> raw_outputs{};
+    raw_outputs[1] = std::log(2.0f);
+    raw_outputs[2] = 100.0f; // Seat beyond the player count
+    lv::NetworkOutput output{};
+    lv::NeuralNetwork::GetOutput(raw_outputs.data(), 2, output);
+    LV_TEST_CHECK(std::abs(output.win_shares[0] - 1.0f / 3.0f) < 1e-6f &&
+                      std::abs(output.win_shares[1] - 2.0f / 3.0f) < 1e-6f && output.win_shares[2] == 0.0f,
+                  "win shares %f %f %f", output.win_shares[0], output.win_shares[1], output.win_shares[2]);
+    for (int32_t face_idx = 0; face_idx < lv::CASINO_COUNT; ++face_idx) {
+        LV_TEST_CHECK(std::abs(output.policy[face_idx] - 1.0f / 6.0f) < 1e-6f, "face %d: %f", face_idx + 1,
+                      output.policy[face_idx]);
+    }
+    return true;
+}
+
+bool CheckRefused(const std::string &rPath, const std::vector<uint8_t> &rData, const char *pWhat, size_t detail)
+{
+    LV_TEST_CHECK(WriteFile(rPath, rData), "%s", rPath.c_str());
+    lv::NeuralNetwork network;
+    LV_TEST_CHECK(!network.Open(rPath.c_str()) && !network.IsOpen(), "%s %zu", pWhat, detail);
+    return true;
+}
+
+bool CheckInvalidFiles(const std::string &rPath, const std::vector<TestLayer> &rLayers)
+{
+    const std::vector<uint8_t> data = MakeNetworkFile(rLayers);
+    for (size_t size = 0; size < data.size(); ++size) {
+        if (!CheckRefused(rPath, std::vector<uint8_t>(data.begin(), data.begin() + size), "truncated to", size)) {
+            return false;
+        }
+    }
+    std::vector<uint8_t> extended = data;
+    extended.push_back(0);
+    if (!CheckRefused(rPath, extended, "extended to", extended.size())) {
+        return false;
+    }
+
+    // Fields of the file header, then of the layer headers, with a value they must not have
+    const size_t second_layer_offset = lv::NETWORK_FILE_HEADER_SIZE + GetLayerSize(rLayers[0]);
+    const struct {
+        size_t offset;
+        uint32_t value;
+    } corruptions[] = {
+        {0, 0x4E4E564C ^ 1},                                                       // Magic
+        {4, lv::NETWORK_FILE_VERSION + 1},                                         // Version
+        {8, lv::FEATURE_LAYOUT_VERSION + 1},                                       // Feature layout
+        {12, lv::FEATURE_COUNT - 1},                                               // Input count
+        {16, 0},                                                                   // No layer
+        {16, lv::NETWORK_MAX_LAYER_COUNT + 1},                                     // Too many layers
+        {32, lv::FEATURE_COUNT + 1},                                               // First layer inputs
+        {36, 0},                                                                   // No output
+        {36, lv::NETWORK_MAX_LAYER_SIZE + 1},                                      // Too many outputs
+        {40, static_cast<uint32_t>(lv::NetworkWeightType::Int8) + 1},              // Weight type
+        {44, static_cast<uint32_t>(lv::NetworkActivation::Relu) + 1},              // Activation
+        {second_layer_offset, static_cast<uint32_t>(rLayers[0].output_count) + 1}, // Second layer inputs
+        {second_layer_offset + 4, lv::NETWORK_OUTPUT_COUNT - 1},                   // Last layer outputs
+    };
+    for (const auto &rCorruption : corruptions) {
+        std::vector<uint8_t> corrupted = data;
+        const uint32_t value = rCorruption.value;
+        std::memcpy(corrupted.data() + rCorruption.offset, &value, sizeof(value));
+        if (!CheckRefused(rPath, corrupted, "value changed at", rCorruption.offset)) {
+            return false;
+        }
+    }
+
+    // A failed open closes the network opened before
+    LV_TEST_CHECK(WriteFile(rPath, data), "%s", rPath.c_str());
+    lv::NeuralNetwork network;
+    LV_TEST_CHECK(network.Open(rPath.c_str()), "%s", rPath.c_str());
+    LV_TEST_CHECK(WriteFile(rPath, extended), "%s", rPath.c_str());
+    LV_TEST_CHECK(!network.Open(rPath.c_str()) && !network.IsOpen(), "%s", rPath.c_str());
+    return true;
+}
+
+} // namespace
+
+bool TestNeuralNetwork()
+{
+    if (!CheckOutput()) {
+        return false;
+    }
+
+    lv::Rng rng{23};
+    const std::vector<TestLayer> float_layers = {
+        MakeLayer(lv::FEATURE_COUNT, 5, lv::NetworkWeightType::Float, lv::NetworkActivation::Relu, rng),
+        MakeLayer(5, lv::NETWORK_OUTPUT_COUNT, lv::NetworkWeightType::Float, lv::NetworkActivation::None, rng),
+    };
+    // 3 * NETWORK_OUTPUT_COUNT int8 weights are padded
+    const std::vector<TestLayer> int8_layers = {
+        MakeLayer(lv::FEATURE_COUNT, 3, lv::NetworkWeightType::Int8, lv::NetworkActivation::Relu, rng),
+        MakeLayer(3, lv::NETWORK_OUTPUT_COUNT, lv::NetworkWeightType::Int8, lv::NetworkActivation::None, rng),
+    };
+
+    const std::string path = (std::filesystem::temp_directory_path() / "LasVegNeuralNetworkTest.lvnn").string();
+    const bool passed = CheckEvaluation(path, float_layers, rng) && CheckEvaluation(path, int8_layers, rng) &&
+                        CheckInvalidFiles(path, float_layers) && CheckInvalidFiles(path, int8_layers);
+    std::remove(path.c_str());
+    return passed;
+}
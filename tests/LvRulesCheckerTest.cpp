@@ -0,0 +1,264 @@
+// IncrementalRulesChecker against RulesChecker
+//
+// Random games are played with a change tracker on the engine. After every step IncrementalRulesChecker::Update, fed
+// the parts the step changed, must report the same as a full RulesChecker::CheckGameState, nothing until the game is
+// over. The final state is checked with CheckFinalGameState instead, it has no turn left.
+//
+// At every step a copy of the state is also tampered with, one part at a time: a bill added, swapped or moved, a bet
+// added or taken back, a dice or a turn changed, the round or the first player out of range. The part is flagged as
+// the engine would, and Update on a copy of the checker must report the same violation as the full check, which for
+// most of them is known.
+
+#include "LvTests.h"
+
+#include "LvGameEngine.h"
+#include "LvRulesChecker.h"
+#include "LvUtils.h"
+
+#include <functional>
+
+namespace {
+
+enum { GAME_COUNT_PER_PLAYER_COUNT = 12 };
+
+struct Tampering {
+    const char *pName = nullptr;
+    lv::RulesViolation expected = lv::RulesViolation::None; // None when it depends on the state
+    std::function<bool(lv::CompactGameState &, lv::StateChanges &, lv::Rng &)> apply_fn;
+};
+
+int32_t GetRandomBillIndex(const lv::BillCounts &rBills, lv::Rng &rRng)
+{
+    int32_t bill_count = 0;
+    for (const uint8_t count : rBills) {
+        bill_count += count;
+    }
+    if (bill_count == 0) {
+        return -1;
+    }
+    int32_t bill_rank = static_cast<int32_t>(rRng.NextBelow(static_cast<uint32_t>(bill_count)));
+    for (int32_t bill_idx = 0; bill_idx < lv::BILL_TYPE_COUNT; ++bill_idx) {
+        bill_rank -= rBills[bill_idx];
+        if (bill_rank < 0) {
+            return bill_idx;
+        }
+    }
+    return -1;
+}
+
+lv::CasinoIdx GetRandomCasino(lv::Rng &rRng)
+{
+    return static_cast<lv::CasinoIdx>(rRng.NextBelow(lv::CASINO_COUNT));
+}
+
+lv::PlayerIdx GetRandomPlayer(const lv::CompactGameState &rGame, lv::Rng &rRng)
+{
+    return static_cast<lv::PlayerIdx>(rRng.NextBelow(static_cast<uint32_t>(rGame.player_count)));
+}
+
+const Tampering TAMPERINGS[] = {
+    {"casino bill added", lv::RulesViolation::BillCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         const lv::CasinoIdx casino_idx = GetRandomCasino(rRng);
+         ++rGame.casinos[casino_idx].bills[rRng.NextBelow(lv::BILL_TYPE_COUNT)];
+         rChanges.casino_mask |= 1u << casino_idx;
+         return true;
+     }},
+    {"player bill added", lv::RulesViolation::BillCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         const lv::PlayerIdx player_idx = GetRandomPlayer(rGame, rRng);
+         ++rGame.players[player_idx].bills[rRng.NextBelow(lv::BILL_TYPE_COUNT)];
+         rChanges.player_mask |= 1u << player_idx;
+         return true;
+     }},
+    {"neutral bill added", lv::RulesViolation::BillCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         ++rGame.neutral_player_bills[rRng.NextBelow(lv::BILL_TYPE_COUNT)];
+         rChanges.flags |= lv::StateChanges::NEUTRAL_PLAYER;
+         return true;
+     }},
+    {"bank bill swapped", lv::RulesViolation::BillCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         if (rGame.bank_size == 0) {
+             return false;
+         }
+         uint8_t &rBill = rGame.bank[rRng.NextBelow(static_cast<uint32_t>(rGame.bank_size))];
+         rBill = static_cast<uint8_t>((rBill + 1 + rRng.NextBelow(lv::BILL_TYPE_COUNT - 1)) % lv::BILL_TYPE_COUNT);
+         rChanges.flags |= lv::StateChanges::BANK;
+         return true;
+     }},
+    {"bank bill out of range", lv::RulesViolation::BankSize,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         if (rGame.bank_size == 0) {
+             return false;
+         }
+         rGame.bank[rRng.NextBelow(static_cast<uint32_t>(rGame.bank_size))] = lv::BILL_TYPE_COUNT;
+         rChanges.flags |= lv::StateChanges::BANK;
+         return true;
+     }},
+    {"bank overflow", lv::RulesViolation::BankSize,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &) {
+         rGame.bank_size = static_cast<int32_t>(rGame.bank.size()) + 1;
+         rChanges.flags |= lv::StateChanges::BANK;
+         return true;
+     }},
+    {"casino bill moved to a player", lv::RulesViolation::None,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         const lv::CasinoIdx casino_idx = GetRandomCasino(rRng);
+         const int32_t bill_idx = GetRandomBillIndex(rGame.casinos[casino_idx].bills, rRng);
+         if (bill_idx < 0) {
+             return false;
+         }
+         const lv::PlayerIdx player_idx = GetRandomPlayer(rGame, rRng);
+         --rGame.casinos[casino_idx].bills[bill_idx];
+         ++rGame.players[player_idx].bills[bill_idx];
+         rChanges.casino_mask |= 1u << casino_idx;
+         rChanges.player_mask |= 1u << player_idx;
+         return true;
+     }},
+    {"bet added", lv::RulesViolation::PlayerDiceCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         const lv::CasinoIdx casino_idx = GetRandomCasino(rRng);
+         ++rGame.casinos[casino_idx].dice_bets[GetRandomPlayer(rGame, rRng)];
+         rChanges.casino_mask |= 1u << casino_idx;
+         return true;
+     }},
+    {"bet taken back by the current player", lv::RulesViolation::TurnDiceCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         const lv::PlayerIdx player_idx = rGame.current_turn.player_idx;
+         const lv::CasinoIdx casino_idx = GetRandomCasino(rRng);
+         if (rGame.casinos[casino_idx].dice_bets[player_idx] == 0) {
+             return false;
+         }
+         --rGame.casinos[casino_idx].dice_bets[player_idx];
+         ++rGame.players[player_idx].dices;
+         rChanges.casino_mask |= 1u << casino_idx;
+         rChanges.player_mask |= 1u << player_idx;
+         return true;
+     }},
+    {"neutral bet added", lv::RulesViolation::NeutralDiceCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         if (!rGame.neutral_player_present) {
+             return false;
+         }
+         const lv::CasinoIdx casino_idx = GetRandomCasino(rRng);
+         ++rGame.casinos[casino_idx].neutral_dice_bet;
+         rChanges.casino_mask |= 1u << casino_idx;
+         return true;
+     }},
+    {"negative dices", lv::RulesViolation::PlayerDiceCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         const lv::PlayerIdx player_idx = GetRandomPlayer(rGame, rRng);
+         rGame.players[player_idx].dices = -1;
+         rChanges.player_mask |= 1u << player_idx;
+         return true;
+     }},
+    {"extra dice rolled", lv::RulesViolation::TurnDiceCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         ++rGame.current_turn.dices[GetRandomCasino(rRng)];
+         rChanges.flags |= lv::StateChanges::TURN;
+         return true;
+     }},
+    {"extra white dice rolled", lv::RulesViolation::TurnWhiteDiceCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &rRng) {
+         ++rGame.current_turn.white_dices[GetRandomCasino(rRng)];
+         rChanges.flags |= lv::StateChanges::TURN;
+         return true;
+     }},
+    {"current player out of range", lv::RulesViolation::CurrentPlayerIndex,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &) {
+         rGame.current_turn.player_idx = static_cast<lv::PlayerIdx>(rGame.player_count);
+         rChanges.flags |= lv::StateChanges::TURN;
+         return true;
+     }},
+    {"first player out of range", lv::RulesViolation::FirstPlayerIndex,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &) {
+         rGame.first_player_idx = static_cast<lv::PlayerIdx>(rGame.player_count);
+         rChanges.flags |= lv::StateChanges::HEADER;
+         return true;
+     }},
+    {"round past the last", lv::RulesViolation::RoundCount,
+     [](lv::CompactGameState &rGame, lv::StateChanges &rChanges, lv::Rng &) {
+         rGame.round = lv::ROUND_COUNT;
+         rChanges.flags |= lv::StateChanges::HEADER;
+         return true;
+     }},
+};
+
+bool CheckTamperings(const lv::CompactGameState &rGame, const lv::IncrementalRulesChecker &rChecker, lv::Rng &rRng)
+{
+    const lv::RulesChecker full_checker{};
+    for (const Tampering &rTampering : TAMPERINGS) {
+        lv::CompactGameState game = rGame;
+        lv::StateChanges changes{};
+        if (!rTampering.apply_fn(game, changes, rRng)) {
+            continue;
+        }
+
+        lv::IncrementalRulesChecker checker = rChecker;
+        const lv::RulesViolation violation = checker.Update(game, changes);
+        const lv::RulesViolation full_violation = full_checker.CheckGameState(game);
+        LV_TEST_CHECK(violation == full_violation, "%s: %s, full check %s", rTampering.pName,
+                      lv::GetRulesViolationName(violation), lv::GetRulesViolationName(full_violation));
+        LV_TEST_CHECK(rTampering.expected == lv::RulesViolation::None || violation == rTampering.expected,
+                      "%s: %s, not %s", rTampering.pName, lv::GetRulesViolationName(violation),
+                      lv::GetRulesViolationName(rTampering.expected));
+    }
+    return true;
+}
+
+bool PlayGame(int32_t player_count, int32_t game_idx, lv::Rng &rRng)
+{
+    const lv::RulesChecker full_checker{};
+    lv::GameEngine engine{static_cast<uint64_t>(game_idx)};
+    lv::CompactGameState game{};
+    LV_TEST_CHECK(engine.SetupInitGameState(game, player_count) && engine.SetupRound(game) && engine.StartRound(game),
+                  "%d players, game %d", player_count, game_idx);
+
+    lv::IncrementalRulesChecker checker{};
+    LV_TEST_CHECK(checker.Reset(game) == lv::RulesViolation::None, "%d players, game %d", player_count, game_idx);
+
+    lv::StateChanges changes{};
+    engine.SetChangeTracker(&changes);
+    for (int32_t step_idx = 0; !engine.IsGameOver(game); ++step_idx) {
+        if (!CheckTamperings(game, checker, rRng)) {
+            std::fprintf(stderr, "  %d players, game %d, step %d\n", player_count, game_idx, step_idx);
+            return false;
+        }
+
+        lv::LegalMoveList moves{};
+        LV_TEST_CHECK(engine.GetLegalMoves(game, moves) > 0, "%d players, game %d, step %d", player_count, game_idx,
+                      step_idx);
+        changes.Clear();
+        LV_TEST_CHECK(engine.PlayMove(game, moves.moves[rRng.NextBelow(static_cast<uint32_t>(moves.count))].dice),
+                      "%d players, game %d, step %d", player_count, game_idx, step_idx);
+
+        const lv::RulesViolation violation = checker.Update(game, changes);
+        if (engine.IsGameOver(game)) {
+            const lv::RulesViolation final_violation = full_checker.CheckFinalGameState(game);
+            LV_TEST_CHECK(final_violation == lv::RulesViolation::None, "%d players, game %d, final state: %s",
+                          player_count, game_idx, lv::GetRulesViolationName(final_violation));
+            break;
+        }
+        const lv::RulesViolation full_violation = full_checker.CheckGameState(game);
+        LV_TEST_CHECK(violation == lv::RulesViolation::None && full_violation == lv::RulesViolation::None,
+                      "%d players, game %d, step %d: %s, full check %s", player_count, game_idx, step_idx,
+                      lv::GetRulesViolationName(violation), lv::GetRulesViolationName(full_violation));
+    }
+    return true;
+}
+
+} // namespace
+
+bool TestRulesChecker()
+{
+    lv::Rng rng{7};
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        for (int32_t game_idx = 0; game_idx < GAME_COUNT_PER_PLAYER_COUNT; ++game_idx) {
+            if (!PlayGame(player_count, game_idx, rng)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
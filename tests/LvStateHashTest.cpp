@@ -0,0 +1,111 @@
+// Incremental hashes through whole games
+//
+// GameEngine updates GameState::hash and CompactGameState::hash in every mutator. Random games of 2 to 5 players are
+// played step by step on the vector GameState, which has no PlayMove: SetupRound, StartRound, AllocateDices then
+// AdvanceToNextPlayer or EndRound. After every call the hash must be the one ComputeHash recomputes, and the one of
+// the same state converted to a CompactGameState. The same games are played with PlayMove on CompactGameState, whose
+// hash is checked after every move.
+
+#include "LvTests.h"
+
+#include "LvGameEngine.h"
+#include "LvSimulator.h"
+#include "LvStateConversion.h"
+#include "LvStateHash.h"
+#include "LvUtils.h"
+
+namespace {
+
+enum { GAME_COUNT_PER_PLAYER_COUNT = 16 };
+
+bool CheckHash(const lv::GameState &rGame, const char *pStep)
+{
+    LV_TEST_CHECK(rGame.hash == lv::ComputeHash(rGame), "after %s, round %d", pStep, rGame.round);
+
+    lv::CompactGameState compact{};
+    LV_TEST_CHECK(lv::ToCompactGameState(rGame, compact), "after %s, round %d", pStep, rGame.round);
+    LV_TEST_CHECK(lv::ComputeHash(compact) == rGame.hash, "compact, after %s, round %d", pStep, rGame.round);
+    return true;
+}
+
+bool PlayVectorGame(int32_t player_count, uint64_t seed)
+{
+    lv::GameEngine engine{seed};
+    lv::Rng move_rng{~seed};
+    lv::GameState game{};
+    LV_TEST_CHECK(engine.SetupInitGameState(game, player_count), "%d players", player_count);
+    if (!CheckHash(game, "SetupInitGameState")) {
+        return false;
+    }
+
+    while (true) {
+        LV_TEST_CHECK(engine.SetupRound(game), "%d players, round %d", player_count, game.round);
+        if (!CheckHash(game, "SetupRound")) {
+            return false;
+        }
+        LV_TEST_CHECK(engine.StartRound(game), "%d players, round %d", player_count, game.round);
+        if (!CheckHash(game, "StartRound")) {
+            return false;
+        }
+
+        while (!engine.IsRoundOver(game)) {
+            lv::LegalMoveList moves{};
+            LV_TEST_CHECK(engine.GetLegalMoves(game, moves) > 0, "%d players, round %d", player_count, game.round);
+            const lv::DiceValue dice = moves.moves[move_rng.NextBelow(static_cast<uint32_t>(moves.count))].dice;
+            LV_TEST_CHECK(engine.AllocateDices(game, dice), "%d players, round %d", player_count, game.round);
+            if (!CheckHash(game, "AllocateDices")) {
+                return false;
+            }
+            if (engine.IsRoundOver(game)) {
+                break;
+            }
+            LV_TEST_CHECK(engine.AdvanceToNextPlayer(game), "%d players, round %d", player_count, game.round);
+            if (!CheckHash(game, "AdvanceToNextPlayer")) {
+                return false;
+            }
+        }
+
+        LV_TEST_CHECK(engine.EndRound(game), "%d players, round %d", player_count, game.round);
+        if (!CheckHash(game, "EndRound")) {
+            return false;
+        }
+        if (engine.IsGameOver(game)) {
+            return true;
+        }
+    }
+}
+
+bool PlayCompactGame(int32_t player_count, uint64_t seed)
+{
+    lv::GameEngine engine{seed};
+    lv::Rng move_rng{~seed};
+    lv::CompactGameState game{};
+    LV_TEST_CHECK(engine.SetupInitGameState(game, player_count) && engine.SetupRound(game) && engine.StartRound(game),
+                  "%d players", player_count);
+    LV_TEST_CHECK(game.hash == lv::ComputeHash(game), "%d players, first round", player_count);
+
+    while (!engine.IsGameOver(game)) {
+        lv::LegalMoveList moves{};
+        LV_TEST_CHECK(engine.GetLegalMoves(game, moves) > 0, "%d players, round %d", player_count, game.round);
+        LV_TEST_CHECK(engine.PlayMove(game, moves.moves[move_rng.NextBelow(static_cast<uint32_t>(moves.count))].dice),
+                      "%d players, round %d", player_count, game.round);
+        LV_TEST_CHECK(game.hash == lv::ComputeHash(game), "%d players, round %d", player_count, game.round);
+    }
+    return true;
+}
+
+} // namespace
+
+bool TestStateHash()
+{
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        for (int32_t game_idx = 0; game_idx < GAME_COUNT_PER_PLAYER_COUNT; ++game_idx) {
+            const uint64_t seed = lv::GetGameSeed(static_cast<uint64_t>(player_count), game_idx);
+            if (!PlayVectorGame(player_count, seed) || !PlayCompactGame(player_count, seed)) {
+                std::fprintf(stderr, "  %d players, game %d\n", player_count, game_idx);
+                return false;
+            }
+        }
+    }
+    return true;
+}
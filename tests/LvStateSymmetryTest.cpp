@@ -0,0 +1,199 @@
+// State symmetries on states of random games
+//
+// Every state is relabeled by hand: casinos permuted at random in the game scope, and in the round scope seats also
+// rotated so that another player is to move. Both must canonicalize to the same state, and with canonical keys the
+// endgame solver must give both the same key. The round scope breaks ties between casinos that only differ by the
+// bets of idle players by casino index, states with such casinos are only relabeled and not compared.
+//
+// The relabeling of every canonicalization must be a permutation, ToOriginal and ToCanonical inverting each other,
+// and must map the dices, bets and bills of the state onto its canonical state.
+
+#include "LvTests.h"
+
+#include "LvEndgameSolver.h"
+#include "LvStateSymmetry.h"
+#include "LvUtils.h"
+
+#include <array>
+
+namespace {
+
+enum { GAME_COUNT_PER_PLAYER_COUNT = 16 };
+
+bool HasDicesLeft(const lv::CompactPlayerState &rPlayer)
+{
+    return rPlayer.dices > 0 || rPlayer.white_dices > 0;
+}
+
+// rGame with casino c moved to pCasinos[c] and player p to seat (p + seat_offset) % player_count
+lv::CompactGameState Relabel(const lv::CompactGameState &rGame, const std::array<uint8_t, lv::CASINO_COUNT> &rCasinos,
+                             int32_t seat_offset)
+{
+    const int32_t player_count = rGame.player_count;
+    const auto to_seat = [&](int32_t player_idx) { return (player_idx + seat_offset) % player_count; };
+
+    lv::CompactGameState relabeled = rGame;
+    for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+        relabeled.players[to_seat(player_idx)] = rGame.players[player_idx];
+    }
+    for (int32_t casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+        const lv::CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        lv::CompactCasinoState &rRelabeledCasino = relabeled.casinos[rCasinos[casino_idx]];
+        rRelabeledCasino = rCasino;
+        for (int32_t player_idx = 0; player_idx < player_count; ++player_idx) {
+            rRelabeledCasino.dice_bets[to_seat(player_idx)] = rCasino.dice_bets[player_idx];
+        }
+        relabeled.current_turn.dices[rCasinos[casino_idx]] = rGame.current_turn.dices[casino_idx];
+        relabeled.current_turn.white_dices[rCasinos[casino_idx]] = rGame.current_turn.white_dices[casino_idx];
+    }
+    relabeled.current_turn.player_idx = static_cast<lv::PlayerIdx>(to_seat(rGame.current_turn.player_idx));
+    relabeled.first_player_idx = static_cast<lv::PlayerIdx>(to_seat(rGame.first_player_idx));
+    return relabeled;
+}
+
+// Whether two casinos of a round scope canonical state can only be told apart by the bets of idle players
+bool HasIdleBetTie(const lv::CompactGameState &rCanonical)
+{
+    for (int32_t casino_idx = 1; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+        const lv::CompactCasinoState &rCasino = rCanonical.casinos[casino_idx];
+        const lv::CompactCasinoState &rPrevious = rCanonical.casinos[casino_idx - 1];
+        bool tie = rCasino.bills == rPrevious.bills && rCasino.neutral_dice_bet == rPrevious.neutral_dice_bet &&
+                   rCanonical.current_turn.dices[casino_idx] == rCanonical.current_turn.dices[casino_idx - 1] &&
+                   rCanonical.current_turn.white_dices[casino_idx] ==
+                       rCanonical.current_turn.white_dices[casino_idx - 1];
+        for (int32_t seat_idx = 0; seat_idx < rCanonical.player_count && tie; ++seat_idx) {
+            tie = !HasDicesLeft(rCanonical.players[seat_idx]) ||
+                  rCasino.dice_bets[seat_idx] == rPrevious.dice_bets[seat_idx];
+        }
+        if (tie && !(rCasino == rPrevious)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CheckSymmetry(const lv::CompactGameState &rGame, lv::SymmetryScope scope, const lv::CompactGameState &rCanonical,
+                   const lv::StateSymmetry &rSymmetry)
+{
+    for (int32_t face = 1; face <= lv::CASINO_COUNT; ++face) {
+        const lv::DiceValue dice = static_cast<lv::DiceValue>(face);
+        LV_TEST_CHECK(rSymmetry.ToOriginal(rSymmetry.ToCanonical(dice)) == dice &&
+                          rSymmetry.ToCanonical(rSymmetry.ToOriginal(dice)) == dice,
+                      "face %d", face);
+
+        const int32_t casino_idx = face - 1;
+        const int32_t canonical_casino_idx = static_cast<int32_t>(rSymmetry.ToCanonical(dice)) - 1;
+        const lv::CompactCasinoState &rCasino = rGame.casinos[casino_idx];
+        const lv::CompactCasinoState &rCanonicalCasino = rCanonical.casinos[canonical_casino_idx];
+        LV_TEST_CHECK(rCanonicalCasino.bills == rCasino.bills &&
+                          rCanonicalCasino.neutral_dice_bet == rCasino.neutral_dice_bet &&
+                          rCanonical.current_turn.dices[canonical_casino_idx] == rGame.current_turn.dices[casino_idx] &&
+                          rCanonical.current_turn.white_dices[canonical_casino_idx] ==
+                              rGame.current_turn.white_dices[casino_idx],
+                      "casino %d", casino_idx);
+        for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+            const lv::PlayerIdx canonical_player_idx = rSymmetry.ToCanonical(static_cast<lv::PlayerIdx>(player_idx));
+            LV_TEST_CHECK(rCanonicalCasino.dice_bets[canonical_player_idx] == rCasino.dice_bets[player_idx],
+                          "casino %d, player %d", casino_idx, player_idx);
+        }
+    }
+
+    for (int32_t player_idx = 0; player_idx < rGame.player_count; ++player_idx) {
+        const lv::PlayerIdx player = static_cast<lv::PlayerIdx>(player_idx);
+        LV_TEST_CHECK(static_cast<int32_t>(rSymmetry.ToCanonical(player)) < rGame.player_count &&
+                          rSymmetry.ToOriginal(rSymmetry.ToCanonical(player)) == player &&
+                          rSymmetry.ToCanonical(rSymmetry.ToOriginal(player)) == player,
+                      "player %d", player_idx);
+        const lv::CompactPlayerState &rPlayer = rGame.players[player_idx];
+        const lv::CompactPlayerState &rCanonicalPlayer = rCanonical.players[rSymmetry.ToCanonical(player)];
+        LV_TEST_CHECK(rCanonicalPlayer.dices == rPlayer.dices && rCanonicalPlayer.white_dices == rPlayer.white_dices,
+                      "player %d", player_idx);
+        if (scope == lv::SymmetryScope::Game) {
+            LV_TEST_CHECK(rSymmetry.ToCanonical(player) == player && rCanonicalPlayer.bills == rPlayer.bills,
+                          "player %d", player_idx);
+        }
+    }
+    LV_TEST_CHECK(rCanonical.current_turn.player_idx == rSymmetry.ToCanonical(rGame.current_turn.player_idx),
+                  "player %d to move", rGame.current_turn.player_idx);
+    return true;
+}
+
+bool CheckState(const lv::CompactGameState &rGame, lv::Rng &rRng, const lv::EndgameSolver &rSolver)
+{
+    for (const lv::SymmetryScope scope : {lv::SymmetryScope::Game, lv::SymmetryScope::Round}) {
+        std::array<uint8_t, lv::CASINO_COUNT> casinos{};
+        for (int32_t casino_idx = 0; casino_idx < lv::CASINO_COUNT; ++casino_idx) {
+            casinos[casino_idx] = static_cast<uint8_t>(casino_idx);
+        }
+        for (int32_t casino_idx = lv::CASINO_COUNT - 1; casino_idx > 0; --casino_idx) {
+            std::swap(casinos[casino_idx], casinos[rRng.NextBelow(static_cast<uint32_t>(casino_idx + 1))]);
+        }
+        int32_t seat_offset = 0;
+        if (scope == lv::SymmetryScope::Round) {
+            seat_offset = static_cast<int32_t>(rRng.NextBelow(static_cast<uint32_t>(rGame.player_count)));
+        }
+        const lv::CompactGameState relabeled = Relabel(rGame, casinos, seat_offset);
+
+        lv::CompactGameState canonical{};
+        lv::StateSymmetry symmetry{};
+        lv::Canonicalize(rGame, scope, canonical, symmetry);
+        lv::CompactGameState relabeled_canonical{};
+        lv::StateSymmetry relabeled_symmetry{};
+        lv::Canonicalize(relabeled, scope, relabeled_canonical, relabeled_symmetry);
+        if (!CheckSymmetry(rGame, scope, canonical, symmetry) ||
+            !CheckSymmetry(relabeled, scope, relabeled_canonical, relabeled_symmetry)) {
+            return false;
+        }
+
+        if (scope == lv::SymmetryScope::Game || !HasIdleBetTie(canonical)) {
+            LV_TEST_CHECK(relabeled_canonical == canonical, "scope %d, seat offset %d", static_cast<int32_t>(scope),
+                          seat_offset);
+            LV_TEST_CHECK(lv::ComputeCanonicalHash(relabeled, scope) == lv::ComputeCanonicalHash(rGame, scope),
+                          "scope %d, seat offset %d", static_cast<int32_t>(scope), seat_offset);
+        }
+    }
+
+    // Keys are taken before the roll, which may leave more casinos tied
+    const std::array<uint8_t, lv::CASINO_COUNT> casinos{5, 3, 1, 0, 2, 4};
+    const int32_t seat_offset = rGame.player_count - 1;
+    lv::CompactGameState game = rGame;
+    game.current_turn.dices = {};
+    game.current_turn.white_dices = {};
+    lv::CompactGameState canonical{};
+    lv::StateSymmetry symmetry{};
+    lv::Canonicalize(game, lv::SymmetryScope::Round, canonical, symmetry);
+    if (!HasIdleBetTie(canonical)) {
+        LV_TEST_CHECK(rSolver.GetKey(Relabel(rGame, casinos, seat_offset)) == rSolver.GetKey(rGame),
+                      "seat offset %d", seat_offset);
+    }
+    return true;
+}
+
+} // namespace
+
+bool TestStateSymmetry()
+{
+    const lv::EndgameSolver solver{lv::EndgameSolver::DEFAULT_MAX_DICE_COUNT, 10, true};
+    lv::Rng rng{1};
+    for (int32_t player_count = 2; player_count <= lv::MAX_PLAYER_COUNT; ++player_count) {
+        for (int32_t game_idx = 0; game_idx < GAME_COUNT_PER_PLAYER_COUNT; ++game_idx) {
+            lv::GameEngine engine{static_cast<uint64_t>(game_idx)};
+            lv::CompactGameState game{};
+            LV_TEST_CHECK(engine.SetupInitGameState(game, player_count) && engine.SetupRound(game) &&
+                              engine.StartRound(game),
+                          "%d players, game %d", player_count, game_idx);
+
+            while (!engine.IsGameOver(game)) {
+                if (!CheckState(game, rng, solver)) {
+                    std::fprintf(stderr, "  %d players, game %d, round %d\n", player_count, game_idx, game.round);
+                    return false;
+                }
+
+                lv::LegalMoveList moves{};
+                LV_TEST_CHECK(engine.GetLegalMoves(game, moves) > 0, "%d players, game %d", player_count, game_idx);
+                engine.PlayMove(game, moves.moves[rng.NextBelow(static_cast<uint32_t>(moves.count))].dice);
+            }
+        }
+    }
+    return true;
+}
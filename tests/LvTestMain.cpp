@@ -0,0 +1,66 @@
+// Test runner: runs the tests named on the command line, or all of them, and fails if any does
+
+#include "LvTests.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+struct TestEntry {
+    const char *pName;
+    bool (*pFn)();
+};
+
+const TestEntry TEST_TABLE[] = {
+    {"CasinoResolution", TestCasinoResolution},
+    {"BatchLockstep", TestBatchLockstep},
+    {"EndgameSolver", TestEndgameSolver},
+    {"StateSymmetry", TestStateSymmetry},
+    {"GameRecord", TestGameRecord},
+    {"ExpectedValue", TestExpectedValue},
+    {"RulesChecker", TestRulesChecker},
+    {"StateHash", TestStateHash},
+    {"DiceRoll", TestDiceRoll},
+    {"NeuralNetwork", TestNeuralNetwork},
+    {"EngineEvents", TestEngineEvents},
+};
+
+bool RunTest(const TestEntry &rTest)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    const bool passed = rTest.pFn();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::printf("%-24s %s (%.2f s)\n", rTest.pName, passed ? "passed" : "FAILED", seconds);
+    return passed;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bool passed = true;
+
+    if (argc <= 1) {
+        for (const TestEntry &rTest : TEST_TABLE) {
+            passed &= RunTest(rTest);
+        }
+        return passed ? 0 : 1;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        const TestEntry *pTest = nullptr;
+        for (const TestEntry &rTest : TEST_TABLE) {
+            if (std::strcmp(rTest.pName, argv[i]) == 0) {
+                pTest = &rTest;
+            }
+        }
+        if (pTest == nullptr) {
+            std::fprintf(stderr, "Unknown test '%s'\n", argv[i]);
+            return 1;
+        }
+        passed &= RunTest(*pTest);
+    }
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdio>
+
+// Tests run by CTest through LasVegTests, one test per name (see LvTestMain.cpp)
+//
+// A test returns whether it passed and prints what went wrong, it stops at the first failure as later ones usually
+// follow from it.
+
+#define LV_TEST_CHECK(condition, ...)                                                                                  \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n  ", __FILE__, __LINE__, #condition);                       \
+            std::fprintf(stderr, __VA_ARGS__);                                                                         \
+            std::fprintf(stderr, "\n");                                                                                \
+            return false;                                                                                              \
+        }                                                                                                              \
+    } while (false)
+
+bool TestBatchLockstep();
+bool TestCasinoResolution();
+bool TestDiceRoll();
+bool TestEndgameSolver();
+bool TestEngineEvents();
+bool TestExpectedValue();
+bool TestGameRecord();
+bool TestNeuralNetwork();
+bool TestRulesChecker();
+bool TestStateHash();
+bool TestStateSymmetry();